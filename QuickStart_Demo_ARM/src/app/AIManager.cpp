@@ -51,7 +51,8 @@ void AIManager::setMode(AIMode mode)
     LOG_INFO(QString("Mode changed from %1 to %2").arg(static_cast<int>(oldMode)).arg(static_cast<int>(mode)));
     
     // 如果当前 AI 已启动，先停止
-    if (m_aiStarted) {
+    bool wasStarted = m_aiStarted;
+    if (wasStarted) {
         stopAI();
     }
     
@@ -61,8 +62,8 @@ void AIManager::setMode(AIMode mode)
         if (!sceneId.isEmpty() && m_aigcApi) {
             m_aigcApi->setSceneId(sceneId);
             
-            // 短暂延迟后启动 AI
-            QTimer::singleShot(800, this, [this]() {
+            // 短暂延迟后启动 AI，等待上一个任务停止；从待机 (如唤醒词) 启动时无需等待
+            QTimer::singleShot(wasStarted ? 800 : 0, this, [this]() {
                 startAI();
             });
         }
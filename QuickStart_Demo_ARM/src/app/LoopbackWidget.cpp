@@ -0,0 +1,131 @@
+#include "LoopbackWidget.h"
+#include "MediaManager.h"
+#include "VideoRenderWidgetGL.h"
+#include "VideoLatencyMonitor.h"
+#include <QLabel>
+#include <QPushButton>
+#include <QResizeEvent>
+#include <QDebug>
+
+static const char* BUTTON_STYLE =
+    "QPushButton {"
+    "  background: rgba(0, 0, 0, 0.5);"
+    "  border: none;"
+    "  border-radius: 6px;"
+    "  color: white;"
+    "  font-size: 14px;"
+    "  padding: 6px 12px;"
+    "}"
+    "QPushButton:checked { background: rgba(33, 150, 243, 0.7); }"
+    "QPushButton:disabled { color: #888; }";
+
+LoopbackWidget::LoopbackWidget(MediaManager* mediaManager, int testCount, QWidget* parent)
+    : QWidget(parent)
+    , m_mediaManager(mediaManager)
+    , m_testCount(testCount > 0 ? testCount : 20)
+{
+    setStyleSheet("background: black;");
+    
+    m_video = new VideoRenderWidgetGL(this);
+    
+    // 延迟统计 (左上角覆盖在画面上)
+    m_statsLabel = new QLabel(this);
+    m_statsLabel->setStyleSheet("background: rgba(0, 0, 0, 0.5); color: white; font-size: 14px; padding: 8px;");
+    m_statsLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+    
+    m_testBtn = new QPushButton("测量延迟", this);
+    m_testBtn->setStyleSheet(BUTTON_STYLE);
+    m_monitorBtn = new QPushButton("直通", this);
+    m_monitorBtn->setStyleSheet(BUTTON_STYLE);
+    m_monitorBtn->setCheckable(true);
+    m_monitorBtn->setChecked(true);
+    m_monitorBtn->setToolTip("麦克风直接送到扬声器");
+    m_closeBtn = new QPushButton("退出", this);
+    m_closeBtn->setStyleSheet(BUTTON_STYLE);
+    
+    connect(m_testBtn, &QPushButton::clicked, this, [this] {
+        m_mediaManager->startLatencyTest(m_testCount);
+        updateStats();
+    });
+    connect(m_monitorBtn, &QPushButton::toggled, this, [this](bool checked) {
+        m_mediaManager->setLoopbackMonitor(checked);
+    });
+    connect(m_closeBtn, &QPushButton::clicked, this, &QWidget::close);
+    
+    connect(m_mediaManager, &MediaManager::localVideoFrame, this, &LoopbackWidget::onLocalVideoFrame);
+    connect(m_mediaManager, &MediaManager::latencyMeasured, this, &LoopbackWidget::onLatencyMeasured);
+    connect(m_mediaManager, &MediaManager::latencyTestFinished, this, &LoopbackWidget::updateStats);
+    
+    if (m_mediaManager->startLoopback(true)) {
+        // 回环画面不经过 SDK，视频延迟单独分组
+        VideoLatencyMonitor::instance()->setConfiguration(QString("loopback gpu %1")
+            .arg(m_mediaManager->currentCamera().type.toLower()));
+        m_mediaManager->startLatencyTest(m_testCount);
+    }
+    updateStats();
+}
+
+LoopbackWidget::~LoopbackWidget()
+{
+    m_mediaManager->stopLoopback();
+    if (VideoLatencyMonitor::instance()->isEnabled()) {
+        VideoLatencyMonitor::instance()->logSummary();
+    }
+}
+
+void LoopbackWidget::resizeEvent(QResizeEvent* event)
+{
+    Q_UNUSED(event);
+    m_video->setGeometry(rect());
+    m_statsLabel->move(10, 10);
+    m_statsLabel->adjustSize();
+    
+    int x = width() - 10;
+    for (QPushButton* btn : {m_closeBtn, m_monitorBtn, m_testBtn}) {
+        btn->adjustSize();
+        x -= btn->width();
+        btn->move(x, height() - btn->height() - 10);
+        x -= 10;
+    }
+}
+
+void LoopbackWidget::onLocalVideoFrame(const QByteArray& i420, int width, int height)
+{
+    const uint8_t* y = reinterpret_cast<const uint8_t*>(i420.constData());
+    const uint8_t* u = y + width * height;
+    const uint8_t* v = u + width * height / 4;
+    VideoLatencyMonitor::instance()->recordFrame(VideoLatencyMonitor::Sink, y, width, 1, width, height);
+    m_video->updateI420Frame(y, u, v, width, height, width, width / 2, width / 2);
+}
+
+void LoopbackWidget::onLatencyMeasured(double latencyMs)
+{
+    m_lastMs = latencyMs;
+    updateStats();
+}
+
+void LoopbackWidget::updateStats()
+{
+    LatencyStats stats = m_mediaManager->latencyStats();
+    bool running = m_mediaManager->isLatencyTestRunning();
+    QString text;
+    if (!m_mediaManager->isLoopbackActive()) {
+        text = "回环启动失败，查看日志";
+    } else {
+        text = QString("麦克风→扬声器→麦克风 往返延迟%1\n").arg(running ? " (测量中)" : "");
+        if (stats.count > 0) {
+            text += QString("平均 %1 ms，标准差 %2 ms\n最小 %3 ms，最大 %4 ms\n")
+                        .arg(stats.meanMs(), 0, 'f', 1).arg(stats.stddevMs(), 0, 'f', 1)
+                        .arg(stats.minMs, 0, 'f', 1).arg(stats.maxMs, 0, 'f', 1);
+        }
+        text += QString("已测 %1 / %2 次，未检测到 %3 次")
+                    .arg(stats.count + stats.missed).arg(m_testCount).arg(stats.missed);
+        if (m_lastMs >= 0) {
+            text += QString("，上次 %1 ms").arg(m_lastMs, 0, 'f', 1);
+        }
+        text += QString("\n播放缓冲 %1 ms").arg(m_mediaManager->renderLatencyMs());
+    }
+    m_statsLabel->setText(text);
+    m_statsLabel->adjustSize();
+    m_testBtn->setEnabled(m_mediaManager->isLoopbackActive() && !running);
+}
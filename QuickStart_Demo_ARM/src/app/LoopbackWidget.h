@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QWidget>
+
+class MediaManager;
+class VideoRenderWidgetGL;
+class QLabel;
+class QPushButton;
+
+/**
+ * 本地回环页面 (--loopback)
+ * 不加入房间: 摄像头画面直接显示，麦克风直接送到扬声器，
+ * 启动后自动做一轮 chirp 延迟测试，显示麦克风 -> 扬声器 -> 麦克风的往返延迟及其波动，
+ * 作为通话中延迟的对照基线
+ */
+class LoopbackWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    LoopbackWidget(MediaManager* mediaManager, int testCount, QWidget* parent = nullptr);
+    ~LoopbackWidget() override;
+
+protected:
+    void resizeEvent(QResizeEvent* event) override;
+
+private:
+    void onLocalVideoFrame(const QByteArray& i420, int width, int height);
+    void onLatencyMeasured(double latencyMs);
+    void updateStats();
+
+    MediaManager* m_mediaManager = nullptr;
+    VideoRenderWidgetGL* m_video = nullptr;
+    QLabel* m_statsLabel = nullptr;
+    QPushButton* m_testBtn = nullptr;
+    QPushButton* m_monitorBtn = nullptr;
+    QPushButton* m_closeBtn = nullptr;
+    int m_testCount = 20;
+    double m_lastMs = -1.0;
+};
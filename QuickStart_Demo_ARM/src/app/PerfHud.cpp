@@ -0,0 +1,129 @@
+#include "PerfHud.h"
+#include "MediaManager.h"
+#include "ConfigManager.h"
+#include "ControlRegistry.h"
+#include "MetricsRegistry.h"
+#include <QJsonObject>
+#include <QTimer>
+
+static const int HUD_REFRESH_MS = 1000;    // 与 ProcStats 的采样粒度一致
+static const int HUD_TOP_THREADS = 4;
+
+// 读不到的数值显示为 "-"
+static QString number(double value, int precision = 1)
+{
+    return value < 0.0 ? QString("-") : QString::number(value, 'f', precision);
+}
+
+static double readMetric(const QString& name, const QString& labels = QString())
+{
+    double value = 0.0;
+    return MetricsRegistry::instance()->read(name, labels, &value) ? value : -1.0;
+}
+
+PerfHud::PerfHud(MediaManager* mediaManager, QObject* parent)
+    : QObject(parent)
+    , m_mediaManager(mediaManager)
+{
+    m_timer = new QTimer(this);
+    m_timer->setInterval(HUD_REFRESH_MS);
+    connect(m_timer, &QTimer::timeout, this, &PerfHud::refresh);
+
+    ControlRegistry::instance()->registerCommand("hud", "Performance overlay {visible: bool}", this,
+                                                 [this](const QJsonObject& params, QString* error) {
+        if (params.contains("visible")) {
+            if (!params.value("visible").isBool()) {
+                *error = "\"visible\" must be a boolean";
+                return QJsonObject();
+            }
+            setVisible(params.value("visible").toBool());
+        }
+        return QJsonObject{{"visible", m_visible}};
+    });
+
+    setVisible(ConfigManager::instance()->perfHud());
+}
+
+void PerfHud::setVisible(bool visible)
+{
+    if (visible == m_visible) {
+        return;
+    }
+    m_visible = visible;
+    ConfigManager::instance()->setPerfHud(visible);
+    if (visible) {
+        // 第一次刷新只建立基线 (帧率和线程 CPU 需要两次采样)
+        m_lastCounters.clear();
+        m_procStats.sampleThreads();
+        m_interval.start();
+        m_lines = QStringList{"PERF HUD (sampling...)"};
+        m_timer->start();
+    } else {
+        m_timer->stop();
+        m_lines.clear();
+    }
+    emit textChanged(m_lines);
+}
+
+double PerfHud::counterRate(const QString& name, double elapsedSec)
+{
+    double value = 0.0;
+    if (!MetricsRegistry::instance()->read(name, QString(), &value)) {
+        return -1.0;
+    }
+    auto last = m_lastCounters.constFind(name);
+    double rate = last != m_lastCounters.constEnd() && elapsedSec > 0.0 && value >= last.value()
+        ? (value - last.value()) / elapsedSec : -1.0;
+    m_lastCounters.insert(name, value);
+    return rate;
+}
+
+void PerfHud::refresh()
+{
+    double elapsedSec = m_interval.restart() / 1000.0;
+    QStringList lines;
+
+    // 视频: 采集 -> 推送 SDK -> 本地绘制
+    lines << QString("FPS   cap %1  push %2  draw %3")
+        .arg(number(counterRate("video_capture_frames", elapsedSec)))
+        .arg(number(counterRate("video_push_frames", elapsedSec)))
+        .arg(number(counterRate("video_render_frames", elapsedSec)));
+    ConfigManager* config = ConfigManager::instance();
+    lines << QString("VIDEO %1x%2@%3  age %4 ms")
+        .arg(config->videoWidth()).arg(config->videoHeight()).arg(config->videoFrameRate())
+        .arg(number(readMetric("video_render_frame_age_ms")));
+
+    // 音频: 抖动缓冲深度/目标 + 声卡队列
+    if (m_mediaManager) {
+        JitterBuffer::Stats jitter = m_mediaManager->renderJitterStats();
+        lines << QString("AUDIO jitter %1/%2 ms  out %3 ms  underruns %4")
+            .arg(jitter.depthMs).arg(jitter.targetMs)
+            .arg(m_mediaManager->renderLatencyMs()).arg(jitter.underruns);
+    }
+
+    // 网络: 房间统计回调 (rtc_room_bitrate_kbps)，不在房间时为 "-"
+    const QString all = MetricsRegistry::label("media", "all");
+    lines << QString("NET   up %1 kbps  down %2 kbps")
+        .arg(number(readMetric("rtc_room_bitrate_kbps", MetricsRegistry::label("direction", "tx") + "," + all), 0))
+        .arg(number(readMetric("rtc_room_bitrate_kbps", MetricsRegistry::label("direction", "rx") + "," + all), 0));
+
+    // CPU: 进程合计 + 占用最高的几个线程 (wait 为运行队列等待)
+    QList<ProcStats::ThreadCpu> threads = m_procStats.sampleThreads();
+    ProcStats::Memory memory = ProcStats::sampleMemory();
+    lines << QString("CPU   proc %1%  SoC %2 C")
+        .arg(number(m_procStats.processPercent(), 0))
+        .arg(number(ProcStats::socTemperatureC()));
+    lines << QString("MEM   rss %1 MB  pss %2 MB  majflt %3")
+        .arg(number(memory.rssKB < 0 ? -1.0 : memory.rssKB / 1024.0))
+        .arg(number(memory.pssKB < 0 ? -1.0 : memory.pssKB / 1024.0))
+        .arg(memory.majorFaults);
+    for (int i = 0; i < threads.size() && i < HUD_TOP_THREADS; i++) {
+        lines << QString("  %1% wait %2% %3")
+            .arg(number(threads.at(i).percent, 0), 3)
+            .arg(number(threads.at(i).waitPercent, 0), 2)
+            .arg(threads.at(i).name);
+    }
+
+    m_lines = lines;
+    emit textChanged(m_lines);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include "ProcStats.h"
+
+class MediaManager;
+class QTimer;
+
+/**
+ * 性能 HUD 数据源
+ * 显示时每秒汇总一次: 采集/推送/绘制帧率、帧龄、音频抖动缓冲深度、各线程 CPU、SoC 温度、上下行码率，
+ * 生成 ASCII 文本交给视频渲染控件叠加绘制 (setHudText)。帧率由指标注册表中的计数器求差得到，
+ * 隐藏时定时器停止，不读 /proc
+ *
+ * 开关: 配置 ui.perfHud、控制命令 hud、在视频区域长按
+ */
+class PerfHud : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PerfHud(MediaManager* mediaManager, QObject* parent = nullptr);
+
+    void setVisible(bool visible);
+    bool isVisible() const { return m_visible; }
+    // 当前文本 (隐藏时为空)，新建的渲染控件用它初始化
+    QStringList lines() const { return m_lines; }
+
+signals:
+    // 隐藏时发出空列表
+    void textChanged(const QStringList& lines);
+
+private:
+    void refresh();
+    // 计数器在本次与上次刷新之间的增量 / 秒，读不到时返回负数
+    double counterRate(const QString& name, double elapsedSec);
+
+    MediaManager* m_mediaManager = nullptr;
+    QTimer* m_timer = nullptr;
+    bool m_visible = false;
+    QStringList m_lines;
+    ProcStats m_procStats;
+    QElapsedTimer m_interval;
+    QHash<QString, double> m_lastCounters;
+};
@@ -20,6 +20,11 @@
 #include "RoomManager.h"
 #include "MediaManager.h"
 #include "ConfigManager.h"
+#include "VideoLatencyMonitor.h"
+#include "TraceRecorder.h"
+#include "RtcMetrics.h"
+#include "ControlRegistry.h"
+#include "PerfHud.h"
 #include "rtc/bytertc_audio_device_manager.h"
 #include <QPushButton>
 #include <QLabel>
@@ -27,6 +32,13 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QDateTime>
+#include <QDir>
+
+static const int LEVEL_METER_INTERVAL_MS = 50;
+// 长按视频区域切换性能 HUD: 按住时长和允许的移动距离
+static const int HUD_LONG_PRESS_MS = 1500;
+static const int HUD_LONG_PRESS_SLOP = 10;
 
 /**
  * VolcEngineRTC 视频通话的主页面
@@ -91,6 +103,31 @@ RoomMainWidget::RoomMainWidget(QWidget *parent)
     connect(m_aiManager, &AIManager::aiFailed, this, &RoomMainWidget::slotOnAIFailed);
     connect(m_aiManager, &AIManager::aiStopped, this, &RoomMainWidget::slotOnAIStopped);
     
+    // 提前打开麦克风进入预录，AI 启动时补推开头的语音
+    m_mediaManager = new MediaManager(this);
+    m_mediaManager->warmUpAudioCapture();
+    connect(m_mediaManager, &MediaManager::videoFormatChanged, this, &RoomMainWidget::updateVideoLatencyConfiguration);
+    
+    // 性能 HUD (ui.perfHud / 控制命令 hud / 长按视频区域)
+    m_perfHud = new PerfHud(m_mediaManager, this);
+    attachPerfHud();
+    
+    // 控制接口: 查询/切换渲染方式
+    ControlRegistry::instance()->registerCommand("render.mode", "Video rendering {mode: gpu|cpu}", this,
+                                                 [this](const QJsonObject& params, QString* error) {
+        if (params.contains("mode")) {
+            QString mode = params.value("mode").toString();
+            if (mode != "gpu" && mode != "cpu") {
+                *error = "\"mode\" must be \"gpu\" or \"cpu\"";
+                return QJsonObject();
+            }
+            setGPURendering(mode == "gpu");
+        }
+        return QJsonObject{{"mode", m_useGPURendering ? "gpu" : "cpu"}};
+    });
+    connect(m_mediaManager, &MediaManager::wakeWordDetected, this, &RoomMainWidget::slotOnWakeWordDetected);
+    connect(m_mediaManager, &MediaManager::bargeInDetected, this, &RoomMainWidget::slotOnBargeInDetected);
+    
     // 自动获取场景配置
     qDebug() << "正在从 AIGC Server 获取配置...";
     m_aiManager->initialize(ConfigManager::instance()->serverUrl());
@@ -101,16 +138,9 @@ void RoomMainWidget::leaveRoom() {
 }
 
 void RoomMainWidget::setupView() {
-    // 创建视频背景 - 优先使用 GPU 渲染
-    if (m_useGPURendering) {
-        m_videoBackgroundGL = new VideoRenderWidgetGL(ui.mainWidget);
-        m_videoBackgroundGL->setObjectName("videoBackground");
-        qDebug() << "Using GPU (OpenGL) video rendering";
-    } else {
-        m_videoBackground = new VideoRenderWidget(ui.mainWidget);
-        m_videoBackground->setObjectName("videoBackground");
-        qDebug() << "Using CPU video rendering";
-    }
+    // 创建视频背景 - 默认使用 GPU 渲染 (ui.useGPURendering)
+    m_useGPURendering = ConfigManager::instance()->useGPURendering();
+    createVideoBackground();
     
     // 创建对话字幕组件 (覆盖在视频上)
     m_conversationWidget = new ConversationWidget(ui.mainWidget);
@@ -148,6 +178,16 @@ void RoomMainWidget::setupView() {
     m_loginWidget = QSharedPointer<LoginWidget>::create(this);
     m_operateWidget = QSharedPointer<OperateWidget>::create(this);
     m_modeWidget = QSharedPointer<ModeWidget>::create(this);
+    
+    // 电平表按 UI 节拍轮询 (无锁读取)，音频线程不发送任何 Qt 事件
+    m_levelTimer = new QTimer(this);
+    m_levelTimer->setInterval(LEVEL_METER_INTERVAL_MS);
+    connect(m_levelTimer, &QTimer::timeout, this, [this] {
+        if (m_mediaManager) {
+            m_operateWidget->setAudioLevels(m_mediaManager->captureLevel(LEVEL_METER_INTERVAL_MS),
+                                            m_mediaManager->playbackLevel(LEVEL_METER_INTERVAL_MS));
+        }
+    });
     toggleShowFloatWidget(false);
     
     // 初始布局
@@ -163,10 +203,91 @@ void RoomMainWidget::on_closeBtn_clicked() {
 void RoomMainWidget::mousePressEvent(QMouseEvent *event) {
     if (event->buttons() & Qt::LeftButton) {
         m_prevGlobalPoint = event->globalPos();
+        m_pressGlobalPoint = event->globalPos();
+        m_pressTimer.start();
         m_bLeftBtnPressed = true;
     }
 }
 
+void RoomMainWidget::createVideoBackground() {
+    if (m_useGPURendering) {
+        m_videoBackgroundGL = new VideoRenderWidgetGL(ui.mainWidget);
+        m_videoBackgroundGL->setObjectName("videoBackground");
+        qDebug() << "Using GPU (OpenGL) video rendering";
+    } else {
+        m_videoBackground = new VideoRenderWidget(ui.mainWidget);
+        m_videoBackground->setObjectName("videoBackground");
+        qDebug() << "Using CPU video rendering";
+    }
+    attachPerfHud();
+}
+
+void RoomMainWidget::attachPerfHud() {
+    if (!m_perfHud) {
+        return;
+    }
+    // 旧控件销毁时连接自动断开
+    if (m_videoBackgroundGL) {
+        connect(m_perfHud, &PerfHud::textChanged, m_videoBackgroundGL, &VideoRenderWidgetGL::setHudText);
+        m_videoBackgroundGL->setHudText(m_perfHud->lines());
+    } else if (m_videoBackground) {
+        connect(m_perfHud, &PerfHud::textChanged, m_videoBackground, &VideoRenderWidget::setHudText);
+        m_videoBackground->setHudText(m_perfHud->lines());
+    }
+}
+
+void RoomMainWidget::setGPURendering(bool enabled) {
+    if (enabled == m_useGPURendering) {
+        return;
+    }
+    
+    // 旧控件先与 sink 解除关联并隐藏，之后 sink 被替换销毁时不会再被绘制访问
+    QWidget* oldBackground = nullptr;
+    if (m_videoBackgroundGL) {
+        m_videoBackgroundGL->setVideoSink(nullptr);
+        oldBackground = m_videoBackgroundGL;
+    } else if (m_videoBackground) {
+        m_videoBackground->setVideoSink(nullptr);
+        oldBackground = m_videoBackground;
+    }
+    bool visible = oldBackground && !oldBackground->isHidden();
+    if (oldBackground) {
+        oldBackground->hide();
+    }
+    m_videoBackgroundGL = nullptr;
+    m_videoBackground = nullptr;
+    
+    m_useGPURendering = enabled;
+    ConfigManager::instance()->setUseGPURendering(enabled);
+    createVideoBackground();
+    QWidget* background = m_useGPURendering ? static_cast<QWidget*>(m_videoBackgroundGL)
+                                            : static_cast<QWidget*>(m_videoBackground);
+    // 视频背景在字幕、待机动画等覆盖层之下
+    background->setGeometry(ui.mainWidget->rect());
+    background->lower();
+    background->setVisible(visible);
+    
+    // 通话中: SDK 切换到新 sink 后旧 sink 才被销毁
+    if (m_roomManager && m_roomManager->getEngine()) {
+        setupCustomVideoSink(true, "", "", background);
+    }
+    if (oldBackground) {
+        oldBackground->deleteLater();
+    }
+    updateVideoLatencyConfiguration();
+    qDebug() << "Video rendering switched to" << (enabled ? "GPU" : "CPU");
+}
+
+void RoomMainWidget::updateVideoLatencyConfiguration() {
+    if (!m_mediaManager) {
+        return;
+    }
+    VideoLatencyMonitor::instance()->setConfiguration(QString("%1 %2x%3 %4")
+        .arg(m_useGPURendering ? "gpu" : "cpu")
+        .arg(ConfigManager::instance()->videoWidth()).arg(ConfigManager::instance()->videoHeight())
+        .arg(m_mediaManager->currentCamera().type.toLower()));
+}
+
 void RoomMainWidget::resizeEvent(QResizeEvent *event) {
     Q_UNUSED(event);
     
@@ -214,6 +335,10 @@ void RoomMainWidget::mouseMoveEvent(QMouseEvent *event) {
 }
 
 void RoomMainWidget::mouseReleaseEvent(QMouseEvent *event) {
+    if (m_bLeftBtnPressed && m_perfHud && m_pressTimer.elapsed() >= HUD_LONG_PRESS_MS &&
+        (event->globalPos() - m_pressGlobalPoint).manhattanLength() <= HUD_LONG_PRESS_SLOP) {
+        m_perfHud->setVisible(!m_perfHud->isVisible());
+    }
     m_bLeftBtnPressed = false;
 }
 
@@ -254,6 +379,8 @@ void RoomMainWidget::slotOnEnterRoom(const QString &roomID, const QString &userI
         m_mediaManager = new MediaManager(this);
     }
     m_mediaManager->initialize(engine);
+    m_mediaManager->turnTracker()->reset();
+    updateAudioPush();
     
     // 如果是空的stream_id，RTC会自动生成
     std::string stream_id = "";
@@ -266,6 +393,14 @@ void RoomMainWidget::slotOnEnterRoom(const QString &roomID, const QString &userI
         setupCustomVideoSink(true, stream_id, uidStr, m_videoBackground);
     }
     
+    // 视频延迟按渲染方式、编码分辨率和采集管道分组统计
+    updateVideoLatencyConfiguration();
+    
+    // 分流混音时优先播放智能体的音频
+    if (m_aiManager && m_aiManager->hasConfig()) {
+        m_mediaManager->setAgentUserId(m_aiManager->getRtcConfig().botName);
+    }
+    
     // 启动所有媒体
     m_mediaManager->startAll();
 
@@ -291,6 +426,14 @@ void RoomMainWidget::toggleShowFloatWidget(bool isEnterRoom) {
     m_loginWidget->setVisible(!isEnterRoom);
     m_operateWidget->setVisible(isEnterRoom);
     m_modeWidget->setVisible(isEnterRoom);
+    if (m_levelTimer) {
+        if (isEnterRoom) {
+            m_levelTimer->start();
+        } else {
+            m_levelTimer->stop();
+            m_operateWidget->setAudioLevels(AudioLevelMeter::Reading(), AudioLevelMeter::Reading());
+        }
+    }
     if (m_closeBtn) {
         m_closeBtn->setVisible(isEnterRoom);
     }
@@ -309,7 +452,11 @@ void RoomMainWidget::slotOnHangup() {
     
     // 停止所有媒体
     if (m_mediaManager) {
+        exportReports();
         m_mediaManager->stopAll();
+        // 操作栏复位为未静音，挂起状态随之清除
+        m_mediaManager->setAudioCaptureSuspended(false);
+        m_mediaManager->setVideoCaptureSuspended(false);
     }
     
     // 使用 RoomManager 离开房间和销毁引擎
@@ -320,10 +467,38 @@ void RoomMainWidget::slotOnHangup() {
     {
         m_operateWidget->reset();
     }
+    m_micMuted = false;
+    m_wakeTimer.invalidate();
+    updateAudioPush();
 
     clearVideoView();
 }
 
+void RoomMainWidget::exportReports() {
+    TurnLatencyTracker* tracker = m_mediaManager->turnTracker();
+    VideoLatencyMonitor* videoLatency = VideoLatencyMonitor::instance();
+    if (videoLatency->isEnabled()) {
+        videoLatency->logSummary();
+    }
+    
+    QString dir = ConfigManager::instance()->telemetryReportPath();
+    if (dir.isEmpty()) {
+        return;
+    }
+    QString suffix = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    if (tracker->turnCount() > 0) {
+        tracker->exportTo(QDir(dir).filePath(QString("turns-%1.json").arg(suffix)));
+    }
+    if (videoLatency->hasSamples()) {
+        // 视频延迟按配置累计，跨通话保留，每次导出的是到目前为止的全部配置
+        videoLatency->exportTo(QDir(dir).filePath(QString("video-latency-%1.json").arg(suffix)));
+    }
+    if (TraceRecorder::isEnabled()) {
+        // 追踪继续记录，导出的是各线程环形缓冲中最近的事件
+        TraceRecorder::exportTo(QDir(dir).filePath(QString("trace-%1.json").arg(suffix)));
+    }
+}
+
 void RoomMainWidget::onRoomStateChanged(
             const char* room_id, const char* uid, int state, const char* extra_info){
     qDebug() << "onRoomStateChanged,roomid:" << room_id << ",uid:" << uid << ",state:" << state;
@@ -341,6 +516,7 @@ void RoomMainWidget::onUserJoined(const bytertc::UserInfo &user_info) {
 
 void RoomMainWidget::onUserLeave(const char *uid, bytertc::UserOfflineReason reason) {
     qDebug() << "user leave id = " << uid;
+    RtcMetrics::onUserLeave(QString::fromUtf8(uid));
     emit sigUserLeave(uid);
 }
 
@@ -349,6 +525,8 @@ void RoomMainWidget::onRoomBinaryMessageReceived(const char* uid, int size, cons
         qDebug() << "Binary message too short:" << size;
         return;
     }
+    // 轮次延迟统计以收到消息的时刻为准，先于解析取时间
+    int64_t receivedUs = TurnLatencyTracker::nowUs();
     
     // 解析 TLV 格式: | type (4 bytes) | length (4 bytes, big-endian) | value |
     // Type
@@ -389,11 +567,14 @@ void RoomMainWidget::onRoomBinaryMessageReceived(const char* uid, int size, cons
             QString msgUserId = data["userId"].toString();
             bool definite = data["definite"].toBool();
             int paragraph = data["paragraph"].toInt();
+            // 判断是用户还是 AI
+            bool isUser = (msgUserId == (m_roomManager ? m_roomManager->getUserId() : QString()));
+            
+            if (!text.isEmpty() && m_mediaManager) {
+                m_mediaManager->turnTracker()->onSubtitle(isUser, definite, receivedUs);
+            }
             
             if (!text.isEmpty() && m_conversationWidget) {
-                // 判断是用户还是 AI
-                bool isUser = (msgUserId == (m_roomManager ? m_roomManager->getUserId() : QString()));
-                
                 qDebug() << "Subtitle:" << (isUser ? "User" : "AI") << text << "definite:" << definite;
                 
                 // 使用 QMetaObject::invokeMethod 确保在 UI 线程执行
@@ -409,7 +590,15 @@ void RoomMainWidget::onRoomBinaryMessageReceived(const char* uid, int size, cons
         QString description = stage["Description"].toString();
         qDebug() << "Agent state:" << code << description;
         
+        if (m_mediaManager) {
+            m_mediaManager->turnTracker()->onAgentStage(code, receivedUs);
+        }
+        
         // 状态码: 1=LISTENING, 2=THINKING, 3=SPEAKING, 4=INTERRUPTED, 5=FINISHED
+        if (code == 4 && m_mediaManager) {
+            // 被打断: 直接在回调线程中丢弃已缓冲的回复，不经 UI 事件队列
+            m_mediaManager->interruptPlayback();
+        }
         if (code == 4 && m_conversationWidget) {
             // 被打断
             QMetaObject::invokeMethod(this, [this]() {
@@ -429,6 +618,33 @@ void RoomMainWidget::onFirstRemoteVideoFrameDecoded(const char* stream_id, const
     emit sigUserEnter(stream_id, stream_info.user_id);
 }
 
+void RoomMainWidget::onLocalStreamStats(const char* stream_id, const bytertc::StreamInfo& stream_info, const bytertc::LocalStreamStats& stats) {
+    RtcMetrics::onLocalStreamStats(stats);
+}
+
+void RoomMainWidget::onRemoteStreamStats(const char* stream_id, const bytertc::StreamInfo& stream_info, const bytertc::RemoteStreamStats& stats) {
+    RtcMetrics::onRemoteStreamStats(stats);
+}
+
+void RoomMainWidget::onRoomStats(const bytertc::RtcRoomStats& stats) {
+    RtcMetrics::onRoomStats(stats);
+}
+
+void RoomMainWidget::onNetworkQuality(const bytertc::NetworkQualityStats& local_quality, const bytertc::NetworkQualityStats* remote_qualities, int remote_quality_num) {
+    RtcMetrics::onNetworkQuality(local_quality, remote_qualities, remote_quality_num);
+}
+
+void RoomMainWidget::onSysStats(const bytertc::SysStats& stats) {
+    RtcMetrics::onSysStats(stats);
+}
+
+void RoomMainWidget::onPerformanceAlarms(const char* stream_id, const bytertc::StreamInfo& stream_info, bytertc::PerformanceAlarmMode mode,
+                                         bytertc::PerformanceAlarmReason reason, const bytertc::SourceWantedData& data) {
+    qDebug() << "performance alarm, stream_id =" << stream_id << ", reason =" << reason
+             << ", wanted" << data.width << "x" << data.height << "@" << data.frame_rate;
+    RtcMetrics::onPerformanceAlarm(mode, reason);
+}
+
 void RoomMainWidget::setRenderCanvas(bool isLocal, void *view, const std::string &stream_id, const std::string &user_id) {
     bytertc::IRTCEngine* engine = m_roomManager ? m_roomManager->getEngine() : nullptr;
     if (engine == nullptr) {
@@ -525,6 +741,12 @@ void RoomMainWidget::setupSignals() {
     });
 
     connect(m_operateWidget.get(), &OperateWidget::sigMuteAudio, this, [this](bool bMute) {
+        m_micMuted = bMute;
+        if (m_mediaManager) {
+            // 静音期间麦克风保持打开但不处理，取消静音后下一帧即恢复
+            m_mediaManager->setAudioCaptureSuspended(bMute);
+        }
+        updateAudioPush();
         bytertc::IRTCRoom* room = m_roomManager ? m_roomManager->getRoom() : nullptr;
         if (room) {
             if (bMute) {
@@ -541,19 +763,22 @@ void RoomMainWidget::setupSignals() {
     connect(m_operateWidget.get(), &OperateWidget::sigMuteVideo, this, [this](bool bMute) {
         if (m_mediaManager) {
             if (bMute) {
-                // 关闭视频采集
-                m_mediaManager->stopVideoCapture();
+                // 挂起视频采集，管道和摄像头保持打开，恢复时不需要重新初始化
+                m_mediaManager->setVideoCaptureSuspended(true);
                 // 清除画面显示黑屏
                 if (m_useGPURendering && m_videoBackgroundGL) {
                     m_videoBackgroundGL->clearFrame();
                 } else if (m_videoBackground) {
                     m_videoBackground->clearFrame();
                 }
-                qDebug() << "Video capture stopped, frame cleared";
+                qDebug() << "Video capture suspended, frame cleared";
             } else {
-                // 开启视频采集
-                m_mediaManager->startVideoCapture();
-                qDebug() << "Video capture started";
+                // 恢复视频采集；采集线程已退出时 (例如摄像头出错) 重新启动
+                m_mediaManager->setVideoCaptureSuspended(false);
+                if (!m_mediaManager->isVideoCapturing()) {
+                    m_mediaManager->startVideoCapture();
+                }
+                qDebug() << "Video capture resumed";
             }
             QTimer::singleShot(10, this, [=] {
                 if (m_useGPURendering && m_videoBackgroundGL) {
@@ -623,6 +848,41 @@ void RoomMainWidget::slotOnModeChanged(AIMode mode) {
     if (m_aiManager) {
         m_aiManager->setMode(mode);
     }
+    updateAudioPush();
+}
+
+void RoomMainWidget::slotOnWakeWordDetected(float score) {
+    // 检测开关在采集线程异步生效，这里再按当前状态过滤一次
+    bool inRoom = m_roomManager && m_roomManager->getEngine();
+    if (!inRoom || !m_modeWidget || m_modeWidget->currentMode() != AIMode::Standby ||
+        (m_aiManager && m_aiManager->isAIStarted()) || m_micMuted) {
+        return;
+    }
+    qDebug() << "Wake word detected, score:" << score << ", switching to chat mode";
+    
+    // 从命中开始计时，AI 启动后补推这段时间内的语音 (唤醒词之后紧跟的问题)
+    m_wakeTimer.start();
+    m_modeWidget->setMode(AIMode::Chat);
+    slotOnModeChanged(AIMode::Chat);
+}
+
+void RoomMainWidget::slotOnBargeInDetected(int decisionMs) {
+    // 播放端已在采集线程中闪避，这里只做记录和可选的打断通知
+    if (!m_aiManager || !m_aiManager->isAIStarted() || m_micMuted) {
+        return;
+    }
+    m_bargeInCount++;
+    qDebug() << "Barge-in" << m_bargeInCount << "decided in" << decisionMs << "ms";
+    
+    if (ConfigManager::instance()->bargeInSignalAgent() && m_roomManager) {
+        // 不等服务端识别，直接让智能体停止当前回复
+        QString botName = m_aiManager->getRtcConfig().botName;
+        QJsonObject command;
+        command["Command"] = "interrupt";
+        int64_t ret = m_roomManager->sendBinaryToUser(botName, "ctrl",
+                                                      QJsonDocument(command).toJson(QJsonDocument::Compact));
+        qDebug() << "Sent interrupt to agent" << botName << "ret:" << ret;
+    }
 }
 
 void RoomMainWidget::slotOnAIConfigLoaded(const AIGCApi::RTCConfig& config) {
@@ -653,11 +913,14 @@ void RoomMainWidget::slotOnAIConfigFailed(const AppError& error) {
 
 void RoomMainWidget::slotOnAIStarted() {
     qDebug() << "AI 启动成功！";
+    m_bargeInCount = 0;
     
     // 更新 AI 准备状态
     if (m_conversationWidget) {
         m_conversationWidget->setAIReady(true);
     }
+    
+    updateAudioPush();
 }
 
 void RoomMainWidget::slotOnAIFailed(const AppError& error) {
@@ -667,6 +930,8 @@ void RoomMainWidget::slotOnAIFailed(const AppError& error) {
     if (m_modeWidget) {
         m_modeWidget->setMode(AIMode::Standby);
     }
+    m_wakeTimer.invalidate();
+    updateAudioPush();
     
     QMessageBox::warning(this, QStringLiteral(u"AI 启动失败"), 
         error.message(), 
@@ -675,6 +940,31 @@ void RoomMainWidget::slotOnAIFailed(const AppError& error) {
 
 void RoomMainWidget::slotOnAIStopped() {
     qDebug() << "AI 已停止";
+    updateAudioPush();
+}
+
+void RoomMainWidget::updateAudioPush() {
+    if (!m_mediaManager) {
+        return;
+    }
+    bool aiRunning = m_aiManager && m_aiManager->isAIStarted();
+    if (aiRunning && !m_micMuted) {
+        int flushMs = -1;
+        if (m_wakeTimer.isValid()) {
+            // 唤醒启动: 补推命中之后的全部语音，加上默认补推时长覆盖唤醒词本身
+            flushMs = qMin(static_cast<int>(m_wakeTimer.elapsed()) +
+                               ConfigManager::instance()->audioPrerollFlushMs(),
+                           ConfigManager::instance()->audioPrerollMs());
+            m_wakeTimer.invalidate();
+        }
+        m_mediaManager->resumeAudioPush(flushMs);
+    } else {
+        m_mediaManager->suspendAudioPush();
+    }
+    
+    bool inRoom = m_roomManager && m_roomManager->getEngine();
+    bool standby = m_modeWidget && m_modeWidget->currentMode() == AIMode::Standby;
+    m_mediaManager->setWakeWordEnabled(inRoom && standby && !aiRunning && !m_micMuted);
 }
 
 // ==================== 摄像头切换槽函数 ====================
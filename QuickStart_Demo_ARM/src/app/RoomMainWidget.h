@@ -4,6 +4,7 @@
 #include <QSharedPointer>
 #include <QLabel>
 #include <QMovie>
+#include <QElapsedTimer>
 #include "ui_RoomMainWidget.h"
 #include "bytertc_engine.h"
 #include "bytertc_room.h"
@@ -26,6 +27,9 @@ class ConversationWidget;
 class VideoRenderWidget;
 class VideoRenderWidgetGL;
 class QPushButton;
+class QTimer;
+
+class PerfHud;
 
 class RoomMainWidget : public QWidget, public bytertc::IRTCRoomEventHandler, public bytertc::IRTCEngineEventHandler {
     Q_OBJECT
@@ -58,6 +62,15 @@ protected:
 
     void onFirstRemoteVideoFrameDecoded(const char* stream_id, const bytertc::StreamInfo& stream_info, const bytertc::VideoFrameInfo& info) override;
 
+    // 统计回调 (SDK 线程)，写入指标注册表
+    void onLocalStreamStats(const char* stream_id, const bytertc::StreamInfo& stream_info, const bytertc::LocalStreamStats& stats) override;
+    void onRemoteStreamStats(const char* stream_id, const bytertc::StreamInfo& stream_info, const bytertc::RemoteStreamStats& stats) override;
+    void onRoomStats(const bytertc::RtcRoomStats& stats) override;
+    void onNetworkQuality(const bytertc::NetworkQualityStats& local_quality, const bytertc::NetworkQualityStats* remote_qualities, int remote_quality_num) override;
+    void onSysStats(const bytertc::SysStats& stats) override;
+    void onPerformanceAlarms(const char* stream_id, const bytertc::StreamInfo& stream_info, bytertc::PerformanceAlarmMode mode,
+                             bytertc::PerformanceAlarmReason reason, const bytertc::SourceWantedData& data) override;
+
 public
     slots:
             void slotOnEnterRoom(
@@ -79,6 +92,12 @@ public
     
     // 模式切换槽
     void slotOnModeChanged(AIMode mode);
+    
+    // 待机唤醒词槽
+    void slotOnWakeWordDetected(float score);
+    
+    // 本地插话槽
+    void slotOnBargeInDetected(int decisionMs);
 
     signals:
             void sigJoinChannelSuccess(std::string
@@ -98,6 +117,14 @@ public
     void sigError(int errorCode);
 private:
     void setupView();
+    // 按 m_useGPURendering 创建视频背景控件
+    void createVideoBackground();
+    // 运行时切换 GPU/CPU 渲染 (控制接口 render.mode): 重建视频背景，通话中把本地视频 sink 挂到新控件
+    void setGPURendering(bool enabled);
+    // 视频延迟统计的分组: 渲染方式、编码分辨率和采集管道
+    void updateVideoLatencyConfiguration();
+    // 把性能 HUD 的文本接到当前视频背景
+    void attachPerfHud();
 
     void setupSignals();
 
@@ -113,6 +140,8 @@ private:
     Ui::RoomMainForm ui;
     bool m_bLeftBtnPressed = false;
     QPoint m_prevGlobalPoint;
+    QPoint m_pressGlobalPoint;
+    QElapsedTimer m_pressTimer;  // 长按切换性能 HUD
     QSharedPointer <LoginWidget> m_loginWidget;
     QSharedPointer <OperateWidget> m_operateWidget;
     QSharedPointer <ModeWidget> m_modeWidget;
@@ -132,6 +161,11 @@ private:
     
     // 媒体管理器
     MediaManager* m_mediaManager = nullptr;
+    PerfHud* m_perfHud = nullptr;
+    bool m_micMuted = false;
+    QElapsedTimer m_wakeTimer;  // 唤醒词命中到 AI 启动的耗时，决定补推多少预录
+    int m_bargeInCount = 0;     // 本次对话中本地判定的插话次数
+    QTimer* m_levelTimer = nullptr;  // 房间内定时把麦克风/喇叭电平刷新到操作栏
     
     // AI 管理器
     AIManager* m_aiManager = nullptr;
@@ -142,4 +176,11 @@ private:
     QMovie* m_standbyMovie = nullptr;
     
     void showStandbyAnimation(bool show);
+    
+    // AI 运行且麦克风未静音时才向 SDK 推送音频，否则只预录；
+    // 在房间内待机且未静音时开启唤醒词检测
+    void updateAudioPush();
+    
+    // 通话结束时导出本次会话的轮次延迟、视频延迟报告和热路径追踪 (telemetry.reportDir)
+    void exportReports();
 };
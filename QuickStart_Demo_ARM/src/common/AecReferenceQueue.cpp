@@ -0,0 +1,71 @@
+#include "AecReferenceQueue.h"
+#include <algorithm>
+
+AecReferenceQueue::AecReferenceQueue()
+{
+}
+
+void AecReferenceQueue::configure(int maxFrameSamples, int capacity)
+{
+    m_maxSamples = std::max(0, maxFrameSamples);
+    m_slots.assign(static_cast<size_t>(std::max(1, capacity)), Slot());
+    for (Slot& slot : m_slots) {
+        slot.samples.assign(static_cast<size_t>(m_maxSamples), 0);
+    }
+    clear();
+    m_dropped = 0;
+}
+
+void AecReferenceQueue::clear()
+{
+    m_head = 0;
+    m_count = 0;
+}
+
+void AecReferenceQueue::push(const int16_t* samples, int frames, int channels, int64_t playoutUs)
+{
+    if (m_slots.empty() || frames <= 0) {
+        return;
+    }
+    int capacity = static_cast<int>(m_slots.size());
+    if (m_count == capacity) {
+        // 队满说明推送停滞，丢弃最早的一块，保证参考信号始终是最近播出的
+        pop();
+        m_dropped++;
+    }
+    Slot& slot = m_slots[(m_head + m_count) % capacity];
+    int count = std::min(frames * channels, m_maxSamples);
+    std::copy(samples, samples + count, slot.samples.begin());
+    slot.frames = count / std::max(1, channels);
+    slot.playoutUs = playoutUs;
+    m_count++;
+}
+
+bool AecReferenceQueue::isDue(int64_t nowUs, int64_t leadUs) const
+{
+    return m_count > 0 && m_slots[m_head].playoutUs <= nowUs + leadUs;
+}
+
+const int16_t* AecReferenceQueue::front(int* frames, int64_t* playoutUs) const
+{
+    if (m_count == 0) {
+        return nullptr;
+    }
+    const Slot& slot = m_slots[m_head];
+    if (frames) {
+        *frames = slot.frames;
+    }
+    if (playoutUs) {
+        *playoutUs = slot.playoutUs;
+    }
+    return slot.samples.data();
+}
+
+void AecReferenceQueue::pop()
+{
+    if (m_count == 0) {
+        return;
+    }
+    m_head = (m_head + 1) % static_cast<int>(m_slots.size());
+    m_count--;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * 回声消除参考信号的延迟队列
+ * 播放线程每写入声卡一块 (10ms)，连同这块音频实际从扬声器播出的时间 (playoutUs) 一起入队；
+ * 到了播出时间才出队推送给 SDK，参考信号与麦克风中的回声在到达时间和时间戳上都对齐
+ *
+ * 槽位在 configure 时预分配，读写均在播放线程中，不加锁不分配
+ */
+class AecReferenceQueue {
+public:
+    AecReferenceQueue();
+
+    // maxFrameSamples: 一块的最大采样数 (帧数 x 声道)；capacity: 最多排队的块数
+    void configure(int maxFrameSamples, int capacity);
+    void clear();
+
+    // 入队一块，队满时丢弃最早的一块
+    void push(const int16_t* samples, int frames, int channels, int64_t playoutUs);
+    // 队首的一块是否已到播出时间 (提前量 leadUs 以内)
+    bool isDue(int64_t nowUs, int64_t leadUs) const;
+    // 队首的一块，队列为空时返回 nullptr
+    const int16_t* front(int* frames, int64_t* playoutUs) const;
+    void pop();
+
+    int size() const { return m_count; }
+    int64_t dropped() const { return m_dropped; }
+
+private:
+    struct Slot {
+        std::vector<int16_t> samples;
+        int frames = 0;
+        int64_t playoutUs = 0;
+    };
+
+    std::vector<Slot> m_slots;
+    int m_maxSamples = 0;
+    int m_head = 0;
+    int m_count = 0;
+    int64_t m_dropped = 0;
+};
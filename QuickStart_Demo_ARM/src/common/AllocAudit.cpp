@@ -0,0 +1,385 @@
+#include "AllocAudit.h"
+#include "Logger.h"
+
+#define LOG_MODULE "AllocAudit"
+
+#ifdef RTC_ALLOC_AUDIT
+
+#include <QMutex>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <unistd.h>
+
+// 音频 10 ms 周期约 2 秒，视频 15 fps 约 13 秒；覆盖设备打开后缓冲区、SDK 帧对象的首次分配
+static const quint64 WARMUP_CYCLES = 200;
+static const int MAX_THREADS = 16;
+static const int MAX_SITES = 256;
+static const int SITE_DEPTH = 12;
+// backtrace 结果中 recordSite / onAllocate / 分配函数本身这三帧不保留
+static const int SKIP_FRAMES = 3;
+
+// glibc 内部入口，替换后的分配函数转发到这里
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+}
+
+namespace {
+
+// 分配钩子中只访问原子量和线程局部的 POD，自身不分配内存
+struct ThreadSlot {
+    QString name;                   // 只在登记和报告时访问
+    bool used = false;
+    std::atomic<bool> active{false};
+    std::atomic<quint64> cycles{0};
+    std::atomic<quint64> warmupAllocations{0};
+    std::atomic<quint64> steadyAllocations{0};
+    std::atomic<quint64> steadyBytes{0};
+    std::atomic<quint64> allowedAllocations{0};
+};
+
+struct Site {
+    std::atomic<int> state{0};      // 0 空，1 写入中，2 可读
+    quint64 hash = 0;
+    void* frames[SITE_DEPTH];
+    int depth = 0;
+    int slot = 0;
+    std::atomic<quint64> count{0};
+};
+
+ThreadSlot s_slots[MAX_THREADS];
+Site s_sites[MAX_SITES];
+QMutex s_slotMutex;
+std::atomic<quint64> s_violations{0};
+std::atomic<quint64> s_droppedSites{0};
+std::atomic<bool> s_abortOnViolation{false};
+
+thread_local ThreadSlot* t_slot = nullptr;
+thread_local quint64 t_warmupLeft = 0;
+thread_local int t_allowDepth = 0;
+thread_local bool t_inHook = false;
+
+__attribute__((noinline)) void recordSite(int slot)
+{
+    void* frames[SKIP_FRAMES + SITE_DEPTH];
+    int depth = backtrace(frames, SKIP_FRAMES + SITE_DEPTH) - SKIP_FRAMES;
+    if (depth <= 0) {
+        return;
+    }
+
+    // FNV-1a，按线程和调用栈去重
+    quint64 hash = 14695981039346656037ULL;
+    for (int i = 0; i < depth; i++) {
+        hash = (hash ^ reinterpret_cast<uintptr_t>(frames[SKIP_FRAMES + i])) * 1099511628211ULL;
+    }
+    hash = (hash ^ static_cast<quint64>(slot)) * 1099511628211ULL;
+
+    for (int probe = 0; probe < MAX_SITES; probe++) {
+        Site& site = s_sites[(hash + probe) % MAX_SITES];
+        int state = site.state.load(std::memory_order_acquire);
+        if (state == 0) {
+            if (site.state.compare_exchange_strong(state, 1, std::memory_order_acq_rel)) {
+                site.hash = hash;
+                site.depth = depth;
+                site.slot = slot;
+                for (int i = 0; i < depth; i++) {
+                    site.frames[i] = frames[SKIP_FRAMES + i];
+                }
+                site.count.store(1, std::memory_order_relaxed);
+                site.state.store(2, std::memory_order_release);
+                return;
+            }
+        }
+        // 另一线程正在写入同一格，只需等待几次赋值
+        while (state == 1) {
+            state = site.state.load(std::memory_order_acquire);
+        }
+        if (site.hash == hash) {
+            site.count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    s_droppedSites.fetch_add(1, std::memory_order_relaxed);
+}
+
+__attribute__((noinline)) void onAllocate(size_t size)
+{
+    ThreadSlot* slot = t_slot;
+    if (t_inHook) {
+        return;     // backtrace 等钩子内部的分配
+    }
+    t_inHook = true;
+    if (t_allowDepth > 0) {
+        slot->allowedAllocations.fetch_add(1, std::memory_order_relaxed);
+    } else if (t_warmupLeft > 0) {
+        slot->warmupAllocations.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        slot->steadyAllocations.fetch_add(1, std::memory_order_relaxed);
+        slot->steadyBytes.fetch_add(size, std::memory_order_relaxed);
+        s_violations.fetch_add(1, std::memory_order_relaxed);
+        recordSite(static_cast<int>(slot - s_slots));
+        if (s_abortOnViolation.load(std::memory_order_relaxed)) {
+            // 日志会再分配，直接写 stderr；调用栈留给 core 文件
+            static const char message[] = "AllocAudit: heap allocation on a realtime thread after warm-up\n";
+            ssize_t written = write(STDERR_FILENO, message, sizeof(message) - 1);
+            (void)written;
+            abort();
+        }
+    }
+    t_inHook = false;
+}
+
+QString describeFrame(void* address)
+{
+    // 返回地址指向调用指令之后，减一落在调用所在的函数/行内
+    void* lookup = static_cast<char*>(address) - 1;
+    Dl_info info;
+    if (!dladdr(lookup, &info)) {
+        return QString("0x%1").arg(reinterpret_cast<quintptr>(address), 0, 16);
+    }
+    if (info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        QString name = QString::fromUtf8(status == 0 && demangled ? demangled : info.dli_sname);
+        free(demangled);
+        return name;
+    }
+    if (info.dli_fname) {
+        QString module = QString::fromUtf8(info.dli_fname).section('/', -1);
+        return QString("%1+0x%2").arg(module)
+            .arg(static_cast<quint64>(static_cast<char*>(lookup) - static_cast<char*>(info.dli_fbase)), 0, 16);
+    }
+    return QString("0x%1").arg(reinterpret_cast<quintptr>(address), 0, 16);
+}
+
+}
+
+// 替换 libc 的分配入口。free 不需要替换: 转发后的内存仍由 glibc 管理
+extern "C" {
+
+void* malloc(size_t size)
+{
+    if (t_slot) {
+        onAllocate(size);
+    }
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    if (t_slot) {
+        onAllocate(count * size);
+    }
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    if (t_slot && size > 0) {
+        onAllocate(size);
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    if (t_slot) {
+        onAllocate(size);
+    }
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    if (t_slot) {
+        onAllocate(size);
+    }
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size)
+{
+    if (t_slot) {
+        onAllocate(size);
+    }
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+}
+
+bool AllocAudit::isEnabled()
+{
+    return true;
+}
+
+void AllocAudit::setAbortOnViolation(bool enable)
+{
+    s_abortOnViolation.store(enable, std::memory_order_relaxed);
+}
+
+void AllocAudit::registerThread(const QString& name)
+{
+    ThreadSlot* slot = nullptr;
+    {
+        QMutexLocker locker(&s_slotMutex);
+        for (int i = 0; i < MAX_THREADS && !slot; i++) {
+            if (s_slots[i].used && s_slots[i].name == name && !s_slots[i].active.load()) {
+                slot = &s_slots[i];
+            }
+        }
+        for (int i = 0; i < MAX_THREADS && !slot; i++) {
+            if (!s_slots[i].used) {
+                slot = &s_slots[i];
+                slot->used = true;
+                slot->name = name;
+            }
+        }
+        if (!slot) {
+            LOG_WARN(QString("Too many audited threads, %1 is not audited").arg(name));
+            return;
+        }
+        slot->active.store(true);
+    }
+    // backtrace 首次调用会加载 libgcc_s，提前完成，避免发生在钩子里
+    void* frame = nullptr;
+    backtrace(&frame, 1);
+    t_warmupLeft = WARMUP_CYCLES;
+    t_slot = slot;
+}
+
+void AllocAudit::unregisterThread()
+{
+    ThreadSlot* slot = t_slot;
+    if (slot) {
+        t_slot = nullptr;
+        slot->active.store(false);
+    }
+}
+
+void AllocAudit::endCycle()
+{
+    ThreadSlot* slot = t_slot;
+    if (slot) {
+        slot->cycles.fetch_add(1, std::memory_order_relaxed);
+        if (t_warmupLeft > 0) {
+            t_warmupLeft--;
+        }
+    }
+}
+
+void AllocAudit::restartWarmup()
+{
+    t_warmupLeft = WARMUP_CYCLES;
+}
+
+quint64 AllocAudit::violations()
+{
+    return s_violations.load(std::memory_order_relaxed);
+}
+
+QList<AllocAudit::Snapshot> AllocAudit::snapshotAll()
+{
+    QMutexLocker locker(&s_slotMutex);
+    QList<Snapshot> result;
+    for (const ThreadSlot& slot : s_slots) {
+        if (!slot.used) {
+            continue;
+        }
+        Snapshot s;
+        s.thread = slot.name;
+        s.cycles = slot.cycles.load(std::memory_order_relaxed);
+        s.warmupAllocations = slot.warmupAllocations.load(std::memory_order_relaxed);
+        s.steadyAllocations = slot.steadyAllocations.load(std::memory_order_relaxed);
+        s.steadyBytes = slot.steadyBytes.load(std::memory_order_relaxed);
+        s.allowedAllocations = slot.allowedAllocations.load(std::memory_order_relaxed);
+        result.append(s);
+    }
+    return result;
+}
+
+QList<AllocAudit::CallSite> AllocAudit::callSites()
+{
+    QList<CallSite> result;
+    for (const Site& site : s_sites) {
+        if (site.state.load(std::memory_order_acquire) != 2) {
+            continue;
+        }
+        CallSite callSite;
+        {
+            QMutexLocker locker(&s_slotMutex);
+            callSite.thread = s_slots[site.slot].name;
+        }
+        callSite.count = site.count.load(std::memory_order_relaxed);
+        for (int i = 0; i < site.depth; i++) {
+            callSite.frames.append(describeFrame(site.frames[i]));
+        }
+        result.append(callSite);
+    }
+    std::sort(result.begin(), result.end(), [](const CallSite& a, const CallSite& b) {
+        return a.count > b.count;
+    });
+    return result;
+}
+
+bool AllocAudit::report()
+{
+    for (const Snapshot& s : snapshotAll()) {
+        LOG_INFO(QString("%1: %2 cycles, %3 allocations during warm-up, %4 allowed, %5 after warm-up (%6 bytes)")
+                 .arg(s.thread).arg(s.cycles).arg(s.warmupAllocations).arg(s.allowedAllocations)
+                 .arg(s.steadyAllocations).arg(s.steadyBytes));
+    }
+    quint64 total = violations();
+    if (total == 0) {
+        LOG_INFO("No heap allocations on realtime threads after warm-up");
+        return true;
+    }
+    for (const CallSite& site : callSites()) {
+        LOG_WARN(QString("%1x on %2: %3").arg(site.count).arg(site.thread).arg(site.frames.join(" <- ")));
+    }
+    quint64 dropped = s_droppedSites.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        LOG_WARN(QString("%1 allocations not attributed (call site table full)").arg(dropped));
+    }
+    LOG_WARN(QString("%1 heap allocations on realtime threads after warm-up").arg(total));
+    return false;
+}
+
+AllocAudit::ScopedAllow::ScopedAllow()
+{
+    t_allowDepth++;
+}
+
+AllocAudit::ScopedAllow::~ScopedAllow()
+{
+    t_allowDepth--;
+}
+
+#else
+
+bool AllocAudit::isEnabled() { return false; }
+void AllocAudit::setAbortOnViolation(bool) {}
+void AllocAudit::registerThread(const QString&) {}
+void AllocAudit::unregisterThread() {}
+void AllocAudit::endCycle() {}
+void AllocAudit::restartWarmup() {}
+quint64 AllocAudit::violations() { return 0; }
+QList<AllocAudit::Snapshot> AllocAudit::snapshotAll() { return QList<Snapshot>(); }
+QList<AllocAudit::CallSite> AllocAudit::callSites() { return QList<CallSite>(); }
+bool AllocAudit::report() { return true; }
+AllocAudit::ScopedAllow::ScopedAllow() {}
+AllocAudit::ScopedAllow::~ScopedAllow() {}
+
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * 实时线程稳态堆分配审计 (调试构建: cmake -DALLOC_AUDIT=ON)
+ * 开启后替换 malloc/calloc/realloc/memalign 系列 (operator new 经由 malloc，一并覆盖)，
+ * 只统计登记过的线程。DeadlineMonitor 在构造时登记所在线程 (audio-in / audio-out / video-capture)，
+ * 每个 tick() 为一个周期；热身 WARMUP_CYCLES 个周期后仍发生的分配记为违规，并记录调用栈
+ * (按调用栈去重，退出时或通过控制命令 alloc.audit 用 dladdr 符号化输出)
+ *
+ * 违规时默认只记录；--alloc-audit-abort 时在第一次违规处 abort()，便于在回环/延迟测试中
+ * 直接得到失败退出和 core 文件。--latency-test 在有违规时以非零退出码结束
+ *
+ * 未开启时所有接口为空实现，不替换分配函数，没有开销
+ */
+class AllocAudit {
+public:
+    struct Snapshot {
+        QString thread;
+        quint64 cycles = 0;
+        quint64 warmupAllocations = 0;    // 热身期 (含设备重开后的重新热身)
+        quint64 steadyAllocations = 0;    // 违规
+        quint64 steadyBytes = 0;
+        quint64 allowedAllocations = 0;   // ScopedAllow 范围内，不计违规
+    };
+
+    struct CallSite {
+        QString thread;
+        quint64 count = 0;
+        QStringList frames;               // 从分配函数的调用者向外
+    };
+
+    // 本次构建是否开启了审计
+    static bool isEnabled();
+
+    // 违规时立即 abort()
+    static void setAbortOnViolation(bool enable);
+
+    // 在被审计线程内调用；同名线程重启后沿用同一组统计
+    static void registerThread(const QString& name);
+    static void unregisterThread();
+    // 当前线程完成一个周期
+    static void endCycle();
+    // 周期中断后 (例如设备重开、格式变化) 重新热身，期间的分配不计违规
+    static void restartWarmup();
+
+    static quint64 violations();
+    static QList<Snapshot> snapshotAll();
+    static QList<CallSite> callSites();
+    // 把统计和违规调用栈写入日志，没有违规时返回 true
+    static bool report();
+
+    // 已知且低频的分配 (例如每 10 秒一次的日志)，范围内的分配单独计数
+    class ScopedAllow {
+    public:
+        ScopedAllow();
+        ~ScopedAllow();
+        ScopedAllow(const ScopedAllow&) = delete;
+        ScopedAllow& operator=(const ScopedAllow&) = delete;
+    };
+};
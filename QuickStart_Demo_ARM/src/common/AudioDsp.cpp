@@ -0,0 +1,848 @@
+#include "AudioDsp.h"
+#include "Logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DSP_HAVE_NEON 1
+#if defined(__linux__) && !defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+#if defined(__SSE2__) || defined(__x86_64__)
+#include <emmintrin.h>
+#define DSP_HAVE_SSE2 1
+#endif
+
+#define LOG_MODULE "AudioDsp"
+
+namespace {
+
+// 电平测量的累加状态，各实现的主循环和标量尾部共用
+struct Accumulator {
+    int maxValue = -32768;
+    int minValue = 32767;
+    int64_t sumSquares = 0;
+
+    bool operator==(const Accumulator& other) const
+    {
+        return maxValue == other.maxValue && minValue == other.minValue && sumSquares == other.sumSquares;
+    }
+};
+
+struct Kernels {
+    // acc 不为空时同时测量输出电平
+    void (*gainRamp)(int16_t* samples, int frames, int channels, float startGain, float step, Accumulator* acc);
+    void (*mixAccumulate)(int32_t* acc, const int16_t* in, int count, int16_t gain);
+    void (*mixOutput)(const int32_t* acc, int16_t* out, int count);
+    void (*monoToStereo)(const int16_t* in, int16_t* out, int frames);
+    void (*stereoToMono)(const int16_t* in, int16_t* out, int frames);
+    void (*measure)(const int16_t* samples, int count, Accumulator* acc);
+};
+
+inline int16_t clamp16(int32_t v)
+{
+    return static_cast<int16_t>(std::max(-32768, std::min(32767, v)));
+}
+
+// ---- 标量实现，同时作为各 SIMD 实现的尾部处理和自检基准 ----
+
+void scalarMeasure(const int16_t* samples, int count, Accumulator* acc)
+{
+    int maxV = acc->maxValue;
+    int minV = acc->minValue;
+    int64_t sum = acc->sumSquares;
+    for (int i = 0; i < count; i++) {
+        int v = samples[i];
+        maxV = std::max(maxV, v);
+        minV = std::min(minV, v);
+        sum += v * v;
+    }
+    acc->maxValue = maxV;
+    acc->minValue = minV;
+    acc->sumSquares = sum;
+}
+
+void scalarGainRampFrom(int16_t* samples, int firstFrame, int frames, int channels, float startGain, float step,
+                        Accumulator* acc)
+{
+    for (int f = firstFrame; f < frames; f++) {
+        float gain = startGain + step * static_cast<float>(f + 1);
+        int16_t* frame = samples + f * channels;
+        for (int c = 0; c < channels; c++) {
+            // 截断取整，与 SIMD 的 float -> int32 转换一致
+            frame[c] = clamp16(static_cast<int32_t>(frame[c] * gain));
+        }
+    }
+    if (acc && frames > firstFrame) {
+        scalarMeasure(samples + firstFrame * channels, (frames - firstFrame) * channels, acc);
+    }
+}
+
+void scalarGainRamp(int16_t* samples, int frames, int channels, float startGain, float step, Accumulator* acc)
+{
+    scalarGainRampFrom(samples, 0, frames, channels, startGain, step, acc);
+}
+
+void scalarMixAccumulate(int32_t* acc, const int16_t* in, int count, int16_t gain)
+{
+    for (int i = 0; i < count; i++) {
+        acc[i] += (static_cast<int32_t>(in[i]) * gain) >> 15;
+    }
+}
+
+void scalarMixOutput(const int32_t* acc, int16_t* out, int count)
+{
+    for (int i = 0; i < count; i++) {
+        out[i] = clamp16(acc[i]);
+    }
+}
+
+void scalarMonoToStereo(const int16_t* in, int16_t* out, int frames)
+{
+    for (int i = 0; i < frames; i++) {
+        out[2 * i] = in[i];
+        out[2 * i + 1] = in[i];
+    }
+}
+
+void scalarStereoToMono(const int16_t* in, int16_t* out, int frames)
+{
+    for (int i = 0; i < frames; i++) {
+        out[i] = static_cast<int16_t>((static_cast<int32_t>(in[2 * i]) + in[2 * i + 1]) >> 1);
+    }
+}
+
+const Kernels SCALAR_KERNELS = {
+    scalarGainRamp, scalarMixAccumulate, scalarMixOutput, scalarMonoToStereo, scalarStereoToMono, scalarMeasure
+};
+
+#if defined(DSP_HAVE_NEON)
+
+// 每 8 个采样对应的帧序号 (+1)，单声道 / 立体声
+const float NEON_RAMP_OFFSETS[2][8] = {
+    {1, 2, 3, 4, 5, 6, 7, 8},
+    {1, 1, 2, 2, 3, 3, 4, 4},
+};
+
+// 电平累加器的向量形式，主循环结束后归并到 Accumulator
+struct NeonAccumulator {
+    int16x8_t maxValue = vdupq_n_s16(-32768);
+    int16x8_t minValue = vdupq_n_s16(32767);
+    int64x2_t sumSquares = vdupq_n_s64(0);
+
+    void add(int16x8_t x)
+    {
+        maxValue = vmaxq_s16(maxValue, x);
+        minValue = vminq_s16(minValue, x);
+        // 单个平方最大 2^30，两两累加到 64 位
+        sumSquares = vpadalq_s32(sumSquares, vmull_s16(vget_low_s16(x), vget_low_s16(x)));
+        sumSquares = vpadalq_s32(sumSquares, vmull_s16(vget_high_s16(x), vget_high_s16(x)));
+    }
+
+    void mergeInto(Accumulator* acc) const
+    {
+        int16_t maxLanes[8];
+        int16_t minLanes[8];
+        int64_t sumLanes[2];
+        vst1q_s16(maxLanes, maxValue);
+        vst1q_s16(minLanes, minValue);
+        vst1q_s64(sumLanes, sumSquares);
+        for (int k = 0; k < 8; k++) {
+            acc->maxValue = std::max(acc->maxValue, static_cast<int>(maxLanes[k]));
+            acc->minValue = std::min(acc->minValue, static_cast<int>(minLanes[k]));
+        }
+        acc->sumSquares += sumLanes[0] + sumLanes[1];
+    }
+};
+
+void neonGainRamp(int16_t* samples, int frames, int channels, float startGain, float step, Accumulator* acc)
+{
+    if (channels != 1 && channels != 2) {
+        scalarGainRamp(samples, frames, channels, startGain, step, acc);
+        return;
+    }
+    NeonAccumulator level;
+    const float32x4_t offLo = vld1q_f32(NEON_RAMP_OFFSETS[channels - 1]);
+    const float32x4_t offHi = vld1q_f32(NEON_RAMP_OFFSETS[channels - 1] + 4);
+    const float32x4_t vStep = vdupq_n_f32(step);
+    const float32x4_t vStart = vdupq_n_f32(startGain);
+    const int count = frames * channels;
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t base = vdupq_n_f32(static_cast<float>(i / channels));
+        float32x4_t gLo = vaddq_f32(vStart, vmulq_f32(vStep, vaddq_f32(base, offLo)));
+        float32x4_t gHi = vaddq_f32(vStart, vmulq_f32(vStep, vaddq_f32(base, offHi)));
+        int16x8_t x = vld1q_s16(samples + i);
+        float32x4_t lo = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), gLo);
+        float32x4_t hi = vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), gHi);
+        int16x8_t y = vcombine_s16(vqmovn_s32(vcvtq_s32_f32(lo)), vqmovn_s32(vcvtq_s32_f32(hi)));
+        vst1q_s16(samples + i, y);
+        if (acc) {
+            level.add(y);
+        }
+    }
+    if (acc && i > 0) {
+        level.mergeInto(acc);
+    }
+    scalarGainRampFrom(samples, i / channels, frames, channels, startGain, step, acc);
+}
+
+void neonMixAccumulate(int32_t* acc, const int16_t* in, int count, int16_t gain)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(in + i);
+        int32x4_t lo = vshrq_n_s32(vmull_n_s16(vget_low_s16(x), gain), 15);
+        int32x4_t hi = vshrq_n_s32(vmull_n_s16(vget_high_s16(x), gain), 15);
+        vst1q_s32(acc + i, vaddq_s32(vld1q_s32(acc + i), lo));
+        vst1q_s32(acc + i + 4, vaddq_s32(vld1q_s32(acc + i + 4), hi));
+    }
+    scalarMixAccumulate(acc + i, in + i, count - i, gain);
+}
+
+void neonMixOutput(const int32_t* acc, int16_t* out, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(vld1q_s32(acc + i)), vqmovn_s32(vld1q_s32(acc + i + 4))));
+    }
+    scalarMixOutput(acc + i, out + i, count - i);
+}
+
+void neonMonoToStereo(const int16_t* in, int16_t* out, int frames)
+{
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        int16x8_t x = vld1q_s16(in + i);
+        int16x8x2_t pair = {{x, x}};
+        vst2q_s16(out + 2 * i, pair);
+    }
+    scalarMonoToStereo(in + i, out + 2 * i, frames - i);
+}
+
+void neonStereoToMono(const int16_t* in, int16_t* out, int frames)
+{
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        int16x8x2_t pair = vld2q_s16(in + 2 * i);
+        vst1q_s16(out + i, vhaddq_s16(pair.val[0], pair.val[1]));
+    }
+    scalarStereoToMono(in + 2 * i, out + i, frames - i);
+}
+
+void neonMeasure(const int16_t* samples, int count, Accumulator* acc)
+{
+    int i = 0;
+    if (count >= 8) {
+        NeonAccumulator level;
+        for (; i + 8 <= count; i += 8) {
+            level.add(vld1q_s16(samples + i));
+        }
+        level.mergeInto(acc);
+    }
+    scalarMeasure(samples + i, count - i, acc);
+}
+
+const Kernels NEON_KERNELS = {
+    neonGainRamp, neonMixAccumulate, neonMixOutput, neonMonoToStereo, neonStereoToMono, neonMeasure
+};
+
+#endif
+
+#if defined(DSP_HAVE_SSE2)
+
+const float SSE_RAMP_OFFSETS[2][8] = {
+    {1, 2, 3, 4, 5, 6, 7, 8},
+    {1, 1, 2, 2, 3, 3, 4, 4},
+};
+
+// 电平累加器的向量形式，主循环结束后归并到 Accumulator
+struct SseAccumulator {
+    __m128i maxValue = _mm_set1_epi16(-32768);
+    __m128i minValue = _mm_set1_epi16(32767);
+    __m128i sumSquares = _mm_setzero_si128();
+
+    void add(__m128i x)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        maxValue = _mm_max_epi16(maxValue, x);
+        minValue = _mm_min_epi16(minValue, x);
+        // 两个平方之和最大 2^31，按无符号扩展到 64 位累加
+        __m128i sq = _mm_madd_epi16(x, x);
+        sumSquares = _mm_add_epi64(sumSquares, _mm_unpacklo_epi32(sq, zero));
+        sumSquares = _mm_add_epi64(sumSquares, _mm_unpackhi_epi32(sq, zero));
+    }
+
+    void mergeInto(Accumulator* acc) const
+    {
+        int16_t maxLanes[8];
+        int16_t minLanes[8];
+        int64_t sumLanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(maxLanes), maxValue);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(minLanes), minValue);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sumLanes), sumSquares);
+        for (int k = 0; k < 8; k++) {
+            acc->maxValue = std::max(acc->maxValue, static_cast<int>(maxLanes[k]));
+            acc->minValue = std::min(acc->minValue, static_cast<int>(minLanes[k]));
+        }
+        acc->sumSquares += sumLanes[0] + sumLanes[1];
+    }
+};
+
+void sseGainRamp(int16_t* samples, int frames, int channels, float startGain, float step, Accumulator* acc)
+{
+    if (channels != 1 && channels != 2) {
+        scalarGainRamp(samples, frames, channels, startGain, step, acc);
+        return;
+    }
+    SseAccumulator level;
+    const __m128 offLo = _mm_loadu_ps(SSE_RAMP_OFFSETS[channels - 1]);
+    const __m128 offHi = _mm_loadu_ps(SSE_RAMP_OFFSETS[channels - 1] + 4);
+    const __m128 vStep = _mm_set1_ps(step);
+    const __m128 vStart = _mm_set1_ps(startGain);
+    const int count = frames * channels;
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 base = _mm_set1_ps(static_cast<float>(i / channels));
+        __m128 gLo = _mm_add_ps(vStart, _mm_mul_ps(vStep, _mm_add_ps(base, offLo)));
+        __m128 gHi = _mm_add_ps(vStart, _mm_mul_ps(vStep, _mm_add_ps(base, offHi)));
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        // int16 -> int32 符号扩展
+        __m128i lo32 = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i hi32 = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        __m128i lo = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lo32), gLo));
+        __m128i hi = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(hi32), gHi));
+        __m128i y = _mm_packs_epi32(lo, hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + i), y);
+        if (acc) {
+            level.add(y);
+        }
+    }
+    if (acc && i > 0) {
+        level.mergeInto(acc);
+    }
+    scalarGainRampFrom(samples, i / channels, frames, channels, startGain, step, acc);
+}
+
+void sseMixAccumulate(int32_t* acc, const int16_t* in, int count, int16_t gain)
+{
+    const __m128i g = _mm_set1_epi16(gain);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // 16x16 -> 32 位乘积: 低 16 位与高 16 位交错拼接
+        __m128i lo16 = _mm_mullo_epi16(x, g);
+        __m128i hi16 = _mm_mulhi_epi16(x, g);
+        __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo16, hi16), 15);
+        __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo16, hi16), 15);
+        __m128i* a = reinterpret_cast<__m128i*>(acc + i);
+        _mm_storeu_si128(a, _mm_add_epi32(_mm_loadu_si128(a), p0));
+        _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), p1));
+    }
+    scalarMixAccumulate(acc + i, in + i, count - i, gain);
+}
+
+void sseMixOutput(const int32_t* acc, int16_t* out, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(lo, hi));
+    }
+    scalarMixOutput(acc + i, out + i, count - i);
+}
+
+void sseMonoToStereo(const int16_t* in, int16_t* out, int frames)
+{
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi16(x, x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 8), _mm_unpackhi_epi16(x, x));
+    }
+    scalarMonoToStereo(in + i, out + 2 * i, frames - i);
+}
+
+void sseStereoToMono(const int16_t* in, int16_t* out, int frames)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        // 相邻两个采样 (L, R) 相加到 32 位，右移一位后饱和打包
+        __m128i a = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i)), ones);
+        __m128i b = _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 2 * i + 8)), ones);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                         _mm_packs_epi32(_mm_srai_epi32(a, 1), _mm_srai_epi32(b, 1)));
+    }
+    scalarStereoToMono(in + 2 * i, out + i, frames - i);
+}
+
+void sseMeasure(const int16_t* samples, int count, Accumulator* acc)
+{
+    int i = 0;
+    if (count >= 8) {
+        SseAccumulator level;
+        for (; i + 8 <= count; i += 8) {
+            level.add(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)));
+        }
+        level.mergeInto(acc);
+    }
+    scalarMeasure(samples + i, count - i, acc);
+}
+
+const Kernels SSE2_KERNELS = {
+    sseGainRamp, sseMixAccumulate, sseMixOutput, sseMonoToStereo, sseStereoToMono, sseMeasure
+};
+
+#endif
+
+const Kernels* kernelsFor(AudioDsp::Backend backend)
+{
+    switch (backend) {
+#if defined(DSP_HAVE_NEON)
+    case AudioDsp::Neon:
+        return &NEON_KERNELS;
+#endif
+#if defined(DSP_HAVE_SSE2)
+    case AudioDsp::Sse2:
+        return &SSE2_KERNELS;
+#endif
+    default:
+        return &SCALAR_KERNELS;
+    }
+}
+
+AudioDsp::Backend detectBackend()
+{
+    if (AudioDsp::isSupported(AudioDsp::Neon)) {
+        return AudioDsp::Neon;
+    }
+    if (AudioDsp::isSupported(AudioDsp::Sse2)) {
+        return AudioDsp::Sse2;
+    }
+    return AudioDsp::Scalar;
+}
+
+std::atomic<int> g_backend{-1};
+
+const Kernels* kernels()
+{
+    int backend = g_backend.load(std::memory_order_acquire);
+    if (backend < 0) {
+        backend = detectBackend();
+        g_backend.store(backend, std::memory_order_release);
+    }
+    return kernelsFor(static_cast<AudioDsp::Backend>(backend));
+}
+
+// 自检/基准用的可重复伪随机数据，包含满幅值
+AudioDsp::Level toLevel(const Accumulator& acc, int count)
+{
+    AudioDsp::Level level;
+    level.peak = std::max(std::abs(acc.maxValue), std::abs(acc.minValue));
+    level.rms = static_cast<float>(std::sqrt(static_cast<double>(acc.sumSquares) / count));
+    return level;
+}
+
+void fillTestSignal(std::vector<int16_t>& buffer, uint32_t seed)
+{
+    for (size_t i = 0; i < buffer.size(); i++) {
+        seed = seed * 1664525u + 1013904223u;
+        buffer[i] = static_cast<int16_t>(seed >> 16);
+    }
+    if (buffer.size() > 3) {
+        buffer[0] = 32767;
+        buffer[1] = -32768;
+        buffer[2] = -32768;
+    }
+}
+
+// 手算结果的固定向量，长度 16 覆盖 SIMD 主循环；与标量比对只能发现实现之间不一致，
+// 这里检查各实现 (包括标量本身) 的绝对结果
+bool checkKnownVectors(const Kernels* k)
+{
+    bool ok = true;
+    auto expect = [&ok](bool condition, const char* what) {
+        if (!condition) {
+            LOG_ERROR(QString("Known-vector check failed: %1").arg(what));
+            ok = false;
+        }
+    };
+
+    // 增益斜坡端点: 第 i 帧增益 start + step * (i + 1)，最后一帧正好是 end
+    {
+        std::vector<int16_t> s(16, 8000);
+        k->gainRamp(s.data(), 16, 1, 0.0f, 1.0f / 16, nullptr);
+        expect(s[0] == 500 && s[7] == 4000 && s[15] == 8000, "gain ramp 0 -> 1");
+        std::vector<int16_t> t(32, -8000);
+        k->gainRamp(t.data(), 16, 2, 1.0f, -1.0f / 16, nullptr);
+        expect(t[0] == -7500 && t[1] == -7500 && t[30] == 0 && t[31] == 0, "gain ramp 1 -> 0 stereo");
+    }
+
+    // 饱和: 2 倍增益把 ±20000 推到 32767 / -32768；-32768 乘 1 保持不变；截断向零取整
+    {
+        const int16_t in[16] = {20000, -20000, 32767, -32768, 1, -1, 3, -3,
+                                20000, -20000, 32767, -32768, 1, -1, 3, -3};
+        std::vector<int16_t> s(in, in + 16);
+        k->gainRamp(s.data(), 16, 1, 2.0f, 0.0f, nullptr);
+        expect(s[0] == 32767 && s[1] == -32768 && s[2] == 32767 && s[3] == -32768 &&
+               s[4] == 2 && s[5] == -2 && s[14] == 6 && s[15] == -6, "gain x2 clamp");
+        std::vector<int16_t> u(in, in + 16);
+        k->gainRamp(u.data(), 16, 1, 1.0f, 0.0f, nullptr);
+        expect(std::equal(u.begin(), u.end(), in), "gain x1 identity");
+        std::vector<int16_t> h(in, in + 16);
+        k->gainRamp(h.data(), 16, 1, 0.5f, 0.0f, nullptr);
+        expect(h[0] == 10000 && h[3] == -16384 && h[4] == 0 && h[5] == 0 && h[6] == 1 && h[7] == -1,
+               "gain x0.5 truncation");
+    }
+
+    // 5 路满幅混音: 每路 (32767 * 32767) >> 15 = 32766、(-32768 * 32767) >> 15 = -32767，
+    // 累加 163830 / -163835 不回绕，输出饱和；半增益 (1000 * 16384) >> 15 = 500 共 2500
+    {
+        std::vector<int16_t> high(16, 32767);
+        std::vector<int16_t> low(16, -32768);
+        std::vector<int16_t> small(16, 1000);
+        std::vector<int32_t> accHigh(16, 0), accLow(16, 0), accSmall(16, 0);
+        for (int i = 0; i < 5; i++) {
+            k->mixAccumulate(accHigh.data(), high.data(), 16, 32767);
+            k->mixAccumulate(accLow.data(), low.data(), 16, 32767);
+            k->mixAccumulate(accSmall.data(), small.data(), 16, 16384);
+        }
+        expect(accHigh[0] == 163830 && accHigh[15] == 163830 && accLow[0] == -163835 && accLow[15] == -163835 &&
+               accSmall[0] == 2500, "mix accumulate");
+        std::vector<int16_t> out(16);
+        k->mixOutput(accHigh.data(), out.data(), 16);
+        expect(out[0] == 32767 && out[15] == 32767, "mix output clamp high");
+        k->mixOutput(accLow.data(), out.data(), 16);
+        expect(out[0] == -32768 && out[15] == -32768, "mix output clamp low");
+        k->mixOutput(accSmall.data(), out.data(), 16);
+        expect(out[0] == 2500 && out[15] == 2500, "mix output");
+    }
+
+    // 声道转换: 立体声取平均向下取整 (算术右移)
+    {
+        const int16_t stereo[32] = {1, 2, -1, -2, 32767, 32767, -32768, -32768, 32767, -32768, 0, 1, -3, 0, 5, 6,
+                                    1, 2, -1, -2, 32767, 32767, -32768, -32768, 32767, -32768, 0, 1, -3, 0, 5, 6};
+        const int16_t mono[16] = {1, -2, 32767, -32768, -1, 0, -2, 5, 1, -2, 32767, -32768, -1, 0, -2, 5};
+        std::vector<int16_t> out(16);
+        k->stereoToMono(stereo, out.data(), 16);
+        expect(std::equal(out.begin(), out.end(), mono), "stereo to mono rounding");
+        std::vector<int16_t> dup(32);
+        k->monoToStereo(mono, dup.data(), 16);
+        expect(dup[0] == 1 && dup[1] == 1 && dup[6] == -32768 && dup[7] == -32768 && dup[31] == 5, "mono to stereo");
+    }
+
+    // 电平: 幅度 16384、周期 16 的正弦，峰值 16384，RMS = 16384 / sqrt(2) = 11585.2；含 -32768 时峰值 32768
+    {
+        const double pi = 3.14159265358979323846;
+        std::vector<int16_t> sine(160);
+        for (int i = 0; i < 160; i++) {
+            sine[i] = static_cast<int16_t>(std::lrint(16384.0 * std::sin(2.0 * pi * i / 16)));
+        }
+        Accumulator acc;
+        k->measure(sine.data(), 160, &acc);
+        AudioDsp::Level level = toLevel(acc, 160);
+        expect(level.peak == 16384 && std::fabs(level.rms - 11585.2f) < 1.0f, "sine level");
+        sine[37] = -32768;
+        Accumulator full;
+        k->measure(sine.data(), 160, &full);
+        expect(toLevel(full, 160).peak == 32768, "full-scale peak");
+    }
+    return ok;
+}
+
+} // namespace
+
+void AudioDsp::initialize()
+{
+    Backend best = detectBackend();
+    g_backend.store(best, std::memory_order_release);
+    if (best != Scalar && !selfTest(best)) {
+        LOG_WARN(QString("%1 kernels failed self-test, falling back to scalar").arg(backendName(best)));
+        g_backend.store(Scalar, std::memory_order_release);
+        return;
+    }
+    LOG_INFO(QString("Using %1 kernels").arg(backendName(best)));
+}
+
+AudioDsp::Backend AudioDsp::backend()
+{
+    kernels();
+    return static_cast<Backend>(g_backend.load(std::memory_order_acquire));
+}
+
+const char* AudioDsp::backendName(Backend backend)
+{
+    switch (backend) {
+    case Neon:
+        return "NEON";
+    case Sse2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
+
+bool AudioDsp::isSupported(Backend backend)
+{
+    switch (backend) {
+    case Scalar:
+        return true;
+    case Neon:
+#if defined(DSP_HAVE_NEON)
+#if defined(__aarch64__)
+        return true;
+#elif defined(__linux__)
+        // 32 位 ARM 上 NEON 是可选扩展，以内核报告的 hwcap 为准
+        return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+        return true;
+#endif
+#else
+        return false;
+#endif
+    case Sse2:
+#if defined(DSP_HAVE_SSE2)
+#if defined(__GNUC__)
+        return __builtin_cpu_supports("sse2");
+#else
+        return true;
+#endif
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+bool AudioDsp::setBackend(Backend backend)
+{
+    if (!isSupported(backend)) {
+        return false;
+    }
+    g_backend.store(backend, std::memory_order_release);
+    return true;
+}
+
+void AudioDsp::applyGainRamp(int16_t* samples, int frames, int channels, float startGain, float endGain)
+{
+    if (!samples || frames <= 0 || channels <= 0) {
+        return;
+    }
+    kernels()->gainRamp(samples, frames, channels, startGain, (endGain - startGain) / frames, nullptr);
+}
+
+AudioDsp::Level AudioDsp::applyGainRampMeasured(int16_t* samples, int frames, int channels,
+                                                float startGain, float endGain)
+{
+    if (!samples || frames <= 0 || channels <= 0) {
+        return Level();
+    }
+    Accumulator acc;
+    kernels()->gainRamp(samples, frames, channels, startGain, (endGain - startGain) / frames, &acc);
+    return toLevel(acc, frames * channels);
+}
+
+void AudioDsp::mixAccumulate(int32_t* acc, const int16_t* in, int count, int gainQ15)
+{
+    if (acc && in && count > 0 && gainQ15 > 0) {
+        kernels()->mixAccumulate(acc, in, count, static_cast<int16_t>(std::min(gainQ15, 32767)));
+    }
+}
+
+void AudioDsp::mixOutput(const int32_t* acc, int16_t* out, int count)
+{
+    if (acc && out && count > 0) {
+        kernels()->mixOutput(acc, out, count);
+    }
+}
+
+void AudioDsp::monoToStereo(const int16_t* in, int16_t* out, int frames)
+{
+    if (in && out && frames > 0) {
+        kernels()->monoToStereo(in, out, frames);
+    }
+}
+
+void AudioDsp::stereoToMono(const int16_t* in, int16_t* out, int frames)
+{
+    if (in && out && frames > 0) {
+        kernels()->stereoToMono(in, out, frames);
+    }
+}
+
+AudioDsp::Level AudioDsp::measure(const int16_t* samples, int count)
+{
+    Level level;
+    if (!samples || count <= 0) {
+        return level;
+    }
+    Accumulator acc;
+    kernels()->measure(samples, count, &acc);
+    return toLevel(acc, count);
+}
+
+bool AudioDsp::selfTest(Backend backend)
+{
+    if (!isSupported(backend)) {
+        return false;
+    }
+    const Kernels* simd = kernelsFor(backend);
+    const Kernels* ref = &SCALAR_KERNELS;
+    // 长度覆盖 SIMD 主循环和标量尾部
+    const int lengths[] = {1, 7, 8, 15, 160, 333, 480};
+    bool ok = checkKnownVectors(simd);
+
+    for (int length : lengths) {
+        for (int channels = 1; channels <= 2; channels++) {
+            int count = length * channels;
+            std::vector<int16_t> input(count);
+            fillTestSignal(input, static_cast<uint32_t>(length * 31 + channels));
+
+            // 增益斜坡: 衰减、放大 (触发饱和)，允许 1 LSB 的浮点误差
+            const float ramps[][2] = {{1.0f, 0.2f}, {0.0f, 1.0f}, {0.5f, 3.0f}};
+            for (const auto& ramp : ramps) {
+                std::vector<int16_t> a = input;
+                std::vector<int16_t> b = input;
+                float step = (ramp[1] - ramp[0]) / length;
+                simd->gainRamp(a.data(), length, channels, ramp[0], step, nullptr);
+                ref->gainRamp(b.data(), length, channels, ramp[0], step, nullptr);
+                for (int i = 0; i < count; i++) {
+                    if (std::abs(a[i] - b[i]) > 1) {
+                        ok = false;
+                    }
+                }
+                // 增益与测量合并时，测得的应是本实现自己的输出
+                std::vector<int16_t> c = input;
+                Accumulator fused;
+                Accumulator expected;
+                simd->gainRamp(c.data(), length, channels, ramp[0], step, &fused);
+                ref->measure(c.data(), count, &expected);
+                ok = ok && c == a && fused == expected;
+            }
+
+            // 多路混音: 多路满幅叠加 (累加器不得回绕)，输出触发饱和
+            std::vector<int16_t> other(count);
+            fillTestSignal(other, static_cast<uint32_t>(length * 17 + channels));
+            const int16_t gains[] = {32767, 16384, 1, 32767, 32767};
+            std::vector<int32_t> accA(count, 0);
+            std::vector<int32_t> accB(count, 0);
+            for (int16_t gain : gains) {
+                simd->mixAccumulate(accA.data(), input.data(), count, gain);
+                ref->mixAccumulate(accB.data(), input.data(), count, gain);
+                simd->mixAccumulate(accA.data(), other.data(), count, gain);
+                ref->mixAccumulate(accB.data(), other.data(), count, gain);
+            }
+            std::vector<int16_t> a(count);
+            std::vector<int16_t> b(count);
+            simd->mixOutput(accA.data(), a.data(), count);
+            ref->mixOutput(accB.data(), b.data(), count);
+            ok = ok && accA == accB && a == b;
+
+            Accumulator levelA;
+            Accumulator levelB;
+            simd->measure(input.data(), count, &levelA);
+            ref->measure(input.data(), count, &levelB);
+            ok = ok && levelA == levelB;
+        }
+
+        std::vector<int16_t> mono(length);
+        std::vector<int16_t> stereo(length * 2);
+        fillTestSignal(mono, static_cast<uint32_t>(length));
+        fillTestSignal(stereo, static_cast<uint32_t>(length + 1));
+        std::vector<int16_t> a(length * 2), b(length * 2);
+        simd->monoToStereo(mono.data(), a.data(), length);
+        ref->monoToStereo(mono.data(), b.data(), length);
+        ok = ok && a == b;
+        std::vector<int16_t> c(length), d(length);
+        simd->stereoToMono(stereo.data(), c.data(), length);
+        ref->stereoToMono(stereo.data(), d.data(), length);
+        ok = ok && c == d;
+    }
+    return ok;
+}
+
+bool AudioDsp::benchmark()
+{
+    // 先对每个可用实现 (含标量) 自检，基准结果只在全部通过时有意义
+    bool ok = true;
+    const Backend backends[] = {Scalar, Neon, Sse2};
+    for (Backend backend : backends) {
+        if (isSupported(backend) && !selfTest(backend)) {
+            LOG_ERROR(QString("%1 kernels failed self-test").arg(backendName(backend)));
+            ok = false;
+        }
+    }
+
+    const int frames = 480;             // 10ms @ 48kHz
+    const int iterations = 20000;
+    std::vector<int16_t> stereo(frames * 2);
+    std::vector<int16_t> other(frames * 2);
+    std::vector<int16_t> mono(frames);
+    fillTestSignal(stereo, 1);
+    fillTestSignal(other, 2);
+    fillTestSignal(mono, 3);
+    std::vector<int16_t> work = stereo;
+    std::vector<int32_t> mixAcc(frames * 2);
+
+    for (Backend backend : backends) {
+        if (!isSupported(backend)) {
+            continue;
+        }
+        const Kernels* k = kernelsFor(backend);
+        int64_t sink = 0;
+        auto run = [&](const char* name, const std::function<void()>& body) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++) {
+                body();
+            }
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            LOG_INFO(QString("%1 %2: %3 ns / 10ms block")
+                     .arg(backendName(backend), -6).arg(name, -12).arg(ns / iterations, 0, 'f', 1));
+        };
+
+        run("gainRamp", [&]() {
+            std::copy(stereo.begin(), stereo.end(), work.begin());
+            k->gainRamp(work.data(), frames, 2, 1.0f, -0.8f / frames, nullptr);
+        });
+        run("gainMeasure", [&]() {
+            std::copy(stereo.begin(), stereo.end(), work.begin());
+            Accumulator acc;
+            k->gainRamp(work.data(), frames, 2, 1.0f, -0.8f / frames, &acc);
+            sink += acc.sumSquares;
+        });
+        // 两路流按增益混音并输出，即 RemoteStreamMixer 每块的工作量
+        run("mix2", [&]() {
+            std::fill(mixAcc.begin(), mixAcc.end(), 0);
+            k->mixAccumulate(mixAcc.data(), stereo.data(), frames * 2, 32767);
+            k->mixAccumulate(mixAcc.data(), other.data(), frames * 2, 9830);
+            k->mixOutput(mixAcc.data(), work.data(), frames * 2);
+        });
+        run("monoToStereo", [&]() {
+            k->monoToStereo(mono.data(), work.data(), frames);
+        });
+        run("stereoToMono", [&]() {
+            k->stereoToMono(stereo.data(), work.data(), frames);
+        });
+        run("measure", [&]() {
+            Accumulator acc;
+            k->measure(stereo.data(), frames * 2, &acc);
+            sink += acc.sumSquares + acc.maxValue - acc.minValue;
+        });
+        sink += work[0];
+        if (sink == 42) {
+            // 防止编译器把整个循环优化掉
+            LOG_DEBUG("benchmark sink");
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * 音频 DSP 基础运算 (int16 交错数据)
+ * 采集/播放线程中的音量、闪避、混音、声道转换和电平测量共用这一组实现
+ *
+ * - 每个运算有 NEON、SSE2 和标量三种实现，运行时按 CPU 能力选择
+ * - 所有实现逐采样结果一致 (增益斜坡允许 1 LSB 的浮点误差)，initialize 时自检，不一致则退回标量
+ * - 只读写调用方的缓冲，不分配内存，可在实时线程中调用
+ */
+class AudioDsp {
+public:
+    enum Backend {
+        Scalar,
+        Neon,
+        Sse2
+    };
+
+    struct Level {
+        int peak = 0;           // 最大绝对值 (0 - 32768)
+        float rms = 0.0f;
+    };
+
+    // 选择当前 CPU 支持的最快实现并自检，进程启动时调用一次 (未调用时首次使用会自动选择，但不自检)
+    static void initialize();
+    static Backend backend();
+    static const char* backendName(Backend backend);
+    // 强制使用指定实现 (基准测试、排查问题)，CPU 不支持时返回 false
+    static bool setBackend(Backend backend);
+    static bool isSupported(Backend backend);
+
+    // 增益斜坡: 第 i 帧的增益为 start + (end - start) * (i + 1) / frames，结果饱和
+    // start == end 时即固定增益
+    static void applyGainRamp(int16_t* samples, int frames, int channels, float startGain, float endGain);
+    // 同上，并在同一次遍历中测量输出的峰值和 RMS (电平表)
+    static Level applyGainRampMeasured(int16_t* samples, int frames, int channels, float startGain, float endGain);
+    // 多路混音 (AudioMixer): 每路 acc += (in * gain) >> 15，gain 为 Q15 (0 - 32767)，
+    // 每路贡献不超过 ±32767，int32 累加器不会溢出；全部累加后饱和输出 out = clamp(acc)
+    static void mixAccumulate(int32_t* acc, const int16_t* in, int count, int gainQ15);
+    static void mixOutput(const int32_t* acc, int16_t* out, int count);
+    // 声道转换: 单声道复制到左右声道 / 左右声道取平均 (向下取整)
+    static void monoToStereo(const int16_t* in, int16_t* out, int frames);
+    static void stereoToMono(const int16_t* in, int16_t* out, int frames);
+    // 一次遍历同时得到峰值和 RMS
+    static Level measure(const int16_t* samples, int count);
+
+    // 先用手算结果的固定向量检查，再与标量实现逐采样比对，返回是否全部通过
+    static bool selfTest(Backend backend);
+    // 微基准: 各实现每个运算处理 10ms 48kHz 立体声的耗时，结果写入日志；
+    // 之前对每个可用实现自检，返回是否全部通过
+    static bool benchmark();
+};
@@ -0,0 +1,74 @@
+#include "AudioLevelMeter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static const int CLIP_PEAK = 32767;
+
+static int64_t nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+AudioLevelMeter::AudioLevelMeter()
+{
+    reset();
+}
+
+void AudioLevelMeter::reset()
+{
+    for (std::atomic<uint32_t>& block : m_blocks) {
+        block.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_release);
+    m_lastPublishUs.store(0, std::memory_order_relaxed);
+}
+
+void AudioLevelMeter::publish(const AudioDsp::Level& level)
+{
+    uint32_t peak = static_cast<uint32_t>(std::min(std::max(level.peak, 0), 32768));
+    uint32_t rms = static_cast<uint32_t>(std::min(std::max(level.rms + 0.5f, 0.0f), 32768.0f));
+    uint32_t index = m_count.load(std::memory_order_relaxed);
+    m_blocks[index % HISTORY_BLOCKS].store(rms << 16 | peak, std::memory_order_relaxed);
+    m_count.store(index + 1, std::memory_order_release);
+    m_lastPublishUs.store(nowUs(), std::memory_order_relaxed);
+}
+
+AudioLevelMeter::Reading AudioLevelMeter::read(int windowMs) const
+{
+    Reading reading;
+    // 音频线程停止 (或阻塞) 后历史不再代表当前的声音
+    if (nowUs() - m_lastPublishUs.load(std::memory_order_relaxed) > 2 * BLOCK_MS * 1000) {
+        return reading;
+    }
+    uint32_t count = m_count.load(std::memory_order_acquire);
+    int blocks = std::min<int>(std::min(HISTORY_BLOCKS, std::max(1, windowMs / BLOCK_MS)),
+                               static_cast<int>(std::min<uint32_t>(count, HISTORY_BLOCKS)));
+    if (blocks <= 0) {
+        return reading;
+    }
+    double power = 0.0;
+    for (int i = 1; i <= blocks; i++) {
+        uint32_t block = m_blocks[(count - i) % HISTORY_BLOCKS].load(std::memory_order_relaxed);
+        int peak = static_cast<int>(block & PEAK_MASK);
+        double rms = static_cast<double>(block >> 16);
+        reading.peak = std::max(reading.peak, peak);
+        power += rms * rms;
+        if (peak >= CLIP_PEAK) {
+            reading.clippedBlocks++;
+        }
+    }
+    reading.rms = static_cast<float>(std::sqrt(power / blocks));
+    reading.peakDbfs = toDbfs(static_cast<float>(reading.peak));
+    reading.rmsDbfs = toDbfs(reading.rms);
+    return reading;
+}
+
+float AudioLevelMeter::toDbfs(float amplitude)
+{
+    if (amplitude <= 0.0f) {
+        return MIN_DBFS;
+    }
+    return std::max(static_cast<float>(MIN_DBFS), 20.0f * std::log10(amplitude / 32768.0f));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "AudioDsp.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 音频电平表 (麦克风 / 扬声器)
+ * 音频线程每 10ms 发布一块的峰值和 RMS (由增益处理同一次遍历测得)，
+ * UI 和监控按需读取最近一段时间的电平，不产生逐帧的 Qt 事件
+ *
+ * 单写多读，全部为原子变量，读写两端都不加锁、不分配
+ */
+class AudioLevelMeter {
+public:
+    static const int BLOCK_MS = 10;
+    static const int HISTORY_BLOCKS = 100;  // 1 秒
+    static const int MIN_DBFS = -96;        // 静音时的读数
+
+    struct Reading {
+        int peak = 0;                   // 0 - 32768
+        float rms = 0.0f;
+        float peakDbfs = MIN_DBFS;
+        float rmsDbfs = MIN_DBFS;
+        int clippedBlocks = 0;          // 窗口内峰值达到满幅的块数
+    };
+
+    AudioLevelMeter();
+
+    // 音频线程: 发布一块 (10ms) 的电平
+    void publish(const AudioDsp::Level& level);
+    void reset();
+
+    // 任意线程: 最近 windowMs 内的最大峰值和平均 RMS (按功率平均)，音频线程停止超过两块时返回静音
+    Reading read(int windowMs) const;
+
+    static float toDbfs(float amplitude);
+
+private:
+    static const uint32_t PEAK_MASK = 0xFFFF;
+
+    std::atomic<uint32_t> m_blocks[HISTORY_BLOCKS];   // RMS << 16 | 峰值
+    std::atomic<uint32_t> m_count{0};
+    std::atomic<int64_t> m_lastPublishUs{0};
+};
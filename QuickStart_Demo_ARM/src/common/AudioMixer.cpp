@@ -0,0 +1,35 @@
+#include "AudioMixer.h"
+#include "AudioDsp.h"
+#include <algorithm>
+
+AudioMixer::AudioMixer(int capacitySamples)
+{
+    setCapacity(capacitySamples);
+}
+
+void AudioMixer::setCapacity(int samples)
+{
+    m_acc.assign(static_cast<size_t>(std::max(0, samples)), 0);
+    m_samples = 0;
+}
+
+int AudioMixer::gainFromPercent(int percent)
+{
+    return std::max(0, std::min(100, percent)) * UNITY_GAIN / 100;
+}
+
+void AudioMixer::begin(int samples)
+{
+    m_samples = std::min(samples, static_cast<int>(m_acc.size()));
+    std::fill(m_acc.begin(), m_acc.begin() + m_samples, 0);
+}
+
+void AudioMixer::add(const int16_t* in, int gain)
+{
+    AudioDsp::mixAccumulate(m_acc.data(), in, m_samples, gain);
+}
+
+void AudioMixer::end(int16_t* out) const
+{
+    AudioDsp::mixOutput(m_acc.data(), out, m_samples);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * int16 混音器
+ * 各路输入乘 Q15 增益后先右移 15 位回到 int16 量级，再累加到 int32 累加器，最后统一饱和输出；
+ * 每路贡献不超过 ±32767，累加器不会溢出，多路同时满幅也只在输出时削顶一次
+ *
+ * 累加和输出由 AudioDsp 按 CPU 选择的实现完成 (NEON / SSE2 / 标量)；
+ * 这里只管理累加器，缓冲在 setCapacity 时分配，混音过程不分配内存
+ */
+class AudioMixer {
+public:
+    static const int UNITY_GAIN = 32767;    // Q15 的 1.0
+
+    explicit AudioMixer(int capacitySamples = 0);
+
+    void setCapacity(int samples);
+
+    // 开始新的一块 (清零累加器)
+    void begin(int samples);
+    // 累加一路输入: acc += (in * gain) >> 15，gain 为 Q15 (0 - UNITY_GAIN)
+    void add(const int16_t* in, int gain);
+    // 饱和输出到 out
+    void end(int16_t* out) const;
+
+    // 百分比转 Q15 增益
+    static int gainFromPercent(int percent);
+
+private:
+    std::vector<int32_t> m_acc;
+    int m_samples = 0;
+};
@@ -0,0 +1,88 @@
+#include "AudioRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+AudioRingBuffer::AudioRingBuffer(size_t minCapacity)
+{
+    allocate(minCapacity);
+}
+
+void AudioRingBuffer::allocate(size_t minCapacity)
+{
+    size_t capacity = 1;
+    while (capacity < minCapacity) {
+        capacity <<= 1;
+    }
+    m_buffer.assign(capacity, 0);
+    m_mask = capacity - 1;
+    reset();
+}
+
+void AudioRingBuffer::reset()
+{
+    m_writePos.store(0, std::memory_order_relaxed);
+    m_readPos.store(0, std::memory_order_relaxed);
+}
+
+size_t AudioRingBuffer::available() const
+{
+    return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_relaxed);
+}
+
+size_t AudioRingBuffer::space() const
+{
+    return capacity() - (m_writePos.load(std::memory_order_relaxed) -
+                         m_readPos.load(std::memory_order_acquire));
+}
+
+size_t AudioRingBuffer::write(const int16_t* src, size_t count)
+{
+    if (m_buffer.empty()) {
+        return 0;
+    }
+    size_t writePos = m_writePos.load(std::memory_order_relaxed);
+    size_t readPos = m_readPos.load(std::memory_order_acquire);
+    count = std::min(count, capacity() - (writePos - readPos));
+
+    size_t offset = writePos & m_mask;
+    size_t first = std::min(count, capacity() - offset);
+    memcpy(m_buffer.data() + offset, src, first * sizeof(int16_t));
+    if (count > first) {
+        memcpy(m_buffer.data(), src + first, (count - first) * sizeof(int16_t));
+    }
+
+    m_writePos.store(writePos + count, std::memory_order_release);
+    return count;
+}
+
+size_t AudioRingBuffer::peek(int16_t* dst, size_t count) const
+{
+    if (m_buffer.empty()) {
+        return 0;
+    }
+    size_t readPos = m_readPos.load(std::memory_order_relaxed);
+    size_t writePos = m_writePos.load(std::memory_order_acquire);
+    count = std::min(count, writePos - readPos);
+
+    size_t offset = readPos & m_mask;
+    size_t first = std::min(count, capacity() - offset);
+    memcpy(dst, m_buffer.data() + offset, first * sizeof(int16_t));
+    if (count > first) {
+        memcpy(dst + first, m_buffer.data(), (count - first) * sizeof(int16_t));
+    }
+    return count;
+}
+
+size_t AudioRingBuffer::read(int16_t* dst, size_t count)
+{
+    count = peek(dst, count);
+    m_readPos.store(m_readPos.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    return count;
+}
+
+size_t AudioRingBuffer::discard(size_t count)
+{
+    count = std::min(count, available());
+    m_readPos.store(m_readPos.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    return count;
+}
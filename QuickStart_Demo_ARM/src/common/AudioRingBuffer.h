@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 音频环形缓冲 (int16 采样)
+ * 单生产者/单消费者无锁实现，读写两端各自只修改自己的位置计数
+ * 容量向上取整为 2 的幂，位置计数单调递增，用掩码取下标
+ *
+ * 容量在 allocate() 时一次性分配，之后读写不会分配内存，
+ * 可以放在实时线程中使用，也可以用 ThreadPolicy::lockBuffer 锁定
+ */
+class AudioRingBuffer {
+public:
+    AudioRingBuffer() = default;
+    explicit AudioRingBuffer(size_t minCapacity);
+
+    // 分配存储并清空 (非线程安全，需在读写线程启动前调用)
+    void allocate(size_t minCapacity);
+    // 清空 (非线程安全)
+    void reset();
+
+    size_t capacity() const { return m_buffer.size(); }
+    const int16_t* data() const { return m_buffer.data(); }
+
+    // 可读采样数 (消费者调用)
+    size_t available() const;
+    // 可写采样数 (生产者调用)
+    size_t space() const;
+
+    // 生产者: 写入最多 count 个采样，空间不足时只写能写下的部分，返回写入数
+    size_t write(const int16_t* src, size_t count);
+    // 消费者: 读取最多 count 个采样，返回读取数
+    size_t read(int16_t* dst, size_t count);
+    // 消费者: 读取但不移动读位置
+    size_t peek(int16_t* dst, size_t count) const;
+    // 消费者: 丢弃最多 count 个采样，返回丢弃数
+    size_t discard(size_t count);
+
+private:
+    std::vector<int16_t> m_buffer;
+    size_t m_mask = 0;
+    // 读写位置隔开一个缓存行，避免伪共享；不用 alignas，
+    // C++14 的 new 不保证超对齐，作为成员嵌入堆对象时会失效
+    char m_pad0[64];
+    std::atomic<size_t> m_writePos{0};
+    char m_pad1[64];
+    std::atomic<size_t> m_readPos{0};
+};
@@ -0,0 +1,115 @@
+#include "BargeInDetector.h"
+#include "AudioDsp.h"
+#include <algorithm>
+#include <cmath>
+
+static const float MIN_NOISE_RMS = 16.0f;       // 约 -66 dBFS，数字静音时的下限
+static const float NOISE_RISE = 1.002f;         // 噪声底每帧最多上升 0.02dB (约 2dB/s)
+static const float COUPLING_ATTACK = 0.1f;
+static const float COUPLING_RELEASE = 0.01f;      // 约 1 秒时间常数
+static const float MIN_COUPLING = 0.01f;        // -40dB
+static const float MAX_COUPLING = 4.0f;         // +12dB
+
+static float dbToGain(float db)
+{
+    return std::pow(10.0f, db / 20.0f);
+}
+
+BargeInDetector::BargeInDetector()
+{
+    setConfig(Config());
+}
+
+void BargeInDetector::setConfig(const Config& config)
+{
+    m_config = config;
+    m_config.minSpeechMs = std::max(FRAME_MS, config.minSpeechMs);
+    m_snrGain = dbToGain(config.snrDb);
+    m_marginGain = dbToGain(config.echoMarginDb);
+    reset();
+}
+
+void BargeInDetector::reset()
+{
+    m_noiseRms = MIN_NOISE_RMS * 4;
+    m_coupling = 0.5f;
+    m_inSpeech = false;
+    m_ended = false;
+    m_speechMs = 0;
+    m_candidateMs = 0;
+    m_gapMs = 0;
+    m_decisionMs = 0;
+}
+
+float BargeInDetector::echoCouplingDb() const
+{
+    return 20.0f * std::log10(m_coupling);
+}
+
+bool BargeInDetector::process(const int16_t* samples, int count, int farPeak)
+{
+    if (!samples || count <= 0) {
+        return false;
+    }
+    return process(AudioDsp::measure(samples, count), farPeak);
+}
+
+bool BargeInDetector::process(const AudioDsp::Level& level, int farPeak)
+{
+    int peak = level.peak;
+    float rms = level.rms;
+    m_ended = false;
+
+    // 回声只能解释到 耦合 x 播放峰值 为止，再加余量
+    float echoPeak = m_coupling * farPeak;
+    bool aboveNoise = rms > m_noiseRms * m_snrGain;
+    bool aboveEcho = farPeak == 0 || peak > echoPeak * m_marginGain;
+    bool speech = aboveNoise && aboveEcho;
+
+    if (!speech && !m_inSpeech) {
+        if (farPeak == 0) {
+            // 只在没有播放时学习噪声底，避免把回声当噪声
+            m_noiseRms = rms < m_noiseRms ? m_noiseRms + (rms - m_noiseRms) * 0.2f
+                                          : m_noiseRms * NOISE_RISE;
+            m_noiseRms = std::max(MIN_NOISE_RMS, m_noiseRms);
+        } else if (peak > 0) {
+            float ratio = static_cast<float>(peak) / farPeak;
+            float rate = ratio > m_coupling ? COUPLING_ATTACK : COUPLING_RELEASE;
+            m_coupling = std::min(MAX_COUPLING, std::max(MIN_COUPLING, m_coupling + (ratio - m_coupling) * rate));
+        }
+    }
+
+    if (m_inSpeech) {
+        m_gapMs = speech ? 0 : m_gapMs + FRAME_MS;
+        if (m_gapMs >= HANGOVER_MS) {
+            m_inSpeech = false;
+            m_ended = true;
+            m_speechMs = 0;
+            m_candidateMs = 0;
+            m_gapMs = 0;
+        }
+        return false;
+    }
+
+    if (speech) {
+        m_speechMs += FRAME_MS;
+        m_candidateMs += FRAME_MS;
+        m_gapMs = 0;
+    } else if (m_speechMs > 0) {
+        m_gapMs += FRAME_MS;
+        m_candidateMs += FRAME_MS;
+        if (m_gapMs > MAX_GAP_MS) {
+            m_speechMs = 0;
+            m_candidateMs = 0;
+            m_gapMs = 0;
+        }
+    }
+
+    if (m_speechMs >= m_config.minSpeechMs) {
+        m_inSpeech = true;
+        m_decisionMs = m_candidateMs;
+        m_gapMs = 0;
+        return true;
+    }
+    return false;
+}
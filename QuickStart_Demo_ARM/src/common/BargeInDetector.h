@@ -0,0 +1,62 @@
+#pragma once
+
+#include "AudioDsp.h"
+#include <cstdint>
+
+/**
+ * 回声感知的近端语音检测 (本地插话)
+ * 采集线程逐帧 (10ms) 调用，播放端的近期峰值由 PlaybackMonitor 提供
+ *
+ * - 噪声底: 没有播放时跟踪麦克风帧 RMS 的慢速最小值
+ * - 回声耦合: 播放期间、非语音帧上跟踪 麦克风峰值 / 播放峰值 (快升慢降)
+ * - 语音帧: RMS 高于噪声底 snrDb，且峰值高于 预测回声 + echoMarginDb (Geigel 双讲判据)
+ * - 起点确认: 语音帧累计 minSpeechMs (中间允许 30ms 间断)；结束: 连续 300ms 非语音
+ *
+ * 非线程安全，只在采集线程中使用
+ */
+class BargeInDetector {
+public:
+    struct Config {
+        int minSpeechMs = 200;
+        float echoMarginDb = 6.0f;
+        float snrDb = 12.0f;
+    };
+
+    BargeInDetector();
+
+    void setConfig(const Config& config);
+    void reset();
+
+    // farPeak: 回声时间窗内播放端的最大峰值 (0 表示没有播放)
+    // 返回 true 表示本帧确认了一段语音的起点
+    bool process(const int16_t* samples, int count, int farPeak);
+    // 同上，输入为调用方已测得的本帧电平 (与电平表共用一次测量)
+    bool process(const AudioDsp::Level& level, int farPeak);
+
+    bool inSpeech() const { return m_inSpeech; }
+    // 本帧确认了语音结束 (连续 hangoverMs 非语音)，最后一个语音帧在 hangoverMs 之前结束
+    bool speechEnded() const { return m_ended; }
+    static int hangoverMs() { return HANGOVER_MS; }
+    // 最近一次确认时，从第一帧语音到确认经过的时长
+    int decisionMs() const { return m_decisionMs; }
+    // 当前回声耦合估计 (dB，麦克风相对播放)
+    float echoCouplingDb() const;
+
+private:
+    static const int FRAME_MS = 10;
+    static const int MAX_GAP_MS = 30;
+    static const int HANGOVER_MS = 300;
+
+    Config m_config;
+    float m_snrGain = 1.0f;
+    float m_marginGain = 1.0f;
+
+    float m_noiseRms = 0.0f;
+    float m_coupling = 0.5f;     // 未知时按 -6dB (Geigel 常用假设)
+    bool m_inSpeech = false;
+    bool m_ended = false;
+    int m_speechMs = 0;
+    int m_candidateMs = 0;       // 候选起点以来经过的时长 (含间断)
+    int m_gapMs = 0;
+    int m_decisionMs = 0;
+};
@@ -0,0 +1,152 @@
+#include "ControlRegistry.h"
+#include "Logger.h"
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <memory>
+
+#define LOG_MODULE "Control"
+
+// 等待 context 线程执行处理函数的上限，主线程卡住时请求返回错误而不是一直挂起
+static const int HANDLER_TIMEOUT_MS = 2000;
+
+namespace {
+// 投递到 context 线程的调用，请求线程超时返回后仍由处理函数一侧持有
+struct PendingCall {
+    QSemaphore done;
+    QJsonObject result;
+    QString error;
+};
+}
+
+ControlRegistry* ControlRegistry::instance()
+{
+    static ControlRegistry registry;
+    return &registry;
+}
+
+void ControlRegistry::registerCommand(const QString& name, const QString& help, QObject* context, Handler handler)
+{
+    if (!context || !handler) {
+        return;
+    }
+    {
+        QMutexLocker locker(&m_mutex);
+        Command command;
+        command.help = help;
+        command.context = context;
+        command.handler = std::move(handler);
+        m_commands.insert(name, command);
+    }
+    // 在销毁 context 的线程中直接调用
+    QObject::connect(context, &QObject::destroyed, [this, context]() { unregisterContext(context); });
+}
+
+void ControlRegistry::unregisterContext(QObject* context)
+{
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_commands.begin(); it != m_commands.end();) {
+        if (it.value().context == context) {
+            it = m_commands.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool ControlRegistry::invoke(const QString& name, const QJsonObject& params, QJsonObject* result, QString* error)
+{
+    std::shared_ptr<PendingCall> pending = std::make_shared<PendingCall>();
+    {
+        // 持锁投递: context 销毁时 unregisterContext 先等待此锁，投递时对象一定仍然存在
+        QMutexLocker locker(&m_mutex);
+        auto it = m_commands.constFind(name);
+        if (it == m_commands.constEnd()) {
+            *error = QString("unknown command \"%1\", try \"help\"").arg(name);
+            return false;
+        }
+        Handler handler = it.value().handler;
+        QMetaObject::invokeMethod(it.value().context, [pending, handler, params]() {
+            pending->result = handler(params, &pending->error);
+            pending->done.release();
+        }, Qt::QueuedConnection);
+    }
+
+    if (!pending->done.tryAcquire(1, HANDLER_TIMEOUT_MS)) {
+        *error = QString("\"%1\" timed out waiting for its owner thread").arg(name);
+        return false;
+    }
+    *result = pending->result;
+    *error = pending->error;
+    return error->isEmpty();
+}
+
+QJsonObject ControlRegistry::helpResult() const
+{
+    QJsonObject commands;
+    commands.insert("help", "List commands");
+    commands.insert("state", "Query every command without parameters");
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_commands.constBegin(); it != m_commands.constEnd(); ++it) {
+        commands.insert(it.key(), it.value().help);
+    }
+    return commands;
+}
+
+QJsonObject ControlRegistry::stateResult()
+{
+    QStringList names;
+    {
+        QMutexLocker locker(&m_mutex);
+        names = m_commands.keys();
+    }
+    QJsonObject state;
+    for (const QString& name : names) {
+        QJsonObject result;
+        QString error;
+        if (invoke(name, QJsonObject(), &result, &error)) {
+            state.insert(name, result);
+        } else {
+            state.insert(name, QJsonObject{{"error", error}});
+        }
+    }
+    return state;
+}
+
+QJsonObject ControlRegistry::execute(const QJsonObject& request)
+{
+    QString name = request.value("cmd").toString();
+    QJsonObject params = request;
+    params.remove("cmd");
+    params.remove("id");
+
+    QJsonObject result;
+    QString error;
+    if (name.isEmpty()) {
+        error = "missing \"cmd\"";
+    } else if (name == "help") {
+        result = helpResult();
+    } else if (name == "state") {
+        result = stateResult();
+    } else {
+        if (!params.isEmpty()) {
+            // 修改类请求留痕，便于对照日志中的性能变化
+            LOG_INFO(QString("%1 %2").arg(name, QString::fromUtf8(
+                QJsonDocument(params).toJson(QJsonDocument::Compact))));
+        }
+        invoke(name, params, &result, &error);
+    }
+
+    QJsonObject response;
+    if (request.contains("id")) {
+        response.insert("id", request.value("id"));
+    }
+    response.insert("ok", error.isEmpty());
+    if (error.isEmpty()) {
+        response.insert("result", result);
+    } else {
+        response.insert("error", error);
+        LOG_WARN(QString("%1 failed: %2").arg(name.isEmpty() ? QString("request") : name, error));
+    }
+    return response;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <functional>
+
+/**
+ * 运行时控制命令注册表
+ * 各模块在自己的线程 (通常是主线程) 注册命令，ControlServer 的线程收到请求后经此分发:
+ * 处理函数通过事件队列投递到注册时的 context 对象所在线程执行，请求线程等待结果 (有超时)，
+ * 因此处理函数可以直接操作 context 线程中的对象，不需要额外加锁
+ *
+ * 约定: 不带参数调用命令即查询当前值，带参数时修改并返回修改后的值；
+ * 内置命令 help 列出所有命令，state 以无参数方式调用所有命令并汇总结果
+ *
+ * context 销毁时其注册的命令自动注销
+ */
+class ControlRegistry {
+public:
+    // params 为请求中除 cmd/id 以外的字段；出错时写入 error，返回值作为 result
+    using Handler = std::function<QJsonObject(const QJsonObject& params, QString* error)>;
+
+    static ControlRegistry* instance();
+
+    // 同名命令后注册的覆盖先注册的
+    void registerCommand(const QString& name, const QString& help, QObject* context, Handler handler);
+
+    // 执行一个请求 ({"cmd": "...", "id": ..., 参数...})，返回 {"ok": bool, "result"/"error": ..., "id": ...}
+    // 不能在任何 context 所在的线程调用 (会等待自身而超时)
+    QJsonObject execute(const QJsonObject& request);
+
+private:
+    struct Command {
+        QString help;
+        QObject* context = nullptr;
+        Handler handler;
+    };
+
+    ControlRegistry() = default;
+    void unregisterContext(QObject* context);
+    // 在 context 线程中执行处理函数并等待结果
+    bool invoke(const QString& name, const QJsonObject& params, QJsonObject* result, QString* error);
+    QJsonObject helpResult() const;
+    QJsonObject stateResult();
+
+    mutable QMutex m_mutex;
+    QMap<QString, Command> m_commands;
+};
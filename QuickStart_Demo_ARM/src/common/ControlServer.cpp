@@ -0,0 +1,95 @@
+#include "ControlServer.h"
+#include "ControlRegistry.h"
+#include "Logger.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#define LOG_MODULE "ControlServer"
+
+// 单个请求行的上限，超过视为异常连接
+static const int MAX_REQUEST_BYTES = 64 * 1024;
+
+ControlServer::ControlServer(QObject* parent)
+    : QThread(parent)
+{
+}
+
+ControlServer::~ControlServer()
+{
+    stopServer();
+}
+
+void ControlServer::startServer(const QString& socketPath)
+{
+    if (isRunning() || socketPath.isEmpty()) {
+        return;
+    }
+    m_socketPath = socketPath;
+    start();
+}
+
+void ControlServer::stopServer()
+{
+    if (isRunning()) {
+        quit();
+        wait(3000);
+    }
+}
+
+static void reply(QLocalSocket* socket, const QJsonObject& response)
+{
+    socket->write(QJsonDocument(response).toJson(QJsonDocument::Compact));
+    socket->write("\n");
+}
+
+static void handleRequests(QLocalSocket* socket)
+{
+    while (socket->canReadLine()) {
+        QByteArray line = socket->readLine(MAX_REQUEST_BYTES).trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        QJsonParseError parseError;
+        QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+        if (!document.isObject()) {
+            QString error = parseError.error != QJsonParseError::NoError
+                ? QString("invalid JSON: %1").arg(parseError.errorString())
+                : QString("request must be a JSON object");
+            reply(socket, QJsonObject{{"ok", false}, {"error", error}});
+            continue;
+        }
+        reply(socket, ControlRegistry::instance()->execute(document.object()));
+    }
+    if (socket->bytesAvailable() >= MAX_REQUEST_BYTES) {
+        LOG_WARN("Request too large, closing connection");
+        socket->abort();
+    }
+}
+
+void ControlServer::run()
+{
+    // 对象都在本线程创建，信号在本线程的事件循环中处理
+    QLocalServer server;
+    server.setSocketOptions(QLocalServer::UserAccessOption);
+    // 上次异常退出时残留的套接字文件会导致 listen 失败
+    QLocalServer::removeServer(m_socketPath);
+    if (!server.listen(m_socketPath)) {
+        LOG_WARN(QString("Failed to listen on %1: %2").arg(m_socketPath, server.errorString()));
+        return;
+    }
+    LOG_INFO(QString("Control socket at %1 (try: echo '{\"cmd\":\"help\"}' | socat - UNIX-CONNECT:%1)")
+             .arg(m_socketPath));
+
+    QObject::connect(&server, &QLocalServer::newConnection, [&server]() {
+        while (QLocalSocket* socket = server.nextPendingConnection()) {
+            QObject::connect(socket, &QLocalSocket::readyRead, socket, [socket]() { handleRequests(socket); });
+            QObject::connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        }
+    });
+
+    exec();
+
+    server.close();
+}
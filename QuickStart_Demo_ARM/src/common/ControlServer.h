@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QThread>
+#include <QString>
+
+/**
+ * 运行时控制接口 (Unix 域套接字)
+ * 在独立线程的事件循环中收发请求，不占用 GUI 线程；命令由 ControlRegistry 分发到各模块
+ *
+ * 协议: 每行一个 JSON 请求，每行一个 JSON 应答，连接可连续发送多个请求，例如
+ *   {"cmd":"video.format","width":1280,"height":720,"fps":30}
+ *   {"ok":true,"result":{"width":1280,"height":720,"fps":30}}
+ *
+ * 套接字只允许同一用户访问；路径为空时不启动线程
+ */
+class ControlServer : public QThread {
+    Q_OBJECT
+
+public:
+    explicit ControlServer(QObject* parent = nullptr);
+    ~ControlServer() override;
+
+    void startServer(const QString& socketPath);
+    void stopServer();
+
+protected:
+    void run() override;
+
+private:
+    QString m_socketPath;
+};
@@ -0,0 +1,73 @@
+#include "DriftEstimator.h"
+#include <algorithm>
+
+constexpr double DriftEstimator::MAX_CORRECTION;
+constexpr double DriftEstimator::WARMUP_SEC;
+constexpr double DriftEstimator::FILTER_TIME_SEC;
+constexpr double DriftEstimator::KP;
+constexpr double DriftEstimator::KI;
+
+DriftEstimator::DriftEstimator(int sampleRate, double updateIntervalSec)
+    : m_sampleRate(sampleRate > 0 ? sampleRate : 16000)
+    , m_interval(updateIntervalSec > 0 ? updateIntervalSec : 0.01)
+{
+    m_alpha = std::min(1.0, m_interval / FILTER_TIME_SEC);
+    m_warmupUpdates = static_cast<int>(WARMUP_SEC / m_interval);
+    reset();
+}
+
+void DriftEstimator::reset()
+{
+    m_filtered = 0.0;
+    m_updates = 0;
+    m_locked = m_manualTarget;
+    if (!m_manualTarget) {
+        m_target = -1.0;
+    }
+    m_integral = 0.0;
+    m_correction = 0.0;
+    m_driftPpm.store(0.0, std::memory_order_relaxed);
+}
+
+void DriftEstimator::setTargetLevel(double frames)
+{
+    m_manualTarget = frames >= 0;
+    m_target = frames;
+    m_locked = m_manualTarget;
+}
+
+void DriftEstimator::update(double levelFrames)
+{
+    if (m_updates == 0) {
+        m_filtered = levelFrames;
+    } else {
+        m_filtered += m_alpha * (levelFrames - m_filtered);
+    }
+    m_updates++;
+
+    if (!m_locked) {
+        if (m_updates < m_warmupUpdates) {
+            return;
+        }
+        m_target = m_filtered;
+        m_locked = true;
+    }
+
+    // 误差换算为秒，与采样率无关
+    double error = (m_filtered - m_target) / m_sampleRate;
+
+    double integral = m_integral + error * m_interval;
+    double correction = KP * error + KI * integral;
+
+    // 饱和时停止积分，防止积分项越积越大
+    if (correction > MAX_CORRECTION) {
+        correction = MAX_CORRECTION;
+    } else if (correction < -MAX_CORRECTION) {
+        correction = -MAX_CORRECTION;
+    } else {
+        m_integral = integral;
+    }
+
+    m_correction = correction;
+    m_driftPpm.store(KI * m_integral * 1e6, std::memory_order_relaxed);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * 时钟漂移估计器
+ * 根据缓冲水位 (采样帧数) 的长期变化估计两个时钟之间的偏差，
+ * 输出给 FractionalResampler 使用的修正比率
+ *
+ * 水位先做一阶低通去掉周期性锯齿 (arecord/SDK 按块投递)，
+ * 再用 PI 控制器把水位拉回目标值；积分项在稳态下即为实际漂移
+ *
+ * 目标水位默认在预热期结束时锁定为当时的平均水位，
+ * 这样不会改变链路原有的延迟，只抵消长期累积
+ */
+class DriftEstimator {
+public:
+    explicit DriftEstimator(int sampleRate = 16000, double updateIntervalSec = 0.01);
+
+    void reset();
+
+    // 手动指定目标水位 (帧)，<0 表示在预热期后自动锁定
+    void setTargetLevel(double frames);
+    double targetLevel() const { return m_target; }
+
+    // 每个处理周期调用一次，输入当前水位 (帧)
+    void update(double levelFrames);
+
+    // 重采样比率 (输入/输出)
+    double ratio() const { return 1.0 + m_correction; }
+    // 估计的时钟偏差 (ppm)，正值表示生产端比消费端快
+    double driftPpm() const { return m_driftPpm.load(std::memory_order_relaxed); }
+    double filteredLevel() const { return m_filtered; }
+    bool isLocked() const { return m_locked; }
+
+private:
+    static constexpr double MAX_CORRECTION = 0.002;   // ±2000 ppm
+    static constexpr double WARMUP_SEC = 2.0;
+    static constexpr double FILTER_TIME_SEC = 1.0;
+    static constexpr double KP = 0.1;                 // 水位误差 1 秒 -> 10% 修正
+    static constexpr double KI = KP / 60.0;
+
+    int m_sampleRate;
+    double m_interval;
+    double m_alpha;
+    double m_filtered = 0.0;
+    double m_target = -1.0;
+    bool m_manualTarget = false;
+    bool m_locked = false;
+    int m_updates = 0;
+    int m_warmupUpdates;
+    double m_integral = 0.0;
+    double m_correction = 0.0;
+    std::atomic<double> m_driftPpm{0.0};
+};
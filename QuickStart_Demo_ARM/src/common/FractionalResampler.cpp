@@ -0,0 +1,141 @@
+#include "FractionalResampler.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+
+#define LOG_MODULE "FractionalResampler"
+
+FractionalResampler::FractionalResampler(int channels)
+    : m_channels(channels > 0 ? channels : 1)
+{
+    reset();
+}
+
+void FractionalResampler::setChannels(int channels)
+{
+    if (channels > 0 && channels != m_channels) {
+        m_channels = channels;
+        reset();
+    }
+}
+
+void FractionalResampler::reset()
+{
+    m_pos = HISTORY_FRAMES;
+    m_work.assign(HISTORY_FRAMES * m_channels, 0.0f);
+}
+
+void FractionalResampler::setRatio(double ratio)
+{
+    // 覆盖 8k-48k 之间的采样率转换 (含漂移补偿)，限制范围防止异常输入
+    m_ratio = std::min(8.0, std::max(0.125, ratio));
+}
+
+int FractionalResampler::inputFramesFor(int outFrames) const
+{
+    if (outFrames <= 0) {
+        return 0;
+    }
+    // 最后一个输出点 p 需要工作缓冲中有 floor(p) + 3 帧 (插值用到 floor(p) + 2)
+    double lastPos = m_pos + (outFrames - 1) * m_ratio;
+    int historyFrames = static_cast<int>(m_work.size()) / m_channels;
+    int needed = static_cast<int>(std::floor(lastPos)) + 3 - historyFrames;
+    return std::max(0, needed);
+}
+
+int FractionalResampler::maxOutputFrames(int inFrames) const
+{
+    int historyFrames = static_cast<int>(m_work.size()) / m_channels;
+    return static_cast<int>(std::ceil((inFrames + historyFrames) / m_ratio)) + 2;
+}
+
+int FractionalResampler::process(const int16_t* in, int inFrames, int16_t* out, int maxOutFrames)
+{
+    inFrames = std::max(0, inFrames);
+    const int ch = m_channels;
+    const int historyFrames = static_cast<int>(m_work.size()) / ch;
+    const int totalFrames = historyFrames + inFrames;
+    m_work.resize(static_cast<size_t>(totalFrames) * ch);
+    float* work = m_work.data();
+    for (int i = 0; i < inFrames * ch; i++) {
+        work[historyFrames * ch + i] = static_cast<float>(in[i]);
+    }
+
+    int produced = 0;
+
+    // 输出满时立即停止，不再推进位置: 否则多出的输出点被丢弃而输入照样消耗，
+    // 比率 < 1 时每隔几块少一帧，长期偏差可达上千 ppm
+    while (produced < maxOutFrames) {
+        int idx = static_cast<int>(m_pos);
+        if (idx + 2 > totalFrames - 1) {
+            break;
+        }
+        float t = static_cast<float>(m_pos - idx);
+        const float* xm1 = work + (idx - 1) * ch;
+        const float* x0 = work + idx * ch;
+        const float* x1 = work + (idx + 1) * ch;
+        const float* x2 = work + (idx + 2) * ch;
+        int16_t* dst = out + produced * ch;
+        for (int c = 0; c < ch; c++) {
+            // Catmull-Rom 三次 Hermite 插值
+            float c0 = x0[c];
+            float c1 = 0.5f * (x1[c] - xm1[c]);
+            float c2 = xm1[c] - 2.5f * x0[c] + 2.0f * x1[c] - 0.5f * x2[c];
+            float c3 = 0.5f * (x2[c] - xm1[c]) + 1.5f * (x0[c] - x1[c]);
+            float v = ((c3 * t + c2) * t + c1) * t + c0;
+            v = std::min(32767.0f, std::max(-32768.0f, v));
+            dst[c] = static_cast<int16_t>(std::lrint(v));
+        }
+        produced++;
+        m_pos += m_ratio;
+    }
+
+    // 从下一个输出点的前一帧开始保留 (尚未用到的输入留到下次)，至少保留最后 HISTORY_FRAMES 帧；
+    // 比率 > 1 时下一个输出点可能越过本次输入的末尾，位置相应减去
+    int keepFrom = std::min(static_cast<int>(m_pos) - 1, totalFrames - HISTORY_FRAMES);
+    std::copy(m_work.begin() + keepFrom * ch, m_work.end(), m_work.begin());
+    m_work.resize(static_cast<size_t>(totalFrames - keepFrom) * ch);
+    m_pos -= keepFrom;
+
+    return produced;
+}
+
+bool FractionalResampler::selfTest()
+{
+    // 采样率转换 (48k/44.1k/8k <-> 16k) 与漂移补偿附近的非整数比率
+    static const double RATIOS[] = {0.3335, 1.0 / 3.0, 0.5, 0.99987, 1.00013, 2.75625, 3.0};
+    const int blocks = 1000;
+    const int outFrames = 160;
+    bool ok = true;
+
+    for (double ratio : RATIOS) {
+        FractionalResampler resampler(1);
+        resampler.setRatio(ratio);
+        std::vector<int16_t> in(static_cast<size_t>(resampler.inputFramesFor(outFrames)) * 2 + 16);
+        std::vector<int16_t> out(outFrames);
+        long long totalIn = 0;
+        long long totalOut = 0;
+        for (int b = 0; b < blocks; b++) {
+            int inFrames = resampler.inputFramesFor(outFrames);
+            if (inFrames > static_cast<int>(in.size())) {
+                in.resize(inFrames);
+            }
+            for (int i = 0; i < inFrames; i++) {
+                in[i] = static_cast<int16_t>((totalIn + i) % 1000);
+            }
+            totalIn += inFrames;
+            totalOut += resampler.process(in.data(), inFrames, out.data(), outFrames);
+        }
+        // 输入总量与比率的偏差不超过插值窗口 (历史帧)
+        double expectedIn = static_cast<double>(blocks) * outFrames * ratio;
+        bool countOk = totalOut == static_cast<long long>(blocks) * outFrames;
+        bool inputOk = std::fabs(totalIn - expectedIn) <= HISTORY_FRAMES + 1;
+        if (!countOk || !inputOk) {
+            LOG_ERROR(QString("Self test failed at ratio %1: %2 frames out (expected %3), %4 frames in (expected %5)")
+                      .arg(ratio).arg(totalOut).arg(static_cast<long long>(blocks) * outFrames)
+                      .arg(totalIn).arg(expectedIn, 0, 'f', 1));
+            ok = false;
+        }
+    }
+    return ok;
+}
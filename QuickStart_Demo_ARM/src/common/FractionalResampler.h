@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * 分数比率重采样器
+ * 对交织 int16 PCM 做 4 点三次 Hermite 插值，比率可以逐块平滑调整
+ * 用于时钟漂移补偿 (比率接近 1.0) 和采样率转换 (比率 1/8 - 8)
+ *
+ * ratio = 输入采样数 / 输出采样数
+ *   > 1.0: 消耗更多输入，输出变少 (缓冲在增长时使用)
+ *   < 1.0: 消耗更少输入，输出变多 (缓冲在减少时使用)
+ */
+class FractionalResampler {
+public:
+    explicit FractionalResampler(int channels = 1);
+
+    void setChannels(int channels);
+    int channels() const { return m_channels; }
+
+    void reset();
+    void setRatio(double ratio);
+    double ratio() const { return m_ratio; }
+
+    // 按当前比率产生 outFrames 帧还需要输入的帧数 (扣除历史中尚未消耗的帧，可能为 0)
+    int inputFramesFor(int outFrames) const;
+    // 输入 inFrames 帧时可能产生的最大输出帧数 (用于分配输出缓冲)
+    int maxOutputFrames(int inFrames) const;
+
+    // 接收 inFrames 输入帧，返回写入 out 的帧数 (不超过 maxOutFrames)；
+    // 达到 maxOutFrames 时停止，未用到的输入留在历史中供下次使用，长期输出帧数与比率严格对应
+    int process(const int16_t* in, int inFrames, int16_t* out, int maxOutFrames);
+
+    // 按采集/播放线程的调用方式 (inputFramesFor + process) 连续处理若干块，
+    // 检查非整数比率下每块都输出整块、总输入与比率一致；--dsp-bench 时运行
+    static bool selfTest();
+
+private:
+    static const int HISTORY_FRAMES = 3;
+
+    int m_channels;
+    double m_ratio = 1.0;
+    double m_pos = HISTORY_FRAMES;   // 下一个输出点在工作缓冲中的位置
+    std::vector<float> m_work;       // 历史帧 (至少 HISTORY_FRAMES 帧) + 本次输入 (交织)
+};
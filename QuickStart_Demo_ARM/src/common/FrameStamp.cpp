@@ -0,0 +1,111 @@
+#include "FrameStamp.h"
+#include <cstring>
+
+static const int TIMESTAMP_BITS = 48;
+static const int CRC_BITS = 8;
+static const uint8_t SYNC_WORD = 0xA5;
+static const uint8_t LUMA_BLACK = 16;
+static const uint8_t LUMA_WHITE = 235;
+static const uint8_t CHROMA_NEUTRAL = 128;
+static const int LUMA_THRESHOLD = (LUMA_BLACK + LUMA_WHITE) / 2;
+static const int MIN_BLOCK = 4;
+static const int64_t TIMESTAMP_MASK = (static_cast<int64_t>(1) << TIMESTAMP_BITS) - 1;
+
+// CRC-8 (多项式 0x07)，覆盖时间戳的 6 个字节
+static uint8_t crc8(int64_t value)
+{
+    uint8_t crc = 0;
+    for (int i = TIMESTAMP_BITS / 8 - 1; i >= 0; i--) {
+        crc ^= static_cast<uint8_t>(value >> (i * 8));
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+int FrameStamp::bandHeight(int width, int height)
+{
+    int block = width / COLUMNS;
+    if (block < MIN_BLOCK || block * ROWS > height) {
+        return 0;
+    }
+    return block * ROWS;
+}
+
+void FrameStamp::encode(uint8_t* y, int yStride, uint8_t* u, uint8_t* v, int uvStride,
+                        int width, int height, int64_t timestampUs)
+{
+    int band = bandHeight(width, height);
+    if (!y || band == 0) {
+        return;
+    }
+    int block = width / COLUMNS;
+
+    // 按位组装: 同步字、时间戳、CRC，高位在前
+    int64_t value = timestampUs & TIMESTAMP_MASK;
+    uint64_t bits = (static_cast<uint64_t>(SYNC_WORD) << (TIMESTAMP_BITS + CRC_BITS)) |
+                    (static_cast<uint64_t>(value) << CRC_BITS) | crc8(value);
+
+    for (int row = 0; row < ROWS; row++) {
+        for (int col = 0; col < COLUMNS; col++) {
+            int index = row * COLUMNS + col;
+            bool one = (bits >> (COLUMNS * ROWS - 1 - index)) & 1;
+            uint8_t luma = one ? LUMA_WHITE : LUMA_BLACK;
+            for (int line = 0; line < block; line++) {
+                memset(y + static_cast<size_t>(row * block + line) * yStride + col * block, luma, block);
+            }
+        }
+    }
+    if (u && v) {
+        for (int line = 0; line < band / 2; line++) {
+            memset(u + static_cast<size_t>(line) * uvStride, CHROMA_NEUTRAL, width / 2);
+            memset(v + static_cast<size_t>(line) * uvStride, CHROMA_NEUTRAL, width / 2);
+        }
+    }
+}
+
+bool FrameStamp::decode(const uint8_t* plane, int stride, int pixelStep, int width, int height,
+                        int64_t nowUs, int64_t* timestampUs)
+{
+    if (!plane || bandHeight(width, height) == 0) {
+        return false;
+    }
+    int block = width / COLUMNS;
+    int half = block / 4;
+
+    uint64_t bits = 0;
+    for (int row = 0; row < ROWS; row++) {
+        for (int col = 0; col < COLUMNS; col++) {
+            // 取方块中心的 4 个点，避开边缘的缩放和压缩振铃
+            int cx = col * block + block / 2;
+            int cy = row * block + block / 2;
+            int sum = plane[static_cast<size_t>(cy - half) * stride + (cx - half) * pixelStep] +
+                      plane[static_cast<size_t>(cy - half) * stride + (cx + half) * pixelStep] +
+                      plane[static_cast<size_t>(cy + half) * stride + (cx - half) * pixelStep] +
+                      plane[static_cast<size_t>(cy + half) * stride + (cx + half) * pixelStep];
+            bits = (bits << 1) | (sum > LUMA_THRESHOLD * 4 ? 1 : 0);
+        }
+    }
+
+    if (static_cast<uint8_t>(bits >> (TIMESTAMP_BITS + CRC_BITS)) != SYNC_WORD) {
+        return false;
+    }
+    int64_t value = static_cast<int64_t>((bits >> CRC_BITS) & TIMESTAMP_MASK);
+    if (static_cast<uint8_t>(bits & 0xFF) != crc8(value)) {
+        return false;
+    }
+
+    // 补全高位: 取与 nowUs 最接近的那个回绕周期
+    int64_t full = (nowUs & ~TIMESTAMP_MASK) | value;
+    int64_t period = TIMESTAMP_MASK + 1;
+    if (full > nowUs + period / 2) {
+        full -= period;
+    } else if (full < nowUs - period / 2) {
+        full += period;
+    }
+    if (timestampUs) {
+        *timestampUs = full;
+    }
+    return true;
+}
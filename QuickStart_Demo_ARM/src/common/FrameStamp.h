@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * 视频帧时间戳图案 (端到端延迟测量)
+ * 采集端把 steady 时钟时间戳编码成画面顶部的黑白方块，接收/显示端从像素中解码，
+ * 不依赖 SDK 是否透传帧时间戳，经过缩放和有损编码后仍可识别
+ *
+ * - 图案为 2 行 x 32 列方块，方块边长为画面宽度的 1/32，共 64 位:
+ *   8 位同步字 + 48 位时间戳 (us，约 8.9 年回绕) + 8 位 CRC
+ * - 图案区域的色度置为中性灰，解码只读亮度 (或 RGB 中的一个通道)
+ */
+class FrameStamp {
+public:
+    static const int COLUMNS = 32;
+    static const int ROWS = 2;
+
+    // 把时间戳写入 I420 帧顶部 (原地修改)
+    static void encode(uint8_t* y, int yStride, uint8_t* u, uint8_t* v, int uvStride,
+                       int width, int height, int64_t timestampUs);
+
+    // 从亮度平面 (pixelStep = 1) 或 RGB888/RGBA 的某一通道 (pixelStep = 3/4) 解码；
+    // 48 位时间戳按 nowUs 补全高位，没有有效图案时返回 false
+    static bool decode(const uint8_t* plane, int stride, int pixelStep, int width, int height,
+                       int64_t nowUs, int64_t* timestampUs);
+
+    // 图案占用的高度 (像素)，画面过小时返回 0
+    static int bandHeight(int width, int height);
+};
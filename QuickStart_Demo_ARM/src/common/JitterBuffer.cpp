@@ -0,0 +1,287 @@
+#include "JitterBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+
+static const int BOOST_STEP_MS = 20;        // 每次欠载增加的目标深度
+static const int CONCEAL_FADE_MS = 30;      // 补偿淡出时长
+static const int HISTORY_MS = 20;
+static const int QUIET_LEVEL = 64;          // 平均幅度低于此值视为安静 (约 -54 dBFS)
+
+JitterBuffer::JitterBuffer(int sampleRate, int channels)
+{
+    configure(sampleRate, channels, 40, 200, 1000, sampleRate / 50);
+}
+
+void JitterBuffer::configure(int sampleRate, int channels, int minDelayMs, int maxDelayMs,
+                             int capacityMs, int maxBlockFrames)
+{
+    m_sampleRate = sampleRate > 0 ? sampleRate : 48000;
+    m_channels = channels > 0 ? channels : 1;
+    m_minLag = m_sampleRate / 400;
+    m_maxLag = m_sampleRate / 100;
+    m_minFrames = std::max(0, minDelayMs) * m_sampleRate / 1000;
+    m_maxFrames = std::max(m_minFrames, maxDelayMs * m_sampleRate / 1000);
+    m_capacityFrames = std::max(m_maxFrames * 2, capacityMs * m_sampleRate / 1000);
+    m_maxBlockFrames = std::max(1, maxBlockFrames);
+
+    m_ring.allocate(static_cast<size_t>(m_capacityFrames) * m_channels);
+    m_history.assign(static_cast<size_t>(m_sampleRate * HISTORY_MS / 1000) * m_channels, 0);
+    m_scratch.assign(static_cast<size_t>(m_maxBlockFrames + m_maxLag) * m_channels, 0);
+    reset();
+}
+
+void JitterBuffer::reset()
+{
+    m_ring.reset();
+    m_lastArrivalUs = 0;
+    m_jitterUs = 0.0;
+    m_jitterFrames.store(0, std::memory_order_relaxed);
+    m_packetFrames.store(0, std::memory_order_relaxed);
+
+    m_targetFrames = m_minFrames;
+    m_boostFrames = 0;
+    m_framesSinceUnderrun = 0;
+    m_playing = false;
+    m_fadeIn = false;
+    m_concealLag = m_minLag;
+    m_concealPos = -1;
+    std::fill(m_history.begin(), m_history.end(), 0);
+
+    m_depthFrames.store(0, std::memory_order_relaxed);
+    m_targetShared.store(m_targetFrames, std::memory_order_relaxed);
+    m_underruns.store(0, std::memory_order_relaxed);
+    m_droppedFrames.store(0, std::memory_order_relaxed);
+    m_concealedFrames.store(0, std::memory_order_relaxed);
+    m_acceleratedFrames.store(0, std::memory_order_relaxed);
+}
+
+void JitterBuffer::push(const int16_t* samples, int frames)
+{
+    if (!samples || frames <= 0) {
+        return;
+    }
+
+    // 到达间隔相对包长的偏差做平滑，作为抖动估计
+    int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (m_lastArrivalUs > 0) {
+        double expectedUs = frames * 1e6 / m_sampleRate;
+        double deviation = std::fabs((nowUs - m_lastArrivalUs) - expectedUs);
+        m_jitterUs += (deviation - m_jitterUs) / 16.0;
+        m_jitterFrames.store(static_cast<int>(m_jitterUs * m_sampleRate / 1e6), std::memory_order_relaxed);
+    }
+    m_lastArrivalUs = nowUs;
+    m_packetFrames.store(frames, std::memory_order_relaxed);
+
+    size_t count = static_cast<size_t>(frames) * m_channels;
+    size_t buffered = m_ring.capacity() - m_ring.space();
+    if (buffered + count > static_cast<size_t>(m_capacityFrames) * m_channels) {
+        m_droppedFrames.fetch_add(frames, std::memory_order_relaxed);
+        return;
+    }
+    m_ring.write(samples, count);
+}
+
+int JitterBuffer::depthFrames() const
+{
+    return static_cast<int>(m_ring.available() / m_channels);
+}
+
+void JitterBuffer::updateTarget()
+{
+    int target = m_packetFrames.load(std::memory_order_relaxed) +
+                 3 * m_jitterFrames.load(std::memory_order_relaxed) + m_boostFrames;
+    m_targetFrames = std::max(m_minFrames, std::min(m_maxFrames, target));
+    m_targetShared.store(m_targetFrames, std::memory_order_relaxed);
+}
+
+int JitterBuffer::pop(int16_t* out, int frames)
+{
+    frames = std::min(frames, m_maxBlockFrames);
+
+    // 持续无欠载时补偿缓慢回落
+    if (m_playing) {
+        m_framesSinceUnderrun += frames;
+        while (m_framesSinceUnderrun >= m_sampleRate) {
+            m_framesSinceUnderrun -= m_sampleRate;
+            m_boostFrames = std::max(0, m_boostFrames - m_sampleRate / 1000);
+        }
+    }
+    updateTarget();
+
+    int depth = depthFrames();
+    if (!m_playing) {
+        if (depth < std::max(m_targetFrames, frames)) {
+            conceal(out, frames);
+            m_depthFrames.store(depth, std::memory_order_relaxed);
+            return 0;
+        }
+        m_playing = true;
+        m_fadeIn = true;
+    } else if (depth < frames) {
+        // 欠载: 回到缓冲状态，提高目标深度
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+        m_boostFrames = std::min(m_maxFrames, m_boostFrames + m_sampleRate * BOOST_STEP_MS / 1000);
+        m_framesSinceUnderrun = 0;
+        m_playing = false;
+        conceal(out, frames);
+        m_depthFrames.store(depth, std::memory_order_relaxed);
+        return 0;
+    }
+
+    int excessThreshold = std::max(m_targetFrames / 2, m_sampleRate / 50);
+    if (depth - frames <= m_targetFrames + excessThreshold || !accelerate(out, frames)) {
+        m_ring.read(out, static_cast<size_t>(frames) * m_channels);
+    }
+
+    if (m_fadeIn) {
+        int fadeFrames = std::min(frames, m_sampleRate / 400);
+        for (int i = 0; i < fadeFrames; i++) {
+            float gain = static_cast<float>(i) / fadeFrames;
+            for (int c = 0; c < m_channels; c++) {
+                out[i * m_channels + c] = static_cast<int16_t>(out[i * m_channels + c] * gain);
+            }
+        }
+        m_fadeIn = false;
+    }
+
+    remember(out, frames);
+    m_concealPos = 0;
+    m_depthFrames.store(depthFrames(), std::memory_order_relaxed);
+    return frames;
+}
+
+int JitterBuffer::flush()
+{
+    // 只移动读位置，与生产者并发安全；目标深度和抖动估计保留
+    int frames = depthFrames();
+    m_ring.discard(static_cast<size_t>(frames) * m_channels);
+    m_playing = false;
+    m_fadeIn = false;
+    m_concealPos = -1;
+    m_depthFrames.store(depthFrames(), std::memory_order_relaxed);
+    return frames;
+}
+
+void JitterBuffer::conceal(int16_t* out, int frames)
+{
+    int fadeFrames = m_sampleRate * CONCEAL_FADE_MS / 1000;
+    int historyFrames = static_cast<int>(m_history.size()) / m_channels;
+    std::fill(out, out + static_cast<size_t>(frames) * m_channels, 0);
+
+    if (m_concealPos < 0 || m_concealPos >= fadeFrames) {
+        return;
+    }
+
+    // 从最近的输出中找基音周期，按周期重复并线性淡出
+    if (m_concealPos == 0) {
+        int window = m_sampleRate / 200;
+        const int16_t* tail = m_history.data() + static_cast<size_t>(historyFrames - window) * m_channels;
+        m_concealLag = findPitchLag(tail, -1, window);
+    }
+
+    int count = std::min(frames, fadeFrames - m_concealPos);
+    for (int i = 0; i < count; i++) {
+        int k = m_concealPos + i;
+        int src = historyFrames - m_concealLag + (k % m_concealLag);
+        float gain = 1.0f - static_cast<float>(k) / fadeFrames;
+        for (int c = 0; c < m_channels; c++) {
+            out[i * m_channels + c] = static_cast<int16_t>(m_history[src * m_channels + c] * gain);
+        }
+    }
+    m_concealPos += count;
+    m_concealedFrames.fetch_add(count, std::memory_order_relaxed);
+}
+
+bool JitterBuffer::accelerate(int16_t* out, int frames)
+{
+    int need = frames + m_maxLag;
+    if (depthFrames() < need) {
+        return false;
+    }
+    m_ring.peek(m_scratch.data(), static_cast<size_t>(need) * m_channels);
+
+    // 安静的块丢弃最长的一段；有声的块按基音周期对齐后丢弃，避免相位相消
+    int64_t level = 0;
+    for (int i = 0; i < frames * m_channels; i++) {
+        level += std::abs(m_scratch[i]);
+    }
+    bool quiet = level < static_cast<int64_t>(QUIET_LEVEL) * frames * m_channels;
+    int window = std::min(frames, m_sampleRate / 100);
+    int lag = quiet ? m_maxLag : findPitchLag(m_scratch.data(), 1, window);
+
+    // 交叉淡化: 开头接上一块的结尾，结尾接下一块的开头 (跳过 lag 帧)
+    for (int i = 0; i < frames; i++) {
+        float w = static_cast<float>(i + 1) / frames;
+        for (int c = 0; c < m_channels; c++) {
+            float a = m_scratch[i * m_channels + c];
+            float b = m_scratch[(i + lag) * m_channels + c];
+            out[i * m_channels + c] = static_cast<int16_t>(a * (1.0f - w) + b * w);
+        }
+    }
+    m_ring.discard(static_cast<size_t>(frames + lag) * m_channels);
+    m_acceleratedFrames.fetch_add(lag, std::memory_order_relaxed);
+    return true;
+}
+
+int JitterBuffer::findPitchLag(const int16_t* ref, int direction, int window) const
+{
+    // 参考段与相距 lag 的候选段做归一化互相关 (各声道求和，隔点采样)
+    int bestLag = m_minLag;
+    double bestScore = -2.0;
+    for (int lag = m_minLag; lag <= m_maxLag; lag++) {
+        const int16_t* cand = ref + static_cast<ptrdiff_t>(direction) * lag * m_channels;
+        double cross = 0.0;
+        double energy = 0.0;
+        for (int i = 0; i < window; i += 2) {
+            int a = 0;
+            int b = 0;
+            for (int c = 0; c < m_channels; c++) {
+                a += ref[i * m_channels + c];
+                b += cand[i * m_channels + c];
+            }
+            cross += static_cast<double>(a) * b;
+            energy += static_cast<double>(b) * b;
+        }
+        double score = energy > 0.0 ? cross / std::sqrt(energy) : 0.0;
+        if (score > bestScore) {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+    return bestLag;
+}
+
+void JitterBuffer::remember(const int16_t* out, int frames)
+{
+    int historyFrames = static_cast<int>(m_history.size()) / m_channels;
+    if (frames >= historyFrames) {
+        std::copy(out + static_cast<size_t>(frames - historyFrames) * m_channels,
+                  out + static_cast<size_t>(frames) * m_channels, m_history.begin());
+        return;
+    }
+    std::copy(m_history.begin() + static_cast<size_t>(frames) * m_channels, m_history.end(), m_history.begin());
+    std::copy(out, out + static_cast<size_t>(frames) * m_channels,
+              m_history.end() - static_cast<size_t>(frames) * m_channels);
+}
+
+int JitterBuffer::framesToMs(int64_t frames) const
+{
+    return static_cast<int>(frames * 1000 / m_sampleRate);
+}
+
+JitterBuffer::Stats JitterBuffer::stats() const
+{
+    Stats s;
+    s.depthMs = framesToMs(m_depthFrames.load(std::memory_order_relaxed));
+    s.targetMs = framesToMs(m_targetShared.load(std::memory_order_relaxed));
+    s.jitterMs = framesToMs(m_jitterFrames.load(std::memory_order_relaxed));
+    s.underruns = m_underruns.load(std::memory_order_relaxed);
+    s.droppedMs = static_cast<uint32_t>(framesToMs(m_droppedFrames.load(std::memory_order_relaxed)));
+    s.concealedMs = static_cast<uint32_t>(framesToMs(m_concealedFrames.load(std::memory_order_relaxed)));
+    s.acceleratedMs = static_cast<uint32_t>(framesToMs(m_acceleratedFrames.load(std::memory_order_relaxed)));
+    return s;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "AudioRingBuffer.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 自适应抖动缓冲 (交错 int16)
+ * SDK 回调线程 push，播放线程 pop，两端通过无锁 SPSC 环形缓冲交接，读写过程不分配内存
+ *
+ * - 目标深度: 包长 + 3 倍到达抖动 (RFC 3550 平滑) + 欠载补偿，限制在 [minDelay, maxDelay]；
+ *   欠载后补偿增加 20ms，之后每秒无欠载回落 1ms
+ * - 欠载: 进入缓冲状态，按基音周期重复最近的输出并在 30ms 内淡出 (丢包补偿)，
+ *   深度回到目标后淡入恢复
+ * - 追赶: 深度超过目标过多时，安静的块直接跳过，有声的块用相关搜索找到一个基音周期，
+ *   交叉淡化后丢弃 (时间压缩，不改变音调)
+ * - 溢出: 超过容量的整包丢弃 (生产者不能移动读位置)
+ */
+class JitterBuffer {
+public:
+    struct Stats {
+        int depthMs = 0;
+        int targetMs = 0;
+        int jitterMs = 0;
+        uint32_t underruns = 0;
+        uint32_t droppedMs = 0;       // 溢出丢弃
+        uint32_t concealedMs = 0;     // 补偿输出 (不含空闲静音)
+        uint32_t acceleratedMs = 0;   // 追赶时压缩掉的时长
+    };
+
+    JitterBuffer(int sampleRate = 48000, int channels = 2);
+
+    // 设置格式、延迟范围并分配存储 (非线程安全，需在 push/pop 开始前调用)
+    void configure(int sampleRate, int channels, int minDelayMs, int maxDelayMs,
+                   int capacityMs, int maxBlockFrames);
+    // 清空状态和统计 (非线程安全)
+    void reset();
+
+    // 生产者: 写入一包音频，空间不足时整包丢弃
+    void push(const int16_t* samples, int frames);
+
+    // 消费者: 总是输出 frames 帧 (frames <= maxBlockFrames)，返回其中真实音频的帧数
+    int pop(int16_t* out, int frames);
+    // 消费者: 丢弃所有缓冲数据并回到缓冲状态 (不做补偿)，返回丢弃的帧数
+    int flush();
+    // 消费者: 缓冲帧数 / 目标帧数
+    int depthFrames() const;
+    int targetFrames() const { return m_targetFrames; }
+    bool isPlaying() const { return m_playing; }
+
+    // 任意线程
+    Stats stats() const;
+
+private:
+    void updateTarget();
+    void conceal(int16_t* out, int frames);
+    bool accelerate(int16_t* out, int frames);
+    int findPitchLag(const int16_t* x, int length, int window) const;
+    void remember(const int16_t* out, int frames);
+    int framesToMs(int64_t frames) const;
+
+    int m_sampleRate;
+    int m_channels;
+    int m_minFrames = 0;
+    int m_maxFrames = 0;
+    int m_capacityFrames = 0;
+    int m_maxBlockFrames = 0;
+    int m_minLag;               // 基音搜索范围 2.5ms - 10ms
+    int m_maxLag;
+
+    AudioRingBuffer m_ring;
+
+    // 生产者状态
+    int64_t m_lastArrivalUs = 0;
+    double m_jitterUs = 0.0;
+    std::atomic<int> m_jitterFrames{0};
+    std::atomic<int> m_packetFrames{0};
+
+    // 消费者状态
+    int m_targetFrames = 0;
+    int m_boostFrames = 0;
+    int m_framesSinceUnderrun = 0;
+    bool m_playing = false;
+    bool m_fadeIn = false;
+    int m_concealLag = 0;
+    int m_concealPos = 0;       // 本次补偿已输出的帧数，-1 表示历史不可用
+    std::vector<int16_t> m_history;    // 最近输出，供补偿使用
+    std::vector<int16_t> m_scratch;    // 追赶时 peek 的输入
+
+    std::atomic<int> m_depthFrames{0};
+    std::atomic<int> m_targetShared{0};
+    std::atomic<uint32_t> m_underruns{0};
+    std::atomic<uint32_t> m_droppedFrames{0};
+    std::atomic<uint32_t> m_concealedFrames{0};
+    std::atomic<uint32_t> m_acceleratedFrames{0};
+};
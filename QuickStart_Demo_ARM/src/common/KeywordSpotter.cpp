@@ -0,0 +1,314 @@
+#include "KeywordSpotter.h"
+#include "Logger.h"
+#include "TraceRecorder.h"
+#include <QFile>
+#include <QByteArray>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define KWS_USE_NEON 1
+#elif defined(__SSE2__) || defined(__x86_64__)
+#include <emmintrin.h>
+#define KWS_USE_SSE2 1
+#endif
+
+#define LOG_MODULE "KWS"
+
+namespace {
+
+// 模型文件顺序读取，越界后 ok 置为 false
+class ModelReader {
+public:
+    explicit ModelReader(const QByteArray& data) : m_data(data) {}
+
+    bool ok() const { return m_ok; }
+    // 尚未读取的字节数，分配缓冲前据此检查文件长度
+    size_t remaining() const { return m_ok ? static_cast<size_t>(m_data.size() - m_pos) : 0; }
+
+    quint32 u32()
+    {
+        const char* p = take(4);
+        return p ? qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(p)) : 0;
+    }
+
+    float f32()
+    {
+        quint32 bits = u32();
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    bool bytes(void* dst, int size)
+    {
+        const char* p = take(size);
+        if (p) {
+            memcpy(dst, p, size);
+        }
+        return p != nullptr;
+    }
+
+private:
+    const char* take(int size)
+    {
+        if (!m_ok || size < 0 || m_pos + size > m_data.size()) {
+            m_ok = false;
+            return nullptr;
+        }
+        const char* p = m_data.constData() + m_pos;
+        m_pos += size;
+        return p;
+    }
+
+    const QByteArray& m_data;
+    int m_pos = 0;
+    bool m_ok = true;
+};
+
+const int MAX_DIM = 4096;
+const int MAX_CONTEXT_FRAMES = 500;     // 5 秒
+
+} // namespace
+
+KeywordSpotter::KeywordSpotter()
+{
+    std::fill(m_posteriors, m_posteriors + SMOOTH_WINDOW, 0.0f);
+}
+
+KeywordSpotter::~KeywordSpotter()
+{
+    delete m_mfcc;
+}
+
+bool KeywordSpotter::loadModel(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        LOG_WARN("Cannot open wake word model: " + path);
+        return false;
+    }
+    QByteArray data = file.readAll();
+    file.close();
+
+    if (data.size() < 4 || memcmp(data.constData(), "KWS1", 4) != 0) {
+        LOG_WARN("Invalid wake word model: " + path);
+        return false;
+    }
+
+    ModelReader reader(data);
+    char magic[4];
+    reader.bytes(magic, 4);
+    int contextFrames = static_cast<int>(reader.u32());
+    int numCoeffs = static_cast<int>(reader.u32());
+    int numLayers = static_cast<int>(reader.u32());
+    int keywordIndex = static_cast<int>(reader.u32());
+    float inputScale = reader.f32();
+
+    if (!reader.ok() || contextFrames <= 0 || contextFrames > MAX_CONTEXT_FRAMES ||
+        numCoeffs <= 0 || numCoeffs > Mfcc::NUM_FILTERS ||
+        numLayers <= 0 || numLayers > 8 || inputScale <= 0.0f) {
+        LOG_WARN("Malformed wake word model header");
+        return false;
+    }
+
+    std::vector<Layer> layers(numLayers);
+    int expectedIn = contextFrames * numCoeffs;
+    for (Layer& layer : layers) {
+        layer.inDim = static_cast<int>(reader.u32());
+        layer.outDim = static_cast<int>(reader.u32());
+        layer.weightScale = reader.f32();
+        layer.outputScale = reader.f32();
+        if (!reader.ok() || layer.inDim != expectedIn || layer.outDim <= 0 ||
+            layer.outDim > MAX_DIM || layer.weightScale <= 0.0f) {
+            LOG_WARN("Malformed wake word model layer");
+            return false;
+        }
+        // 截断或损坏的文件在分配前拒绝: int8 权重 + int32 偏置
+        size_t weightCount = static_cast<size_t>(layer.inDim) * static_cast<size_t>(layer.outDim);
+        if (weightCount + static_cast<size_t>(layer.outDim) * sizeof(int32_t) > reader.remaining()) {
+            LOG_WARN("Truncated wake word model");
+            return false;
+        }
+        layer.weights.resize(weightCount);
+        layer.bias.resize(layer.outDim);
+        reader.bytes(layer.weights.data(), static_cast<int>(layer.weights.size()));
+        for (int o = 0; o < layer.outDim; o++) {
+            layer.bias[o] = static_cast<int32_t>(reader.u32());
+        }
+        expectedIn = layer.outDim;
+    }
+
+    if (!reader.ok() || keywordIndex < 0 || keywordIndex >= layers.back().outDim) {
+        LOG_WARN("Malformed wake word model weights");
+        return false;
+    }
+
+    delete m_mfcc;
+    m_mfcc = new Mfcc(numCoeffs);
+    m_contextFrames = contextFrames;
+    m_numCoeffs = numCoeffs;
+    m_keywordIndex = keywordIndex;
+    m_inputScale = inputScale;
+    m_layers.swap(layers);
+
+    // 推理缓冲一次性分配，采集线程上不再分配内存
+    int maxDim = contextFrames * numCoeffs;
+    for (const Layer& layer : m_layers) {
+        maxDim = std::max(maxDim, layer.outDim);
+    }
+    m_features.assign(contextFrames * numCoeffs, 0);
+    m_input.assign(contextFrames * numCoeffs, 0);
+    m_hidden[0].assign(maxDim, 0);
+    m_hidden[1].assign(maxDim, 0);
+    m_logits.assign(m_layers.back().outDim, 0.0f);
+    m_coeffs.assign(numCoeffs, 0.0f);
+    reset();
+
+    LOG_INFO(QString("Wake word model loaded: %1 (%2 frames x %3 coeffs, %4 layers)")
+             .arg(path).arg(contextFrames).arg(numCoeffs).arg(numLayers));
+    return true;
+}
+
+void KeywordSpotter::reset()
+{
+    if (m_mfcc) {
+        m_mfcc->reset();
+    }
+    std::fill(m_features.begin(), m_features.end(), 0);
+    std::fill(m_posteriors, m_posteriors + SMOOTH_WINDOW, 0.0f);
+    m_featureHead = 0;
+    m_featureCount = 0;
+    m_posteriorIndex = 0;
+    m_frameCounter = 0;
+    m_refractory = 0;
+    m_lastScore = 0.0f;
+}
+
+bool KeywordSpotter::process(const int16_t* samples, int count)
+{
+    TRACE_SCOPE("audio.kws.process");
+    if (!isLoaded() || count < Mfcc::FRAME_SHIFT) {
+        return false;
+    }
+
+    if (!m_mfcc->process(samples, m_coeffs.data())) {
+        return false;
+    }
+
+    // 量化并写入特征环
+    int8_t* slot = &m_features[m_featureHead * m_numCoeffs];
+    for (int i = 0; i < m_numCoeffs; i++) {
+        float q = std::round(m_coeffs[i] / m_inputScale);
+        slot[i] = static_cast<int8_t>(std::max(-128.0f, std::min(127.0f, q)));
+    }
+    m_featureHead = (m_featureHead + 1) % m_contextFrames;
+    m_featureCount = std::min(m_contextFrames, m_featureCount + 1);
+
+    if (m_refractory > 0) {
+        m_refractory--;
+    }
+    if (m_featureCount < m_contextFrames || ++m_frameCounter < EVAL_INTERVAL_FRAMES) {
+        return false;
+    }
+    m_frameCounter = 0;
+
+    m_posteriors[m_posteriorIndex] = evaluate();
+    m_posteriorIndex = (m_posteriorIndex + 1) % SMOOTH_WINDOW;
+
+    float sum = 0.0f;
+    for (int i = 0; i < SMOOTH_WINDOW; i++) {
+        sum += m_posteriors[i];
+    }
+    m_lastScore = sum / SMOOTH_WINDOW;
+
+    if (m_refractory == 0 && m_lastScore >= m_threshold) {
+        m_refractory = REFRACTORY_FRAMES;
+        std::fill(m_posteriors, m_posteriors + SMOOTH_WINDOW, 0.0f);
+        return true;
+    }
+    return false;
+}
+
+float KeywordSpotter::evaluate()
+{
+    // 按时间顺序展开特征环 (最旧的帧在前)
+    int tail = m_featureHead * m_numCoeffs;
+    int total = m_contextFrames * m_numCoeffs;
+    memcpy(m_input.data(), m_features.data() + tail, total - tail);
+    memcpy(m_input.data() + (total - tail), m_features.data(), tail);
+
+    const int8_t* x = m_input.data();
+    float inScale = m_inputScale;
+    int current = 0;
+
+    for (size_t l = 0; l < m_layers.size(); l++) {
+        const Layer& layer = m_layers[l];
+        bool last = (l + 1 == m_layers.size());
+        float scale = inScale * layer.weightScale;
+        int8_t* y = m_hidden[current].data();
+
+        for (int o = 0; o < layer.outDim; o++) {
+            int32_t acc = layer.bias[o] +
+                          dotInt8(&layer.weights[static_cast<size_t>(o) * layer.inDim], x, layer.inDim);
+            float value = acc * scale;
+            if (last) {
+                m_logits[o] = value;
+            } else {
+                float q = std::round(std::max(0.0f, value) / layer.outputScale);
+                y[o] = static_cast<int8_t>(std::min(127.0f, q));
+            }
+        }
+
+        x = y;
+        inScale = layer.outputScale;
+        current ^= 1;
+    }
+
+    // softmax，只需关键词类别的概率
+    float maxLogit = *std::max_element(m_logits.begin(), m_logits.end());
+    float denom = 0.0f;
+    for (float logit : m_logits) {
+        denom += std::exp(logit - maxLogit);
+    }
+    return std::exp(m_logits[m_keywordIndex] - maxLogit) / denom;
+}
+
+int32_t KeywordSpotter::dotInt8(const int8_t* a, const int8_t* b, int n)
+{
+    int i = 0;
+    int32_t sum = 0;
+#if defined(KWS_USE_NEON)
+    int32x4_t acc = vdupq_n_s32(0);
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t prod = vmull_s8(vld1_s8(a + i), vld1_s8(b + i));
+        acc = vpadalq_s16(acc, prod);
+    }
+    int32x2_t pair = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    sum = vget_lane_s32(vpadd_s32(pair, pair), 0);
+#elif defined(KWS_USE_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        // 符号扩展到 int16 后用 madd 累加相邻乘积
+        __m128i signA = _mm_cmpgt_epi8(zero, va);
+        __m128i signB = _mm_cmpgt_epi8(zero, vb);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(va, signA),
+                                                _mm_unpacklo_epi8(vb, signB)));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpackhi_epi8(va, signA),
+                                                _mm_unpackhi_epi8(vb, signB)));
+    }
+    int32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; i++) {
+        sum += static_cast<int32_t>(a[i]) * b[i];
+    }
+    return sum;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Mfcc.h"
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 唤醒词检测 (Keyword Spotting)
+ * MFCC 特征 + 小型 int8 量化全连接网络，在采集线程上逐 10ms 帧运行
+ *
+ * 模型文件格式 (小端):
+ *   "KWS1"
+ *   uint32 contextFrames      输入上下文帧数 (如 49 帧 ≈ 0.5s)，不超过 500
+ *   uint32 numCoeffs          每帧 MFCC 系数个数，不超过 Mfcc::NUM_FILTERS
+ *   uint32 numLayers          不超过 8
+ *   uint32 keywordIndex       关键词对应的输出类别 (其余为背景/其他词)
+ *   float  inputScale         MFCC 量化步长: q = round(x / inputScale)
+ *   每层:
+ *     uint32 inDim, outDim    inDim 等于上一层 outDim (第一层为 contextFrames * numCoeffs)，outDim 不超过 4096
+ *     float  weightScale
+ *     float  outputScale      隐藏层输出 (ReLU 后) 的量化步长，最后一层忽略
+ *     int8   weights[outDim * inDim]   行优先
+ *     int32  bias[outDim]              单位为 输入步长 * weightScale
+ *
+ * 隐藏层使用 ReLU，最后一层输出经 softmax 得到后验概率，
+ * 后验在约 200ms 内平滑后超过阈值即判定命中，命中后进入 1s 冷却期
+ */
+class KeywordSpotter {
+public:
+    KeywordSpotter();
+    ~KeywordSpotter();
+
+    KeywordSpotter(const KeywordSpotter&) = delete;
+    KeywordSpotter& operator=(const KeywordSpotter&) = delete;
+
+    bool loadModel(const QString& path);
+    bool isLoaded() const { return !m_layers.empty(); }
+
+    void setThreshold(float threshold) { m_threshold = threshold; }
+    float threshold() const { return m_threshold; }
+
+    void reset();
+
+    // 输入 10ms 16kHz 单声道 PCM (160 个采样)，命中时返回 true
+    bool process(const int16_t* samples, int count);
+    float lastScore() const { return m_lastScore; }
+
+private:
+    struct Layer {
+        int inDim = 0;
+        int outDim = 0;
+        float weightScale = 1.0f;
+        float outputScale = 1.0f;
+        std::vector<int8_t> weights;
+        std::vector<int32_t> bias;
+    };
+
+    float evaluate();
+    static int32_t dotInt8(const int8_t* a, const int8_t* b, int n);
+
+    static const int EVAL_INTERVAL_FRAMES = 2;     // 每 20ms 推理一次
+    static const int SMOOTH_WINDOW = 10;           // 平滑 10 次推理 ≈ 200ms
+    static const int REFRACTORY_FRAMES = 100;      // 命中后 1s 内不再触发
+
+    Mfcc* m_mfcc = nullptr;
+    int m_contextFrames = 0;
+    int m_numCoeffs = 0;
+    int m_keywordIndex = 1;
+    float m_inputScale = 1.0f;
+    std::vector<Layer> m_layers;
+
+    // 特征环形缓冲 (contextFrames x numCoeffs, int8)，推理时按时间顺序展开
+    std::vector<int8_t> m_features;
+    std::vector<int8_t> m_input;
+    std::vector<int8_t> m_hidden[2];
+    std::vector<float> m_logits;
+    std::vector<float> m_coeffs;
+    int m_featureHead = 0;
+    int m_featureCount = 0;
+
+    float m_posteriors[SMOOTH_WINDOW];
+    int m_posteriorIndex = 0;
+    int m_frameCounter = 0;
+    int m_refractory = 0;
+    float m_threshold = 0.8f;
+    float m_lastScore = 0.0f;
+};
@@ -0,0 +1,90 @@
+#include "LatencyHistogram.h"
+#include <QJsonArray>
+#include <algorithm>
+
+static const int BUCKET_BOUNDS_MS[LatencyHistogram::BUCKET_COUNT - 1] = {
+    10, 20, 50, 100, 200, 300, 500, 750, 1000, 1500, 2000, 3000, 5000, 7500, 10000
+};
+
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    std::fill(m_buckets, m_buckets + BUCKET_COUNT, 0);
+    m_count = 0;
+    m_sumMs = 0.0;
+    m_minMs = 0.0;
+    m_maxMs = 0.0;
+}
+
+int LatencyHistogram::bucketBoundMs(int index)
+{
+    return index >= 0 && index < BUCKET_COUNT - 1 ? BUCKET_BOUNDS_MS[index] : -1;
+}
+
+void LatencyHistogram::add(double ms)
+{
+    ms = std::max(0.0, ms);
+    int index = 0;
+    while (index < BUCKET_COUNT - 1 && ms > BUCKET_BOUNDS_MS[index]) {
+        index++;
+    }
+    m_buckets[index]++;
+    m_minMs = m_count == 0 ? ms : std::min(m_minMs, ms);
+    m_maxMs = m_count == 0 ? ms : std::max(m_maxMs, ms);
+    m_count++;
+    m_sumMs += ms;
+}
+
+double LatencyHistogram::meanMs() const
+{
+    return m_count > 0 ? m_sumMs / m_count : 0.0;
+}
+
+double LatencyHistogram::percentileMs(double p) const
+{
+    if (m_count == 0) {
+        return 0.0;
+    }
+    double rank = std::min(1.0, std::max(0.0, p)) * m_count;
+    int seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        if (m_buckets[i] == 0 || seen + m_buckets[i] < rank) {
+            seen += m_buckets[i];
+            continue;
+        }
+        // 桶内按均匀分布插值，首尾桶用实际极值收窄范围
+        double lower = i > 0 ? BUCKET_BOUNDS_MS[i - 1] : 0.0;
+        double upper = i < BUCKET_COUNT - 1 ? BUCKET_BOUNDS_MS[i] : m_maxMs;
+        lower = std::max(lower, m_minMs);
+        upper = std::min(upper, m_maxMs);
+        double fraction = (rank - seen) / m_buckets[i];
+        return lower + (upper - lower) * fraction;
+    }
+    return m_maxMs;
+}
+
+QJsonObject LatencyHistogram::toJson() const
+{
+    QJsonObject item;
+    item["count"] = m_count;
+    item["meanMs"] = meanMs();
+    item["p50Ms"] = percentileMs(0.5);
+    item["p90Ms"] = percentileMs(0.9);
+    item["p99Ms"] = percentileMs(0.99);
+    item["minMs"] = m_minMs;
+    item["maxMs"] = m_maxMs;
+    QJsonArray buckets;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        QJsonObject bucket;
+        int bound = bucketBoundMs(i);
+        bucket["leMs"] = bound >= 0 ? QJsonValue(bound) : QJsonValue("+Inf");
+        bucket["count"] = m_buckets[i];
+        buckets.append(bucket);
+    }
+    item["buckets"] = buckets;
+    return item;
+}
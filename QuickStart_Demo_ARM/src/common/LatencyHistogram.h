@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QJsonObject>
+
+/**
+ * 延迟直方图 (ms)
+ * 固定分桶 (10ms - 10s，约按 1-2-3-5 递增)，另记总数、总和与极值；
+ * 分位数按桶内线性插值估计，可直接导出为累计桶 (OpenMetrics histogram)
+ *
+ * 非线程安全，由调用方加锁
+ */
+class LatencyHistogram {
+public:
+    static const int BUCKET_COUNT = 16;     // 最后一个桶为 +Inf
+
+    LatencyHistogram();
+
+    void add(double ms);
+    void reset();
+
+    int count() const { return m_count; }
+    double sumMs() const { return m_sumMs; }
+    double minMs() const { return m_minMs; }
+    double maxMs() const { return m_maxMs; }
+    double meanMs() const;
+    // p: 0 - 1，没有样本时返回 0
+    double percentileMs(double p) const;
+
+    // 第 i 个桶的上界 (ms)，最后一个桶返回 -1 表示 +Inf
+    static int bucketBoundMs(int index);
+    // 落在第 i 个桶 (上一个上界, 上界] 内的样本数
+    int bucketCount(int index) const { return m_buckets[index]; }
+
+    // 总数、均值、p50/p90/p99、极值和各桶计数
+    QJsonObject toJson() const;
+
+private:
+    int m_buckets[BUCKET_COUNT];
+    int m_count = 0;
+    double m_sumMs = 0.0;
+    double m_minMs = 0.0;
+    double m_maxMs = 0.0;
+};
@@ -0,0 +1,135 @@
+#include "LatencyProbe.h"
+#include <algorithm>
+#include <cmath>
+
+static const double PI = 3.14159265358979323846;
+static const double CHIRP_START_HZ = 500.0;
+static const double CHIRP_END_HZ = 5000.0;
+static const double CHIRP_AMPLITUDE = 0.5;      // -6 dBFS
+
+LatencyProbe::LatencyProbe()
+{
+    configure(16000);
+}
+
+void LatencyProbe::configure(int sampleRate, int maxLatencyMs, float threshold)
+{
+    m_sampleRate = sampleRate > 0 ? sampleRate : 16000;
+    m_maxLatencyUs = static_cast<int64_t>(std::max(1, maxLatencyMs)) * 1000;
+    m_threshold = threshold;
+    m_length = m_sampleRate * CHIRP_MS / 1000;
+
+    // 线性扫频，结束频率不超过奈奎斯特频率的 80%；Hann 窗避免起止处的爆音
+    double endHz = std::min(CHIRP_END_HZ, m_sampleRate * 0.4);
+    double duration = static_cast<double>(m_length) / m_sampleRate;
+    double sweep = (endHz - CHIRP_START_HZ) / duration;
+    m_chirp.assign(m_length, 0);
+    m_template.assign(m_length, 0.0f);
+    double norm = 0.0;
+    for (int i = 0; i < m_length; i++) {
+        double t = static_cast<double>(i) / m_sampleRate;
+        double window = 0.5 - 0.5 * std::cos(2.0 * PI * i / (m_length - 1));
+        double value = window * std::sin(2.0 * PI * (CHIRP_START_HZ * t + 0.5 * sweep * t * t));
+        m_chirp[i] = static_cast<int16_t>(std::lround(value * CHIRP_AMPLITUDE * 32767.0));
+        m_template[i] = static_cast<float>(value);
+        norm += value * value;
+    }
+    float scale = static_cast<float>(1.0 / std::sqrt(norm));
+    for (float& v : m_template) {
+        v *= scale;
+    }
+
+    m_window.assign(static_cast<size_t>(m_length) * 2, 0.0f);
+    disarm();
+}
+
+void LatencyProbe::arm(int64_t sentUs)
+{
+    std::fill(m_window.begin(), m_window.end(), 0.0f);
+    m_pos = 0;
+    m_energy = 0.0;
+    m_sentUs = sentUs;
+    m_bestScore = 0.0f;
+    m_bestArrivalUs = 0;
+    m_sinceBest = 0;
+}
+
+void LatencyProbe::disarm()
+{
+    m_sentUs = -1;
+}
+
+int64_t LatencyProbe::process(const int16_t* samples, int count, int64_t timestampUs)
+{
+    if (!isArmed() || !samples || count <= 0) {
+        return NO_RESULT;
+    }
+
+    for (int i = 0; i < count; i++) {
+        // 新采样写入两处，最近 m_length 个采样 [m_pos, m_pos + m_length) 始终连续
+        float x = samples[i];
+        float old = m_window[m_pos];
+        m_window[m_pos] = x;
+        m_window[m_pos + m_length] = x;
+        m_pos = (m_pos + 1) % m_length;
+        m_energy += static_cast<double>(x) * x - static_cast<double>(old) * old;
+
+        const float* window = m_window.data() + m_pos;
+        float dot = 0.0f;
+        for (int k = 0; k < m_length; k++) {
+            dot += window[k] * m_template[k];
+        }
+        float score = m_energy > 1.0 ? static_cast<float>(dot / std::sqrt(m_energy)) : 0.0f;
+
+        if (score > m_threshold && score > m_bestScore) {
+            // 窗口末尾为当前采样，chirp 起点在 m_length - 1 个采样之前
+            m_bestScore = score;
+            m_bestArrivalUs = timestampUs +
+                static_cast<int64_t>(i - (m_length - 1)) * 1000000 / m_sampleRate;
+            m_sinceBest = 0;
+        } else if (m_bestScore > 0.0f && ++m_sinceBest >= m_length / 2) {
+            // 峰值之后半个 chirp 长度内没有更高的相关，确认到达
+            m_lastScore = m_bestScore;
+            int64_t latencyUs = m_bestArrivalUs - m_sentUs;
+            disarm();
+            return std::max<int64_t>(0, latencyUs);
+        }
+    }
+
+    // 计算误差随运算累积，每帧按窗口重新求一次能量
+    double energy = 0.0;
+    const float* window = m_window.data() + m_pos;
+    for (int k = 0; k < m_length; k++) {
+        energy += static_cast<double>(window[k]) * window[k];
+    }
+    m_energy = energy;
+
+    if (m_bestScore == 0.0f && timestampUs - m_sentUs > m_maxLatencyUs) {
+        disarm();
+        return TIMED_OUT;
+    }
+    return NO_RESULT;
+}
+
+void LatencyStats::add(double ms)
+{
+    minMs = count == 0 ? ms : std::min(minMs, ms);
+    maxMs = count == 0 ? ms : std::max(maxMs, ms);
+    count++;
+    sumMs += ms;
+    sumSquaresMs += ms * ms;
+}
+
+double LatencyStats::meanMs() const
+{
+    return count > 0 ? sumMs / count : 0.0;
+}
+
+double LatencyStats::stddevMs() const
+{
+    if (count < 2) {
+        return 0.0;
+    }
+    double mean = meanMs();
+    return std::sqrt(std::max(0.0, sumSquaresMs / count - mean * mean));
+}
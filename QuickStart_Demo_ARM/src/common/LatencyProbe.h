@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * 回环延迟探测 (扬声器 -> 空气 -> 麦克风)
+ * 生成一段加窗线性扫频 (chirp)，由调用方送入播放链路并记录送出时刻；
+ * 采集线程逐帧调用 process，用归一化互相关在麦克风信号中找到 chirp 的到达时刻
+ *
+ * - 只在 arm 之后做相关运算，平时不占 CPU
+ * - 时间戳为 steady 时钟 (微秒)，采集端给出每帧首个采样的采集时刻
+ *
+ * 非线程安全，arm/process 都在采集线程中调用
+ */
+class LatencyProbe {
+public:
+    static const int CHIRP_MS = 40;
+    static const int64_t NO_RESULT = -1;
+    static const int64_t TIMED_OUT = -2;
+
+    LatencyProbe();
+
+    // 采样率、最长等待时间、判定阈值 (归一化互相关，0 - 1)
+    void configure(int sampleRate, int maxLatencyMs = 1000, float threshold = 0.3f);
+    // 送入播放链路的 chirp (单声道)
+    const std::vector<int16_t>& chirp() const { return m_chirp; }
+
+    // chirp 首个采样送入播放链路的时刻，开始检测
+    void arm(int64_t sentUs);
+    bool isArmed() const { return m_sentUs >= 0; }
+    void disarm();
+
+    // 返回测得的延迟 (微秒)；尚无结果返回 NO_RESULT，超时返回 TIMED_OUT (均会解除检测)
+    int64_t process(const int16_t* samples, int count, int64_t timestampUs);
+
+    // 最近一次判定的相关系数
+    float lastScore() const { return m_lastScore; }
+
+private:
+    int m_sampleRate = 16000;
+    int m_length = 0;               // chirp 采样数
+    int64_t m_maxLatencyUs = 1000000;
+    float m_threshold = 0.3f;
+
+    std::vector<int16_t> m_chirp;
+    std::vector<float> m_template;  // 归一化到单位能量
+    std::vector<float> m_window;    // 双倍长度的环形窗口，保证相关窗口连续
+    int m_pos = 0;
+    double m_energy = 0.0;
+
+    int64_t m_sentUs = -1;
+    float m_bestScore = 0.0f;
+    int64_t m_bestArrivalUs = 0;
+    int m_sinceBest = 0;
+    float m_lastScore = 0.0f;
+};
+
+/**
+ * 延迟测量统计 (均值、标准差、极值、丢失次数)
+ */
+struct LatencyStats {
+    int count = 0;
+    int missed = 0;
+    double sumMs = 0.0;
+    double sumSquaresMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+
+    void add(double ms);
+    void addMiss() { missed++; }
+    double meanMs() const;
+    double stddevMs() const;
+};
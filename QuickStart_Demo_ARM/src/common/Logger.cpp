@@ -2,6 +2,8 @@
 #include <QDebug>
 #include <QDir>
 #include <QTextStream>
+#include <atomic>
+#include <cstdio>
 
 Logger::Level Logger::s_level = Logger::Debug;
 bool Logger::s_consoleOutput = true;
@@ -9,6 +11,25 @@ QFile* Logger::s_logFile = nullptr;
 QMutex Logger::s_mutex;
 bool Logger::s_initialized = false;
 
+// 驱动层直接使用 qDebug，级别高于 Debug 时由消息处理函数丢弃；
+// 只过滤 QtDebugMsg，Logger 自己的 Info 经 qInfo 输出不受影响，也不改动全局日志分类规则
+static std::atomic<bool> s_dropQtDebug{false};
+static QtMessageHandler s_previousHandler = nullptr;
+static bool s_handlerInstalled = false;
+
+static void messageHandler(QtMsgType type, const QMessageLogContext& context, const QString& message)
+{
+    if (type == QtDebugMsg && s_dropQtDebug.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (s_previousHandler) {
+        s_previousHandler(type, context, message);
+    } else {
+        fprintf(stderr, "%s\n", qPrintable(qFormatLogMessage(type, context, message)));
+        fflush(stderr);
+    }
+}
+
 void Logger::init()
 {
     QMutexLocker locker(&s_mutex);
@@ -17,6 +38,11 @@ void Logger::init()
     s_level = Debug;
     s_consoleOutput = true;
     s_initialized = true;
+    s_dropQtDebug = false;
+    if (!s_handlerInstalled) {
+        s_previousHandler = qInstallMessageHandler(messageHandler);
+        s_handlerInstalled = true;
+    }
 }
 
 void Logger::shutdown()
@@ -34,6 +60,41 @@ void Logger::setLevel(Level level)
 {
     QMutexLocker locker(&s_mutex);
     s_level = level;
+    // 驱动层直接使用 qDebug，高于 Debug 级别时一并丢弃，避免采集/播放线程的调试输出
+    s_dropQtDebug = level > Debug;
+}
+
+Logger::Level Logger::level()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_level;
+}
+
+bool Logger::levelFromString(const QString& name, Level* level)
+{
+    static const char* names[] = {"debug", "info", "warning", "error"};
+    for (int i = 0; i < 4; i++) {
+        if (name.compare(names[i], Qt::CaseInsensitive) == 0) {
+            *level = static_cast<Level>(i);
+            return true;
+        }
+    }
+    if (name.compare("warn", Qt::CaseInsensitive) == 0) {
+        *level = Warning;
+        return true;
+    }
+    return false;
+}
+
+QString Logger::levelName(Level level)
+{
+    switch (level) {
+        case Debug:   return "debug";
+        case Info:    return "info";
+        case Warning: return "warning";
+        case Error:   return "error";
+    }
+    return QString();
 }
 
 void Logger::setLogFile(const QString& path)
@@ -140,9 +201,11 @@ void Logger::writeToConsole(Level level, const QString& message)
 {
     switch (level) {
         case Debug:
-        case Info:
             qDebug().noquote() << message;
             break;
+        case Info:
+            qInfo().noquote() << message;
+            break;
         case Warning:
             qWarning().noquote() << message;
             break;
@@ -24,6 +24,10 @@ public:
     
     // 配置
     static void setLevel(Level level);
+    static Level level();
+    // 级别名 (debug/info/warning/error，不区分大小写)，无法识别时返回 false
+    static bool levelFromString(const QString& name, Level* level);
+    static QString levelName(Level level);
     static void setLogFile(const QString& path);
     static void setConsoleOutput(bool enabled);
     
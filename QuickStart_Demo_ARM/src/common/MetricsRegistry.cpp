@@ -0,0 +1,221 @@
+#include "MetricsRegistry.h"
+#include "Logger.h"
+#include <QMutexLocker>
+
+#define LOG_MODULE "Metrics"
+
+// ==================== MetricHistogram ====================
+
+MetricHistogram::MetricHistogram()
+{
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricHistogram::observe(double ms)
+{
+    ms = ms > 0.0 ? ms : 0.0;
+    int index = 0;
+    while (index < LatencyHistogram::BUCKET_COUNT - 1 && ms > LatencyHistogram::bucketBoundMs(index)) {
+        index++;
+    }
+    m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+    // std::atomic<double> 没有 fetch_add (C++20 之前)，用 CAS 累加
+    double sum = m_sumMs.load(std::memory_order_relaxed);
+    while (!m_sumMs.compare_exchange_weak(sum, sum + ms, std::memory_order_relaxed)) {
+    }
+    m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MetricHistogram::assign(const LatencyHistogram& histogram)
+{
+    for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; i++) {
+        m_buckets[i].store(histogram.bucketCount(i), std::memory_order_relaxed);
+    }
+    m_sumMs.store(histogram.sumMs(), std::memory_order_relaxed);
+    m_count.store(histogram.count(), std::memory_order_relaxed);
+}
+
+// ==================== MetricsRegistry ====================
+
+static const char* typeName(MetricsRegistry::Type type)
+{
+    switch (type) {
+        case MetricsRegistry::Counter:   return "counter";
+        case MetricsRegistry::Histogram: return "histogram";
+        case MetricsRegistry::Gauge:
+        default:                         return "gauge";
+    }
+}
+
+static QByteArray formatValue(double value)
+{
+    return QByteArray::number(value, 'g', 12);
+}
+
+// 样本行: name{labels} value [timestamp]
+static void appendSample(QByteArray& out, const QString& name, const QString& labels, const QByteArray& value,
+                         const QByteArray& timestamp)
+{
+    out += name.toUtf8();
+    if (!labels.isEmpty()) {
+        out += '{';
+        out += labels.toUtf8();
+        out += '}';
+    }
+    out += ' ';
+    out += value;
+    out += timestamp;
+    out += '\n';
+}
+
+MetricsRegistry* MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return &registry;
+}
+
+QString MetricsRegistry::label(const QString& key, const QString& value)
+{
+    QString escaped = value;
+    escaped.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n");
+    return QString("%1=\"%2\"").arg(key, escaped);
+}
+
+void* MetricsRegistry::lookup(Type type, const QString& name, const QString& help, const QString& labels)
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_families.find(name);
+    if (it == m_families.end()) {
+        Family family;
+        family.type = type;
+        family.help = help;
+        it = m_families.insert(name, family);
+    } else if (it->type != type) {
+        LOG_WARN(QString("Metric %1 registered as %2, requested as %3")
+                 .arg(name, typeName(it->type), typeName(type)));
+        return nullptr;
+    }
+
+    for (Series& series : it->series) {
+        if (series.labels == labels) {
+            series.retired = false;
+            return series.metric;
+        }
+    }
+
+    // 指标对象不释放，调用方缓存的指针始终有效
+    Series series;
+    series.labels = labels;
+    switch (type) {
+        case Counter:   series.metric = new MetricCounter(); break;
+        case Histogram: series.metric = new MetricHistogram(); break;
+        case Gauge:     series.metric = new MetricGauge(); break;
+    }
+    it->series.append(series);
+    return series.metric;
+}
+
+MetricCounter* MetricsRegistry::counter(const QString& name, const QString& help, const QString& labels)
+{
+    return static_cast<MetricCounter*>(lookup(Counter, name, help, labels));
+}
+
+MetricGauge* MetricsRegistry::gauge(const QString& name, const QString& help, const QString& labels)
+{
+    return static_cast<MetricGauge*>(lookup(Gauge, name, help, labels));
+}
+
+MetricHistogram* MetricsRegistry::histogram(const QString& name, const QString& help, const QString& labels)
+{
+    return static_cast<MetricHistogram*>(lookup(Histogram, name, help, labels));
+}
+
+bool MetricsRegistry::read(const QString& name, const QString& labels, double* value) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_families.constFind(name);
+    if (it == m_families.constEnd() || it.value().type == Histogram) {
+        return false;
+    }
+    for (const Series& series : it.value().series) {
+        if (series.labels == labels && !series.retired) {
+            *value = it.value().type == Counter
+                ? static_cast<double>(static_cast<const MetricCounter*>(series.metric)->value())
+                : static_cast<const MetricGauge*>(series.metric)->value();
+            return true;
+        }
+    }
+    return false;
+}
+
+void MetricsRegistry::retire(const QString& labelPrefix)
+{
+    if (labelPrefix.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    for (Family& family : m_families) {
+        for (Series& series : family.series) {
+            if (series.labels.startsWith(labelPrefix)) {
+                series.retired = true;
+            }
+        }
+    }
+}
+
+QByteArray MetricsRegistry::exposition(double timestampSec) const
+{
+    QByteArray timestamp = timestampSec > 0.0 ? ' ' + QByteArray::number(timestampSec, 'f', 3) : QByteArray();
+    QByteArray out;
+    out.reserve(16 * 1024);
+
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_families.constBegin(); it != m_families.constEnd(); ++it) {
+        const QString& name = it.key();
+        const Family& family = it.value();
+        QString help = family.help;
+        help.replace("\\", "\\\\").replace("\n", "\\n");
+        out += "# TYPE " + name.toUtf8() + ' ' + typeName(family.type) + '\n';
+        out += "# HELP " + name.toUtf8() + ' ' + help.toUtf8() + '\n';
+
+        for (const Series& series : family.series) {
+            if (series.retired) {
+                continue;
+            }
+            switch (family.type) {
+                case Counter: {
+                    const MetricCounter* counter = static_cast<const MetricCounter*>(series.metric);
+                    appendSample(out, name + "_total", series.labels,
+                                 QByteArray::number(static_cast<qulonglong>(counter->value())), timestamp);
+                    break;
+                }
+                case Gauge: {
+                    const MetricGauge* gauge = static_cast<const MetricGauge*>(series.metric);
+                    appendSample(out, name, series.labels, formatValue(gauge->value()), timestamp);
+                    break;
+                }
+                case Histogram: {
+                    // OpenMetrics 的桶为累计计数，+Inf 桶等于总数
+                    const MetricHistogram* histogram = static_cast<const MetricHistogram*>(series.metric);
+                    QString prefix = series.labels.isEmpty() ? QString() : series.labels + ",";
+                    uint64_t cumulative = 0;
+                    for (int i = 0; i < LatencyHistogram::BUCKET_COUNT; i++) {
+                        cumulative += histogram->bucketCount(i);
+                        int bound = LatencyHistogram::bucketBoundMs(i);
+                        QString le = bound >= 0 ? QString::number(bound) : QString("+Inf");
+                        appendSample(out, name + "_bucket", prefix + label("le", le),
+                                     QByteArray::number(static_cast<qulonglong>(cumulative)), timestamp);
+                    }
+                    appendSample(out, name + "_count", series.labels,
+                                 QByteArray::number(static_cast<qulonglong>(cumulative)), timestamp);
+                    appendSample(out, name + "_sum", series.labels, formatValue(histogram->sumMs()), timestamp);
+                    break;
+                }
+            }
+        }
+    }
+    out += "# EOF\n";
+    return out;
+}
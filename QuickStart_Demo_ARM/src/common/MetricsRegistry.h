@@ -0,0 +1,111 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 计数器 (只增)
+ */
+class MetricCounter {
+public:
+    void add(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    // 外部已累计的计数 (例如 SDK 或抖动缓冲的统计) 直接同步过来
+    void set(uint64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+/**
+ * 瞬时值
+ */
+class MetricGauge {
+public:
+    void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+    double value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value{0.0};
+};
+
+/**
+ * 直方图 (ms)，分桶与 LatencyHistogram 一致
+ * observe 逐个样本累计；assign 用已有的 LatencyHistogram 整体覆盖 (统计在别处累计时)
+ */
+class MetricHistogram {
+public:
+    MetricHistogram();
+
+    void observe(double ms);
+    void assign(const LatencyHistogram& histogram);
+
+    uint64_t bucketCount(int index) const { return m_buckets[index].load(std::memory_order_relaxed); }
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    double sumMs() const { return m_sumMs.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_buckets[LatencyHistogram::BUCKET_COUNT];
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<double> m_sumMs{0.0};
+};
+
+/**
+ * 指标注册表 (OpenMetrics 文本格式导出)
+ * 按名称 + 标签登记一次，返回的指针在进程生命周期内有效；写入只操作原子变量，不加锁不分配，
+ * 可在 SDK 回调线程、音视频线程中调用。登记和导出加锁
+ *
+ * 标签为 OpenMetrics 语法的字符串，例如 label("user", uid) + "," + label("kind", "audio")
+ */
+class MetricsRegistry {
+public:
+    enum Type {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    static MetricsRegistry* instance();
+
+    // 同名指标的类型和说明以第一次登记为准；类型不符时返回 nullptr
+    MetricCounter* counter(const QString& name, const QString& help, const QString& labels = QString());
+    MetricGauge* gauge(const QString& name, const QString& help, const QString& labels = QString());
+    MetricHistogram* histogram(const QString& name, const QString& help, const QString& labels = QString());
+
+    // 读取计数/数值型指标的当前值 (不登记)，不存在、已停止上报或为直方图时返回 false
+    bool read(const QString& name, const QString& labels, double* value) const;
+
+    // 不再上报某组标签 (例如远端用户离开)，已取得的指针仍然有效，只是不再导出
+    void retire(const QString& labelPrefix);
+
+    // key="value"，值按 OpenMetrics 规则转义
+    static QString label(const QString& key, const QString& value);
+
+    // 全部指标的 OpenMetrics 文本，以 "# EOF" 结尾；timestampSec > 0 时每个样本带时间戳
+    QByteArray exposition(double timestampSec = 0.0) const;
+
+private:
+    struct Series {
+        QString labels;
+        void* metric = nullptr;
+        bool retired = false;
+    };
+
+    struct Family {
+        Type type = Gauge;
+        QString help;
+        QList<Series> series;
+    };
+
+    MetricsRegistry() = default;
+    void* lookup(Type type, const QString& name, const QString& help, const QString& labels);
+
+    mutable QMutex m_mutex;
+    QMap<QString, Family> m_families;
+};
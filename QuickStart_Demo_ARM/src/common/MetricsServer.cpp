@@ -0,0 +1,152 @@
+#include "MetricsServer.h"
+#include "MetricsRegistry.h"
+#include "Logger.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+
+#define LOG_MODULE "MetricsServer"
+
+// 请求头上限，超过视为异常连接
+static const int MAX_REQUEST_BYTES = 8 * 1024;
+// 连接在这段时间内没有发完请求头就关闭
+static const int REQUEST_TIMEOUT_MS = 5000;
+
+static const char* CONTENT_TYPE = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+MetricsServer::MetricsServer(QObject* parent)
+    : QThread(parent)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stopServer();
+}
+
+void MetricsServer::startServer(const Config& config)
+{
+    if (isRunning()) {
+        return;
+    }
+    m_config = config;
+    if (m_config.port <= 0 && m_config.snapshotPath.isEmpty()) {
+        return;
+    }
+    start();
+}
+
+void MetricsServer::stopServer()
+{
+    if (isRunning()) {
+        quit();
+        wait(3000);
+    }
+}
+
+static void respond(QTcpSocket* socket, const QByteArray& status, const QByteArray& contentType,
+                    const QByteArray& body)
+{
+    QByteArray response = "HTTP/1.1 " + status + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+static void handleRequest(QTcpSocket* socket)
+{
+    QByteArray request = socket->peek(MAX_REQUEST_BYTES);
+    int headerEnd = request.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (request.size() >= MAX_REQUEST_BYTES) {
+            socket->abort();
+        }
+        return;
+    }
+    socket->read(headerEnd + 4);
+
+    // 只看请求行: GET /metrics HTTP/1.1
+    QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    QByteArray method = requestLine.value(0);
+    QByteArray path = requestLine.value(1);
+    int query = path.indexOf('?');
+    if (query >= 0) {
+        path.truncate(query);
+    }
+
+    if (method != "GET") {
+        respond(socket, "405 Method Not Allowed", "text/plain", "only GET is supported\n");
+    } else if (path == "/metrics") {
+        respond(socket, "200 OK", CONTENT_TYPE, MetricsRegistry::instance()->exposition());
+    } else {
+        respond(socket, "404 Not Found", "text/plain", "try /metrics\n");
+    }
+}
+
+void MetricsServer::run()
+{
+    // 对象都在本线程创建，信号在本线程的事件循环中处理
+    QTcpServer server;
+    if (m_config.port > 0) {
+        QHostAddress address(m_config.bindAddress.isEmpty() ? QString("127.0.0.1") : m_config.bindAddress);
+        if (server.listen(address, static_cast<quint16>(m_config.port))) {
+            LOG_INFO(QString("Serving OpenMetrics on http://%1:%2/metrics")
+                     .arg(address.toString()).arg(m_config.port));
+        } else {
+            LOG_WARN(QString("Failed to listen on %1:%2: %3")
+                     .arg(address.toString()).arg(m_config.port).arg(server.errorString()));
+        }
+    }
+    QObject::connect(&server, &QTcpServer::newConnection, [&server]() {
+        while (QTcpSocket* socket = server.nextPendingConnection()) {
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket]() { handleRequest(socket); });
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            QTimer::singleShot(REQUEST_TIMEOUT_MS, socket, [socket]() { socket->abort(); });
+        }
+    });
+
+    QTimer snapshotTimer;
+    if (!m_config.snapshotPath.isEmpty() && m_config.snapshotIntervalSec > 0) {
+        QDir().mkpath(QFileInfo(m_config.snapshotPath).absolutePath());
+        QObject::connect(&snapshotTimer, &QTimer::timeout, [this]() { writeSnapshot(); });
+        snapshotTimer.start(m_config.snapshotIntervalSec * 1000);
+        LOG_INFO(QString("Metrics snapshot every %1 s to %2")
+                 .arg(m_config.snapshotIntervalSec).arg(m_config.snapshotPath));
+    }
+
+    exec();
+
+    server.close();
+    if (snapshotTimer.isActive()) {
+        writeSnapshot();
+    }
+}
+
+void MetricsServer::writeSnapshot()
+{
+    // 超过上限时滚动: 当前文件改名为 .1 (覆盖上一份)，再新建
+    QFileInfo info(m_config.snapshotPath);
+    if (info.exists() && info.size() >= static_cast<qint64>(m_config.snapshotMaxKB) * 1024) {
+        QString previous = m_config.snapshotPath + ".1";
+        QFile::remove(previous);
+        QFile::rename(m_config.snapshotPath, previous);
+    }
+
+    QFile file(m_config.snapshotPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        LOG_WARN(QString("Failed to write metrics snapshot: %1").arg(m_config.snapshotPath));
+        return;
+    }
+    // 每份快照是一段完整的 OpenMetrics 文本 (以 # EOF 结尾)，样本带秒级时间戳
+    double nowSec = QDateTime::currentMSecsSinceEpoch() / 1000.0;
+    file.write(MetricsRegistry::instance()->exposition(nowSec));
+    file.close();
+}
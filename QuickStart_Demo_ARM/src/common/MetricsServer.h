@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QThread>
+#include <QString>
+
+/**
+ * 指标导出服务
+ * 在独立线程的事件循环中运行，不占用 GUI 线程:
+ *
+ * - HTTP: GET /metrics 返回 MetricsRegistry 的 OpenMetrics 文本，供 Prometheus 抓取
+ * - 快照: 按固定间隔把带时间戳的指标追加到文件，超过上限时滚动为 <文件>.1
+ *
+ * 端口为 0 且未配置快照时不启动线程
+ */
+class MetricsServer : public QThread {
+    Q_OBJECT
+
+public:
+    struct Config {
+        QString bindAddress = "127.0.0.1";
+        int port = 0;                   // 0 表示不提供 HTTP
+        QString snapshotPath;           // 空表示不写快照
+        int snapshotIntervalSec = 60;
+        int snapshotMaxKB = 1024;
+    };
+
+    explicit MetricsServer(QObject* parent = nullptr);
+    ~MetricsServer() override;
+
+    void startServer(const Config& config);
+    void stopServer();
+
+protected:
+    void run() override;
+
+private:
+    void writeSnapshot();
+
+    Config m_config;
+};
@@ -0,0 +1,233 @@
+#include "Mfcc.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MFCC_USE_NEON 1
+#elif defined(__SSE__) || defined(__x86_64__)
+#include <xmmintrin.h>
+#define MFCC_USE_SSE 1
+#endif
+
+static const float PRE_EMPHASIS = 0.97f;
+static const float LOW_FREQ = 20.0f;
+static const float HIGH_FREQ = 7600.0f;
+static const float LOG_FLOOR = 1e-6f;
+
+static float hzToMel(float hz)
+{
+    return 1127.0f * std::log(1.0f + hz / 700.0f);
+}
+
+Mfcc::Mfcc(int numCoeffs)
+    : m_numCoeffs(std::max(1, std::min(numCoeffs, NUM_FILTERS)))
+{
+    const double pi = 3.14159265358979323846;
+
+    m_window.resize(FRAME_LENGTH);
+    for (int i = 0; i < FRAME_LENGTH; i++) {
+        m_window[i] = static_cast<float>(0.54 - 0.46 * std::cos(2.0 * pi * i / (FRAME_LENGTH - 1)));
+    }
+
+    m_re.resize(FFT_SIZE);
+    m_im.resize(FFT_SIZE);
+    m_power.resize(FFT_SIZE / 2 + 1);
+    m_melEnergy.resize(NUM_FILTERS);
+
+    m_cosTable.resize(FFT_SIZE / 2);
+    m_sinTable.resize(FFT_SIZE / 2);
+    for (int i = 0; i < FFT_SIZE / 2; i++) {
+        m_cosTable[i] = static_cast<float>(std::cos(2.0 * pi * i / FFT_SIZE));
+        m_sinTable[i] = static_cast<float>(-std::sin(2.0 * pi * i / FFT_SIZE));
+    }
+
+    int bits = 0;
+    while ((1 << bits) < FFT_SIZE) {
+        bits++;
+    }
+    m_bitReverse.resize(FFT_SIZE);
+    for (int i = 0; i < FFT_SIZE; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (1 << b)) {
+                r |= 1 << (bits - 1 - b);
+            }
+        }
+        m_bitReverse[i] = r;
+    }
+
+    // Mel 三角滤波器
+    const int numBins = FFT_SIZE / 2 + 1;
+    const float binHz = static_cast<float>(SAMPLE_RATE) / FFT_SIZE;
+    float melLow = hzToMel(LOW_FREQ);
+    float melHigh = hzToMel(HIGH_FREQ);
+    float melStep = (melHigh - melLow) / (NUM_FILTERS + 1);
+
+    for (int f = 0; f < NUM_FILTERS; f++) {
+        float left = melLow + f * melStep;
+        float center = left + melStep;
+        float right = center + melStep;
+
+        int start = -1;
+        std::vector<float> weights;
+        for (int bin = 0; bin < numBins; bin++) {
+            float mel = hzToMel(bin * binHz);
+            float w = 0.0f;
+            if (mel > left && mel < right) {
+                w = (mel <= center) ? (mel - left) / (center - left) : (right - mel) / (right - center);
+            }
+            if (w > 0.0f) {
+                if (start < 0) {
+                    start = bin;
+                }
+                weights.push_back(w);
+            }
+        }
+        if (start < 0) {
+            start = 0;
+        }
+        m_filterStart.push_back(start);
+        m_filterLength.push_back(static_cast<int>(weights.size()));
+        m_filterOffset.push_back(static_cast<int>(m_filterWeights.size()));
+        m_filterWeights.insert(m_filterWeights.end(), weights.begin(), weights.end());
+    }
+
+    // DCT-II 正交归一化
+    m_dct.resize(m_numCoeffs * NUM_FILTERS);
+    for (int k = 0; k < m_numCoeffs; k++) {
+        double scale = (k == 0) ? std::sqrt(1.0 / NUM_FILTERS) : std::sqrt(2.0 / NUM_FILTERS);
+        for (int n = 0; n < NUM_FILTERS; n++) {
+            m_dct[k * NUM_FILTERS + n] =
+                static_cast<float>(scale * std::cos(pi * k * (n + 0.5) / NUM_FILTERS));
+        }
+    }
+
+    m_history.resize(FRAME_LENGTH);
+    reset();
+}
+
+void Mfcc::reset()
+{
+    std::fill(m_history.begin(), m_history.end(), 0.0f);
+    m_filled = 0;
+    m_prevSample = 0.0f;
+}
+
+bool Mfcc::process(const int16_t* samples, float* coeffs)
+{
+    // 滑动窗口: 丢弃最旧的一个帧移，追加预加重后的新采样
+    memmove(m_history.data(), m_history.data() + FRAME_SHIFT,
+            (FRAME_LENGTH - FRAME_SHIFT) * sizeof(float));
+    float* dst = m_history.data() + FRAME_LENGTH - FRAME_SHIFT;
+    for (int i = 0; i < FRAME_SHIFT; i++) {
+        float x = samples[i] * (1.0f / 32768.0f);
+        dst[i] = x - PRE_EMPHASIS * m_prevSample;
+        m_prevSample = x;
+    }
+
+    m_filled = std::min(FRAME_LENGTH, m_filled + FRAME_SHIFT);
+    if (m_filled < FRAME_LENGTH) {
+        return false;
+    }
+
+    // 加窗 + 补零
+    for (int i = 0; i < FRAME_LENGTH; i++) {
+        m_re[i] = m_history[i] * m_window[i];
+    }
+    std::fill(m_re.begin() + FRAME_LENGTH, m_re.end(), 0.0f);
+    std::fill(m_im.begin(), m_im.end(), 0.0f);
+
+    fft(m_re.data(), m_im.data());
+
+    // 功率谱
+    const int numBins = FFT_SIZE / 2 + 1;
+    int i = 0;
+#if defined(MFCC_USE_NEON)
+    for (; i + 4 <= numBins; i += 4) {
+        float32x4_t r = vld1q_f32(&m_re[i]);
+        float32x4_t im = vld1q_f32(&m_im[i]);
+        vst1q_f32(&m_power[i], vmlaq_f32(vmulq_f32(r, r), im, im));
+    }
+#elif defined(MFCC_USE_SSE)
+    for (; i + 4 <= numBins; i += 4) {
+        __m128 r = _mm_loadu_ps(&m_re[i]);
+        __m128 im = _mm_loadu_ps(&m_im[i]);
+        _mm_storeu_ps(&m_power[i], _mm_add_ps(_mm_mul_ps(r, r), _mm_mul_ps(im, im)));
+    }
+#endif
+    for (; i < numBins; i++) {
+        m_power[i] = m_re[i] * m_re[i] + m_im[i] * m_im[i];
+    }
+
+    // Mel 滤波器组 + 对数
+    for (int f = 0; f < NUM_FILTERS; f++) {
+        float energy = dot(&m_power[m_filterStart[f]], &m_filterWeights[m_filterOffset[f]],
+                           m_filterLength[f]);
+        m_melEnergy[f] = std::log(energy + LOG_FLOOR);
+    }
+
+    // DCT
+    for (int k = 0; k < m_numCoeffs; k++) {
+        coeffs[k] = dot(&m_dct[k * NUM_FILTERS], m_melEnergy.data(), NUM_FILTERS);
+    }
+    return true;
+}
+
+void Mfcc::fft(float* re, float* im) const
+{
+    // 原地迭代 radix-2
+    for (int i = 0; i < FFT_SIZE; i++) {
+        int j = m_bitReverse[i];
+        if (j > i) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+
+    for (int size = 2; size <= FFT_SIZE; size <<= 1) {
+        int half = size / 2;
+        int step = FFT_SIZE / size;
+        for (int start = 0; start < FFT_SIZE; start += size) {
+            for (int k = 0; k < half; k++) {
+                float wr = m_cosTable[k * step];
+                float wi = m_sinTable[k * step];
+                int a = start + k;
+                int b = a + half;
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+float Mfcc::dot(const float* a, const float* b, int n)
+{
+    int i = 0;
+    float sum = 0.0f;
+#if defined(MFCC_USE_NEON)
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+    float32x2_t pair = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(pair, pair), 0);
+#elif defined(MFCC_USE_SSE)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
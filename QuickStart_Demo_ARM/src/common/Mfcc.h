@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * MFCC 特征提取 (16kHz 单声道)
+ * 帧长 25ms (400 点)，帧移 10ms (160 点)，与采集线程的 10ms 推送帧对齐
+ *
+ * 特征定义 (训练/导出模型时必须一致):
+ *   预加重 0.97 -> Hamming 窗 -> 512 点 FFT 功率谱
+ *   -> 40 个三角 Mel 滤波器 (20Hz - 7600Hz) -> ln(能量 + 1e-6)
+ *   -> DCT-II (正交归一化) 取前 numCoeffs 个系数 (含 c0)
+ *
+ * 功率谱、滤波器组和 DCT 的内积使用 NEON/SSE 向量化，其他平台回退标量实现
+ */
+class Mfcc {
+public:
+    static const int SAMPLE_RATE = 16000;
+    static const int FRAME_LENGTH = 400;
+    static const int FRAME_SHIFT = 160;
+    static const int FFT_SIZE = 512;
+    static const int NUM_FILTERS = 40;
+
+    explicit Mfcc(int numCoeffs = 10);
+
+    int numCoeffs() const { return m_numCoeffs; }
+    void reset();
+
+    // 输入一帧移 (160 个采样)，窗口填满后输出 numCoeffs 个系数并返回 true
+    bool process(const int16_t* samples, float* coeffs);
+
+private:
+    void fft(float* re, float* im) const;
+    static float dot(const float* a, const float* b, int n);
+
+    int m_numCoeffs;
+    int m_filled = 0;
+    float m_prevSample = 0.0f;
+
+    std::vector<float> m_window;        // Hamming 窗
+    std::vector<float> m_history;       // 最近 FRAME_LENGTH 个预加重后的采样
+    std::vector<float> m_re;
+    std::vector<float> m_im;
+    std::vector<float> m_power;
+    std::vector<float> m_melEnergy;
+    std::vector<float> m_cosTable;      // FFT 旋转因子
+    std::vector<float> m_sinTable;
+    std::vector<int> m_bitReverse;
+
+    // Mel 滤波器按 [起始 bin, 权重...] 稀疏存储
+    std::vector<int> m_filterStart;
+    std::vector<int> m_filterLength;
+    std::vector<float> m_filterWeights;
+    std::vector<int> m_filterOffset;
+
+    std::vector<float> m_dct;           // numCoeffs x NUM_FILTERS
+};
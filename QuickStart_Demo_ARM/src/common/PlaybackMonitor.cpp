@@ -0,0 +1,77 @@
+#include "PlaybackMonitor.h"
+#include <algorithm>
+#include <chrono>
+
+static int64_t nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+PlaybackMonitor::PlaybackMonitor()
+{
+    for (std::atomic<int>& block : m_blocks) {
+        block.store(0, std::memory_order_relaxed);
+    }
+}
+
+void PlaybackMonitor::publish(int peak, bool real)
+{
+    uint32_t index = m_count.load(std::memory_order_relaxed);
+    m_blocks[index % HISTORY_BLOCKS].store(std::min(peak, REAL_FLAG - 1) | (real ? REAL_FLAG : 0),
+                                           std::memory_order_relaxed);
+    m_count.store(index + 1, std::memory_order_release);
+    m_lastPublishUs.store(nowUs(), std::memory_order_relaxed);
+}
+
+bool PlaybackMonitor::isDuckRequested() const
+{
+    return nowUs() < m_duckUntilUs.load(std::memory_order_relaxed);
+}
+
+void PlaybackMonitor::clearDuck()
+{
+    m_duckUntilUs.store(0, std::memory_order_relaxed);
+}
+
+bool PlaybackMonitor::isStale(int64_t now) const
+{
+    // 播放线程停止 (或阻塞) 后历史不再代表正在播出的声音
+    return now - m_lastPublishUs.load(std::memory_order_relaxed) > 2 * BLOCK_MS * 1000;
+}
+
+int PlaybackMonitor::recentPeak(int windowMs) const
+{
+    if (isStale(nowUs())) {
+        return 0;
+    }
+    uint32_t count = m_count.load(std::memory_order_acquire);
+    int blocks = std::min<int>(std::min(HISTORY_BLOCKS, std::max(1, windowMs / BLOCK_MS)),
+                               static_cast<int>(std::min<uint32_t>(count, HISTORY_BLOCKS)));
+    int peak = 0;
+    for (int i = 1; i <= blocks; i++) {
+        peak = std::max(peak, m_blocks[(count - i) % HISTORY_BLOCKS].load(std::memory_order_relaxed) & (REAL_FLAG - 1));
+    }
+    return peak;
+}
+
+bool PlaybackMonitor::isActive(int windowMs) const
+{
+    if (isStale(nowUs())) {
+        return false;
+    }
+    uint32_t count = m_count.load(std::memory_order_acquire);
+    int blocks = std::min<int>(std::min(HISTORY_BLOCKS, std::max(1, windowMs / BLOCK_MS)),
+                               static_cast<int>(std::min<uint32_t>(count, HISTORY_BLOCKS)));
+    for (int i = 1; i <= blocks; i++) {
+        if (m_blocks[(count - i) % HISTORY_BLOCKS].load(std::memory_order_relaxed) & REAL_FLAG) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PlaybackMonitor::requestDuck(int holdMs)
+{
+    m_duckUntilUs.store(nowUs() + static_cast<int64_t>(holdMs) * 1000, std::memory_order_relaxed);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 播放状态共享 (播放线程 <-> 采集线程)
+ * 播放线程每 10ms 发布一次实际写入声卡的峰值，采集线程据此估计回声；
+ * 采集线程检测到用户插话时请求闪避 (duck)，播放线程读取后降低音量
+ *
+ * 全部为原子变量，读写两端都不加锁、不分配
+ */
+class PlaybackMonitor {
+public:
+    static const int BLOCK_MS = 10;
+    static const int HISTORY_BLOCKS = 64;   // 640ms，覆盖声卡缓冲 + 声学路径
+
+    PlaybackMonitor();
+
+    // 播放线程: 发布一块 (10ms) 的峰值，real 表示其中有远端音频 (不是补偿/静音)
+    void publish(int peak, bool real);
+    // 播放线程: 是否有未过期的闪避请求
+    bool isDuckRequested() const;
+    void clearDuck();
+
+    // 任意线程: 最近 windowMs 内的最大输出峰值，播放停止超过一块时返回 0
+    int recentPeak(int windowMs) const;
+    // 任意线程: 最近 windowMs 内是否播放过远端音频
+    bool isActive(int windowMs) const;
+    // 任意线程: 请求闪避并保持 holdMs，重复调用延长保持时间
+    void requestDuck(int holdMs);
+
+private:
+    static const int REAL_FLAG = 0x10000;
+
+    bool isStale(int64_t nowUs) const;
+
+    std::atomic<int> m_blocks[HISTORY_BLOCKS];   // 峰值 | REAL_FLAG
+    std::atomic<uint32_t> m_count{0};
+    std::atomic<int64_t> m_lastPublishUs{0};
+    std::atomic<int64_t> m_duckUntilUs{0};
+};
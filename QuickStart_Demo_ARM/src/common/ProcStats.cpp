@@ -0,0 +1,307 @@
+#include "ProcStats.h"
+#include "MetricsRegistry.h"
+#include <QDir>
+#include <QFile>
+#include <QMap>
+#include <QMutexLocker>
+#include <algorithm>
+#include <chrono>
+#include <unistd.h>
+
+static const int MAX_THERMAL_ZONES = 8;
+
+QMutex ProcStats::s_childMutex;
+QHash<qint64, QString> ProcStats::s_children;
+
+static int64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static QByteArray readProcFile(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+// /proc/<pid>/task/<tid>/stat: "tid (comm) state ppid ... minflt cminflt majflt cmajflt utime stime ..."
+// comm 可能包含空格和括号，以最后一个 ')' 为界；其后第 8、10 个字段为缺页，第 12、13 个字段为 utime/stime
+static bool parseStat(const QByteArray& stat, QString* name, QList<QByteArray>* fields)
+{
+    int open = stat.indexOf('(');
+    int close = stat.lastIndexOf(')');
+    if (open < 0 || close < open) {
+        return false;
+    }
+    *fields = stat.mid(close + 2).split(' ');
+    if (fields->size() < 13) {
+        return false;
+    }
+    if (name) {
+        *name = QString::fromUtf8(stat.mid(open + 1, close - open - 1));
+    }
+    return true;
+}
+
+static bool readThread(const QString& dir, ProcStats::ThreadCpu* thread)
+{
+    static const uint64_t nsPerTick = 1000000000ULL / static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+
+    QList<QByteArray> fields;
+    if (!parseStat(readProcFile(dir + "/stat"), &thread->name, &fields)) {
+        return false;  // 线程已退出
+    }
+    thread->minorFaults = fields.at(7).toULongLong();
+    thread->majorFaults = fields.at(9).toULongLong();
+
+    // schedstat: "run_ns wait_ns timeslices"，纳秒精度；内核未开启 CONFIG_SCHED_INFO 时不存在
+    QList<QByteArray> schedstat = readProcFile(dir + "/schedstat").trimmed().split(' ');
+    if (schedstat.size() >= 2) {
+        thread->cpuNs = schedstat.at(0).toULongLong();
+        thread->waitNs = schedstat.at(1).toULongLong();
+    } else {
+        thread->cpuNs = (fields.at(11).toULongLong() + fields.at(12).toULongLong()) * nsPerTick;
+        thread->waitNs = 0;
+    }
+    return true;
+}
+
+QList<ProcStats::ThreadCpu> ProcStats::sampleThreads()
+{
+    static const int mainTid = static_cast<int>(getpid());
+
+    int64_t nowNs = steadyNowNs();
+    double elapsedNs = m_lastSampleNs > 0 ? static_cast<double>(nowNs - m_lastSampleNs) : 0.0;
+    m_lastSampleNs = nowNs;
+
+    QList<ThreadCpu> threads;
+    QHash<int, Baseline> baselines;
+    uint64_t processNs = 0;
+    const QStringList tids = QDir("/proc/self/task").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& tidName : tids) {
+        ThreadCpu thread;
+        if (!readThread(QString("/proc/self/task/%1").arg(tidName), &thread)) {
+            continue;
+        }
+        thread.tid = tidName.toInt();
+        if (thread.tid == mainTid) {
+            thread.name = "gui";
+        }
+        Baseline baseline;
+        baseline.cpuNs = thread.cpuNs;
+        baseline.waitNs = thread.waitNs;
+        baselines.insert(thread.tid, baseline);
+
+        auto last = m_last.constFind(thread.tid);
+        if (elapsedNs > 0.0 && last != m_last.constEnd() && thread.cpuNs >= last.value().cpuNs) {
+            uint64_t delta = thread.cpuNs - last.value().cpuNs;
+            processNs += delta;
+            thread.percent = delta / elapsedNs * 100.0;
+            if (thread.waitNs >= last.value().waitNs) {
+                thread.waitPercent = (thread.waitNs - last.value().waitNs) / elapsedNs * 100.0;
+            }
+            threads.append(thread);
+        }
+    }
+    m_last.swap(baselines);
+    m_processPercent = elapsedNs > 0.0 ? processNs / elapsedNs * 100.0 : 0.0;
+
+    std::sort(threads.begin(), threads.end(), [](const ThreadCpu& a, const ThreadCpu& b) {
+        return a.percent > b.percent;
+    });
+    return threads;
+}
+
+// /proc/self/status、smaps_rollup 中 "Key:   1234 kB" 形式的行
+static int64_t readKB(const QByteArray& content, const QByteArray& key)
+{
+    int pos = content.indexOf("\n" + key + ":");
+    if (pos < 0) {
+        return -1;
+    }
+    QList<QByteArray> parts = content.mid(pos + key.size() + 2, 32).simplified().split(' ');
+    bool ok = false;
+    int64_t value = parts.isEmpty() ? 0 : parts.first().toLongLong(&ok);
+    return ok ? value : -1;
+}
+
+ProcStats::Memory ProcStats::sampleMemory()
+{
+    Memory memory;
+    // 两个文件的第一行都不是要读的字段，前面补换行统一按 "\nKey:" 查找
+    QByteArray status = "\n" + readProcFile("/proc/self/status");
+    memory.rssKB = readKB(status, "VmRSS");
+    memory.peakRssKB = readKB(status, "VmHWM");
+    memory.threads = static_cast<int>(readKB(status, "Threads"));
+    memory.pssKB = readKB("\n" + readProcFile("/proc/self/smaps_rollup"), "Pss");
+
+    QList<QByteArray> fields;
+    if (parseStat(readProcFile("/proc/self/stat"), nullptr, &fields)) {
+        memory.minorFaults = fields.at(7).toULongLong();
+        memory.majorFaults = fields.at(9).toULongLong();
+    }
+    return memory;
+}
+
+double ProcStats::socTemperatureC()
+{
+    // 树莓派为 thermal_zone0 (cpu-thermal)，单位为毫摄氏度
+    for (int zone = 0; zone < MAX_THERMAL_ZONES; zone++) {
+        QFile file(QString("/sys/class/thermal/thermal_zone%1/temp").arg(zone));
+        if (!file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        bool ok = false;
+        int milliC = file.readAll().trimmed().toInt(&ok);
+        if (ok) {
+            return milliC / 1000.0;
+        }
+    }
+    return -1.0;
+}
+
+void ProcStats::publishMetrics()
+{
+    // 首次调用只建立基线，占用为 0
+    QList<ThreadCpu> threads = sampleThreads();
+
+    struct Group {
+        double percent = 0.0;
+        double waitPercent = 0.0;
+        uint64_t cpuNs = 0;
+        uint64_t minorFaults = 0;
+        uint64_t majorFaults = 0;
+        int count = 0;
+    };
+    QMap<QString, Group> groups;
+    for (const ThreadCpu& thread : threads) {
+        Group& group = groups[thread.name];
+        group.percent += thread.percent;
+        group.waitPercent += thread.waitPercent;
+        group.cpuNs += thread.cpuNs;
+        group.minorFaults += thread.minorFaults;
+        group.majorFaults += thread.majorFaults;
+        group.count++;
+    }
+    // 已退出的线程组置 0，保留序列以便看到它曾经存在
+    for (const QString& name : m_publishedThreads) {
+        if (!groups.contains(name)) {
+            groups.insert(name, Group());
+        }
+    }
+
+    MetricsRegistry* registry = MetricsRegistry::instance();
+    for (auto it = groups.constBegin(); it != groups.constEnd(); ++it) {
+        const Group& group = it.value();
+        QString labels = MetricsRegistry::label("thread", it.key());
+        registry->gauge("thread_cpu_percent", "Thread CPU usage over the last interval (100 = one core)", labels)
+            ->set(group.percent);
+        registry->gauge("thread_runqueue_wait_percent", "Time runnable but waiting for a CPU", labels)
+            ->set(group.waitPercent);
+        registry->gauge("thread_count", "Live threads with this name", labels)->set(group.count);
+        // 同名线程退出后累计值会减少，因此用 gauge
+        registry->gauge("thread_cpu_ms", "CPU time of live threads with this name", labels)
+            ->set(group.cpuNs / 1e6);
+        registry->gauge("thread_page_faults", "Page faults of live threads with this name",
+                        labels + "," + MetricsRegistry::label("type", "minor"))->set(group.minorFaults);
+        registry->gauge("thread_page_faults", "Page faults of live threads with this name",
+                        labels + "," + MetricsRegistry::label("type", "major"))->set(group.majorFaults);
+        m_publishedThreads.insert(it.key());
+    }
+
+    Memory memory = sampleMemory();
+    registry->gauge("process_cpu_percent", "Process CPU usage over the last interval (100 = one core)")
+        ->set(m_processPercent);
+    registry->gauge("process_threads", "Threads in the process")->set(memory.threads);
+    const QString types[] = {"rss", "pss", "peak_rss"};
+    const int64_t values[] = {memory.rssKB, memory.pssKB, memory.peakRssKB};
+    for (int i = 0; i < 3; i++) {
+        if (values[i] >= 0) {
+            registry->gauge("process_memory_kb", "Process memory", MetricsRegistry::label("type", types[i]))
+                ->set(values[i]);
+        }
+    }
+    registry->counter("process_page_faults", "Process page faults", MetricsRegistry::label("type", "minor"))
+        ->set(memory.minorFaults);
+    registry->counter("process_page_faults", "Process page faults", MetricsRegistry::label("type", "major"))
+        ->set(memory.majorFaults);
+
+    publishChildProcesses();
+
+    double temperature = socTemperatureC();
+    if (temperature >= 0.0) {
+        registry->gauge("soc_temperature_celsius", "SoC temperature")->set(temperature);
+    }
+}
+
+void ProcStats::registerChildProcess(const QString& name, qint64 pid)
+{
+    if (pid <= 0) {
+        return;
+    }
+    QMutexLocker locker(&s_childMutex);
+    s_children.insert(pid, name);
+}
+
+void ProcStats::unregisterChildProcess(qint64 pid)
+{
+    QMutexLocker locker(&s_childMutex);
+    s_children.remove(pid);
+}
+
+void ProcStats::publishChildProcesses()
+{
+    static const uint64_t nsPerTick = 1000000000ULL / static_cast<uint64_t>(sysconf(_SC_CLK_TCK));
+
+    QHash<qint64, QString> children;
+    {
+        QMutexLocker locker(&s_childMutex);
+        children = s_children;
+    }
+
+    int64_t nowNs = steadyNowNs();
+    double elapsedNs = m_lastChildSampleNs > 0 ? static_cast<double>(nowNs - m_lastChildSampleNs) : 0.0;
+    m_lastChildSampleNs = nowNs;
+
+    // 同名子进程合并；首次采样只建立基线
+    QMap<QString, double> percent;
+    QMap<QString, int64_t> rssKB;
+    QHash<qint64, uint64_t> baselines;
+    for (auto it = children.constBegin(); it != children.constEnd(); ++it) {
+        QString dir = QString("/proc/%1").arg(it.key());
+        QList<QByteArray> fields;
+        if (!parseStat(readProcFile(dir + "/stat"), nullptr, &fields)) {
+            continue;  // 已退出
+        }
+        uint64_t cpuNs = (fields.at(11).toULongLong() + fields.at(12).toULongLong()) * nsPerTick;
+        baselines.insert(it.key(), cpuNs);
+        double& groupPercent = percent[it.value()];
+        auto last = m_lastChildNs.constFind(it.key());
+        if (elapsedNs > 0.0 && last != m_lastChildNs.constEnd() && cpuNs >= last.value()) {
+            groupPercent += (cpuNs - last.value()) / elapsedNs * 100.0;
+        }
+        int64_t rss = readKB("\n" + readProcFile(dir + "/status"), "VmRSS");
+        if (rss > 0) {
+            rssKB[it.value()] += rss;
+        }
+    }
+    m_lastChildNs.swap(baselines);
+    for (const QString& name : m_publishedChildren) {
+        if (!percent.contains(name)) {
+            percent.insert(name, 0.0);
+        }
+    }
+
+    MetricsRegistry* registry = MetricsRegistry::instance();
+    for (auto it = percent.constBegin(); it != percent.constEnd(); ++it) {
+        QString labels = MetricsRegistry::label("process", it.key());
+        registry->gauge("child_process_cpu_percent", "Child process CPU usage over the last interval (100 = one core)",
+                        labels)->set(it.value());
+        registry->gauge("child_process_memory_kb", "Child process RSS", labels)->set(rssKB.value(it.key(), 0));
+        m_publishedChildren.insert(it.key());
+    }
+}
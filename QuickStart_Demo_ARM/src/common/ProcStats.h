@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <cstdint>
+
+/**
+ * 进程/系统运行状态采样 (Linux procfs / sysfs)
+ * 每次 sampleThreads 读取 /proc/self/task/<tid>/stat 和 schedstat，按与上次采样之间的差值计算各线程占用；
+ * 文件读取在调用线程完成，适合 1 秒量级的定时采样，不要在实时线程中调用
+ *
+ * 线程名来自 pthread_setname_np (ThreadPolicy: audio-in / audio-out / video-capture，SDK 和 GStreamer
+ * 线程有各自的名字)，主线程固定显示为 "gui"
+ *
+ * 程序启动的子进程 (例如麦克风采集的 arecord) 不在本进程的线程中，由启动方登记 pid 后一并采样
+ */
+class ProcStats {
+public:
+    struct ThreadCpu {
+        int tid = 0;
+        QString name;
+        double percent = 0.0;       // 100 表示占满一个核
+        double waitPercent = 0.0;   // 可运行但在运行队列中等待的时间占比 (schedstat)，偏高说明被抢占
+        // 累计值 (线程启动以来)
+        uint64_t cpuNs = 0;         // schedstat 的运行时间，不可用时由 utime+stime 换算 (精度为一个时钟节拍)
+        uint64_t waitNs = 0;
+        uint64_t minorFaults = 0;
+        uint64_t majorFaults = 0;   // 需要读盘的缺页，实时线程中出现即会造成卡顿
+    };
+
+    struct Memory {
+        int64_t rssKB = -1;         // 读不到时为负
+        int64_t pssKB = -1;         // 按共享比例分摊的内存 (smaps_rollup，内核 4.14+)
+        int64_t peakRssKB = -1;
+        uint64_t minorFaults = 0;
+        uint64_t majorFaults = 0;
+        int threads = 0;
+    };
+
+    // 各线程在上次调用以来的 CPU 占用，从高到低排序；首次调用只建立基线，返回空
+    QList<ThreadCpu> sampleThreads();
+    // 同一采样区间内整个进程的 CPU 占用
+    double processPercent() const { return m_processPercent; }
+
+    // 进程内存与缺页 (/proc/self/status、smaps_rollup、stat)
+    static Memory sampleMemory();
+
+    // SoC 温度 (摄氏度)，取第一个可读的 thermal zone，读不到时返回负数
+    static double socTemperatureC();
+
+    // 登记/注销子进程，可在任意线程调用；退出的子进程在下次采样时占用置 0
+    static void registerChildProcess(const QString& name, qint64 pid);
+    static void unregisterChildProcess(qint64 pid);
+
+    // 采样一次并写入指标注册表 (thread_* / process_* / child_process_* / soc_temperature_celsius)。
+    // 同名线程 (例如 SDK 的线程池) 合并为一组；线程退出后该组占用置 0
+    void publishMetrics();
+
+private:
+    struct Baseline {
+        uint64_t cpuNs = 0;
+        uint64_t waitNs = 0;
+    };
+
+    void publishChildProcesses();
+
+    QHash<int, Baseline> m_last;
+    int64_t m_lastSampleNs = 0;
+    double m_processPercent = 0.0;
+    QSet<QString> m_publishedThreads;
+
+    // 子进程 CPU 时间基线 (pid -> utime+stime 纳秒)
+    QHash<qint64, uint64_t> m_lastChildNs;
+    int64_t m_lastChildSampleNs = 0;
+    QSet<QString> m_publishedChildren;
+
+    static QMutex s_childMutex;
+    static QHash<qint64, QString> s_children;
+};
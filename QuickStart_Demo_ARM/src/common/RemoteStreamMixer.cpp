@@ -0,0 +1,225 @@
+#include "RemoteStreamMixer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+static const int64_t STREAM_TIMEOUT_US = 2000000;
+
+static int64_t nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RemoteStreamMixer::RemoteStreamMixer()
+{
+}
+
+RemoteStreamMixer::~RemoteStreamMixer()
+{
+}
+
+void RemoteStreamMixer::configure(int sampleRate, int channels, int maxStreams,
+                                  int minDelayMs, int maxDelayMs, int maxBlockFrames)
+{
+    m_channels = channels > 0 ? channels : 1;
+    m_slots.clear();
+    for (int i = 0; i < std::max(1, maxStreams); i++) {
+        std::unique_ptr<Slot> slot(new Slot());
+        slot->jitter.configure(sampleRate, m_channels, minDelayMs, maxDelayMs, 1000, maxBlockFrames);
+        m_slots.push_back(std::move(slot));
+    }
+    m_mixer.setCapacity(maxBlockFrames * m_channels);
+    m_scratch.assign(static_cast<size_t>(maxBlockFrames) * m_channels, 0);
+    m_leadIndex = -1;
+    m_activeCount = 0;
+}
+
+void RemoteStreamMixer::setPriorityUser(const std::string& userId)
+{
+    m_priorityUser = userId;
+}
+
+void RemoteStreamMixer::setGains(int priorityPercent, int otherPercent, int duckOthersPercent)
+{
+    m_priorityGain = AudioMixer::gainFromPercent(priorityPercent);
+    m_otherGain = AudioMixer::gainFromPercent(otherPercent);
+    m_duckOthersGain = AudioMixer::gainFromPercent(std::min(otherPercent, duckOthersPercent));
+}
+
+RemoteStreamMixer::Slot* RemoteStreamMixer::findSlot(const char* streamId)
+{
+    for (const std::unique_ptr<Slot>& slot : m_slots) {
+        if (slot->state.load(std::memory_order_acquire) == SlotActive &&
+            strncmp(slot->streamId, streamId, MAX_ID_LENGTH - 1) == 0) {
+            return slot.get();
+        }
+    }
+    return nullptr;
+}
+
+RemoteStreamMixer::Slot* RemoteStreamMixer::claimSlot(const char* streamId, const char* userId)
+{
+    for (const std::unique_ptr<Slot>& slot : m_slots) {
+        int expected = SlotFree;
+        if (slot->state.compare_exchange_strong(expected, SlotClaimed)) {
+            // 认领期间只有生产者访问 streamId/priority，消费者跳过该槽位
+            strncpy(slot->streamId, streamId, MAX_ID_LENGTH - 1);
+            slot->streamId[MAX_ID_LENGTH - 1] = '\0';
+            slot->priority = !m_priorityUser.empty() && userId && m_priorityUser == userId;
+            slot->lastPushUs.store(nowUs(), std::memory_order_relaxed);
+            slot->state.store(SlotActive, std::memory_order_release);
+            m_activeCount.fetch_add(1, std::memory_order_relaxed);
+            return slot.get();
+        }
+    }
+    return nullptr;
+}
+
+void RemoteStreamMixer::push(const char* streamId, const char* userId, const int16_t* samples, int frames)
+{
+    if (!streamId || !samples || frames <= 0 || m_slots.empty()) {
+        return;
+    }
+
+    Slot* slot = findSlot(streamId);
+    if (!slot) {
+        bool priority = !m_priorityUser.empty() && userId && m_priorityUser == userId;
+        int gain = priority ? m_priorityGain.load(std::memory_order_relaxed)
+                            : m_otherGain.load(std::memory_order_relaxed);
+        if (gain == 0) {
+            return;
+        }
+        slot = claimSlot(streamId, userId);
+        if (!slot) {
+            return;
+        }
+    }
+
+    int gain = slot->priority ? m_priorityGain.load(std::memory_order_relaxed)
+                              : m_otherGain.load(std::memory_order_relaxed);
+    if (gain == 0) {
+        // 听不见的流不缓冲；保持活跃时间，避免槽位反复认领
+        slot->lastPushUs.store(nowUs(), std::memory_order_relaxed);
+        return;
+    }
+
+    slot->busy.store(true);
+    if (slot->state.load() == SlotActive) {
+        slot->jitter.push(samples, frames);
+        slot->lastPushUs.store(nowUs(), std::memory_order_relaxed);
+    }
+    slot->busy.store(false);
+}
+
+void RemoteStreamMixer::retireIdle(int64_t now)
+{
+    for (const std::unique_ptr<Slot>& slot : m_slots) {
+        if (slot->state.load(std::memory_order_acquire) != SlotActive ||
+            now - slot->lastPushUs.load(std::memory_order_relaxed) < STREAM_TIMEOUT_US ||
+            slot->jitter.isPlaying()) {
+            continue;
+        }
+        int expected = SlotActive;
+        if (!slot->state.compare_exchange_strong(expected, SlotRetiring)) {
+            continue;
+        }
+        // 等待可能正在进行的写入结束，之后生产者不会再访问该槽位
+        while (slot->busy.load()) {
+            std::this_thread::yield();
+        }
+        slot->jitter.reset();
+        slot->state.store(SlotFree, std::memory_order_release);
+        m_activeCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+int RemoteStreamMixer::pop(int16_t* out, int frames)
+{
+    int samples = frames * m_channels;
+    retireIdle(nowUs());
+
+    // 先混优先流，根据它是否在发声决定其他流的增益
+    int priorityGain = m_priorityGain.load(std::memory_order_relaxed);
+    int otherGain = m_otherGain.load(std::memory_order_relaxed);
+    int priorityReal = 0;
+    int realFrames = 0;
+    int lead = -1;
+
+    m_mixer.begin(samples);
+    for (int pass = 0; pass < 2; pass++) {
+        bool priorityPass = pass == 0;
+        int gain = priorityPass ? priorityGain
+                                : (priorityReal > 0 ? m_duckOthersGain.load(std::memory_order_relaxed) : otherGain);
+        for (size_t i = 0; i < m_slots.size(); i++) {
+            Slot* slot = m_slots[i].get();
+            if (slot->priority != priorityPass || slot->state.load(std::memory_order_acquire) != SlotActive) {
+                continue;
+            }
+            if (lead < 0) {
+                lead = static_cast<int>(i);
+            }
+            if (gain == 0) {
+                // 运行中增益调到 0 的流直接丢弃缓冲，不参与混音
+                slot->jitter.flush();
+                continue;
+            }
+            int real = slot->jitter.pop(m_scratch.data(), frames);
+            m_mixer.add(m_scratch.data(), gain);
+            realFrames = std::max(realFrames, real);
+            if (priorityPass) {
+                priorityReal = std::max(priorityReal, real);
+            }
+        }
+    }
+    m_mixer.end(out);
+    m_leadIndex.store(lead, std::memory_order_relaxed);
+    return realFrames;
+}
+
+int RemoteStreamMixer::flush()
+{
+    int dropped = 0;
+    for (const std::unique_ptr<Slot>& slot : m_slots) {
+        if (slot->state.load(std::memory_order_acquire) == SlotActive) {
+            dropped = std::max(dropped, slot->jitter.flush());
+        }
+    }
+    return dropped;
+}
+
+RemoteStreamMixer::Slot* RemoteStreamMixer::leadSlot() const
+{
+    int lead = m_leadIndex.load(std::memory_order_relaxed);
+    return lead >= 0 && lead < static_cast<int>(m_slots.size()) ? m_slots[lead].get() : nullptr;
+}
+
+int RemoteStreamMixer::depthFrames() const
+{
+    Slot* slot = leadSlot();
+    return slot ? slot->jitter.depthFrames() : 0;
+}
+
+int RemoteStreamMixer::targetFrames() const
+{
+    Slot* slot = leadSlot();
+    return slot ? slot->jitter.targetFrames() : 0;
+}
+
+bool RemoteStreamMixer::isPlaying() const
+{
+    Slot* slot = leadSlot();
+    return slot && slot->jitter.isPlaying();
+}
+
+JitterBuffer::Stats RemoteStreamMixer::stats() const
+{
+    Slot* slot = leadSlot();
+    return slot ? slot->jitter.stats() : JitterBuffer::Stats();
+}
+
+int RemoteStreamMixer::activeStreams() const
+{
+    return m_activeCount.load(std::memory_order_relaxed);
+}
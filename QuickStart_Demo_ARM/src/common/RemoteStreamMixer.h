@@ -0,0 +1,77 @@
+#pragma once
+
+#include "AudioMixer.h"
+#include "JitterBuffer.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * 远端分流混音 (交错 int16)
+ * SDK 回调线程按流 push，播放线程 pop 时逐流取出并按增益混音；
+ * 每路流有独立的抖动缓冲，流槽位在 configure 时预分配，读写过程不加锁不分配
+ *
+ * - 优先用户 (AI 智能体) 的流按 priorityGain 混入，其发声期间其他流闪避到 duckOthersGain
+ * - 增益为 0 的流既不缓冲也不参与混音，CPU 开销只随可听见的流数线性增长
+ * - 超过 2 秒没有数据且已播完的流释放槽位；槽位用完后新流被忽略
+ */
+class RemoteStreamMixer {
+public:
+    RemoteStreamMixer();
+    ~RemoteStreamMixer();
+
+    // 分配槽位和缓冲 (非线程安全，需在 push/pop 开始前调用)
+    void configure(int sampleRate, int channels, int maxStreams,
+                   int minDelayMs, int maxDelayMs, int maxBlockFrames);
+    // 优先用户 ID，需在 push 开始前设置
+    void setPriorityUser(const std::string& userId);
+    // 线程安全，百分比
+    void setGains(int priorityPercent, int otherPercent, int duckOthersPercent);
+
+    // 生产者 (SDK 回调线程)
+    void push(const char* streamId, const char* userId, const int16_t* samples, int frames);
+
+    // 消费者 (播放线程): 总是输出 frames 帧的混音，返回其中真实音频的帧数 (各流取最大)
+    int pop(int16_t* out, int frames);
+    // 消费者: 丢弃所有流中缓冲的数据，返回丢弃的帧数 (各流取最大)
+    int flush();
+    // 消费者: 主导流 (优先用户，否则第一路活动流) 的缓冲状态，用于漂移补偿
+    int depthFrames() const;
+    int targetFrames() const;
+    bool isPlaying() const;
+
+    // 任意线程
+    JitterBuffer::Stats stats() const;   // 主导流
+    int activeStreams() const;
+
+private:
+    enum SlotState { SlotFree, SlotClaimed, SlotActive, SlotRetiring };
+    static const int MAX_ID_LENGTH = 128;
+
+    struct Slot {
+        std::atomic<int> state{SlotFree};
+        std::atomic<bool> busy{false};      // 生产者正在写入，回收前需等待
+        std::atomic<int64_t> lastPushUs{0};
+        char streamId[MAX_ID_LENGTH] = {0};
+        bool priority = false;
+        JitterBuffer jitter;
+    };
+
+    Slot* findSlot(const char* streamId);
+    Slot* claimSlot(const char* streamId, const char* userId);
+    void retireIdle(int64_t nowUs);
+    Slot* leadSlot() const;
+
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    std::string m_priorityUser;
+    std::atomic<int> m_priorityGain{AudioMixer::UNITY_GAIN};
+    std::atomic<int> m_otherGain{AudioMixer::UNITY_GAIN};
+    std::atomic<int> m_duckOthersGain{AudioMixer::UNITY_GAIN};
+    std::atomic<int> m_leadIndex{-1};
+    std::atomic<int> m_activeCount{0};
+
+    int m_channels = 1;
+    AudioMixer m_mixer;
+    std::vector<int16_t> m_scratch;
+};
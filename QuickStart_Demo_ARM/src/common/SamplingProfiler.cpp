@@ -0,0 +1,369 @@
+#include "SamplingProfiler.h"
+#include "Logger.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QSocketNotifier>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <map>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#define LOG_MODULE "Profiler"
+
+// 每线程环形缓冲的数据页数 (2 的幂)。perf 缓冲计入 perf_event_mlock_kb 限额，线程多时不宜过大
+static const int DATA_PAGES = 4;
+static const int POLL_INTERVAL_MS = 50;
+static const int MAX_STACK_DEPTH = 64;
+
+namespace {
+
+int s_triggerPipe[2] = {-1, -1};
+
+void onTriggerSignal(int)
+{
+    // 信号处理函数中只写管道，开始/结束在主线程完成
+    char byte = 1;
+    ssize_t written = write(s_triggerPipe[1], &byte, 1);
+    (void)written;
+}
+
+struct RingBuffer {
+    int tid = 0;
+    int fd = -1;
+    uint8_t* base = nullptr;
+};
+
+// 键: 线程 tid + 调用栈 (叶子在前)
+struct Samples {
+    std::map<std::vector<uint64_t>, uint64_t> stacks;
+    uint64_t total = 0;
+    uint64_t lost = 0;
+};
+
+// 样本布局 (sample_type = TID | CALLCHAIN): header, u32 pid, u32 tid, u64 nr, u64 ips[nr]
+void parseRecord(const uint8_t* record, size_t size, Samples* samples)
+{
+    perf_event_header header;
+    memcpy(&header, record, sizeof(header));
+    if (header.type == PERF_RECORD_LOST && size >= sizeof(header) + 16) {
+        uint64_t lost = 0;
+        memcpy(&lost, record + sizeof(header) + 8, sizeof(lost));
+        samples->lost += lost;
+        return;
+    }
+    if (header.type != PERF_RECORD_SAMPLE || size < sizeof(header) + 16) {
+        return;
+    }
+    uint32_t tid = 0;
+    uint64_t nr = 0;
+    memcpy(&tid, record + sizeof(header) + 4, sizeof(tid));
+    memcpy(&nr, record + sizeof(header) + 8, sizeof(nr));
+    const uint8_t* ips = record + sizeof(header) + 16;
+    if (nr > (size - sizeof(header) - 16) / sizeof(uint64_t)) {
+        return;
+    }
+
+    std::vector<uint64_t> key;
+    key.reserve(nr + 1);
+    key.push_back(tid);
+    for (uint64_t i = 0; i < nr; i++) {
+        uint64_t ip = 0;
+        memcpy(&ip, ips + i * sizeof(uint64_t), sizeof(ip));
+        if (ip >= PERF_CONTEXT_MAX) {
+            continue;  // PERF_CONTEXT_USER 等上下文标记
+        }
+        key.push_back(ip);
+    }
+    samples->stacks[key]++;
+    samples->total++;
+}
+
+// 读出 data_tail..data_head 之间的记录；跨越缓冲末尾的记录先拼接再解析
+void drain(const RingBuffer& ring, size_t pageSize, Samples* samples)
+{
+    perf_event_mmap_page* meta = reinterpret_cast<perf_event_mmap_page*>(ring.base);
+    const uint8_t* data = ring.base + pageSize;
+    const uint64_t dataSize = static_cast<uint64_t>(DATA_PAGES) * pageSize;
+
+    uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+    uint64_t tail = meta->data_tail;
+    std::vector<uint8_t> record;
+    while (tail + sizeof(perf_event_header) <= head) {
+        perf_event_header header;
+        for (size_t i = 0; i < sizeof(header); i++) {
+            reinterpret_cast<uint8_t*>(&header)[i] = data[(tail + i) % dataSize];
+        }
+        if (header.size < sizeof(header) || tail + header.size > head) {
+            break;
+        }
+        uint64_t offset = tail % dataSize;
+        if (offset + header.size <= dataSize) {
+            parseRecord(data + offset, header.size, samples);
+        } else {
+            record.resize(header.size);
+            size_t first = static_cast<size_t>(dataSize - offset);
+            memcpy(record.data(), data + offset, first);
+            memcpy(record.data() + first, data, header.size - first);
+            parseRecord(record.data(), header.size, samples);
+        }
+        tail += header.size;
+    }
+    __atomic_store_n(&meta->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+QString symbolize(uint64_t address, QHash<uint64_t, QString>* cache)
+{
+    auto cached = cache->constFind(address);
+    if (cached != cache->constEnd()) {
+        return cached.value();
+    }
+    QString name;
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(address), &info) && info.dli_sname) {
+        int status = -1;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        name = QString::fromUtf8(status == 0 && demangled ? demangled : info.dli_sname);
+        free(demangled);
+    } else if (info.dli_fname) {
+        // 未导出的符号: 模块名 + 偏移，可用 addr2line -e <模块> <偏移> 还原
+        name = QString("%1+0x%2").arg(QFileInfo(QString::fromUtf8(info.dli_fname)).fileName())
+            .arg(address - reinterpret_cast<uintptr_t>(info.dli_fbase), 0, 16);
+    } else {
+        name = QString("0x%1").arg(address, 0, 16);
+    }
+    // 分号是折叠栈的分隔符
+    name.replace(';', ':');
+    cache->insert(address, name);
+    return name;
+}
+
+QString threadName(int tid)
+{
+    if (tid == static_cast<int>(getpid())) {
+        return "gui";  // 与 ProcStats 一致
+    }
+    QFile file(QString("/proc/self/task/%1/comm").arg(tid));
+    QString name = file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll().trimmed()) : QString();
+    name.replace(';', ':').replace(' ', '_');
+    return name.isEmpty() ? QString::number(tid) : name;
+}
+
+} // namespace
+
+SamplingProfiler::SamplingProfiler(QObject* parent)
+    : QThread(parent)
+{
+}
+
+SamplingProfiler::~SamplingProfiler()
+{
+    stopProfile();
+    wait();
+}
+
+void SamplingProfiler::setConfig(const Config& config)
+{
+    m_config = config;
+    m_config.frequencyHz = qBound(0, m_config.frequencyHz, 1000);
+    m_config.maxSeconds = qMax(1, m_config.maxSeconds);
+}
+
+QString SamplingProfiler::startProfile(int seconds, QString* error)
+{
+    if (!isAvailable()) {
+        *error = "profiler disabled (telemetry.profiler.frequencyHz is 0)";
+        return QString();
+    }
+    if (isRunning()) {
+        *error = "already profiling";
+        return QString();
+    }
+    QString dir = m_config.outputDir.isEmpty() ? QDir::tempPath() : m_config.outputDir;
+    QDir().mkpath(dir);
+    QString path = QDir(dir).filePath(QString("profile-%1.folded")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss")));
+    {
+        QMutexLocker locker(&m_mutex);
+        m_outputPath = path;
+    }
+    m_seconds = qBound(1, seconds, m_config.maxSeconds);
+    m_stopRequested = false;
+    start();
+    LOG_INFO(QString("Profiling %1 s at %2 Hz -> %3").arg(m_seconds).arg(m_config.frequencyHz).arg(path));
+    return path;
+}
+
+void SamplingProfiler::stopProfile()
+{
+    m_stopRequested = true;
+}
+
+QString SamplingProfiler::outputPath() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_outputPath;
+}
+
+void SamplingProfiler::installSignalTrigger()
+{
+    if (!isAvailable() || s_triggerPipe[0] >= 0) {
+        return;
+    }
+    if (pipe2(s_triggerPipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        LOG_WARN("Failed to create profiler trigger pipe");
+        return;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onTriggerSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+
+    QSocketNotifier* notifier = new QSocketNotifier(s_triggerPipe[0], QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, [this]() {
+        char bytes[16];
+        while (read(s_triggerPipe[0], bytes, sizeof(bytes)) > 0) {
+        }
+        if (isRunning()) {
+            stopProfile();
+            return;
+        }
+        QString error;
+        if (startProfile(m_config.maxSeconds, &error).isEmpty()) {
+            LOG_WARN(QString("Profiler not started: %1").arg(error));
+        }
+    });
+    LOG_INFO(QString("Send SIGUSR1 (kill -USR1 %1) to profile for up to %2 s").arg(getpid()).arg(m_config.maxSeconds));
+}
+
+void SamplingProfiler::run()
+{
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t mapSize = (1 + DATA_PAGES) * pageSize;
+    const int selfTid = static_cast<int>(syscall(SYS_gettid));
+
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_SOFTWARE;
+    attr.config = PERF_COUNT_SW_CPU_CLOCK;
+    attr.freq = 1;
+    attr.sample_freq = static_cast<uint64_t>(m_config.frequencyHz);
+    attr.sample_type = PERF_SAMPLE_TID | PERF_SAMPLE_CALLCHAIN;
+    attr.sample_max_stack = MAX_STACK_DEPTH;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.exclude_callchain_kernel = 1;
+    // 缓冲过半时唤醒 poll，否则按 POLL_INTERVAL_MS 轮询
+    attr.watermark = 1;
+    attr.wakeup_watermark = static_cast<uint32_t>(DATA_PAGES * pageSize / 2);
+
+    // 每个线程一个事件和一块环形缓冲
+    std::vector<RingBuffer> rings;
+    QHash<int, QString> names;
+    int openErrno = 0;
+    const QStringList tids = QDir("/proc/self/task").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& tidName : tids) {
+        int tid = tidName.toInt();
+        if (tid == selfTid) {
+            continue;
+        }
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, tid, -1, -1, PERF_FLAG_FD_CLOEXEC));
+        if (fd < 0) {
+            openErrno = errno;
+            continue;
+        }
+        void* base = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (base == MAP_FAILED) {
+            openErrno = errno;
+            close(fd);
+            continue;
+        }
+        RingBuffer ring;
+        ring.tid = tid;
+        ring.fd = fd;
+        ring.base = static_cast<uint8_t*>(base);
+        rings.push_back(ring);
+        names.insert(tid, threadName(tid));
+    }
+    if (rings.empty()) {
+        LOG_WARN(QString("perf_event_open failed: %1 (kernel.perf_event_paranoid must be <= 2)")
+                 .arg(strerror(openErrno)));
+        return;
+    }
+    if (rings.size() < static_cast<size_t>(tids.size() - 1)) {
+        LOG_WARN(QString("Sampling %1 of %2 threads: %3").arg(rings.size()).arg(tids.size() - 1)
+                 .arg(strerror(openErrno)));
+    }
+
+    std::vector<pollfd> pollFds;
+    for (const RingBuffer& ring : rings) {
+        ioctl(ring.fd, PERF_EVENT_IOC_ENABLE, 0);
+        pollfd entry;
+        entry.fd = ring.fd;
+        entry.events = POLLIN;
+        entry.revents = 0;
+        pollFds.push_back(entry);
+    }
+
+    Samples samples;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(m_seconds);
+    while (!m_stopRequested && std::chrono::steady_clock::now() < deadline) {
+        poll(pollFds.data(), pollFds.size(), POLL_INTERVAL_MS);
+        for (const RingBuffer& ring : rings) {
+            drain(ring, pageSize, &samples);
+        }
+    }
+    for (const RingBuffer& ring : rings) {
+        ioctl(ring.fd, PERF_EVENT_IOC_DISABLE, 0);
+        drain(ring, pageSize, &samples);
+        munmap(ring.base, mapSize);
+        close(ring.fd);
+    }
+
+    // 折叠: 根在前，同一符号序列的栈合并 (不同返回地址可能落在同一函数)
+    QHash<uint64_t, QString> symbols;
+    QMap<QString, uint64_t> folded;
+    for (const auto& entry : samples.stacks) {
+        const std::vector<uint64_t>& key = entry.first;
+        QString line = names.value(static_cast<int>(key[0]), QString::number(key[0]));
+        for (size_t i = key.size() - 1; i >= 1; i--) {
+            // 除叶子外都是返回地址，减 1 落回调用指令所在的函数
+            line += ';' + symbolize(i == 1 ? key[i] : key[i] - 1, &symbols);
+        }
+        folded[line] += entry.second;
+    }
+
+    QString path = outputPath();
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOG_WARN(QString("Failed to write %1").arg(path));
+        return;
+    }
+    for (auto it = folded.constBegin(); it != folded.constEnd(); ++it) {
+        file.write(it.key().toUtf8());
+        file.write(" ");
+        file.write(QByteArray::number(static_cast<qulonglong>(it.value())));
+        file.write("\n");
+    }
+    file.close();
+    LOG_INFO(QString("Profile (%1 samples, %2 lost, %3 threads, %4 stacks) written to %5")
+             .arg(samples.total).arg(samples.lost).arg(rings.size()).arg(folded.size()).arg(path));
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <atomic>
+
+/**
+ * 按需采样分析器 (perf_event_open，软件 cpu-clock 事件，不依赖硬件 PMU)
+ * 一个采样窗口内为进程的每个线程打开一个事件，调用栈由内核按帧指针回溯 (只采用户态，
+ * 编译时需 -fno-omit-frame-pointer；SDK 等未保留帧指针的库中调用栈会截断)，
+ * 窗口结束后用 dladdr 符号化 (可执行文件需 -rdynamic)，写出折叠栈文件:
+ *   线程名;最外层函数;...;叶子函数 采样数
+ * 可直接交给 flamegraph.pl 或 speedscope
+ *
+ * 采样在独立线程中读取环形缓冲，窗口外不打开任何事件，没有开销。
+ * 窗口开始后新建的线程不会被采样。内核 perf_event_paranoid 大于 2 时无法打开事件
+ */
+class SamplingProfiler : public QThread {
+    Q_OBJECT
+
+public:
+    struct Config {
+        int frequencyHz = 0;        // 0 表示不启用
+        int maxSeconds = 30;        // 单个窗口的上限
+        QString outputDir;          // 为空时写到临时目录
+    };
+
+    explicit SamplingProfiler(QObject* parent = nullptr);
+    ~SamplingProfiler() override;
+
+    void setConfig(const Config& config);
+    bool isAvailable() const { return m_config.frequencyHz > 0; }
+    int maxSeconds() const { return m_config.maxSeconds; }
+
+    // 开始一个采样窗口 (秒数限制在 1..maxSeconds)，返回将要写出的文件路径；
+    // 未启用或已在采样时返回空并给出原因
+    QString startProfile(int seconds, QString* error);
+    // 提前结束窗口，已采到的样本照常写出
+    void stopProfile();
+    // 最近一次写出 (或正在采样) 的文件
+    QString outputPath() const;
+
+    // kill -USR1 <pid>: 未在采样时开始 maxSeconds 秒的窗口，采样中则提前结束
+    void installSignalTrigger();
+
+protected:
+    void run() override;
+
+private:
+    Config m_config;
+    int m_seconds = 0;
+    std::atomic<bool> m_stopRequested{false};
+    mutable QMutex m_mutex;
+    QString m_outputPath;
+};
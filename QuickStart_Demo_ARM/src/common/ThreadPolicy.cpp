@@ -0,0 +1,297 @@
+#include "ThreadPolicy.h"
+#include "AllocAudit.h"
+#include "Logger.h"
+#include <QDBusConnection>
+#include <QDBusInterface>
+#include <QDBusReply>
+#include <QMutexLocker>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define LOG_MODULE "ThreadPolicy"
+
+QMutex DeadlineMonitor::s_registryMutex;
+QList<DeadlineMonitor*> DeadlineMonitor::s_registry;
+
+// rtkit 要求 RLIMIT_RTTIME 硬限制不超过该值，否则拒绝授予实时调度
+static const rlim_t RTKIT_RTTIME_US = 200000;
+// 预触碰的栈大小
+static const size_t PREFAULT_STACK_SIZE = 64 * 1024;
+
+ThreadPolicyConfig::Scheduler ThreadPolicyConfig::schedulerFromString(const QString& value)
+{
+    QString v = value.trimmed().toLower();
+    if (v == "fifo" || v == "sched_fifo") {
+        return Fifo;
+    }
+    if (v == "rr" || v == "sched_rr" || v == "roundrobin") {
+        return RoundRobin;
+    }
+    return Other;
+}
+
+QString ThreadPolicyConfig::schedulerToString(Scheduler scheduler)
+{
+    switch (scheduler) {
+        case Fifo:       return "fifo";
+        case RoundRobin: return "rr";
+        case Other:
+        default:         return "other";
+    }
+}
+
+bool ThreadPolicy::applyToCurrentThread(const ThreadPolicyConfig& config)
+{
+    if (!config.name.isEmpty()) {
+        // 内核限制线程名 15 个字符
+        QByteArray name = config.name.toUtf8().left(15);
+        pthread_setname_np(pthread_self(), name.constData());
+    }
+
+    setAffinity(config.cpus);
+
+    if (config.lockMemory) {
+        prefaultStack();
+    }
+
+    if (config.scheduler == ThreadPolicyConfig::Other) {
+        return true;
+    }
+
+    int policy = (config.scheduler == ThreadPolicyConfig::Fifo) ? SCHED_FIFO : SCHED_RR;
+    int minPrio = sched_get_priority_min(policy);
+    int maxPrio = sched_get_priority_max(policy);
+    int priority = qBound(minPrio, config.priority, maxPrio);
+
+    if (setRealtime(policy, priority)) {
+        LOG_INFO(QString("%1: %2 priority %3")
+                 .arg(config.name, ThreadPolicyConfig::schedulerToString(config.scheduler))
+                 .arg(priority));
+        return true;
+    }
+
+    // 回退 1: 提升 RLIMIT_RTPRIO 软限制
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_max > 0) {
+        if (limit.rlim_cur < limit.rlim_max) {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_RTPRIO, &limit);
+        }
+        int clamped = qMin<int>(priority, static_cast<int>(limit.rlim_cur));
+        if (clamped >= minPrio && setRealtime(policy, clamped)) {
+            LOG_INFO(QString("%1: %2 priority %3 (clamped by RLIMIT_RTPRIO)")
+                     .arg(config.name, ThreadPolicyConfig::schedulerToString(config.scheduler))
+                     .arg(clamped));
+            return true;
+        }
+    }
+
+    // 回退 2: rtkit (只支持 SCHED_RR)
+    if (setRealtimeViaRtkit(priority)) {
+        LOG_INFO(QString("%1: realtime granted by rtkit").arg(config.name));
+        return true;
+    }
+
+    LOG_WARN(QString("%1: realtime scheduling unavailable, staying on SCHED_OTHER").arg(config.name));
+    return false;
+}
+
+bool ThreadPolicy::setRealtime(int policy, int priority)
+{
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), policy, &param) == 0;
+}
+
+bool ThreadPolicy::setRealtimeViaRtkit(int priority)
+{
+    QDBusConnection bus = QDBusConnection::systemBus();
+    if (!bus.isConnected()) {
+        return false;
+    }
+
+    QDBusInterface rtkit("org.freedesktop.RealtimeKit1", "/org/freedesktop/RealtimeKit1",
+                         "org.freedesktop.RealtimeKit1", bus);
+    if (!rtkit.isValid()) {
+        return false;
+    }
+
+    // rtkit 会限制最大优先级
+    QVariant maxPrio = rtkit.property("MaxRealtimePriority");
+    if (maxPrio.isValid() && maxPrio.toInt() > 0) {
+        priority = qMin(priority, maxPrio.toInt());
+    }
+
+    // RLIMIT_RTTIME 是进程级限制，对进程内所有实时线程生效 (不阻塞连续运行超过限制会收到 SIGXCPU)，
+    // 而且非 root 无法再调高硬限制，所以只在确实走 rtkit 时设置，已经更低时不改动
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_RTTIME, &limit) != 0 || limit.rlim_max == RLIM_INFINITY ||
+        limit.rlim_max > RTKIT_RTTIME_US) {
+        limit.rlim_cur = RTKIT_RTTIME_US;
+        limit.rlim_max = RTKIT_RTTIME_US;
+        setrlimit(RLIMIT_RTTIME, &limit);
+    }
+
+    quint64 tid = static_cast<quint64>(syscall(SYS_gettid));
+    QDBusReply<void> reply = rtkit.call("MakeThreadRealtime", tid, static_cast<quint32>(priority));
+    if (!reply.isValid()) {
+        LOG_DEBUG(QString("rtkit refused: %1").arg(reply.error().message()));
+        return false;
+    }
+    return true;
+}
+
+void ThreadPolicy::setAffinity(const QList<int>& cpus)
+{
+    if (cpus.isEmpty()) {
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    long cpuCount = sysconf(_SC_NPROCESSORS_CONF);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < cpuCount) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (CPU_COUNT(&set) == 0) {
+        return;
+    }
+
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0) {
+        LOG_WARN(QString("pthread_setaffinity_np failed: %1").arg(strerror(ret)));
+    }
+}
+
+bool ThreadPolicy::lockBuffer(const void* addr, size_t size)
+{
+    if (!addr || size == 0) {
+        return false;
+    }
+    if (mlock(addr, size) != 0) {
+        LOG_WARN(QString("mlock(%1 bytes) failed: %2").arg(size).arg(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+void ThreadPolicy::unlockBuffer(const void* addr, size_t size)
+{
+    if (addr && size > 0) {
+        munlock(addr, size);
+    }
+}
+
+void ThreadPolicy::prefaultStack()
+{
+    // 逐页经 volatile 左值写入: 对去掉 volatile 的指针 memset 是未定义行为，可能被编译器整个删掉
+    volatile unsigned char stack[PREFAULT_STACK_SIZE];
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    for (size_t i = 0; i < sizeof(stack); i += pageSize) {
+        stack[i] = 0;
+    }
+    stack[sizeof(stack) - 1] = 0;
+}
+
+// ==================== DeadlineMonitor ====================
+
+DeadlineMonitor::DeadlineMonitor(const QString& name, int periodUs, int toleranceUs)
+    : m_name(name)
+    , m_periodUs(periodUs)
+    , m_toleranceUs(toleranceUs >= 0 ? toleranceUs : periodUs / 2)
+{
+    {
+        QMutexLocker locker(&s_registryMutex);
+        s_registry.append(this);
+    }
+    // 监测对象在实时循环所在线程内构造，同时登记稳态分配审计 (ALLOC_AUDIT 构建)
+    AllocAudit::registerThread(m_name);
+}
+
+DeadlineMonitor::~DeadlineMonitor()
+{
+    AllocAudit::unregisterThread();
+    QMutexLocker locker(&s_registryMutex);
+    s_registry.removeAll(this);
+}
+
+void DeadlineMonitor::tick()
+{
+    Clock::time_point now = Clock::now();
+    const auto period = std::chrono::microseconds(m_periodUs);
+    AllocAudit::endCycle();
+
+    if (!m_started) {
+        m_started = true;
+        m_deadline = now + period;
+        m_lastReport = now;
+        return;
+    }
+
+    m_cycles.fetch_add(1, std::memory_order_relaxed);
+
+    int latenessUs = static_cast<int>(
+        std::chrono::duration_cast<std::chrono::microseconds>(now - m_deadline).count());
+
+    if (latenessUs > m_toleranceUs) {
+        m_missed.fetch_add(1, std::memory_order_relaxed);
+        if (latenessUs > m_maxLatenessUs.load(std::memory_order_relaxed)) {
+            m_maxLatenessUs.store(latenessUs, std::memory_order_relaxed);
+        }
+        // 错过后以当前时刻重新对齐，避免一次长停顿连续计数
+        m_deadline = now + period;
+    } else if (latenessUs < -4 * m_periodUs) {
+        // 周期明显快于标称值 (例如突发补帧)，重新对齐
+        m_deadline = now + period;
+    } else {
+        m_deadline += period;
+    }
+
+    // 每 10 秒最多报告一次新增的错过
+    if (now - m_lastReport >= std::chrono::seconds(10)) {
+        quint64 missedNow = missed();
+        if (missedNow != m_lastReportedMissed) {
+            AllocAudit::ScopedAllow allow;
+            LOG_WARN(QString("%1: %2 missed deadlines in %3 cycles (max lateness %4 us)")
+                     .arg(m_name).arg(missedNow).arg(cycles()).arg(maxLatenessUs()));
+            m_lastReportedMissed = missedNow;
+        }
+        m_lastReport = now;
+    }
+}
+
+void DeadlineMonitor::reset()
+{
+    m_started = false;
+    AllocAudit::restartWarmup();
+}
+
+DeadlineMonitor::Snapshot DeadlineMonitor::snapshot() const
+{
+    Snapshot s;
+    s.name = m_name;
+    s.periodUs = m_periodUs;
+    s.cycles = cycles();
+    s.missed = missed();
+    s.maxLatenessUs = maxLatenessUs();
+    return s;
+}
+
+QList<DeadlineMonitor::Snapshot> DeadlineMonitor::snapshotAll()
+{
+    QMutexLocker locker(&s_registryMutex);
+    QList<Snapshot> result;
+    for (const DeadlineMonitor* monitor : s_registry) {
+        result.append(monitor->snapshot());
+    }
+    return result;
+}
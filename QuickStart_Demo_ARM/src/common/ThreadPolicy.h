@@ -0,0 +1,106 @@
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * 线程调度策略配置
+ * 对应 config.json 中 media.threads.<key> 节点
+ */
+struct ThreadPolicyConfig {
+    enum Scheduler {
+        Other = 0,      // SCHED_OTHER (默认分时调度)
+        Fifo,           // SCHED_FIFO
+        RoundRobin      // SCHED_RR
+    };
+
+    QString name;                   // 线程名 (最多 15 个字符，ps/top 可见)
+    Scheduler scheduler = Other;
+    int priority = 0;               // 实时优先级 1-99，SCHED_OTHER 时忽略
+    QList<int> cpus;                // CPU 亲和性，空表示不限制
+    bool lockMemory = false;        // 是否 mlock 音频缓冲区
+
+    static Scheduler schedulerFromString(const QString& value);
+    static QString schedulerToString(Scheduler scheduler);
+};
+
+/**
+ * 线程策略工具
+ * 在工作线程内部调用，设置线程名、实时调度、CPU 亲和性
+ *
+ * 实时调度申请顺序:
+ * 1. 直接 pthread_setschedparam
+ * 2. EPERM 时尝试把 RLIMIT_RTPRIO 软限制提升到硬限制后重试
+ * 3. 仍失败则通过 rtkit (org.freedesktop.RealtimeKit1) 申请；rtkit 要求先降低 RLIMIT_RTTIME，
+ *    这是进程级限制，会同时作用于进程内其他实时线程 (只在走到这一步时设置)
+ */
+class ThreadPolicy {
+public:
+    // 应用到当前线程，返回实时调度是否生效 (SCHED_OTHER 时总是 true)
+    static bool applyToCurrentThread(const ThreadPolicyConfig& config);
+
+    // 锁定/解锁缓冲区内存，避免缺页造成音频卡顿
+    static bool lockBuffer(const void* addr, size_t size);
+    static void unlockBuffer(const void* addr, size_t size);
+
+    // 预先触碰线程栈，避免实时循环中首次缺页
+    static void prefaultStack();
+
+private:
+    static bool setRealtime(int policy, int priority);
+    static bool setRealtimeViaRtkit(int priority);
+    static void setAffinity(const QList<int>& cpus);
+};
+
+/**
+ * 周期截止时间监测
+ * 实时循环每个周期调用 tick()，超过 (周期 + 容差) 记为一次错过截止时间
+ * 所有实例登记在全局列表中，可按线程汇总查询；所在线程同时登记稳态分配审计 (AllocAudit)
+ */
+class DeadlineMonitor {
+public:
+    struct Snapshot {
+        QString name;
+        int periodUs = 0;
+        quint64 cycles = 0;
+        quint64 missed = 0;
+        int maxLatenessUs = 0;
+    };
+
+    DeadlineMonitor(const QString& name, int periodUs, int toleranceUs = -1);
+    ~DeadlineMonitor();
+
+    // 每完成一个周期调用一次 (在被监测线程内)
+    void tick();
+    // 周期中断后 (例如设备重开) 重新对齐，不计入错过
+    void reset();
+
+    quint64 cycles() const { return m_cycles.load(std::memory_order_relaxed); }
+    quint64 missed() const { return m_missed.load(std::memory_order_relaxed); }
+    int maxLatenessUs() const { return m_maxLatenessUs.load(std::memory_order_relaxed); }
+    Snapshot snapshot() const;
+
+    // 所有已登记线程的统计
+    static QList<Snapshot> snapshotAll();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    QString m_name;
+    int m_periodUs;
+    int m_toleranceUs;
+    bool m_started = false;
+    Clock::time_point m_deadline;
+    std::atomic<quint64> m_cycles{0};
+    std::atomic<quint64> m_missed{0};
+    std::atomic<int> m_maxLatenessUs{0};
+    quint64 m_lastReportedMissed = 0;
+    Clock::time_point m_lastReport;
+
+    static QMutex s_registryMutex;
+    static QList<DeadlineMonitor*> s_registry;
+};
@@ -0,0 +1,315 @@
+#include "TraceRecorder.h"
+#include "Logger.h"
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSocketNotifier>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#define LOG_MODULE "Trace"
+
+namespace {
+
+const uint64_t EVENT_MASK = TraceRecorder::EVENTS_PER_THREAD - 1;
+// 导出时每攒够这么多字节写一次文件
+const int EXPORT_CHUNK_BYTES = 64 * 1024;
+
+struct Event {
+    const char* name;
+    int64_t tsNs;
+    int64_t value;      // complete: 持续时间 (ns)；counter: 计数值
+    char phase;         // Chrome trace 的 ph 字段: X / i / C
+};
+
+struct ThreadBuffer {
+    Event events[TraceRecorder::EVENTS_PER_THREAD];
+    std::atomic<uint64_t> head{0};          // 已写入的事件总数，只由所属线程递增
+    std::atomic<bool> retired{false};       // 线程已退出，缓冲可由新线程复用
+    int tid = 0;
+    QByteArray threadName;
+};
+
+// 线程退出时标记缓冲可复用，事件保留到被新线程复用为止
+struct ThreadSlot {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadSlot() {
+        if (buffer) {
+            buffer->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadSlot t_slot;
+QMutex s_registryMutex;
+QList<ThreadBuffer*> s_registry;
+std::atomic<int64_t> s_sessionStartNs{0};
+int s_togglePipe[2] = {-1, -1};
+
+QByteArray currentThreadName()
+{
+    char name[16] = {0};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    return QByteArray(name);
+}
+
+// 第一次记录时登记 (加锁、分配各一次)，之后只访问线程局部指针
+ThreadBuffer* currentBuffer()
+{
+    if (t_slot.buffer) {
+        return t_slot.buffer;
+    }
+    QMutexLocker locker(&s_registryMutex);
+    ThreadBuffer* buffer = nullptr;
+    for (ThreadBuffer* candidate : s_registry) {
+        if (candidate->retired.load(std::memory_order_acquire)) {
+            buffer = candidate;
+            break;
+        }
+    }
+    if (!buffer) {
+        buffer = new ThreadBuffer();
+        s_registry.append(buffer);
+    }
+    buffer->head.store(0, std::memory_order_relaxed);
+    buffer->retired.store(false, std::memory_order_relaxed);
+    buffer->tid = static_cast<int>(syscall(SYS_gettid));
+    buffer->threadName = currentThreadName();
+    t_slot.buffer = buffer;
+    return buffer;
+}
+
+void record(char phase, const char* name, int64_t tsNs, int64_t value)
+{
+    ThreadBuffer* buffer = currentBuffer();
+    uint64_t index = buffer->head.load(std::memory_order_relaxed);
+    Event& event = buffer->events[index & EVENT_MASK];
+    event.name = name;
+    event.tsNs = tsNs;
+    event.value = value;
+    event.phase = phase;
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+struct ThreadSnapshot {
+    int tid = 0;
+    QByteArray threadName;
+    std::vector<Event> events;
+};
+
+// 复制一个线程缓冲中仍然有效的事件: 复制期间可能被覆盖的槽位按写入序号丢弃
+ThreadSnapshot snapshotBuffer(const ThreadBuffer* buffer, int64_t sessionStartNs)
+{
+    ThreadSnapshot snapshot;
+    snapshot.tid = buffer->tid;
+    snapshot.threadName = buffer->threadName;
+    if (!buffer->retired.load(std::memory_order_acquire)) {
+        // 线程名可能在第一次记录之后才设置，存活的线程以内核中的当前名字为准
+        QFile comm(QString("/proc/self/task/%1/comm").arg(buffer->tid));
+        if (comm.open(QIODevice::ReadOnly)) {
+            QByteArray name = comm.readAll().trimmed();
+            if (!name.isEmpty()) {
+                snapshot.threadName = name;
+            }
+        }
+    }
+
+    uint64_t head = buffer->head.load(std::memory_order_acquire);
+    uint64_t count = std::min<uint64_t>(head, TraceRecorder::EVENTS_PER_THREAD);
+    uint64_t first = head - count;
+    std::vector<Event> copied(count);
+    for (uint64_t i = 0; i < count; i++) {
+        copied[i] = buffer->events[(first + i) & EVENT_MASK];
+    }
+    uint64_t headAfter = buffer->head.load(std::memory_order_acquire);
+    uint64_t valid = headAfter >= TraceRecorder::EVENTS_PER_THREAD
+        ? headAfter - TraceRecorder::EVENTS_PER_THREAD + 1 : 0;
+
+    snapshot.events.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        if (first + i >= valid && copied[i].tsNs >= sessionStartNs) {
+            snapshot.events.push_back(copied[i]);
+        }
+    }
+    return snapshot;
+}
+
+QByteArray jsonString(const QByteArray& value)
+{
+    QByteArray escaped = value;
+    escaped.replace('\\', "\\\\").replace('"', "\\\"");
+    return QByteArray("\"") + escaped + '"';
+}
+
+// Chrome trace 的时间单位为 us，保留 ns 精度
+QByteArray microseconds(int64_t ns)
+{
+    return QByteArray::number(ns / 1000.0, 'f', 3);
+}
+
+void onToggleSignal(int)
+{
+    // 信号处理函数中只写管道，开关和导出在主线程完成
+    char byte = 1;
+    ssize_t written = write(s_togglePipe[1], &byte, 1);
+    (void)written;
+}
+
+} // namespace
+
+std::atomic<bool> TraceRecorder::s_enabled{false};
+
+int64_t TraceRecorder::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceRecorder::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled()) {
+        return;
+    }
+    if (enabled) {
+        s_sessionStartNs.store(nowNs(), std::memory_order_relaxed);
+    }
+    s_enabled.store(enabled, std::memory_order_relaxed);
+    LOG_INFO(QString("Tracing %1").arg(enabled ? "started" : "stopped"));
+}
+
+void TraceRecorder::complete(const char* name, int64_t startNs, int64_t endNs)
+{
+    if (isEnabled()) {
+        record('X', name, startNs, endNs - startNs);
+    }
+}
+
+void TraceRecorder::instant(const char* name)
+{
+    if (isEnabled()) {
+        record('i', name, nowNs(), 0);
+    }
+}
+
+void TraceRecorder::counter(const char* name, int64_t value)
+{
+    if (isEnabled()) {
+        record('C', name, nowNs(), value);
+    }
+}
+
+bool TraceRecorder::exportTo(const QString& path)
+{
+    int64_t sessionStartNs = s_sessionStartNs.load(std::memory_order_relaxed);
+    std::vector<ThreadSnapshot> threads;
+    {
+        QMutexLocker locker(&s_registryMutex);
+        for (const ThreadBuffer* buffer : s_registry) {
+            threads.push_back(snapshotBuffer(buffer, sessionStartNs));
+        }
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARN(QString("Failed to write trace: %1").arg(path));
+        return false;
+    }
+
+    const QByteArray pid = QByteArray::number(static_cast<int>(getpid()));
+    QByteArray out;
+    out.reserve(EXPORT_CHUNK_BYTES * 2);
+    out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out += "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" + pid + ",\"tid\":0,\"args\":{\"name\":"
+         + jsonString(QCoreApplication::applicationName().toUtf8()) + "}}";
+
+    int eventCount = 0;
+    for (const ThreadSnapshot& thread : threads) {
+        if (thread.events.empty()) {
+            continue;
+        }
+        const QByteArray tid = QByteArray::number(thread.tid);
+        const QByteArray prefix = ",\n{\"pid\":" + pid + ",\"tid\":" + tid + ",";
+        out += prefix + "\"ph\":\"M\",\"name\":\"thread_name\",\"args\":{\"name\":"
+             + jsonString(thread.threadName) + "}}";
+
+        for (const Event& event : thread.events) {
+            out += prefix + "\"ph\":\"" + event.phase + "\",\"name\":\"" + event.name
+                 + "\",\"ts\":" + microseconds(event.tsNs);
+            switch (event.phase) {
+                case 'X':
+                    out += ",\"dur\":" + microseconds(event.value) + "}";
+                    break;
+                case 'C':
+                    out += ",\"args\":{\"value\":" + QByteArray::number(static_cast<qlonglong>(event.value)) + "}}";
+                    break;
+                default:
+                    out += ",\"s\":\"t\"}";
+                    break;
+            }
+            eventCount++;
+            if (out.size() >= EXPORT_CHUNK_BYTES) {
+                file.write(out);
+                out.clear();
+            }
+        }
+    }
+    out += "\n]}\n";
+    file.write(out);
+    file.close();
+
+    LOG_INFO(QString("Trace (%1 events, %2 threads) written to %3").arg(eventCount).arg(threads.size()).arg(path));
+    return true;
+}
+
+QString TraceRecorder::exportToDir(const QString& dir)
+{
+    QString fileName = QString("trace-%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    QString path = QDir(dir).filePath(fileName);
+    return exportTo(path) ? path : QString();
+}
+
+void TraceRecorder::installSignalToggle(const QString& dir)
+{
+    if (s_togglePipe[0] >= 0) {
+        return;
+    }
+    if (pipe2(s_togglePipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        LOG_WARN("Failed to create trace toggle pipe");
+        return;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onToggleSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR2, &action, nullptr);
+
+    QSocketNotifier* notifier = new QSocketNotifier(s_togglePipe[0], QSocketNotifier::Read,
+                                                    QCoreApplication::instance());
+    QObject::connect(notifier, &QSocketNotifier::activated, [dir]() {
+        char bytes[16];
+        while (read(s_togglePipe[0], bytes, sizeof(bytes)) > 0) {
+        }
+        bool enable = !isEnabled();
+        setEnabled(enable);
+        if (!enable && !dir.isEmpty()) {
+            exportToDir(dir);
+        }
+    });
+    LOG_INFO(QString("Send SIGUSR2 (kill -USR2 %1) to start/stop tracing").arg(getpid()));
+}
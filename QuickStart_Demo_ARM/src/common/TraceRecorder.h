@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 热路径事件追踪 (导出为 Chrome / Perfetto trace JSON)
+ * 每个线程第一次记录时登记一个固定容量的环形缓冲，只由本线程写入，写满后覆盖最旧的事件；
+ * 记录时不加锁、不分配，未开启时只读一个原子变量
+ *
+ * - TRACE_SCOPE("video.push"):          作用域耗时 (complete 事件)
+ * - TRACE_INSTANT("audio.underrun"):    瞬时事件
+ * - TRACE_COUNTER("audio.depth", n):    计数器曲线
+ *
+ * 事件名只保存指针，必须是字符串字面量；时间戳为 steady 时钟 (ns)
+ * 导出文件可直接用 chrome://tracing 或 ui.perfetto.dev 打开
+ */
+class TraceRecorder {
+public:
+    static const int EVENTS_PER_THREAD = 16384;     // 2 的幂，约 0.5MB / 线程
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+    // 开启时丢弃之前记录的事件
+    static void setEnabled(bool enabled);
+    static int64_t nowNs();
+
+    static void complete(const char* name, int64_t startNs, int64_t endNs);
+    static void instant(const char* name);
+    static void counter(const char* name, int64_t value);
+
+    // 导出本次开启以来各线程缓冲中仍保留的事件，记录期间也可调用
+    static bool exportTo(const QString& path);
+    // 导出到 dir/trace-<时间>.json，返回文件路径，失败时为空
+    static QString exportToDir(const QString& dir);
+
+    // SIGUSR2 切换开关，关闭时导出到 dir/trace-<时间>.json (dir 为空则不导出)；需在主线程调用一次
+    static void installSignalToggle(const QString& dir);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+/**
+ * 作用域计时，析构时记录一个 complete 事件；进入作用域时未开启则什么也不做
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : m_name(name)
+        , m_startNs(TraceRecorder::isEnabled() ? TraceRecorder::nowNs() : 0) {}
+    ~TraceScope() {
+        if (m_startNs != 0) {
+            TraceRecorder::complete(m_name, m_startNs, TraceRecorder::nowNs());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_startNs;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_INSTANT(name) \
+    do { if (TraceRecorder::isEnabled()) TraceRecorder::instant(name); } while (0)
+#define TRACE_COUNTER(name, value) \
+    do { if (TraceRecorder::isEnabled()) TraceRecorder::counter(name, static_cast<int64_t>(value)); } while (0)
@@ -0,0 +1,273 @@
+#include "TurnLatencyTracker.h"
+#include "Logger.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QStringList>
+#include <chrono>
+
+#define LOG_MODULE "TurnLatency"
+
+// 语音结束到 THINKING 超过这个时长时，认为本轮不是由这段语音触发的 (例如文本指令)
+static const int64_t MAX_ENDPOINT_US = 10000000;
+
+static double elapsedMs(int64_t fromUs, int64_t toUs)
+{
+    if (fromUs <= 0 || toUs <= 0) {
+        return -1.0;
+    }
+    // 音频可能先于 SPEAKING 消息到达，阶段耗时不为负
+    return toUs > fromUs ? (toUs - fromUs) / 1000.0 : 0.0;
+}
+
+double TurnLatencyTracker::Turn::segmentMs(Segment segment) const
+{
+    switch (segment) {
+    case Asr:       return elapsedMs(speechEndUs, thinkingUs);
+    case AsrFinal:  return elapsedMs(speechEndUs, userFinalUs);
+    case LlmTts:    return elapsedMs(thinkingUs, speakingUs);
+    case Network:   return elapsedMs(speakingUs, firstReceivedUs);
+    case Playout:   return elapsedMs(firstReceivedUs, firstPlayoutUs);
+    case Subtitle:  return elapsedMs(speechEndUs, firstSubtitleUs);
+    case Total:     return elapsedMs(speechEndUs, firstPlayoutUs);
+    default:        return -1.0;
+    }
+}
+
+TurnLatencyTracker::TurnLatencyTracker()
+{
+    reset();
+}
+
+const char* TurnLatencyTracker::segmentName(Segment segment)
+{
+    switch (segment) {
+    case Asr:       return "asr";
+    case AsrFinal:  return "asrFinal";
+    case LlmTts:    return "llmTts";
+    case Network:   return "network";
+    case Playout:   return "playout";
+    case Subtitle:  return "subtitle";
+    case Total:     return "total";
+    default:        return "unknown";
+    }
+}
+
+int64_t TurnLatencyTracker::nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TurnLatencyTracker::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_sessionStart = QDateTime::currentDateTime();
+    m_inTurn = false;
+    m_current = Turn();
+    m_lastThinkingUs = 0;
+    m_lastUserFinalUs = 0;
+    m_turnCount = 0;
+    m_turns.clear();
+    for (LatencyHistogram& histogram : m_histograms) {
+        histogram.reset();
+    }
+    m_awaiting.store(0);
+    m_lastSpeechEndUs.store(0);
+}
+
+void TurnLatencyTracker::markSpeechEnd(int64_t us)
+{
+    m_lastSpeechEndUs.store(us, std::memory_order_relaxed);
+}
+
+bool TurnLatencyTracker::isAwaitingAudio() const
+{
+    return (m_awaiting.load(std::memory_order_relaxed) & AWAIT_RECEIVED) != 0;
+}
+
+bool TurnLatencyTracker::isAwaitingPlayout() const
+{
+    return (m_awaiting.load(std::memory_order_relaxed) & AWAIT_PLAYOUT) != 0;
+}
+
+void TurnLatencyTracker::markAudioReceived(int64_t us)
+{
+    // 每个标记只有一个写入线程，先写时间戳再清除等待位
+    if (isAwaitingAudio()) {
+        m_firstReceivedUs.store(us, std::memory_order_relaxed);
+        m_awaiting.fetch_and(~AWAIT_RECEIVED, std::memory_order_release);
+    }
+}
+
+void TurnLatencyTracker::markPlayout(int64_t us)
+{
+    if (isAwaitingPlayout()) {
+        m_firstPlayoutUs.store(us, std::memory_order_relaxed);
+        m_awaiting.fetch_and(~AWAIT_PLAYOUT, std::memory_order_release);
+    }
+}
+
+void TurnLatencyTracker::onAgentStage(int code, int64_t us)
+{
+    QMutexLocker locker(&m_mutex);
+    switch (code) {
+    case Thinking:
+        if (m_inTurn) {
+            finishTurn(false);
+        }
+        beginTurn(us);
+        break;
+    case Speaking:
+        if (m_inTurn && m_current.speakingUs == 0) {
+            m_current.speakingUs = us;
+        }
+        break;
+    case Interrupted:
+        if (m_inTurn) {
+            finishTurn(true);
+        }
+        break;
+    case Finished:
+    case Listening:
+        if (m_inTurn) {
+            finishTurn(false);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void TurnLatencyTracker::onSubtitle(bool isUser, bool definite, int64_t us)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isUser) {
+        if (!definite) {
+            return;
+        }
+        // 最终识别结果可能晚于 THINKING 到达，在智能体开口之前都算作本轮
+        if (m_inTurn && m_current.speakingUs == 0 && m_current.userFinalUs == 0) {
+            m_current.userFinalUs = us;
+        } else {
+            m_lastUserFinalUs = us;
+        }
+    } else if (m_inTurn && m_current.firstSubtitleUs == 0) {
+        m_current.firstSubtitleUs = us;
+    }
+}
+
+void TurnLatencyTracker::beginTurn(int64_t us)
+{
+    m_current = Turn();
+    m_current.index = ++m_turnCount;
+    m_current.thinkingUs = us;
+
+    int64_t speechEndUs = m_lastSpeechEndUs.load(std::memory_order_relaxed);
+    if (speechEndUs > m_lastThinkingUs && speechEndUs <= us && us - speechEndUs <= MAX_ENDPOINT_US) {
+        m_current.speechEndUs = speechEndUs;
+    }
+    if (m_lastUserFinalUs > m_lastThinkingUs) {
+        m_current.userFinalUs = m_lastUserFinalUs;
+    }
+    m_lastThinkingUs = us;
+    m_inTurn = true;
+
+    m_firstReceivedUs.store(0, std::memory_order_relaxed);
+    m_firstPlayoutUs.store(0, std::memory_order_relaxed);
+    m_awaiting.store(AWAIT_RECEIVED | AWAIT_PLAYOUT, std::memory_order_release);
+}
+
+void TurnLatencyTracker::finishTurn(bool interrupted)
+{
+    int awaiting = m_awaiting.exchange(0, std::memory_order_acquire);
+    if (!(awaiting & AWAIT_RECEIVED)) {
+        m_current.firstReceivedUs = m_firstReceivedUs.load(std::memory_order_relaxed);
+    }
+    if (!(awaiting & AWAIT_PLAYOUT)) {
+        m_current.firstPlayoutUs = m_firstPlayoutUs.load(std::memory_order_relaxed);
+    }
+    m_current.interrupted = interrupted;
+    m_inTurn = false;
+
+    QStringList parts;
+    for (int i = 0; i < SEGMENT_COUNT; i++) {
+        double ms = m_current.segmentMs(static_cast<Segment>(i));
+        if (ms >= 0) {
+            m_histograms[i].add(ms);
+            parts << QString("%1 %2").arg(segmentName(static_cast<Segment>(i))).arg(ms, 0, 'f', 0);
+        }
+    }
+    if (m_turns.size() >= MAX_TURNS) {
+        m_turns.removeFirst();
+    }
+    m_turns.append(m_current);
+
+    LOG_INFO(QString("Turn %1%2: %3 ms").arg(m_current.index)
+             .arg(interrupted ? " (interrupted)" : "")
+             .arg(parts.isEmpty() ? QString("no timing") : parts.join(", ")));
+}
+
+int TurnLatencyTracker::turnCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_turnCount;
+}
+
+TurnLatencyTracker::Turn TurnLatencyTracker::lastTurn() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_turns.isEmpty() ? Turn() : m_turns.last();
+}
+
+LatencyHistogram TurnLatencyTracker::histogram(Segment segment) const
+{
+    QMutexLocker locker(&m_mutex);
+    return segment >= 0 && segment < SEGMENT_COUNT ? m_histograms[segment] : LatencyHistogram();
+}
+
+QJsonObject TurnLatencyTracker::toJson() const
+{
+    QMutexLocker locker(&m_mutex);
+    QJsonObject root;
+    root["sessionStart"] = m_sessionStart.toString(Qt::ISODate);
+    root["turnCount"] = m_turnCount;
+
+    QJsonArray turns;
+    for (const Turn& turn : m_turns) {
+        QJsonObject item;
+        item["index"] = turn.index;
+        item["interrupted"] = turn.interrupted;
+        for (int i = 0; i < SEGMENT_COUNT; i++) {
+            double ms = turn.segmentMs(static_cast<Segment>(i));
+            item[segmentName(static_cast<Segment>(i))] = ms >= 0 ? QJsonValue(ms) : QJsonValue();
+        }
+        turns.append(item);
+    }
+    root["turns"] = turns;
+
+    QJsonObject histograms;
+    for (int i = 0; i < SEGMENT_COUNT; i++) {
+        histograms[segmentName(static_cast<Segment>(i))] = m_histograms[i].toJson();
+    }
+    root["histograms"] = histograms;
+    return root;
+}
+
+bool TurnLatencyTracker::exportTo(const QString& path) const
+{
+    QJsonObject root = toJson();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARN(QString("Failed to write turn latency report: %1").arg(path));
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    file.close();
+    LOG_INFO(QString("Turn latency report (%1 turns) written to %2").arg(root["turnCount"].toInt()).arg(path));
+    return true;
+}
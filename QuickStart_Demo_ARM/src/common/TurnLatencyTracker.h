@@ -0,0 +1,116 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include <QDateTime>
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 对话轮次延迟统计
+ * 以本地 VAD 判定的用户语音结束为起点，给智能体状态消息 (conv)、字幕 (subv)、
+ * 第一块收到和第一块播出的 AI 音频打上 steady 时钟时间戳，拆分每轮 AI 响应时间:
+ *
+ * - asr:      语音结束 -> THINKING (端点检测 + 识别 + 上行)
+ * - asrFinal: 语音结束 -> 用户最终字幕 (definite)
+ * - llmTts:   THINKING -> SPEAKING (大模型 + 语音合成首包)
+ * - network:  SPEAKING -> 第一块 AI 音频到达本地
+ * - playout:  到达 -> 实际播出 (抖动缓冲 + 声卡缓冲)
+ * - subtitle: 语音结束 -> 第一条 AI 字幕
+ * - total:    语音结束 -> 实际播出
+ *
+ * 消息时间戳为本地收到的时刻，阶段边界包含下行消息的网络延迟。
+ * 音频线程的打点只读写原子变量，不加锁不分配；其余接口加锁，可在任意线程调用
+ */
+class TurnLatencyTracker {
+public:
+    enum Segment {
+        Asr,
+        AsrFinal,
+        LlmTts,
+        Network,
+        Playout,
+        Subtitle,
+        Total,
+        SEGMENT_COUNT
+    };
+
+    // 智能体状态码 (conv 消息 Stage.Code)
+    enum Stage {
+        Listening = 1,
+        Thinking = 2,
+        Speaking = 3,
+        Interrupted = 4,
+        Finished = 5
+    };
+
+    struct Turn {
+        int index = 0;
+        bool interrupted = false;
+        // steady 时钟 (us)，0 表示本轮没有该事件
+        int64_t speechEndUs = 0;
+        int64_t userFinalUs = 0;
+        int64_t thinkingUs = 0;
+        int64_t speakingUs = 0;
+        int64_t firstSubtitleUs = 0;
+        int64_t firstReceivedUs = 0;
+        int64_t firstPlayoutUs = 0;
+
+        // 缺少任一端点时返回 -1
+        double segmentMs(Segment segment) const;
+    };
+
+    TurnLatencyTracker();
+
+    static const char* segmentName(Segment segment);
+    static int64_t nowUs();
+
+    // 开始新的会话: 清空轮次和直方图
+    void reset();
+
+    // 采集线程: 一段用户语音结束，us 为最后一个语音帧的结束时刻
+    void markSpeechEnd(int64_t us);
+    // SDK 回调 / 播放线程: 是否在等待本轮第一块 AI 音频 (到达 / 播出)
+    bool isAwaitingAudio() const;
+    bool isAwaitingPlayout() const;
+    void markAudioReceived(int64_t us);
+    // us 为这块音频实际播出的时刻 (写入时刻 + 声卡中排在它之前的音频)
+    void markPlayout(int64_t us);
+
+    // 消息回调线程
+    void onAgentStage(int code, int64_t us);
+    void onSubtitle(bool isUser, bool definite, int64_t us);
+
+    int turnCount() const;
+    Turn lastTurn() const;
+    LatencyHistogram histogram(Segment segment) const;
+    // 本次会话的全部轮次和各阶段直方图
+    QJsonObject toJson() const;
+    bool exportTo(const QString& path) const;
+
+private:
+    static const int AWAIT_RECEIVED = 1;
+    static const int AWAIT_PLAYOUT = 2;
+    static const int MAX_TURNS = 1000;
+
+    void beginTurn(int64_t us);
+    void finishTurn(bool interrupted);
+
+    mutable QMutex m_mutex;
+    QDateTime m_sessionStart;
+    bool m_inTurn = false;
+    Turn m_current;
+    int64_t m_lastThinkingUs = 0;
+    int64_t m_lastUserFinalUs = 0;
+    int m_turnCount = 0;
+    QVector<Turn> m_turns;
+    LatencyHistogram m_histograms[SEGMENT_COUNT];
+
+    std::atomic<int64_t> m_lastSpeechEndUs{0};
+    std::atomic<int> m_awaiting{0};
+    std::atomic<int64_t> m_firstReceivedUs{0};
+    std::atomic<int64_t> m_firstPlayoutUs{0};
+};
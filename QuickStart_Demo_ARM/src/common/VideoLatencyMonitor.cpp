@@ -0,0 +1,150 @@
+#include "VideoLatencyMonitor.h"
+#include "FrameStamp.h"
+#include "Logger.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <chrono>
+
+#define LOG_MODULE "VideoLatency"
+
+// 超过这个值的结果视为解码到了旧图案或时钟异常，不计入
+static const int64_t MAX_LATENCY_US = 10000000;
+
+static int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+VideoLatencyMonitor* VideoLatencyMonitor::instance()
+{
+    static VideoLatencyMonitor monitor;
+    return &monitor;
+}
+
+const char* VideoLatencyMonitor::stageName(Stage stage)
+{
+    switch (stage) {
+    case Sink:      return "sink";
+    case Display:   return "display";
+    default:        return "unknown";
+    }
+}
+
+void VideoLatencyMonitor::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+    LOG_INFO(QString("Video latency measurement %1").arg(enabled ? "enabled" : "disabled"));
+}
+
+void VideoLatencyMonitor::setConfiguration(const QString& label)
+{
+    QMutexLocker locker(&m_mutex);
+    m_configuration = label;
+}
+
+QString VideoLatencyMonitor::configuration() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_configuration;
+}
+
+void VideoLatencyMonitor::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_distributions.clear();
+}
+
+bool VideoLatencyMonitor::recordFrame(Stage stage, const uint8_t* plane, int stride, int pixelStep,
+                                      int width, int height, int64_t* lastStampUs)
+{
+    if (!isEnabled() || stage < 0 || stage >= STAGE_COUNT) {
+        return false;
+    }
+    int64_t nowUs = steadyNowUs();
+    int64_t stampUs = 0;
+    bool decoded = FrameStamp::decode(plane, stride, pixelStep, width, height, nowUs, &stampUs);
+    if (decoded && lastStampUs) {
+        if (*lastStampUs == stampUs) {
+            return false;
+        }
+        *lastStampUs = stampUs;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    Distribution& distribution = m_distributions[m_configuration];
+    if (!decoded || stampUs > nowUs || nowUs - stampUs > MAX_LATENCY_US) {
+        distribution.undecoded++;
+        return false;
+    }
+    distribution.stages[stage].add((nowUs - stampUs) / 1000.0);
+    return true;
+}
+
+LatencyHistogram VideoLatencyMonitor::histogram(Stage stage) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_distributions.constFind(m_configuration);
+    if (it == m_distributions.constEnd() || stage < 0 || stage >= STAGE_COUNT) {
+        return LatencyHistogram();
+    }
+    return it->stages[stage];
+}
+
+bool VideoLatencyMonitor::hasSamples() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_distributions.isEmpty();
+}
+
+void VideoLatencyMonitor::logSummary() const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = m_distributions.constFind(m_configuration);
+    if (it == m_distributions.constEnd()) {
+        return;
+    }
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        const LatencyHistogram& histogram = it->stages[i];
+        LOG_INFO(QString("[%1] capture->%2: %3 frames, mean %4 ms, p50 %5 ms, p90 %6 ms, max %7 ms")
+                 .arg(m_configuration).arg(stageName(static_cast<Stage>(i))).arg(histogram.count())
+                 .arg(histogram.meanMs(), 0, 'f', 1).arg(histogram.percentileMs(0.5), 0, 'f', 1)
+                 .arg(histogram.percentileMs(0.9), 0, 'f', 1).arg(histogram.maxMs(), 0, 'f', 1));
+    }
+    if (it->undecoded > 0) {
+        LOG_INFO(QString("[%1] %2 frames without a valid stamp").arg(m_configuration).arg(it->undecoded));
+    }
+}
+
+QJsonObject VideoLatencyMonitor::toJson() const
+{
+    QMutexLocker locker(&m_mutex);
+    QJsonObject root;
+    for (auto it = m_distributions.constBegin(); it != m_distributions.constEnd(); ++it) {
+        QJsonObject configuration;
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            configuration[stageName(static_cast<Stage>(i))] = it->stages[i].toJson();
+        }
+        configuration["undecoded"] = it->undecoded;
+        root[it.key()] = configuration;
+    }
+    return root;
+}
+
+bool VideoLatencyMonitor::exportTo(const QString& path) const
+{
+    QJsonObject root = toJson();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARN(QString("Failed to write video latency report: %1").arg(path));
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    file.close();
+    LOG_INFO(QString("Video latency report (%1 configurations) written to %2").arg(root.size()).arg(path));
+    return true;
+}
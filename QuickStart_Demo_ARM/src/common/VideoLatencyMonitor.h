@@ -0,0 +1,65 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * 视频端到端延迟统计 (测试模式)
+ * 采集端在每帧中写入 FrameStamp 时间戳图案，接收端解码后按两个阶段记录:
+ *
+ * - sink:    采集 -> 视频 sink 收到 (本地预览或远端流，含 SDK 处理/编解码/网络)
+ * - display: 采集 -> 渲染控件绘制完成 (再加主线程排队和绘制，不含合成器和扫描输出)
+ *
+ * 按配置 (渲染方式、分辨率、管道) 分别累计直方图，切换配置后新开一组。
+ * 记录接口加锁，可在 SDK 回调线程和主线程调用；未开启时只读一个原子变量
+ */
+class VideoLatencyMonitor {
+public:
+    enum Stage {
+        Sink,
+        Display,
+        STAGE_COUNT
+    };
+
+    static VideoLatencyMonitor* instance();
+    static const char* stageName(Stage stage);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    // 当前配置的标签，例如 "gpu 640x480 usb"
+    void setConfiguration(const QString& label);
+    QString configuration() const;
+    void reset();
+
+    // 从亮度平面 (pixelStep = 1) 或 RGB888/RGBA 的一个通道 (pixelStep = 3/4) 解码时间戳并记录，
+    // lastStampUs 用于跳过同一帧的重复绘制；返回是否记录了新样本
+    bool recordFrame(Stage stage, const uint8_t* plane, int stride, int pixelStep,
+                     int width, int height, int64_t* lastStampUs = nullptr);
+
+    // 当前配置下的直方图
+    LatencyHistogram histogram(Stage stage) const;
+    // 当前配置的各阶段汇总写入日志
+    void logSummary() const;
+    // 全部配置的直方图
+    QJsonObject toJson() const;
+    bool exportTo(const QString& path) const;
+    bool hasSamples() const;
+
+private:
+    struct Distribution {
+        LatencyHistogram stages[STAGE_COUNT];
+        int undecoded = 0;
+    };
+
+    VideoLatencyMonitor() = default;
+
+    std::atomic<bool> m_enabled{false};
+    mutable QMutex m_mutex;
+    QString m_configuration = "default";
+    QMap<QString, Distribution> m_distributions;
+};
@@ -0,0 +1,131 @@
+#include "WavFile.h"
+#include "Logger.h"
+#include <QFile>
+#include <QIODevice>
+#include <QtEndian>
+#include <cstring>
+
+#define LOG_MODULE "WavFile"
+
+// fmt 块: PCM 16 字节，WAVE_FORMAT_EXTENSIBLE 40 字节；更长的视为损坏
+static const quint32 MAX_FMT_CHUNK = 64;
+static const int MAX_CHANNELS = 8;
+static const int MAX_SAMPLE_RATE = 384000;
+
+static quint32 readU32(const char* p)
+{
+    return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(p));
+}
+
+static quint16 readU16(const char* p)
+{
+    return qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(p));
+}
+
+static void writeU32(char* p, quint32 v)
+{
+    qToLittleEndian<quint32>(v, reinterpret_cast<uchar*>(p));
+}
+
+static void writeU16(char* p, quint16 v)
+{
+    qToLittleEndian<quint16>(v, reinterpret_cast<uchar*>(p));
+}
+
+bool WavFile::readHeader(QIODevice* device, WavFormat& format, qint64& dataBytes)
+{
+    char riff[12];
+    if (device->read(riff, sizeof(riff)) != sizeof(riff) ||
+        memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        LOG_WARN("Not a RIFF/WAVE file");
+        return false;
+    }
+
+    bool haveFormat = false;
+    char chunk[8];
+    while (device->read(chunk, sizeof(chunk)) == sizeof(chunk)) {
+        quint32 size = readU32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (size < 16 || size > MAX_FMT_CHUNK) {
+                LOG_WARN(QString("Invalid fmt chunk size %1").arg(size));
+                return false;
+            }
+            char fmt[MAX_FMT_CHUNK + 1];
+            qint64 fmtBytes = size + (size & 1);
+            if (device->read(fmt, fmtBytes) != fmtBytes) {
+                return false;
+            }
+            quint16 audioFormat = readU16(fmt);
+            format.channels = readU16(fmt + 2);
+            format.sampleRate = static_cast<int>(readU32(fmt + 4));
+            quint16 blockAlign = readU16(fmt + 12);
+            format.bitsPerSample = readU16(fmt + 14);
+            // 1 = PCM, 0xFFFE = WAVE_FORMAT_EXTENSIBLE
+            if ((audioFormat != 1 && audioFormat != 0xFFFE) || format.bitsPerSample != 16) {
+                LOG_WARN(QString("Unsupported WAV format %1, %2 bits")
+                         .arg(audioFormat).arg(format.bitsPerSample));
+                return false;
+            }
+            // 读取端按声道数和采样率计算块长，为 0 会除零
+            if (format.channels < 1 || format.channels > MAX_CHANNELS ||
+                format.sampleRate <= 0 || format.sampleRate > MAX_SAMPLE_RATE ||
+                blockAlign != format.channels * 2) {
+                LOG_WARN(QString("Invalid WAV format: %1 ch, %2 Hz, block align %3")
+                         .arg(format.channels).arg(format.sampleRate).arg(blockAlign));
+                return false;
+            }
+            haveFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                return false;
+            }
+            dataBytes = size;
+            return true;
+        } else {
+            // 跳过 LIST 等其他块 (块长度按 2 字节对齐)；长度来自文件，不能按它分配内存
+            qint64 skipBytes = static_cast<qint64>(size) + (size & 1);
+            if (device->isSequential() || !device->seek(device->pos() + skipBytes)) {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+bool WavFile::writeHeader(QIODevice* device, const WavFormat& format, qint64 dataBytes)
+{
+    char header[HEADER_SIZE];
+    int blockAlign = format.channels * format.bitsPerSample / 8;
+
+    memcpy(header, "RIFF", 4);
+    writeU32(header + 4, static_cast<quint32>(36 + dataBytes));
+    memcpy(header + 8, "WAVE", 4);
+    memcpy(header + 12, "fmt ", 4);
+    writeU32(header + 16, 16);
+    writeU16(header + 20, 1);
+    writeU16(header + 22, static_cast<quint16>(format.channels));
+    writeU32(header + 24, static_cast<quint32>(format.sampleRate));
+    writeU32(header + 28, static_cast<quint32>(format.sampleRate * blockAlign));
+    writeU16(header + 32, static_cast<quint16>(blockAlign));
+    writeU16(header + 34, static_cast<quint16>(format.bitsPerSample));
+    memcpy(header + 36, "data", 4);
+    writeU32(header + 40, static_cast<quint32>(dataBytes));
+
+    return device->write(header, HEADER_SIZE) == HEADER_SIZE;
+}
+
+bool WavFile::finalize(QFile* file, const WavFormat& format, qint64 dataBytes)
+{
+    qint64 pos = file->pos();
+    if (!file->seek(0)) {
+        return false;
+    }
+    bool ok = writeHeader(file, format, dataBytes);
+    file->seek(pos);
+    return ok;
+}
+
+bool WavFile::isWavPath(const QString& path)
+{
+    return path.endsWith(".wav", Qt::CaseInsensitive);
+}
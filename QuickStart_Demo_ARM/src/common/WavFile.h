@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+class QIODevice;
+class QFile;
+
+/**
+ * WAV 文件头读写 (PCM S16_LE)
+ * 用于文件音频源/渲染以及调试录音
+ */
+struct WavFormat {
+    int sampleRate = 16000;
+    int channels = 1;
+    int bitsPerSample = 16;
+};
+
+class WavFile {
+public:
+    // 解析 WAV 头，成功后设备位置在 data 块开头，dataBytes 为 data 块长度
+    static bool readHeader(QIODevice* device, WavFormat& format, qint64& dataBytes);
+    // 写入 44 字节标准头，数据长度未知时先写 0，结束时用 finalize 回填
+    static bool writeHeader(QIODevice* device, const WavFormat& format, qint64 dataBytes = 0);
+    static bool finalize(QFile* file, const WavFormat& format, qint64 dataBytes);
+    // 按扩展名判断是否为 WAV (其他视为裸 PCM)
+    static bool isWavPath(const QString& path);
+
+    static const int HEADER_SIZE = 44;
+};
@@ -2,8 +2,10 @@
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QDebug>
 #include <QDir>
+#include <QCoreApplication>
 
 ConfigManager* ConfigManager::s_instance = nullptr;
 
@@ -34,9 +36,73 @@ void ConfigManager::loadDefaults()
     m_videoWidth = 640;
     m_videoHeight = 480;
     m_videoFrameRate = 15;
+    m_videoSource = "camera";
+    m_videoLatencyStamp = false;
+    m_audioPrerollMs = 3000;
+    m_audioPrerollFlushMs = 300;
+    m_audioBackend = "alsa";
+    m_audioInputFile.clear();
+    m_audioOutputFile.clear();
+    m_audioFileRealtime = true;
+    m_audioFileLoop = false;
+    m_audioFileOutputLatencyMs = 0;
+    m_audioPlaybackDevice = "hw:1,0";
+    m_audioPlaybackMixer.clear();
+    m_audioPlaybackPeriodMs = 10;
+    m_audioPlaybackPeriods = 4;
+    m_audioPlaybackSampleRate = 0;
+    m_audioPlaybackChannels = 0;
+    m_audioAecReference = false;
+    m_audioJitterMinMs = 40;
+    m_audioJitterMaxMs = 200;
+    m_wakeWordModel.clear();
+    m_wakeWordThreshold = 0.8;
+    m_bargeInEnabled = false;
+    m_bargeInMinSpeechMs = 200;
+    m_bargeInEchoMarginDb = 6.0;
+    m_bargeInDuckPercent = 20;
+    m_bargeInSignalAgent = false;
+    m_remoteMixPerStream = false;
+    m_remoteMixMaxStreams = 4;
+    m_remoteMixAgentPercent = 100;
+    m_remoteMixOtherPercent = 100;
+    m_remoteMixDuckOthersPercent = 30;
+    
+    // 默认线程策略: 音频线程实时调度，视频采集保持分时调度
+    ThreadPolicyConfig audioCapture;
+    audioCapture.name = "audio-in";
+    audioCapture.scheduler = ThreadPolicyConfig::Fifo;
+    audioCapture.priority = 60;
+    audioCapture.lockMemory = true;
+    m_threadPolicies["audioCapture"] = audioCapture;
+    
+    ThreadPolicyConfig audioRender;
+    audioRender.name = "audio-out";
+    audioRender.scheduler = ThreadPolicyConfig::Fifo;
+    audioRender.priority = 60;
+    audioRender.lockMemory = true;
+    m_threadPolicies["audioRender"] = audioRender;
+    
+    ThreadPolicyConfig videoCapture;
+    videoCapture.name = "video-capture";
+    m_threadPolicies["videoCapture"] = videoCapture;
     
     // 默认 UI 配置
     m_useGPURendering = true;
+    m_perfHud = false;
+    
+    // 默认遥测配置
+    m_telemetryReportDir.clear();
+    m_telemetryTrace = false;
+    m_metricsBindAddress = "127.0.0.1";
+    m_metricsPort = 0;
+    m_metricsSnapshotIntervalSec = 0;
+    m_metricsSnapshotMaxKB = 1024;
+    m_profilerFrequencyHz = 0;
+    m_profilerMaxSeconds = 30;
+    
+    // 控制接口默认关闭
+    m_controlSocketPath.clear();
 }
 
 bool ConfigManager::loadFromFile(const QString& path)
@@ -106,6 +172,127 @@ bool ConfigManager::loadFromFile(const QString& path)
             if (video.contains("frameRate")) {
                 m_videoFrameRate = video["frameRate"].toInt();
             }
+            if (video.contains("source")) {
+                m_videoSource = video["source"].toString() == "pattern" ? "pattern" : "camera";
+            }
+            if (video.contains("latencyStamp")) {
+                m_videoLatencyStamp = video["latencyStamp"].toBool();
+            }
+        }
+        if (media.contains("audio")) {
+            QJsonObject audio = media["audio"].toObject();
+            if (audio.contains("prerollMs")) {
+                m_audioPrerollMs = audio["prerollMs"].toInt();
+            }
+            if (audio.contains("prerollFlushMs")) {
+                m_audioPrerollFlushMs = audio["prerollFlushMs"].toInt();
+            }
+            if (audio.contains("backend")) {
+                m_audioBackend = audio["backend"].toString();
+            }
+            if (audio.contains("file")) {
+                QJsonObject file = audio["file"].toObject();
+                if (file.contains("input")) {
+                    m_audioInputFile = file["input"].toString();
+                }
+                if (file.contains("output")) {
+                    m_audioOutputFile = file["output"].toString();
+                }
+                if (file.contains("realtime")) {
+                    m_audioFileRealtime = file["realtime"].toBool();
+                }
+                if (file.contains("loop")) {
+                    m_audioFileLoop = file["loop"].toBool();
+                }
+                if (file.contains("outputLatencyMs")) {
+                    m_audioFileOutputLatencyMs = qBound(0, file["outputLatencyMs"].toInt(), 500);
+                }
+            }
+            if (audio.contains("playback")) {
+                QJsonObject playback = audio["playback"].toObject();
+                if (playback.contains("device")) {
+                    m_audioPlaybackDevice = playback["device"].toString();
+                }
+                if (playback.contains("mixer")) {
+                    m_audioPlaybackMixer = playback["mixer"].toString();
+                }
+                if (playback.contains("periodMs")) {
+                    m_audioPlaybackPeriodMs = qBound(2, playback["periodMs"].toInt(), 100);
+                }
+                if (playback.contains("periods")) {
+                    m_audioPlaybackPeriods = qBound(2, playback["periods"].toInt(), 32);
+                }
+                if (playback.contains("sampleRate")) {
+                    m_audioPlaybackSampleRate = qMax(0, playback["sampleRate"].toInt());
+                }
+                if (playback.contains("channels")) {
+                    m_audioPlaybackChannels = qBound(0, playback["channels"].toInt(), 2);
+                }
+                if (playback.contains("aecReference")) {
+                    m_audioAecReference = playback["aecReference"].toBool();
+                }
+            }
+            if (audio.contains("jitter")) {
+                QJsonObject jitter = audio["jitter"].toObject();
+                if (jitter.contains("minMs")) {
+                    m_audioJitterMinMs = qBound(0, jitter["minMs"].toInt(), 1000);
+                }
+                if (jitter.contains("maxMs")) {
+                    m_audioJitterMaxMs = qBound(m_audioJitterMinMs, jitter["maxMs"].toInt(), 1000);
+                }
+            }
+            if (audio.contains("wakeWord")) {
+                QJsonObject wakeWord = audio["wakeWord"].toObject();
+                if (wakeWord.contains("model")) {
+                    m_wakeWordModel = wakeWord["model"].toString();
+                }
+                if (wakeWord.contains("threshold")) {
+                    m_wakeWordThreshold = wakeWord["threshold"].toDouble();
+                }
+            }
+            if (audio.contains("bargeIn")) {
+                QJsonObject bargeIn = audio["bargeIn"].toObject();
+                if (bargeIn.contains("enabled")) {
+                    m_bargeInEnabled = bargeIn["enabled"].toBool();
+                }
+                if (bargeIn.contains("minSpeechMs")) {
+                    m_bargeInMinSpeechMs = qBound(50, bargeIn["minSpeechMs"].toInt(), 2000);
+                }
+                if (bargeIn.contains("echoMarginDb")) {
+                    m_bargeInEchoMarginDb = qBound(0.0, bargeIn["echoMarginDb"].toDouble(), 30.0);
+                }
+                if (bargeIn.contains("duckPercent")) {
+                    m_bargeInDuckPercent = qBound(0, bargeIn["duckPercent"].toInt(), 100);
+                }
+                if (bargeIn.contains("signalAgent")) {
+                    m_bargeInSignalAgent = bargeIn["signalAgent"].toBool();
+                }
+            }
+            if (audio.contains("remoteMix")) {
+                QJsonObject remoteMix = audio["remoteMix"].toObject();
+                if (remoteMix.contains("perStream")) {
+                    m_remoteMixPerStream = remoteMix["perStream"].toBool();
+                }
+                if (remoteMix.contains("maxStreams")) {
+                    m_remoteMixMaxStreams = qBound(1, remoteMix["maxStreams"].toInt(), 16);
+                }
+                if (remoteMix.contains("agentPercent")) {
+                    m_remoteMixAgentPercent = qBound(0, remoteMix["agentPercent"].toInt(), 100);
+                }
+                if (remoteMix.contains("otherPercent")) {
+                    m_remoteMixOtherPercent = qBound(0, remoteMix["otherPercent"].toInt(), 100);
+                }
+                if (remoteMix.contains("duckOthersPercent")) {
+                    m_remoteMixDuckOthersPercent = qBound(0, remoteMix["duckOthersPercent"].toInt(), 100);
+                }
+            }
+        }
+        if (media.contains("threads")) {
+            QJsonObject threads = media["threads"].toObject();
+            for (auto it = threads.constBegin(); it != threads.constEnd(); ++it) {
+                m_threadPolicies[it.key()] = parseThreadPolicy(it.value().toObject(),
+                                                               m_threadPolicies.value(it.key()));
+            }
         }
     }
     
@@ -115,6 +302,52 @@ bool ConfigManager::loadFromFile(const QString& path)
         if (ui.contains("useGPURendering")) {
             m_useGPURendering = ui["useGPURendering"].toBool();
         }
+        if (ui.contains("perfHud")) {
+            m_perfHud = ui["perfHud"].toBool();
+        }
+    }
+    
+    // 解析遥测配置
+    if (root.contains("telemetry")) {
+        QJsonObject telemetry = root["telemetry"].toObject();
+        if (telemetry.contains("reportDir")) {
+            m_telemetryReportDir = telemetry["reportDir"].toString();
+        }
+        if (telemetry.contains("trace")) {
+            m_telemetryTrace = telemetry["trace"].toBool();
+        }
+        if (telemetry.contains("metrics")) {
+            QJsonObject metrics = telemetry["metrics"].toObject();
+            if (metrics.contains("bindAddress")) {
+                m_metricsBindAddress = metrics["bindAddress"].toString();
+            }
+            if (metrics.contains("port")) {
+                m_metricsPort = qBound(0, metrics["port"].toInt(), 65535);
+            }
+            if (metrics.contains("snapshotIntervalSec")) {
+                m_metricsSnapshotIntervalSec = qMax(0, metrics["snapshotIntervalSec"].toInt());
+            }
+            if (metrics.contains("snapshotMaxKB")) {
+                m_metricsSnapshotMaxKB = qMax(16, metrics["snapshotMaxKB"].toInt());
+            }
+        }
+        if (telemetry.contains("profiler")) {
+            QJsonObject profiler = telemetry["profiler"].toObject();
+            if (profiler.contains("frequencyHz")) {
+                m_profilerFrequencyHz = qBound(0, profiler["frequencyHz"].toInt(), 1000);
+            }
+            if (profiler.contains("maxSeconds")) {
+                m_profilerMaxSeconds = qMax(1, profiler["maxSeconds"].toInt());
+            }
+        }
+    }
+    
+    // 解析控制接口配置
+    if (root.contains("control")) {
+        QJsonObject control = root["control"].toObject();
+        if (control.contains("socketPath")) {
+            m_controlSocketPath = control["socketPath"].toString();
+        }
     }
     
     m_configPath = path;
@@ -124,6 +357,7 @@ bool ConfigManager::loadFromFile(const QString& path)
     qDebug() << "  AppId:" << m_appId;
     qDebug() << "  ServerUrl:" << m_serverUrl;
     qDebug() << "  Video:" << m_videoWidth << "x" << m_videoHeight << "@" << m_videoFrameRate << "fps";
+    qDebug() << "  Audio backend:" << m_audioBackend;
     qDebug() << "  GPU Rendering:" << m_useGPURendering;
     
     emit configLoaded();
@@ -149,14 +383,86 @@ bool ConfigManager::saveToFile(const QString& path)
     video["width"] = m_videoWidth;
     video["height"] = m_videoHeight;
     video["frameRate"] = m_videoFrameRate;
+    video["source"] = m_videoSource;
+    video["latencyStamp"] = m_videoLatencyStamp;
     media["video"] = video;
+    QJsonObject audio;
+    audio["prerollMs"] = m_audioPrerollMs;
+    audio["prerollFlushMs"] = m_audioPrerollFlushMs;
+    audio["backend"] = m_audioBackend;
+    QJsonObject audioFile;
+    audioFile["input"] = m_audioInputFile;
+    audioFile["output"] = m_audioOutputFile;
+    audioFile["realtime"] = m_audioFileRealtime;
+    audioFile["loop"] = m_audioFileLoop;
+    audioFile["outputLatencyMs"] = m_audioFileOutputLatencyMs;
+    audio["file"] = audioFile;
+    QJsonObject playback;
+    playback["device"] = m_audioPlaybackDevice;
+    playback["mixer"] = m_audioPlaybackMixer;
+    playback["periodMs"] = m_audioPlaybackPeriodMs;
+    playback["periods"] = m_audioPlaybackPeriods;
+    playback["sampleRate"] = m_audioPlaybackSampleRate;
+    playback["channels"] = m_audioPlaybackChannels;
+    playback["aecReference"] = m_audioAecReference;
+    audio["playback"] = playback;
+    QJsonObject jitter;
+    jitter["minMs"] = m_audioJitterMinMs;
+    jitter["maxMs"] = m_audioJitterMaxMs;
+    audio["jitter"] = jitter;
+    QJsonObject wakeWord;
+    wakeWord["model"] = m_wakeWordModel;
+    wakeWord["threshold"] = m_wakeWordThreshold;
+    audio["wakeWord"] = wakeWord;
+    QJsonObject bargeIn;
+    bargeIn["enabled"] = m_bargeInEnabled;
+    bargeIn["minSpeechMs"] = m_bargeInMinSpeechMs;
+    bargeIn["echoMarginDb"] = m_bargeInEchoMarginDb;
+    bargeIn["duckPercent"] = m_bargeInDuckPercent;
+    bargeIn["signalAgent"] = m_bargeInSignalAgent;
+    audio["bargeIn"] = bargeIn;
+    QJsonObject remoteMix;
+    remoteMix["perStream"] = m_remoteMixPerStream;
+    remoteMix["maxStreams"] = m_remoteMixMaxStreams;
+    remoteMix["agentPercent"] = m_remoteMixAgentPercent;
+    remoteMix["otherPercent"] = m_remoteMixOtherPercent;
+    remoteMix["duckOthersPercent"] = m_remoteMixDuckOthersPercent;
+    audio["remoteMix"] = remoteMix;
+    media["audio"] = audio;
+    QJsonObject threads;
+    for (auto it = m_threadPolicies.constBegin(); it != m_threadPolicies.constEnd(); ++it) {
+        threads[it.key()] = threadPolicyToJson(it.value());
+    }
+    media["threads"] = threads;
     root["media"] = media;
     
     // UI 配置
     QJsonObject ui;
     ui["useGPURendering"] = m_useGPURendering;
+    ui["perfHud"] = m_perfHud;
     root["ui"] = ui;
     
+    // 遥测配置
+    QJsonObject telemetry;
+    telemetry["reportDir"] = m_telemetryReportDir;
+    telemetry["trace"] = m_telemetryTrace;
+    QJsonObject metrics;
+    metrics["bindAddress"] = m_metricsBindAddress;
+    metrics["port"] = m_metricsPort;
+    metrics["snapshotIntervalSec"] = m_metricsSnapshotIntervalSec;
+    metrics["snapshotMaxKB"] = m_metricsSnapshotMaxKB;
+    telemetry["metrics"] = metrics;
+    QJsonObject profiler;
+    profiler["frequencyHz"] = m_profilerFrequencyHz;
+    profiler["maxSeconds"] = m_profilerMaxSeconds;
+    telemetry["profiler"] = profiler;
+    root["telemetry"] = telemetry;
+    
+    // 控制接口配置
+    QJsonObject control;
+    control["socketPath"] = m_controlSocketPath;
+    root["control"] = control;
+    
     QJsonDocument doc(root);
     
     QFile file(path);
@@ -198,3 +504,99 @@ void ConfigManager::setServerUrl(const QString& url)
         emit configChanged();
     }
 }
+
+void ConfigManager::setVideoFormat(int width, int height, int frameRate)
+{
+    if (m_videoWidth != width || m_videoHeight != height || m_videoFrameRate != frameRate) {
+        m_videoWidth = width;
+        m_videoHeight = height;
+        m_videoFrameRate = frameRate;
+        emit configChanged();
+    }
+}
+
+void ConfigManager::setAudioPlaybackBuffer(int periodMs, int periods)
+{
+    if (m_audioPlaybackPeriodMs != periodMs || m_audioPlaybackPeriods != periods) {
+        m_audioPlaybackPeriodMs = periodMs;
+        m_audioPlaybackPeriods = periods;
+        emit configChanged();
+    }
+}
+
+void ConfigManager::setAudioJitterRange(int minMs, int maxMs)
+{
+    if (m_audioJitterMinMs != minMs || m_audioJitterMaxMs != maxMs) {
+        m_audioJitterMinMs = minMs;
+        m_audioJitterMaxMs = maxMs;
+        emit configChanged();
+    }
+}
+
+void ConfigManager::setUseGPURendering(bool enabled)
+{
+    if (m_useGPURendering != enabled) {
+        m_useGPURendering = enabled;
+        emit configChanged();
+    }
+}
+
+void ConfigManager::setPerfHud(bool visible)
+{
+    if (m_perfHud != visible) {
+        m_perfHud = visible;
+        emit configChanged();
+    }
+}
+
+ThreadPolicyConfig ConfigManager::threadPolicy(const QString& key) const
+{
+    return m_threadPolicies.value(key);
+}
+
+QString ConfigManager::telemetryReportPath() const
+{
+    if (m_telemetryReportDir.isEmpty() || !QDir::isRelativePath(m_telemetryReportDir)) {
+        return m_telemetryReportDir;
+    }
+    return QDir(QCoreApplication::applicationDirPath()).filePath(m_telemetryReportDir);
+}
+
+ThreadPolicyConfig ConfigManager::parseThreadPolicy(const QJsonObject& obj, const ThreadPolicyConfig& base)
+{
+    ThreadPolicyConfig policy = base;
+    if (obj.contains("name")) {
+        policy.name = obj["name"].toString();
+    }
+    if (obj.contains("scheduler")) {
+        policy.scheduler = ThreadPolicyConfig::schedulerFromString(obj["scheduler"].toString());
+    }
+    if (obj.contains("priority")) {
+        policy.priority = obj["priority"].toInt();
+    }
+    if (obj.contains("cpus")) {
+        policy.cpus.clear();
+        for (const QJsonValue& cpu : obj["cpus"].toArray()) {
+            policy.cpus.append(cpu.toInt());
+        }
+    }
+    if (obj.contains("lockMemory")) {
+        policy.lockMemory = obj["lockMemory"].toBool();
+    }
+    return policy;
+}
+
+QJsonObject ConfigManager::threadPolicyToJson(const ThreadPolicyConfig& policy)
+{
+    QJsonObject obj;
+    obj["name"] = policy.name;
+    obj["scheduler"] = ThreadPolicyConfig::schedulerToString(policy.scheduler);
+    obj["priority"] = policy.priority;
+    QJsonArray cpus;
+    for (int cpu : policy.cpus) {
+        cpus.append(cpu);
+    }
+    obj["cpus"] = cpus;
+    obj["lockMemory"] = policy.lockMemory;
+    return obj;
+}
@@ -3,6 +3,8 @@
 #include <QObject>
 #include <QString>
 #include <QJsonObject>
+#include <QMap>
+#include "ThreadPolicy.h"
 
 /**
  * 配置管理器
@@ -19,6 +21,8 @@ public:
     bool loadFromFile(const QString& path);
     bool saveToFile(const QString& path);
     bool isLoaded() const { return m_loaded; }
+    // 最近一次加载/保存的配置文件路径
+    QString configPath() const { return m_configPath; }
     
     // RTC 配置
     QString appId() const { return m_appId; }
@@ -31,14 +35,85 @@ public:
     int videoWidth() const { return m_videoWidth; }
     int videoHeight() const { return m_videoHeight; }
     int videoFrameRate() const { return m_videoFrameRate; }
+    // 视频源: "camera" (CSI/USB 摄像头) 或 "pattern" (合成测试图案)
+    QString videoSource() const { return m_videoSource; }
+    // 每帧写入时间戳图案，在视频 sink 和渲染控件处统计端到端延迟
+    bool videoLatencyStamp() const { return m_videoLatencyStamp; }
+    int audioPrerollMs() const { return m_audioPrerollMs; }
+    int audioPrerollFlushMs() const { return m_audioPrerollFlushMs; }
+    // 音频后端: "alsa" (USB 麦克风/扬声器) 或 "file" (WAV/PCM 文件回放与录制)
+    QString audioBackend() const { return m_audioBackend; }
+    QString audioInputFile() const { return m_audioInputFile; }
+    QString audioOutputFile() const { return m_audioOutputFile; }
+    bool audioFileRealtime() const { return m_audioFileRealtime; }
+    bool audioFileLoop() const { return m_audioFileLoop; }
+    // 文件播放时模拟的声卡缓冲深度 (ms)，用于离线校验回声参考对齐
+    int audioFileOutputLatencyMs() const { return m_audioFileOutputLatencyMs; }
+    // ALSA 播放设备 (alsa 后端)，混音器控件为空时自动选择
+    QString audioPlaybackDevice() const { return m_audioPlaybackDevice; }
+    QString audioPlaybackMixer() const { return m_audioPlaybackMixer; }
+    int audioPlaybackPeriodMs() const { return m_audioPlaybackPeriodMs; }
+    int audioPlaybackPeriods() const { return m_audioPlaybackPeriods; }
+    // 播放回调格式，0 表示按声卡能力自动选择
+    int audioPlaybackSampleRate() const { return m_audioPlaybackSampleRate; }
+    int audioPlaybackChannels() const { return m_audioPlaybackChannels; }
+    // 把播出的音频推回 SDK 作为回声消除参考
+    bool audioAecReference() const { return m_audioAecReference; }
+    // 远端音频抖动缓冲目标深度范围 (ms)
+    int audioJitterMinMs() const { return m_audioJitterMinMs; }
+    int audioJitterMaxMs() const { return m_audioJitterMaxMs; }
+    // 待机唤醒词: 模型路径为空或加载失败时不启用
+    QString wakeWordModel() const { return m_wakeWordModel; }
+    double wakeWordThreshold() const { return m_wakeWordThreshold; }
+    // 本地插话检测: AI 播放期间检测到用户说话时闪避播放，可选通知智能体打断
+    bool bargeInEnabled() const { return m_bargeInEnabled; }
+    int bargeInMinSpeechMs() const { return m_bargeInMinSpeechMs; }
+    double bargeInEchoMarginDb() const { return m_bargeInEchoMarginDb; }
+    int bargeInDuckPercent() const { return m_bargeInDuckPercent; }
+    bool bargeInSignalAgent() const { return m_bargeInSignalAgent; }
+    // 远端分流混音: 按远端流分别接收并混音，智能体优先，其发声时其他参与者闪避
+    bool remoteMixPerStream() const { return m_remoteMixPerStream; }
+    int remoteMixMaxStreams() const { return m_remoteMixMaxStreams; }
+    int remoteMixAgentPercent() const { return m_remoteMixAgentPercent; }
+    int remoteMixOtherPercent() const { return m_remoteMixOtherPercent; }
+    int remoteMixDuckOthersPercent() const { return m_remoteMixDuckOthersPercent; }
+    
+    // 线程调度配置 (key: audioCapture / audioRender / videoCapture)
+    ThreadPolicyConfig threadPolicy(const QString& key) const;
     
     // UI 配置
     bool useGPURendering() const { return m_useGPURendering; }
+    // 启动时显示性能 HUD
+    bool perfHud() const { return m_perfHud; }
+    
+    // 遥测: 每次通话结束时导出轮次/视频延迟报告的目录，为空时不导出；相对路径相对于程序所在目录
+    QString telemetryReportDir() const { return m_telemetryReportDir; }
+    // 解析为绝对路径的报告目录，未配置时为空
+    QString telemetryReportPath() const;
+    // 启动时即开始热路径追踪 (运行中可用 SIGUSR2 切换)
+    bool telemetryTrace() const { return m_telemetryTrace; }
+    // 指标导出: HTTP 端口为 0 时不提供 /metrics；快照间隔为 0 时不写快照文件 (写在报告目录的 metrics.prom)
+    QString metricsBindAddress() const { return m_metricsBindAddress; }
+    int metricsPort() const { return m_metricsPort; }
+    int metricsSnapshotIntervalSec() const { return m_metricsSnapshotIntervalSec; }
+    int metricsSnapshotMaxKB() const { return m_metricsSnapshotMaxKB; }
+    // 采样分析器: 频率为 0 时不启用；单个窗口最长 profilerMaxSeconds 秒
+    int profilerFrequencyHz() const { return m_profilerFrequencyHz; }
+    int profilerMaxSeconds() const { return m_profilerMaxSeconds; }
+    
+    // 运行时控制套接字 (Unix 域)，为空时不启用
+    QString controlSocketPath() const { return m_controlSocketPath; }
     
     // 运行时修改
     void setAppId(const QString& appId);
     void setAppKey(const QString& appKey);
     void setServerUrl(const QString& url);
+    // 控制接口修改后同步到配置，保存时写入文件
+    void setVideoFormat(int width, int height, int frameRate);
+    void setAudioPlaybackBuffer(int periodMs, int periods);
+    void setAudioJitterRange(int minMs, int maxMs);
+    void setUseGPURendering(bool enabled);
+    void setPerfHud(bool visible);
     
 signals:
     void configChanged();
@@ -54,6 +129,8 @@ private:
     ConfigManager& operator=(const ConfigManager&) = delete;
     
     void loadDefaults();
+    static ThreadPolicyConfig parseThreadPolicy(const QJsonObject& obj, const ThreadPolicyConfig& base);
+    static QJsonObject threadPolicyToJson(const ThreadPolicyConfig& policy);
     
     static ConfigManager* s_instance;
     bool m_loaded = false;
@@ -70,7 +147,53 @@ private:
     int m_videoWidth = 640;
     int m_videoHeight = 480;
     int m_videoFrameRate = 15;
+    QString m_videoSource = "camera";
+    bool m_videoLatencyStamp = false;
+    int m_audioPrerollMs = 3000;        // 预录环形缓冲时长
+    int m_audioPrerollFlushMs = 300;    // AI 启动/取消静音时补推的时长
+    QString m_audioBackend = "alsa";
+    QString m_audioInputFile;
+    QString m_audioOutputFile;
+    bool m_audioFileRealtime = true;
+    bool m_audioFileLoop = false;
+    int m_audioFileOutputLatencyMs = 0;
+    QString m_audioPlaybackDevice = "hw:1,0";
+    QString m_audioPlaybackMixer;
+    int m_audioPlaybackPeriodMs = 10;
+    int m_audioPlaybackPeriods = 4;
+    int m_audioPlaybackSampleRate = 0;
+    int m_audioPlaybackChannels = 0;
+    bool m_audioAecReference = false;
+    int m_audioJitterMinMs = 40;
+    int m_audioJitterMaxMs = 200;
+    QString m_wakeWordModel;
+    double m_wakeWordThreshold = 0.8;
+    bool m_bargeInEnabled = false;
+    int m_bargeInMinSpeechMs = 200;
+    double m_bargeInEchoMarginDb = 6.0;
+    int m_bargeInDuckPercent = 20;
+    bool m_bargeInSignalAgent = false;
+    bool m_remoteMixPerStream = false;
+    int m_remoteMixMaxStreams = 4;
+    int m_remoteMixAgentPercent = 100;
+    int m_remoteMixOtherPercent = 100;
+    int m_remoteMixDuckOthersPercent = 30;
+    QMap<QString, ThreadPolicyConfig> m_threadPolicies;
     
     // UI 配置
     bool m_useGPURendering = true;
+    bool m_perfHud = false;
+    
+    // 遥测配置
+    QString m_telemetryReportDir;
+    bool m_telemetryTrace = false;
+    QString m_metricsBindAddress;
+    int m_metricsPort = 0;
+    int m_metricsSnapshotIntervalSec = 0;
+    int m_metricsSnapshotMaxKB = 1024;
+    int m_profilerFrequencyHz = 0;
+    int m_profilerMaxSeconds = 30;
+    
+    // 控制接口
+    QString m_controlSocketPath;
 };
@@ -4,19 +4,56 @@
 #include "ExternalVideoSource.h"
 #include "ExternalAudioSource.h"
 #include "ExternalAudioRender.h"
+#include "FileAudioSource.h"
+#include "FileAudioRender.h"
+#include "KeywordSpotter.h"
+#include "VideoLatencyMonitor.h"
+#include "TraceRecorder.h"
+#include "MetricsRegistry.h"
+#include "ThreadPolicy.h"
+#include "AllocAudit.h"
+#include "ControlRegistry.h"
 #include "rtc/bytertc_audio_device_manager.h"
 #include <QDebug>
+#include <QJsonObject>
+#include <QTimer>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 
 #define LOG_MODULE "MediaManager"
 
+// 回环模式与采集端一致: 16kHz 单声道，每帧 10ms
+static const int LOOPBACK_SAMPLE_RATE = 16000;
+static const int LOOPBACK_MAX_LATENCY_MS = 1000;
+// 指标同步周期，与 SDK 统计回调 (2 秒) 同量级即可
+static const int METRICS_PUBLISH_INTERVAL_MS = 1000;
+
+static int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 MediaManager::MediaManager(QObject* parent)
     : QObject(parent)
 {
+    ConfigManager* config = ConfigManager::instance();
+    if (config->metricsPort() > 0 || config->metricsSnapshotIntervalSec() > 0) {
+        m_metricsTimer = new QTimer(this);
+        connect(m_metricsTimer, &QTimer::timeout, this, &MediaManager::publishMetrics);
+        m_metricsTimer->start(METRICS_PUBLISH_INTERVAL_MS);
+    }
+    registerControlCommands();
 }
 
 MediaManager::~MediaManager()
 {
+    stopLoopback();
     stopAll();
+    if (m_audioSource) {
+        m_audioSource->stopCapture();
+    }
 }
 
 void MediaManager::initialize(bytertc::IRTCEngine* engine)
@@ -46,8 +83,7 @@ void MediaManager::initialize(bytertc::IRTCEngine* engine)
     
     // 创建视频源
     if (!m_videoSource) {
-        m_videoSource = new ExternalVideoSource(this);
-        connect(m_videoSource, &ExternalVideoSource::cameraError, this, &MediaManager::cameraError);
+        m_videoSource = createVideoSource();
     }
     m_videoSource->setRTCEngine(m_engine);
     
@@ -56,18 +92,24 @@ void MediaManager::initialize(bytertc::IRTCEngine* engine)
     LOG_DEBUG(QString("setAudioSourceType(External) ret: %1").arg(audioSourceRet));
     
     if (audioSourceRet == 0) {
-        // 外部音频源可用
+        // 外部音频源可用 (预热时已创建则直接挂接引擎)
         if (!m_audioSource) {
-            m_audioSource = new ExternalAudioSource(this);
+            m_audioSource = createAudioSource();
         }
         m_audioSource->setRTCEngine(m_engine);
     } else {
         LOG_WARN("External audio source not available, using internal");
+        if (m_audioSource) {
+            // 释放麦克风给 SDK 内部采集
+            m_audioSource->stopCapture();
+            m_audioSource->deleteLater();
+            m_audioSource = nullptr;
+        }
     }
     
     // 创建音频渲染
     if (!m_audioRender) {
-        m_audioRender = new ExternalAudioRender(this);
+        m_audioRender = createAudioRender();
     }
     m_audioRender->setRTCEngine(m_engine);
     
@@ -84,7 +126,13 @@ void MediaManager::startAll()
 void MediaManager::stopAll()
 {
     stopVideoCapture();
-    stopAudioCapture();
+    if (m_audioSource && m_audioSource->isCapturing()) {
+        // 麦克风保持打开继续预录，只断开引擎，之后引擎可以安全销毁
+        m_audioSource->setRTCEngine(nullptr);
+        LOG_DEBUG("Audio capture detached from engine, pre-roll kept running");
+    } else {
+        stopAudioCapture();
+    }
     stopAudioRender();
 }
 
@@ -109,6 +157,44 @@ bool MediaManager::isVideoCapturing() const
     return m_videoSource && m_videoSource->isCapturing();
 }
 
+void MediaManager::setVideoCaptureSuspended(bool suspended)
+{
+    if (m_videoSource && m_videoSource->isSuspended() != suspended) {
+        m_videoSource->setSuspended(suspended);
+        LOG_DEBUG(QString("Video capture %1").arg(suspended ? "suspended" : "resumed"));
+    }
+}
+
+bool MediaManager::isVideoCaptureSuspended() const
+{
+    return m_videoSource && m_videoSource->isSuspended();
+}
+
+void MediaManager::setVideoFormat(int width, int height, int frameRate)
+{
+    ConfigManager::instance()->setVideoFormat(width, height, frameRate);
+    if (m_engine) {
+        bytertc::VideoEncoderConfig conf;
+        conf.frame_rate = frameRate;
+        conf.width = width;
+        conf.height = height;
+        m_engine->setVideoEncoderConfig(conf);
+    }
+    if (m_videoSource) {
+        // 管道的 caps 在创建时固定，只能重建管道；挂起状态在重启后保持
+        bool wasCapturing = m_videoSource->isCapturing();
+        if (wasCapturing) {
+            m_videoSource->stopCapture();
+        }
+        m_videoSource->setCaptureFormat(width, height, frameRate);
+        if (wasCapturing) {
+            m_videoSource->startCapture();
+        }
+    }
+    LOG_INFO(QString("Video format changed to %1x%2@%3fps").arg(width).arg(height).arg(frameRate));
+    emit videoFormatChanged();
+}
+
 void MediaManager::startAudioCapture()
 {
     if (m_audioSource) {
@@ -133,6 +219,164 @@ bool MediaManager::isAudioCapturing() const
     return m_audioSource && m_audioSource->isCapturing();
 }
 
+void MediaManager::setAudioCaptureSuspended(bool suspended)
+{
+    if (m_audioSource && m_audioSource->isSuspended() != suspended) {
+        m_audioSource->setSuspended(suspended);
+        LOG_DEBUG(QString("Audio capture %1").arg(suspended ? "suspended" : "resumed"));
+    }
+}
+
+void MediaManager::warmUpAudioCapture()
+{
+    if (m_audioSource) {
+        return;
+    }
+    
+    m_audioSource = createAudioSource();
+    m_audioSource->setPushEnabled(false);
+    m_audioSource->startCapture();
+    LOG_INFO(QString("Audio capture warmed up, pre-roll %1 ms")
+             .arg(ConfigManager::instance()->audioPrerollMs()));
+}
+
+ExternalVideoSource* MediaManager::createVideoSource()
+{
+    ConfigManager* config = ConfigManager::instance();
+    ExternalVideoSource* source = new ExternalVideoSource(this);
+    connect(source, &ExternalVideoSource::cameraError, this, &MediaManager::cameraError);
+    source->setThreadPolicy(config->threadPolicy("videoCapture"));
+    source->setCaptureFormat(config->videoWidth(), config->videoHeight(), config->videoFrameRate());
+    
+    if (config->videoSource() == "pattern") {
+        source->setCamera(ExternalVideoSource::testPatternCamera());
+        LOG_INFO("Video source: test pattern");
+    }
+    // 端到端延迟测量: 采集端写入时间戳图案，sink 和渲染控件解码统计
+    source->setFrameStamping(config->videoLatencyStamp());
+    VideoLatencyMonitor::instance()->setEnabled(config->videoLatencyStamp());
+    return source;
+}
+
+ExternalAudioSource* MediaManager::createAudioSource()
+{
+    ConfigManager* config = ConfigManager::instance();
+    ExternalAudioSource* source = nullptr;
+    
+    if (config->audioBackend() == "file" && !config->audioInputFile().isEmpty()) {
+        source = new FileAudioSource(config->audioInputFile(), config->audioFileRealtime(),
+                                     config->audioFileLoop(), this);
+        LOG_INFO(QString("Audio source: file %1").arg(config->audioInputFile()));
+    } else {
+        source = new ExternalAudioSource(this);
+    }
+    
+    source->setThreadPolicy(config->threadPolicy("audioCapture"));
+    source->setPrerollDuration(config->audioPrerollMs());
+    source->setLevelMeter(&m_captureLevel);
+    // 轮次统计的语音检测同样需要回声估计，播放监视器总是设置
+    source->setPlaybackMonitor(&m_playbackMonitor);
+    source->setTurnTracker(&m_turnTracker);
+    
+    if (config->bargeInEnabled()) {
+        BargeInDetector::Config bargeIn;
+        bargeIn.minSpeechMs = config->bargeInMinSpeechMs();
+        bargeIn.echoMarginDb = static_cast<float>(config->bargeInEchoMarginDb());
+        source->setBargeInConfig(bargeIn);
+        source->setBargeInEnabled(true);
+        connect(source, &ExternalAudioSource::bargeInDetected,
+                this, &MediaManager::bargeInDetected, Qt::QueuedConnection);
+    }
+    
+    if (!config->wakeWordModel().isEmpty()) {
+        KeywordSpotter* spotter = new KeywordSpotter();
+        if (spotter->loadModel(config->wakeWordModel())) {
+            spotter->setThreshold(static_cast<float>(config->wakeWordThreshold()));
+            source->setKeywordSpotter(spotter);
+            connect(source, &ExternalAudioSource::wakeWordDetected,
+                    this, &MediaManager::wakeWordDetected, Qt::QueuedConnection);
+        } else {
+            LOG_WARN("Wake word disabled: failed to load model");
+            delete spotter;
+        }
+    }
+    return source;
+}
+
+bool MediaManager::isWakeWordAvailable() const
+{
+    return m_audioSource && m_audioSource->hasKeywordSpotter();
+}
+
+bool MediaManager::isBargeInAvailable() const
+{
+    return m_audioSource && m_audioSource->isBargeInEnabled();
+}
+
+void MediaManager::setWakeWordEnabled(bool enabled)
+{
+    if (m_audioSource && m_audioSource->isWakeWordEnabled() != enabled) {
+        m_audioSource->setWakeWordEnabled(enabled);
+        LOG_DEBUG(QString("Wake word detection %1").arg(enabled ? "enabled" : "disabled"));
+    }
+}
+
+ExternalAudioRender* MediaManager::createAudioRender()
+{
+    ConfigManager* config = ConfigManager::instance();
+    ExternalAudioRender* render = nullptr;
+    
+    if (config->audioBackend() == "file" && !config->audioOutputFile().isEmpty()) {
+        FileAudioRender* fileRender = new FileAudioRender(config->audioOutputFile(), config->audioFileRealtime(), this);
+        fileRender->setSimulatedLatency(config->audioFileOutputLatencyMs());
+        render = fileRender;
+        LOG_INFO(QString("Audio render: file %1").arg(config->audioOutputFile()));
+    } else {
+        render = new ExternalAudioRender(this);
+        AlsaPlaybackDevice::Config device;
+        device.device = config->audioPlaybackDevice();
+        device.mixerControl = config->audioPlaybackMixer();
+        device.periodMs = config->audioPlaybackPeriodMs();
+        device.periodCount = config->audioPlaybackPeriods();
+        render->setDeviceConfig(device);
+    }
+    
+    render->setThreadPolicy(config->threadPolicy("audioRender"));
+    render->setJitterRange(config->audioJitterMinMs(), config->audioJitterMaxMs());
+    render->setPreferredFormat(config->audioPlaybackSampleRate(), config->audioPlaybackChannels());
+    render->setPlaybackMonitor(&m_playbackMonitor);
+    render->setLevelMeter(&m_playbackLevel);
+    render->setTurnTracker(&m_turnTracker);
+    render->setDuckLevel(config->bargeInDuckPercent());
+    render->setAecReferenceEnabled(config->audioAecReference());
+    if (config->remoteMixPerStream()) {
+        render->setMixMode(ExternalAudioRender::MixPerStream, config->remoteMixMaxStreams());
+        render->setStreamGains(config->remoteMixAgentPercent(), config->remoteMixOtherPercent(),
+                               config->remoteMixDuckOthersPercent());
+        LOG_INFO(QString("Remote audio: per-stream mix, up to %1 streams").arg(config->remoteMixMaxStreams()));
+    }
+    return render;
+}
+
+void MediaManager::suspendAudioPush()
+{
+    if (m_audioSource && m_audioSource->isPushEnabled()) {
+        m_audioSource->setPushEnabled(false);
+        LOG_DEBUG("Audio push suspended");
+    }
+}
+
+void MediaManager::resumeAudioPush(int flushMs)
+{
+    if (m_audioSource && !m_audioSource->isPushEnabled()) {
+        if (flushMs < 0) {
+            flushMs = ConfigManager::instance()->audioPrerollFlushMs();
+        }
+        m_audioSource->flushPreroll(flushMs);
+        LOG_DEBUG(QString("Audio push resumed, flushing %1 ms pre-roll").arg(flushMs));
+    }
+}
+
 void MediaManager::startAudioRender()
 {
     if (m_audioRender) {
@@ -154,6 +398,55 @@ bool MediaManager::isAudioRendering() const
     return m_audioRender && m_audioRender->isRendering();
 }
 
+void MediaManager::setAudioRenderBuffers(int periodMs, int periods, int jitterMinMs, int jitterMaxMs)
+{
+    ConfigManager* config = ConfigManager::instance();
+    config->setAudioPlaybackBuffer(periodMs, periods);
+    config->setAudioJitterRange(jitterMinMs, jitterMaxMs);
+    if (!m_audioRender) {
+        return;
+    }
+    
+    // 声卡参数和抖动缓冲都在 startRender 中配置，只能重启播放线程
+    // 回环模式下采集线程直接写入渲染端的缓冲，重启期间先停止采集
+    bool wasRendering = m_audioRender->isRendering();
+    bool restartCapture = wasRendering && m_loopbackActive && m_audioSource && m_audioSource->isCapturing();
+    if (restartCapture) {
+        m_audioSource->stopCapture();
+    }
+    if (wasRendering) {
+        m_audioRender->stopRender();
+    }
+    AlsaPlaybackDevice::Config device = m_audioRender->deviceConfig();
+    device.periodMs = periodMs;
+    device.periodCount = periods;
+    m_audioRender->setDeviceConfig(device);
+    m_audioRender->setJitterRange(jitterMinMs, jitterMaxMs);
+    if (wasRendering) {
+        m_audioRender->startRender();
+    }
+    if (restartCapture) {
+        m_audioSource->startCapture();
+    }
+    LOG_INFO(QString("Audio render buffers: period %1 ms x %2, jitter %3-%4 ms")
+             .arg(periodMs).arg(periods).arg(jitterMinMs).arg(jitterMaxMs));
+}
+
+void MediaManager::interruptPlayback()
+{
+    // m_audioRender 创建后随 MediaManager 一起销毁，interrupt 本身无锁
+    if (m_audioRender && m_audioRender->isRendering()) {
+        m_audioRender->interrupt();
+    }
+}
+
+void MediaManager::setAgentUserId(const QString& userId)
+{
+    if (m_audioRender) {
+        m_audioRender->setPriorityUser(userId);
+    }
+}
+
 QList<CameraInfo> MediaManager::detectCameras()
 {
     return ExternalVideoSource::detectCamerasStatic();
@@ -228,6 +521,218 @@ bool MediaManager::isSpeakerMuted() const
     return m_audioRender && m_audioRender->isMuted();
 }
 
+double MediaManager::captureDriftPpm() const
+{
+    return m_audioSource ? m_audioSource->driftPpm() : 0.0;
+}
+
+double MediaManager::renderDriftPpm() const
+{
+    return m_audioRender ? m_audioRender->driftPpm() : 0.0;
+}
+
+int MediaManager::renderLatencyMs() const
+{
+    return m_audioRender ? m_audioRender->outputLatencyMs() : 0;
+}
+
+JitterBuffer::Stats MediaManager::renderJitterStats() const
+{
+    return m_audioRender ? m_audioRender->jitterStats() : JitterBuffer::Stats();
+}
+
+int MediaManager::renderInterruptLatencyMs() const
+{
+    return m_audioRender ? m_audioRender->lastInterruptLatencyMs() : -1;
+}
+
+int MediaManager::renderActiveStreams() const
+{
+    return m_audioRender ? m_audioRender->activeRemoteStreams() : 0;
+}
+
+AudioLevelMeter::Reading MediaManager::captureLevel(int windowMs) const
+{
+    return m_captureLevel.read(windowMs);
+}
+
+AudioLevelMeter::Reading MediaManager::playbackLevel(int windowMs) const
+{
+    return m_playbackLevel.read(windowMs);
+}
+
+bool MediaManager::startLoopback(bool withVideo)
+{
+    if (m_loopbackActive) {
+        return true;
+    }
+    if (m_engine) {
+        LOG_WARN("Loopback is not available during a call");
+        return false;
+    }
+    
+    m_latencyProbe.configure(LOOPBACK_SAMPLE_RATE, LOOPBACK_MAX_LATENCY_MS);
+    m_loopbackBuffer.assign(LOOPBACK_SAMPLE_RATE / 100, 0);
+    m_chirpPos = -1;
+    m_chirpRequested = false;
+    m_latencyTestRemaining = 0;
+    m_latencyStats = LatencyStats();
+    connect(this, &MediaManager::loopbackLatencyMeasured, this, &MediaManager::onLoopbackLatency,
+            Qt::QueuedConnection);
+    
+    // 渲染端直接接收采集帧，回调格式与采集一致，不经过 SDK
+    if (!m_audioRender) {
+        m_audioRender = createAudioRender();
+    }
+    m_audioRender->setLocalInput(true);
+    m_audioRender->setMixMode(ExternalAudioRender::MixSdk);
+    // 回环不经过 SDK，不推送回声参考；文件后端模拟了声卡缓冲时照常走参考链路，只做对齐校验
+    FileAudioRender* fileRender = qobject_cast<FileAudioRender*>(m_audioRender);
+    m_audioRender->setAecReferenceEnabled(fileRender && ConfigManager::instance()->audioFileOutputLatencyMs() > 0);
+    m_audioRender->setPreferredFormat(LOOPBACK_SAMPLE_RATE, 1);
+    m_audioRender->startRender();
+    
+    // 采集端的本地回调需在启动前设置，预热中的采集先停止
+    if (m_audioSource) {
+        m_audioSource->stopCapture();
+    } else {
+        m_audioSource = createAudioSource();
+    }
+    m_audioSource->setLocalFrameCallback([this](const int16_t* samples, int count, int64_t timestampUs) {
+        processLoopbackFrame(samples, count, timestampUs);
+    });
+    m_audioSource->startCapture();
+    
+    if (withVideo) {
+        if (!m_videoSource) {
+            m_videoSource = createVideoSource();
+        }
+        m_videoSource->setLocalFrameCallback([this](const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                                                    int width, int height, int64_t) {
+            int ySize = width * height;
+            int uvSize = ySize / 4;
+            QByteArray frame(ySize + 2 * uvSize, Qt::Uninitialized);
+            memcpy(frame.data(), y, ySize);
+            memcpy(frame.data() + ySize, u, uvSize);
+            memcpy(frame.data() + ySize + uvSize, v, uvSize);
+            emit localVideoFrame(frame, width, height);
+        });
+        m_videoSource->startCapture();
+    }
+    
+    m_loopbackActive = true;
+    LOG_INFO(QString("Loopback started (%1)").arg(withVideo ? "audio + video" : "audio only"));
+    return true;
+}
+
+void MediaManager::stopLoopback()
+{
+    if (!m_loopbackActive) {
+        return;
+    }
+    m_loopbackActive = false;
+    m_latencyTestRemaining = 0;
+    disconnect(this, &MediaManager::loopbackLatencyMeasured, this, &MediaManager::onLoopbackLatency);
+    
+    if (m_videoSource) {
+        m_videoSource->stopCapture();
+        m_videoSource->setLocalFrameCallback(nullptr);
+    }
+    
+    // 采集恢复为预热状态 (只预录)
+    m_audioSource->stopCapture();
+    m_audioSource->setLocalFrameCallback(nullptr);
+    m_audioSource->setPushEnabled(false);
+    m_audioSource->startCapture();
+    
+    // 渲染端的本地输入设置不带入通话，之后按配置重新创建
+    m_audioRender->stopRender();
+    m_audioRender->deleteLater();
+    m_audioRender = nullptr;
+    LOG_INFO("Loopback stopped");
+}
+
+void MediaManager::setLoopbackMonitor(bool enabled)
+{
+    m_loopbackMonitor = enabled;
+}
+
+void MediaManager::startLatencyTest(int count, int intervalMs)
+{
+    if (!m_loopbackActive || count <= 0) {
+        return;
+    }
+    m_latencyStats = LatencyStats();
+    m_latencyTestRemaining = count;
+    // 间隔需覆盖最长等待时间，上一次 chirp 结束之前不会发出下一次
+    m_latencyTestIntervalMs = std::max(intervalMs, LOOPBACK_MAX_LATENCY_MS + LatencyProbe::CHIRP_MS);
+    // 第一次也等待一个间隔，让抖动缓冲和声卡进入稳态
+    QTimer::singleShot(m_latencyTestIntervalMs, this, [this] {
+        m_chirpRequested = m_latencyTestRemaining > 0;
+    });
+    LOG_INFO(QString("Latency test: %1 chirps, every %2 ms").arg(count).arg(m_latencyTestIntervalMs));
+}
+
+void MediaManager::processLoopbackFrame(const int16_t* samples, int count, int64_t timestampUs)
+{
+    TRACE_SCOPE("audio.loopback.frame");
+    // 先在麦克风信号中检测上一次 chirp
+    int64_t latencyUs = m_latencyProbe.process(samples, count, timestampUs);
+    if (latencyUs != LatencyProbe::NO_RESULT) {
+        emit loopbackLatencyMeasured(latencyUs == LatencyProbe::TIMED_OUT ? -1.0 : latencyUs / 1000.0);
+    }
+    
+    // chirp 送入播放链路的时刻即测量起点，结果包含抖动缓冲、声卡缓冲、声学路径和采集缓冲
+    const std::vector<int16_t>& chirp = m_latencyProbe.chirp();
+    if (m_chirpPos < 0 && m_chirpRequested.exchange(false)) {
+        m_chirpPos = 0;
+        m_latencyProbe.arm(steadyNowUs());
+    }
+    
+    count = std::min(count, static_cast<int>(m_loopbackBuffer.size()));
+    const int16_t* out = samples;
+    if (m_chirpPos >= 0) {
+        int n = std::min(count, static_cast<int>(chirp.size()) - m_chirpPos);
+        std::copy(chirp.begin() + m_chirpPos, chirp.begin() + m_chirpPos + n, m_loopbackBuffer.begin());
+        std::fill(m_loopbackBuffer.begin() + n, m_loopbackBuffer.begin() + count, 0);
+        m_chirpPos = m_chirpPos + n < static_cast<int>(chirp.size()) ? m_chirpPos + n : -1;
+        out = m_loopbackBuffer.data();
+    } else if (!m_loopbackMonitor.load(std::memory_order_relaxed) || m_latencyProbe.isArmed()) {
+        // 直通关闭或等待 chirp 到达期间送静音，声卡持续有数据，麦克风不回送扬声器
+        std::fill(m_loopbackBuffer.begin(), m_loopbackBuffer.begin() + count, 0);
+        out = m_loopbackBuffer.data();
+    }
+    m_audioRender->pushLocalAudio(out, count);
+}
+
+void MediaManager::onLoopbackLatency(double latencyMs)
+{
+    if (m_latencyTestRemaining <= 0) {
+        return;
+    }
+    if (latencyMs < 0) {
+        m_latencyStats.addMiss();
+        LOG_WARN("Latency test: chirp not detected");
+    } else {
+        m_latencyStats.add(latencyMs);
+        LOG_DEBUG(QString("Latency test: %1 ms").arg(latencyMs, 0, 'f', 1));
+    }
+    emit latencyMeasured(latencyMs);
+    
+    if (--m_latencyTestRemaining > 0) {
+        QTimer::singleShot(m_latencyTestIntervalMs, this, [this] {
+            m_chirpRequested = m_latencyTestRemaining > 0;
+        });
+        return;
+    }
+    LOG_INFO(QString("Latency test: mean %1 ms, stddev %2 ms, min %3 ms, max %4 ms, %5 measured, %6 missed, "
+                     "render latency %7 ms")
+             .arg(m_latencyStats.meanMs(), 0, 'f', 1).arg(m_latencyStats.stddevMs(), 0, 'f', 1)
+             .arg(m_latencyStats.minMs, 0, 'f', 1).arg(m_latencyStats.maxMs, 0, 'f', 1)
+             .arg(m_latencyStats.count).arg(m_latencyStats.missed).arg(renderLatencyMs()));
+    emit latencyTestFinished();
+}
+
 void MediaManager::setupAudioDevices()
 {
     if (!m_engine) {
@@ -297,3 +802,176 @@ void MediaManager::setupAudioDevices()
         playbackDevices->release();
     }
 }
+
+void MediaManager::publishMetrics()
+{
+    MetricsRegistry* registry = MetricsRegistry::instance();
+    
+    // 电平取最近 1 秒，与同步周期一致
+    const QString directions[] = {"capture", "playback"};
+    const AudioLevelMeter::Reading levels[] = {m_captureLevel.read(1000), m_playbackLevel.read(1000)};
+    for (int i = 0; i < 2; i++) {
+        QString labels = MetricsRegistry::label("direction", directions[i]);
+        registry->gauge("audio_level_peak_dbfs", "Peak level over the last second (dBFS)", labels)
+            ->set(levels[i].peakDbfs);
+        registry->gauge("audio_level_rms_dbfs", "RMS level over the last second (dBFS)", labels)
+            ->set(levels[i].rmsDbfs);
+        registry->gauge("audio_clipped_blocks", "10 ms blocks at full scale in the last second", labels)
+            ->set(levels[i].clippedBlocks);
+    }
+    registry->gauge("audio_drift_ppm", "Sound card clock drift relative to the pipeline",
+                    MetricsRegistry::label("direction", "capture"))->set(captureDriftPpm());
+    registry->gauge("audio_drift_ppm", "Sound card clock drift relative to the pipeline",
+                    MetricsRegistry::label("direction", "playback"))->set(renderDriftPpm());
+    
+    // 播放端: 输出延迟、抖动缓冲、打断延迟
+    registry->gauge("audio_render_latency_ms", "Jitter buffer plus sound card queue")->set(renderLatencyMs());
+    registry->gauge("audio_render_active_streams", "Remote streams currently mixed")->set(renderActiveStreams());
+    registry->gauge("audio_interrupt_latency_ms", "Last interrupt-to-silence latency, -1 if none")
+        ->set(renderInterruptLatencyMs());
+    JitterBuffer::Stats jitter = renderJitterStats();
+    registry->gauge("audio_jitter_depth_ms", "Jitter buffer depth")->set(jitter.depthMs);
+    registry->gauge("audio_jitter_target_ms", "Jitter buffer target depth")->set(jitter.targetMs);
+    registry->gauge("audio_jitter_ms", "Estimated arrival jitter")->set(jitter.jitterMs);
+    registry->counter("audio_jitter_underruns", "Jitter buffer underruns")->set(jitter.underruns);
+    registry->counter("audio_jitter_dropped_ms", "Audio dropped on jitter buffer overflow")->set(jitter.droppedMs);
+    registry->counter("audio_jitter_concealed_ms", "Audio concealed on underrun")->set(jitter.concealedMs);
+    registry->counter("audio_jitter_accelerated_ms", "Audio compressed while catching up")->set(jitter.acceleratedMs);
+    
+    // 实时线程截止时间
+    for (const DeadlineMonitor::Snapshot& deadline : DeadlineMonitor::snapshotAll()) {
+        QString labels = MetricsRegistry::label("thread", deadline.name);
+        registry->counter("thread_cycles", "Realtime loop cycles", labels)->set(deadline.cycles);
+        registry->counter("thread_deadline_missed", "Realtime loop cycles past deadline", labels)
+            ->set(deadline.missed);
+        registry->gauge("thread_max_lateness_us", "Worst realtime loop lateness", labels)
+            ->set(deadline.maxLatenessUs);
+    }
+    for (const AllocAudit::Snapshot& audit : AllocAudit::snapshotAll()) {
+        QString labels = MetricsRegistry::label("thread", audit.thread);
+        registry->counter("thread_steady_allocations", "Heap allocations after warm-up (ALLOC_AUDIT builds)", labels)
+            ->set(audit.steadyAllocations);
+    }
+    
+    // 各线程 CPU/运行队列等待/缺页，进程 RSS/PSS
+    m_procStats.publishMetrics();
+    
+    // 延迟直方图: 统计在各自模块中累计，这里整体覆盖
+    for (int i = 0; i < TurnLatencyTracker::SEGMENT_COUNT; i++) {
+        TurnLatencyTracker::Segment segment = static_cast<TurnLatencyTracker::Segment>(i);
+        registry->histogram("turn_latency_ms", "Conversation turn latency by segment",
+                            MetricsRegistry::label("segment", TurnLatencyTracker::segmentName(segment)))
+            ->assign(m_turnTracker.histogram(segment));
+    }
+    VideoLatencyMonitor* videoLatency = VideoLatencyMonitor::instance();
+    if (videoLatency->isEnabled()) {
+        QString configuration = MetricsRegistry::label("config", videoLatency->configuration());
+        for (int i = 0; i < VideoLatencyMonitor::STAGE_COUNT; i++) {
+            VideoLatencyMonitor::Stage stage = static_cast<VideoLatencyMonitor::Stage>(i);
+            registry->histogram("video_latency_ms", "Capture to sink/display latency",
+                                configuration + "," + MetricsRegistry::label("stage", VideoLatencyMonitor::stageName(stage)))
+                ->assign(videoLatency->histogram(stage));
+        }
+    }
+}
+
+// 控制接口参数: 只允许列出的字段
+static bool checkParams(const QJsonObject& params, const QStringList& allowed, QString* error)
+{
+    for (const QString& key : params.keys()) {
+        if (!allowed.contains(key)) {
+            *error = QString("unknown parameter \"%1\", expected %2").arg(key, allowed.join('/'));
+            return false;
+        }
+    }
+    return true;
+}
+
+// 可选的整数参数，缺省时保留 value 原值
+static bool intParam(const QJsonObject& params, const QString& key, int minValue, int maxValue,
+                     int* value, QString* error)
+{
+    if (!params.contains(key)) {
+        return true;
+    }
+    QJsonValue json = params.value(key);
+    if (!json.isDouble() || json.toDouble() < minValue || json.toDouble() > maxValue) {
+        *error = QString("\"%1\" must be a number in [%2, %3]").arg(key).arg(minValue).arg(maxValue);
+        return false;
+    }
+    *value = qRound(json.toDouble());
+    return true;
+}
+
+void MediaManager::registerControlCommands()
+{
+    ControlRegistry* registry = ControlRegistry::instance();
+    
+    registry->registerCommand("video.format", "Capture/encode format {width, height, fps}; restarts capture",
+                              this, [this](const QJsonObject& params, QString* error) {
+        ConfigManager* config = ConfigManager::instance();
+        int width = config->videoWidth();
+        int height = config->videoHeight();
+        int fps = config->videoFrameRate();
+        if (!checkParams(params, {"width", "height", "fps"}, error) ||
+            !intParam(params, "width", 160, 1920, &width, error) ||
+            !intParam(params, "height", 120, 1080, &height, error) ||
+            !intParam(params, "fps", 1, 60, &fps, error)) {
+            return QJsonObject();
+        }
+        // I420 要求偶数宽高
+        width &= ~1;
+        height &= ~1;
+        if (width != config->videoWidth() || height != config->videoHeight() || fps != config->videoFrameRate()) {
+            setVideoFormat(width, height, fps);
+        }
+        QJsonObject result;
+        result["width"] = config->videoWidth();
+        result["height"] = config->videoHeight();
+        result["fps"] = config->videoFrameRate();
+        result["capturing"] = isVideoCapturing();
+        result["suspended"] = isVideoCaptureSuspended();
+        result["camera"] = currentCamera().name;
+        return result;
+    });
+    
+    registry->registerCommand("audio.buffers",
+                              "Playback buffers {periodMs, periods, jitterMinMs, jitterMaxMs}; restarts playback",
+                              this, [this](const QJsonObject& params, QString* error) {
+        ConfigManager* config = ConfigManager::instance();
+        int periodMs = config->audioPlaybackPeriodMs();
+        int periods = config->audioPlaybackPeriods();
+        int jitterMinMs = config->audioJitterMinMs();
+        int jitterMaxMs = config->audioJitterMaxMs();
+        // 范围与配置文件解析一致
+        if (!checkParams(params, {"periodMs", "periods", "jitterMinMs", "jitterMaxMs"}, error) ||
+            !intParam(params, "periodMs", 2, 100, &periodMs, error) ||
+            !intParam(params, "periods", 2, 32, &periods, error) ||
+            !intParam(params, "jitterMinMs", 0, 1000, &jitterMinMs, error) ||
+            !intParam(params, "jitterMaxMs", 0, 1000, &jitterMaxMs, error)) {
+            return QJsonObject();
+        }
+        if (jitterMaxMs < jitterMinMs) {
+            *error = "jitterMaxMs must not be less than jitterMinMs";
+            return QJsonObject();
+        }
+        if (periodMs != config->audioPlaybackPeriodMs() || periods != config->audioPlaybackPeriods() ||
+            jitterMinMs != config->audioJitterMinMs() || jitterMaxMs != config->audioJitterMaxMs()) {
+            setAudioRenderBuffers(periodMs, periods, jitterMinMs, jitterMaxMs);
+        }
+        JitterBuffer::Stats jitter = renderJitterStats();
+        QJsonObject result;
+        result["periodMs"] = config->audioPlaybackPeriodMs();
+        result["periods"] = config->audioPlaybackPeriods();
+        result["jitterMinMs"] = config->audioJitterMinMs();
+        result["jitterMaxMs"] = config->audioJitterMaxMs();
+        result["rendering"] = isAudioRendering();
+        result["outputLatencyMs"] = renderLatencyMs();
+        result["driftPpm"] = renderDriftPpm();
+        result["jitterDepthMs"] = jitter.depthMs;
+        result["jitterTargetMs"] = jitter.targetMs;
+        result["underruns"] = static_cast<qint64>(jitter.underruns);
+        result["droppedMs"] = static_cast<qint64>(jitter.droppedMs);
+        return result;
+    });
+}
@@ -1,8 +1,19 @@
 #pragma once
 
 #include <QObject>
+#include <QByteArray>
+#include <atomic>
+#include <vector>
 #include "bytertc_engine.h"
 #include "drivers/interfaces/IVideoSource.h"
+#include "JitterBuffer.h"
+#include "PlaybackMonitor.h"
+#include "AudioLevelMeter.h"
+#include "LatencyProbe.h"
+#include "TurnLatencyTracker.h"
+#include "ProcStats.h"
+
+class QTimer;
 
 class ExternalVideoSource;
 class ExternalAudioSource;
@@ -30,16 +41,43 @@ public:
     void startVideoCapture();
     void stopVideoCapture();
     bool isVideoCapturing() const;
+    // 关闭画面: 管道保持预热只停止推送，恢复时不重启摄像头
+    void setVideoCaptureSuspended(bool suspended);
+    bool isVideoCaptureSuspended() const;
+    // 运行时修改采集/编码格式并同步到配置；采集中会重启采集线程 (摄像头重新协商，约数百毫秒无画面)
+    void setVideoFormat(int width, int height, int frameRate);
     
     // 音频采集控制
     void startAudioCapture();
     void stopAudioCapture();
     bool isAudioCapturing() const;
+    // 麦克风静音: 设备保持打开，停止处理和推送 (也不预录)，恢复后下一帧即推送
+    void setAudioCaptureSuspended(bool suspended);
     
     // 音频播放控制
+    // 预热: 应用启动时打开麦克风，无引擎时采集到预录缓冲
+    void warmUpAudioCapture();
+    // 暂停/恢复向 SDK 推送麦克风音频，恢复时补推预录缓冲中最近的语音
+    // flushMs < 0 时使用配置的补推时长
+    void suspendAudioPush();
+    void resumeAudioPush(int flushMs = -1);
+    
+    // 待机唤醒词检测 (需配置模型)
+    bool isWakeWordAvailable() const;
+    void setWakeWordEnabled(bool enabled);
+    
+    // 本地插话检测 (需在配置中开启)
+    bool isBargeInAvailable() const;
+    
     void startAudioRender();
     void stopAudioRender();
     bool isAudioRendering() const;
+    // 运行时修改声卡 period 大小/个数和抖动缓冲范围并同步到配置；播放中会重启播放线程
+    void setAudioRenderBuffers(int periodMs, int periods, int jitterMinMs, int jitterMaxMs);
+    // 智能体被打断时立即停止播放已缓冲的回复 (可在 SDK 回调线程调用)
+    void interruptPlayback();
+    // 智能体的用户 ID，分流混音时优先播放其音频，需在 startAudioRender 之前设置
+    void setAgentUserId(const QString& userId);
     
     // 摄像头管理
     QList<CameraInfo> detectCameras();
@@ -54,6 +92,36 @@ public:
     void setSpeakerMute(bool mute);
     bool isSpeakerMuted() const;
     
+    // 时钟漂移估计 (ppm)，采集端/播放端各一个
+    double captureDriftPpm() const;
+    double renderDriftPpm() const;
+    // 播放输出延迟 (队列 + 声卡缓冲, ms)
+    int renderLatencyMs() const;
+    // 远端音频抖动缓冲统计 (深度/目标/欠载/丢弃)
+    JitterBuffer::Stats renderJitterStats() const;
+    // 最近一次打断到声卡静音的耗时 (ms)，未打断过时为 -1
+    int renderInterruptLatencyMs() const;
+    // 分流混音时正在播放的远端流数
+    int renderActiveStreams() const;
+    // 最近 windowMs 内麦克风发送 / 扬声器播出的电平 (任意线程，无锁)
+    AudioLevelMeter::Reading captureLevel(int windowMs = 100) const;
+    AudioLevelMeter::Reading playbackLevel(int windowMs = 100) const;
+    // 对话轮次延迟统计: 采集/播放线程打点，消息回调中喂入智能体状态和字幕
+    TurnLatencyTracker* turnTracker() { return &m_turnTracker; }
+    
+    // 本地回环 (不经过 RTC): 麦克风直接送到扬声器，摄像头直接送到 localVideoFrame；
+    // 用于设备检查和测量本机音频链路延迟，不能与通话同时使用
+    bool startLoopback(bool withVideo);
+    void stopLoopback();
+    bool isLoopbackActive() const { return m_loopbackActive; }
+    // 麦克风到扬声器直通 (线程安全)；延迟测试期间自动改送静音，避免啸叫
+    void setLoopbackMonitor(bool enabled);
+    // chirp 延迟测试: 每隔 intervalMs 播放一次 chirp，共 count 次；
+    // 每次结果发出 latencyMeasured，全部结束后发出 latencyTestFinished
+    void startLatencyTest(int count, int intervalMs = 1000);
+    bool isLatencyTestRunning() const { return m_latencyTestRemaining > 0; }
+    LatencyStats latencyStats() const { return m_latencyStats; }
+    
     // 获取组件（供外部使用）
     ExternalVideoSource* getVideoSource() const { return m_videoSource; }
     ExternalAudioSource* getAudioSource() const { return m_audioSource; }
@@ -61,13 +129,55 @@ public:
 
 signals:
     void cameraError(const QString& error);
+    // setVideoFormat 生效后发出
+    void videoFormatChanged();
     void audioError(const QString& error);
+    void wakeWordDetected(float score);
+    // 本地检测到用户插话 (播放已闪避)，decisionMs 为判定耗时
+    void bargeInDetected(int decisionMs);
+    // 回环模式下的一帧本地画面 (I420，采集线程中发出)
+    void localVideoFrame(const QByteArray& i420, int width, int height);
+    // 一次 chirp 测量结果 (ms)，未检测到时为 -1 (采集线程中发出，内部汇总用)
+    void loopbackLatencyMeasured(double latencyMs);
+    // 汇总到 latencyStats 之后发出 (主线程)
+    void latencyMeasured(double latencyMs);
+    void latencyTestFinished();
 
 private:
     void setupAudioDevices();
+    // 按 media.video 创建视频源 (摄像头或测试图案，可选写入时间戳图案)
+    ExternalVideoSource* createVideoSource();
+    // 按 media.audio.backend 创建音频源/渲染 (alsa 或 file)
+    ExternalAudioSource* createAudioSource();
+    ExternalAudioRender* createAudioRender();
+    // 回环模式下的采集帧处理 (采集线程)
+    void processLoopbackFrame(const int16_t* samples, int count, int64_t timestampUs);
+    // 汇总一次测量结果并安排下一次 chirp (主线程)
+    void onLoopbackLatency(double latencyMs);
+    // 把电平、漂移、抖动缓冲、线程截止时间和延迟直方图同步到指标注册表 (主线程定时调用)
+    void publishMetrics();
+    // 向控制接口注册 video.format / audio.buffers
+    void registerControlCommands();
     
     bytertc::IRTCEngine* m_engine = nullptr;
     ExternalVideoSource* m_videoSource = nullptr;
     ExternalAudioSource* m_audioSource = nullptr;
     ExternalAudioRender* m_audioRender = nullptr;
+    PlaybackMonitor m_playbackMonitor;  // 播放端与采集端共享，生命周期覆盖两者的线程
+    AudioLevelMeter m_captureLevel;     // 采集线程写，UI/监控读
+    AudioLevelMeter m_playbackLevel;    // 播放线程写，UI/监控读
+    TurnLatencyTracker m_turnTracker;
+    QTimer* m_metricsTimer = nullptr;
+    ProcStats m_procStats;  // 各线程 CPU/缺页、进程内存 (随指标一起同步)
+    
+    // 本地回环
+    bool m_loopbackActive = false;
+    std::atomic<bool> m_loopbackMonitor{true};
+    std::atomic<bool> m_chirpRequested{false};
+    LatencyProbe m_latencyProbe;             // 仅在采集线程中访问
+    int m_chirpPos = -1;                     // 仅在采集线程中访问，正在送出的 chirp 位置
+    std::vector<int16_t> m_loopbackBuffer;   // 仅在采集线程中访问
+    int m_latencyTestRemaining = 0;
+    int m_latencyTestIntervalMs = 1000;
+    LatencyStats m_latencyStats;
 };
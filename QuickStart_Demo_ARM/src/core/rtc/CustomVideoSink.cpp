@@ -1,5 +1,7 @@
 #include "CustomVideoSink.h"
 #include "VideoRenderWidgetGL.h"
+#include "VideoLatencyMonitor.h"
+#include "TraceRecorder.h"
 #include <QDebug>
 #include <QMetaObject>
 #include <chrono>
@@ -12,6 +14,7 @@ CustomVideoSink::~CustomVideoSink() {
 }
 
 bool CustomVideoSink::onFrame(bytertc::IVideoFrame* video_frame) {
+    TRACE_SCOPE("video.sink.onFrame");
     if (!video_frame) {
         return false;
     }
@@ -25,6 +28,9 @@ bool CustomVideoSink::onFrame(bytertc::IVideoFrame* video_frame) {
     }
 
     auto start = std::chrono::high_resolution_clock::now();
+    // 性能 HUD: 帧从到达 sink 到被绘制的耗时
+    const int64_t arrivalUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 
     int width = video_frame->width();
     int height = video_frame->height();
@@ -41,6 +47,18 @@ bool CustomVideoSink::onFrame(bytertc::IVideoFrame* video_frame) {
 
     bytertc::VideoPixelFormat format = video_frame->pixelFormat();
     
+    // 延迟测量模式: 从亮度平面 (RGBA 时取 G 通道) 解码采集端写入的时间戳
+    VideoLatencyMonitor* latencyMonitor = VideoLatencyMonitor::instance();
+    if (latencyMonitor->isEnabled()) {
+        if (format == bytertc::kVideoPixelFormatI420) {
+            latencyMonitor->recordFrame(VideoLatencyMonitor::Sink, video_frame->planeData(0),
+                                        video_frame->planeStride(0), 1, width, height);
+        } else if (format == bytertc::kVideoPixelFormatRGBA) {
+            latencyMonitor->recordFrame(VideoLatencyMonitor::Sink, video_frame->planeData(0) + 1,
+                                        video_frame->planeStride(0), 4, width, height);
+        }
+    }
+    
     // GPU 模式：直接传递 I420 数据到 OpenGL Widget
     if (m_useGPU && format == bytertc::kVideoPixelFormatI420) {
         uint8_t* yPlane = video_frame->planeData(0);
@@ -53,7 +71,7 @@ bool CustomVideoSink::onFrame(bytertc::IVideoFrame* video_frame) {
         // 在主线程更新 OpenGL 纹理
         QMetaObject::invokeMethod(m_glRenderWidget, [=]() {
             m_glRenderWidget->updateI420Frame(yPlane, uPlane, vPlane,
-                                              width, height, yStride, uStride, vStride);
+                                              width, height, yStride, uStride, vStride, arrivalUs);
         }, Qt::QueuedConnection);
         
         auto end = std::chrono::high_resolution_clock::now();
@@ -99,6 +117,7 @@ bool CustomVideoSink::onFrame(bytertc::IVideoFrame* video_frame) {
     {
         QMutexLocker locker(&m_mutex);
         m_currentFrame = image;
+        m_frameArrivalUs = arrivalUs;
     }
 
     // 在主线程更新 UI
@@ -159,8 +178,11 @@ void CustomVideoSink::release() {
     m_currentFrame = QImage();
 }
 
-QImage CustomVideoSink::getCurrentFrame() {
+QImage CustomVideoSink::getCurrentFrame(int64_t* arrivalUs) {
     QMutexLocker locker(&m_mutex);
+    if (arrivalUs) {
+        *arrivalUs = m_frameArrivalUs;
+    }
     return m_currentFrame;
 }
 
@@ -27,8 +27,8 @@ public:
     int getRenderElapse() override;
     void release() override;
 
-    // 获取当前帧用于显示 (CPU 模式)
-    QImage getCurrentFrame();
+    // 获取当前帧用于显示 (CPU 模式)；arrivalUs 返回该帧到达 sink 的时刻 (steady 时钟)
+    QImage getCurrentFrame(int64_t* arrivalUs = nullptr);
     
     // 清除当前帧
     void clearFrame();
@@ -50,6 +50,7 @@ private:
     QWidget* m_renderWidget = nullptr;
     VideoRenderWidgetGL* m_glRenderWidget = nullptr;
     QImage m_currentFrame;
+    int64_t m_frameArrivalUs = 0;
     QMutex m_mutex;
     std::atomic<int> m_renderElapse{0};
     bool m_useGPU = false;
@@ -108,6 +108,27 @@ bool RoomManager::joinRoom(const QString& roomId, const QString& userId, const Q
     return true;
 }
 
+int64_t RoomManager::sendBinaryToUser(const QString& uid, const QByteArray& type, const QByteArray& value)
+{
+    if (!m_room || uid.isEmpty() || type.size() != 4) {
+        return -1;
+    }
+    
+    QByteArray message;
+    message.reserve(8 + value.size());
+    message.append(type);
+    uint32_t length = static_cast<uint32_t>(value.size());
+    message.append(static_cast<char>((length >> 24) & 0xFF));
+    message.append(static_cast<char>((length >> 16) & 0xFF));
+    message.append(static_cast<char>((length >> 8) & 0xFF));
+    message.append(static_cast<char>(length & 0xFF));
+    message.append(value);
+    
+    std::string uidStr = uid.toStdString();
+    return m_room->sendUserBinaryMessage(uidStr.c_str(), message.size(),
+                                         reinterpret_cast<const uint8_t*>(message.constData()));
+}
+
 void RoomManager::leaveRoom()
 {
     if (m_room) {
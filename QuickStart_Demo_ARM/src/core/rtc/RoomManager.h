@@ -2,6 +2,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QByteArray>
 #include "bytertc_engine.h"
 #include "bytertc_room.h"
 #include "ErrorCode.h"
@@ -34,6 +35,10 @@ public:
     bool isInRoom() const { return m_room != nullptr; }
     QString getRoomId() const { return m_roomId; }
     QString getUserId() const { return m_userId; }
+    
+    // 按 TLV 格式 (| type 4B | length 4B 大端 | value |) 向房间内用户发送二进制消息，
+    // 与 onRoomBinaryMessageReceived 的解析对应；返回 SDK 消息编号，失败返回 -1
+    int64_t sendBinaryToUser(const QString& uid, const QByteArray& type, const QByteArray& value);
 
 signals:
     void engineCreated();
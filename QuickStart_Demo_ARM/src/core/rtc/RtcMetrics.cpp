@@ -0,0 +1,183 @@
+#include "RtcMetrics.h"
+#include "MetricsRegistry.h"
+
+static const double BYTES_PER_MB = 1024.0 * 1024.0;
+
+static QString userLabel(const char* uid)
+{
+    return MetricsRegistry::label("user", uid ? QString::fromUtf8(uid) : QString());
+}
+
+static QString labels(const QString& user, const char* key, const char* value)
+{
+    return user + "," + MetricsRegistry::label(key, value);
+}
+
+static void setGauge(const char* name, const char* help, const QString& labels, double value)
+{
+    MetricsRegistry::instance()->gauge(name, help, labels)->set(value);
+}
+
+// SDK 的卡顿次数/时长是每个统计周期内的值，累加成计数器
+static void addCounter(const char* name, const char* help, const QString& labels, int value)
+{
+    if (value > 0) {
+        MetricsRegistry::instance()->counter(name, help, labels)->add(static_cast<uint64_t>(value));
+    }
+}
+
+static const char* qualityDirections[] = {"tx", "rx"};
+
+static void setQuality(const QString& user, bytertc::NetworkQuality tx, bytertc::NetworkQuality rx)
+{
+    const bytertc::NetworkQuality values[] = {tx, rx};
+    for (int i = 0; i < 2; i++) {
+        setGauge("rtc_network_quality", "SDK network quality (0 unknown, 1 excellent ... 6 down)",
+                 labels(user, "direction", qualityDirections[i]), values[i]);
+    }
+}
+
+void RtcMetrics::onLocalStreamStats(const bytertc::LocalStreamStats& stats)
+{
+    if (stats.is_screen) {
+        return;
+    }
+    const QString user = MetricsRegistry::label("user", "local");
+    const QString audio = labels(user, "media", "audio");
+    const QString video = labels(user, "media", "video");
+    const bytertc::LocalAudioStats& a = stats.audio_stats;
+    const bytertc::LocalVideoStats& v = stats.video_stats;
+
+    setGauge("rtc_stream_bitrate_kbps", "Stream bitrate", audio, a.send_kbitrate);
+    setGauge("rtc_stream_bitrate_kbps", "Stream bitrate", video, v.sent_kbitrate);
+    setGauge("rtc_stream_loss_ratio", "Packet loss ratio (0-1)", audio, a.audio_loss_rate);
+    setGauge("rtc_stream_loss_ratio", "Packet loss ratio (0-1)", video, v.video_loss_rate);
+    setGauge("rtc_stream_rtt_ms", "Round trip time", audio, a.rtt);
+    setGauge("rtc_stream_rtt_ms", "Round trip time", video, v.rtt);
+    setGauge("rtc_stream_jitter_ms", "Network jitter", audio, a.jitter);
+    setGauge("rtc_stream_jitter_ms", "Network jitter", video, v.jitter);
+
+    setGauge("rtc_video_fps", "Video frame rate by pipeline stage", labels(user, "stage", "input"), v.input_frame_rate);
+    setGauge("rtc_video_fps", "Video frame rate by pipeline stage", labels(user, "stage", "encoded"),
+             v.encoder_output_frame_rate);
+    setGauge("rtc_video_fps", "Video frame rate by pipeline stage", labels(user, "stage", "sent"), v.sent_frame_rate);
+    setGauge("rtc_video_width", "Video frame width", user, v.encoded_frame_width);
+    setGauge("rtc_video_height", "Video frame height", user, v.encoded_frame_height);
+    setGauge("rtc_video_codec_ms", "Encode/decode time per frame", user, v.codec_elapse_per_frame);
+
+    setQuality(user, stats.local_tx_quality, stats.local_rx_quality);
+}
+
+void RtcMetrics::onRemoteStreamStats(const bytertc::RemoteStreamStats& stats)
+{
+    if (stats.is_screen) {
+        return;
+    }
+    const QString user = userLabel(stats.uid);
+    const QString audio = labels(user, "media", "audio");
+    const QString video = labels(user, "media", "video");
+    const bytertc::RemoteAudioStats& a = stats.audio_stats;
+    const bytertc::RemoteVideoStats& v = stats.video_stats;
+
+    setGauge("rtc_stream_bitrate_kbps", "Stream bitrate", audio, a.received_kbitrate);
+    setGauge("rtc_stream_bitrate_kbps", "Stream bitrate", video, v.received_kbitrate);
+    setGauge("rtc_stream_loss_ratio", "Packet loss ratio (0-1)", audio, a.audio_loss_rate);
+    setGauge("rtc_stream_loss_ratio", "Packet loss ratio (0-1)", video, v.video_loss_rate);
+    setGauge("rtc_stream_rtt_ms", "Round trip time", audio, a.rtt);
+    setGauge("rtc_stream_rtt_ms", "Round trip time", video, v.rtt);
+    setGauge("rtc_stream_jitter_ms", "Network jitter", audio, a.jitter);
+    setGauge("rtc_stream_jitter_ms", "Network jitter", video, v.jitter);
+    setGauge("rtc_stream_e2e_delay_ms", "Sender capture to local playout/render", audio, a.e2e_delay);
+    setGauge("rtc_stream_e2e_delay_ms", "Sender capture to local playout/render", video, v.e2e_delay);
+    addCounter("rtc_stream_stalls", "Playback stalls", audio, a.stall_count);
+    addCounter("rtc_stream_stalls", "Playback stalls", video, v.stall_count);
+    addCounter("rtc_stream_stall_ms", "Playback stall duration", audio, a.stall_duration);
+    addCounter("rtc_stream_stall_ms", "Playback stall duration", video, v.stall_duration);
+
+    setGauge("rtc_audio_jitter_buffer_ms", "SDK audio jitter buffer delay", user, a.jitter_buffer_delay);
+    setGauge("rtc_video_fps", "Video frame rate by pipeline stage", labels(user, "stage", "decoded"),
+             v.decoder_output_frame_rate);
+    setGauge("rtc_video_fps", "Video frame rate by pipeline stage", labels(user, "stage", "rendered"),
+             v.renderer_output_frame_rate);
+    setGauge("rtc_video_width", "Video frame width", user, v.width);
+    setGauge("rtc_video_height", "Video frame height", user, v.height);
+    setGauge("rtc_video_codec_ms", "Encode/decode time per frame", user, v.codec_elapse_per_frame);
+    setGauge("rtc_video_capture_to_render_ms", "Remote capture to local render", user, v.cap_to_render_delay);
+
+    setQuality(user, stats.remote_tx_quality, stats.remote_rx_quality);
+}
+
+void RtcMetrics::onRoomStats(const bytertc::RtcRoomStats& stats)
+{
+    const QString tx = MetricsRegistry::label("direction", "tx");
+    const QString rx = MetricsRegistry::label("direction", "rx");
+
+    setGauge("rtc_room_bitrate_kbps", "Room bitrate by media", tx + "," + MetricsRegistry::label("media", "all"),
+             stats.tx_kbitrate);
+    setGauge("rtc_room_bitrate_kbps", "Room bitrate by media", rx + "," + MetricsRegistry::label("media", "all"),
+             stats.rx_kbitrate);
+    setGauge("rtc_room_bitrate_kbps", "Room bitrate by media", tx + "," + MetricsRegistry::label("media", "audio"),
+             stats.tx_audio_kbitrate);
+    setGauge("rtc_room_bitrate_kbps", "Room bitrate by media", rx + "," + MetricsRegistry::label("media", "audio"),
+             stats.rx_audio_kbitrate);
+    setGauge("rtc_room_bitrate_kbps", "Room bitrate by media", tx + "," + MetricsRegistry::label("media", "video"),
+             stats.tx_video_kbitrate);
+    setGauge("rtc_room_bitrate_kbps", "Room bitrate by media", rx + "," + MetricsRegistry::label("media", "video"),
+             stats.rx_video_kbitrate);
+    setGauge("rtc_room_loss_ratio", "Room packet loss ratio (0-1)", tx, stats.tx_lostrate);
+    setGauge("rtc_room_loss_ratio", "Room packet loss ratio (0-1)", rx, stats.rx_lostrate);
+    setGauge("rtc_room_jitter_ms", "Room network jitter", tx, stats.tx_jitter);
+    setGauge("rtc_room_jitter_ms", "Room network jitter", rx, stats.rx_jitter);
+    MetricsRegistry::instance()->counter("rtc_room_bytes", "Bytes transferred in the current room", tx)
+        ->set(stats.tx_bytes);
+    MetricsRegistry::instance()->counter("rtc_room_bytes", "Bytes transferred in the current room", rx)
+        ->set(stats.rx_bytes);
+    setGauge("rtc_room_rtt_ms", "Round trip time to the server", QString(), stats.rtt);
+    setGauge("rtc_room_users", "Users in the room", QString(), stats.user_count);
+    setGauge("rtc_room_duration_seconds", "Time since joining the room", QString(), stats.duration);
+}
+
+void RtcMetrics::onSysStats(const bytertc::SysStats& stats)
+{
+    const QString app = MetricsRegistry::label("scope", "app");
+    const QString total = MetricsRegistry::label("scope", "system");
+
+    setGauge("sys_cpu_cores", "CPU cores", QString(), stats.cpu_cores);
+    setGauge("sys_cpu_usage_ratio", "CPU usage (0-1)", app, stats.cpu_app_usage);
+    setGauge("sys_cpu_usage_ratio", "CPU usage (0-1)", total, stats.cpu_total_usage);
+    // SDK 以 MB 上报
+    setGauge("sys_memory_used_bytes", "Memory in use", app, stats.memory_usage * BYTES_PER_MB);
+    setGauge("sys_memory_used_bytes", "Memory in use", total, stats.total_memory_usage * BYTES_PER_MB);
+    setGauge("sys_memory_free_bytes", "Memory available for allocation", QString(), stats.free_memory * BYTES_PER_MB);
+    setGauge("sys_memory_total_bytes", "Physical memory", QString(), stats.full_memory * BYTES_PER_MB);
+}
+
+void RtcMetrics::onNetworkQuality(const bytertc::NetworkQualityStats& local,
+                                  const bytertc::NetworkQualityStats* remotes, int remoteCount)
+{
+    const QString localUser = MetricsRegistry::label("user", "local");
+    setQuality(localUser, local.tx_quality, local.rx_quality);
+    setGauge("rtc_network_bandwidth_kbps", "Estimated available bandwidth", localUser, local.total_bandwidth);
+    for (int i = 0; remotes && i < remoteCount; i++) {
+        setQuality(userLabel(remotes[i].uid), remotes[i].tx_quality, remotes[i].rx_quality);
+    }
+}
+
+void RtcMetrics::onPerformanceAlarm(bytertc::PerformanceAlarmMode mode, bytertc::PerformanceAlarmReason reason)
+{
+    const char* reasonName = "unknown";
+    switch (reason) {
+        case bytertc::kPerformanceAlarmReasonBandwidthFallbacked:   reasonName = "bandwidth_fallback"; break;
+        case bytertc::kPerformanceAlarmReasonBandwidthResumed:      reasonName = "bandwidth_resumed"; break;
+        case bytertc::kPerformanceAlarmReasonPerformanceFallbacked: reasonName = "performance_fallback"; break;
+        case bytertc::kPerformanceAlarmReasonPerformanceResumed:    reasonName = "performance_resumed"; break;
+    }
+    QString alarmLabels = MetricsRegistry::label("reason", reasonName) + "," +
+        MetricsRegistry::label("mode", mode == bytertc::kPerformanceAlarmModeSimulcast ? "simulcast" : "normal");
+    MetricsRegistry::instance()->counter("rtc_performance_alarms", "SDK performance alarms", alarmLabels)->add();
+}
+
+void RtcMetrics::onUserLeave(const QString& userId)
+{
+    MetricsRegistry::instance()->retire(MetricsRegistry::label("user", userId));
+}
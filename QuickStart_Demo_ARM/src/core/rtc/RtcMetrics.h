@@ -0,0 +1,23 @@
+#pragma once
+
+#include "bytertc_room_event_handler.h"
+#include "bytertc_engine_event_handler.h"
+#include <QString>
+
+/**
+ * SDK 统计回调 -> 指标注册表
+ * 在 SDK 回调线程中直接调用；统计回调约 2 秒一次，每次按名称查找指标 (短暂加锁)，写入为原子操作
+ *
+ * 本地流的 user 标签为 "local"，远端流为对方 uid；远端用户离开后其指标不再导出
+ */
+class RtcMetrics {
+public:
+    static void onLocalStreamStats(const bytertc::LocalStreamStats& stats);
+    static void onRemoteStreamStats(const bytertc::RemoteStreamStats& stats);
+    static void onRoomStats(const bytertc::RtcRoomStats& stats);
+    static void onSysStats(const bytertc::SysStats& stats);
+    static void onNetworkQuality(const bytertc::NetworkQualityStats& local,
+                                 const bytertc::NetworkQualityStats* remotes, int remoteCount);
+    static void onPerformanceAlarm(bytertc::PerformanceAlarmMode mode, bytertc::PerformanceAlarmReason reason);
+    static void onUserLeave(const QString& userId);
+};
@@ -0,0 +1,335 @@
+#include "AlsaPlaybackDevice.h"
+#include "Logger.h"
+#include <alsa/asoundlib.h>
+#include <QStringList>
+#include <cerrno>
+
+#define LOG_MODULE "AlsaPlayback"
+
+AlsaPlaybackDevice::AlsaPlaybackDevice()
+{
+}
+
+bool AlsaPlaybackDevice::queryCapabilities(const QString& device, const QList<int>& candidateRates,
+                                           Capabilities& caps)
+{
+    QByteArray name = device.toUtf8();
+    snd_pcm_t* pcm = nullptr;
+    int err = snd_pcm_open(&pcm, name.constData(), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
+    if (err < 0) {
+        LOG_WARN(QString("Cannot probe %1: %2").arg(device, snd_strerror(err)));
+        return false;
+    }
+
+    snd_pcm_hw_params_t* hw = nullptr;
+    snd_pcm_hw_params_alloca(&hw);
+    snd_pcm_hw_params_any(pcm, hw);
+    snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_RW_INTERLEAVED);
+    bool ok = snd_pcm_hw_params_set_format(pcm, hw, SND_PCM_FORMAT_S16_LE) >= 0;
+
+    caps = Capabilities();
+    if (ok) {
+        unsigned int minChannels = 0;
+        unsigned int maxChannels = 0;
+        snd_pcm_hw_params_get_channels_min(hw, &minChannels);
+        snd_pcm_hw_params_get_channels_max(hw, &maxChannels);
+        caps.minChannels = static_cast<int>(minChannels);
+        caps.maxChannels = static_cast<int>(maxChannels);
+        for (int rate : candidateRates) {
+            if (snd_pcm_hw_params_test_rate(pcm, hw, static_cast<unsigned int>(rate), 0) == 0) {
+                caps.sampleRates << rate;
+            }
+        }
+    }
+    snd_pcm_close(pcm);
+
+    if (!ok || caps.sampleRates.isEmpty() || caps.maxChannels <= 0) {
+        LOG_WARN(QString("%1 supports none of the candidate S16_LE formats").arg(device));
+        return false;
+    }
+
+    QStringList rates;
+    for (int rate : caps.sampleRates) {
+        rates << QString::number(rate);
+    }
+    LOG_INFO(QString("%1 capabilities: rates [%2], channels %3-%4")
+             .arg(device, rates.join(",")).arg(caps.minChannels).arg(caps.maxChannels));
+    return true;
+}
+
+AlsaPlaybackDevice::~AlsaPlaybackDevice()
+{
+    close();
+}
+
+bool AlsaPlaybackDevice::open(const Config& config)
+{
+    close();
+
+    QByteArray device = config.device.toUtf8();
+    int err = snd_pcm_open(&m_pcm, device.constData(), SND_PCM_STREAM_PLAYBACK, 0);
+    if (err < 0) {
+        LOG_ERROR(QString("Cannot open %1: %2").arg(config.device, snd_strerror(err)));
+        m_pcm = nullptr;
+        return false;
+    }
+
+    snd_pcm_hw_params_t* hw = nullptr;
+    snd_pcm_hw_params_alloca(&hw);
+    snd_pcm_hw_params_any(m_pcm, hw);
+
+    unsigned int rate = static_cast<unsigned int>(config.sampleRate);
+    snd_pcm_uframes_t period = static_cast<snd_pcm_uframes_t>(qMax(1, config.sampleRate * config.periodMs / 1000));
+    snd_pcm_uframes_t buffer = period * static_cast<snd_pcm_uframes_t>(qMax(2, config.periodCount));
+
+    if ((err = snd_pcm_hw_params_set_access(m_pcm, hw, SND_PCM_ACCESS_RW_INTERLEAVED)) < 0 ||
+        (err = snd_pcm_hw_params_set_format(m_pcm, hw, SND_PCM_FORMAT_S16_LE)) < 0 ||
+        (err = snd_pcm_hw_params_set_channels(m_pcm, hw, static_cast<unsigned int>(config.channels))) < 0 ||
+        (err = snd_pcm_hw_params_set_rate_near(m_pcm, hw, &rate, nullptr)) < 0 ||
+        (err = snd_pcm_hw_params_set_period_size_near(m_pcm, hw, &period, nullptr)) < 0 ||
+        (err = snd_pcm_hw_params_set_buffer_size_near(m_pcm, hw, &buffer)) < 0 ||
+        (err = snd_pcm_hw_params(m_pcm, hw)) < 0) {
+        LOG_ERROR(QString("Cannot configure %1: %2").arg(config.device, snd_strerror(err)));
+        close();
+        return false;
+    }
+
+    // 格式应先经 queryCapabilities 协商；硬件给出其他采样率说明不支持，需要改用 plughw 设备
+    if (rate != static_cast<unsigned int>(config.sampleRate)) {
+        LOG_ERROR(QString("%1 does not support %2 Hz (got %3), use plughw instead")
+                  .arg(config.device).arg(config.sampleRate).arg(rate));
+        close();
+        return false;
+    }
+
+    snd_pcm_hw_params_get_period_size(hw, &period, nullptr);
+    snd_pcm_hw_params_get_buffer_size(hw, &buffer);
+
+    // 写满一个 period 即开始播放；每次至少空出一个 period 再唤醒写入
+    snd_pcm_sw_params_t* sw = nullptr;
+    snd_pcm_sw_params_alloca(&sw);
+    snd_pcm_sw_params_current(m_pcm, sw);
+    snd_pcm_sw_params_set_start_threshold(m_pcm, sw, period);
+    snd_pcm_sw_params_set_avail_min(m_pcm, sw, period);
+    if ((err = snd_pcm_sw_params(m_pcm, sw)) < 0) {
+        LOG_WARN(QString("Cannot set sw params: %1").arg(snd_strerror(err)));
+    }
+
+    snd_pcm_prepare(m_pcm);
+
+    m_sampleRate = static_cast<int>(rate);
+    m_channels = config.channels;
+    m_periodFrames = static_cast<int>(period);
+    m_bufferFrames = static_cast<int>(buffer);
+    m_underruns = 0;
+    m_silence.assign(static_cast<size_t>(m_periodFrames) * m_channels, 0);
+
+    LOG_INFO(QString("Opened %1: %2 Hz, %3 ch, period %4 frames, buffer %5 frames (%6 ms)")
+             .arg(config.device).arg(m_sampleRate).arg(m_channels)
+             .arg(m_periodFrames).arg(m_bufferFrames)
+             .arg(m_bufferFrames * 1000 / m_sampleRate));
+
+    if (!openMixer(config.device, config.mixerControl)) {
+        LOG_INFO("No hardware playback volume, using software volume");
+    }
+    return true;
+}
+
+void AlsaPlaybackDevice::close()
+{
+    closeMixer();
+    if (m_pcm) {
+        snd_pcm_drop(m_pcm);
+        snd_pcm_close(m_pcm);
+        m_pcm = nullptr;
+        if (m_underruns > 0) {
+            LOG_INFO(QString("Closed, %1 underruns").arg(m_underruns));
+        }
+    }
+}
+
+int AlsaPlaybackDevice::write(const int16_t* samples, int frames)
+{
+    if (!m_pcm) {
+        return -1;
+    }
+
+    int written = 0;
+    while (written < frames) {
+        snd_pcm_sframes_t ret = snd_pcm_writei(m_pcm, samples + written * m_channels,
+                                               static_cast<snd_pcm_uframes_t>(frames - written));
+        if (ret == -EAGAIN) {
+            snd_pcm_wait(m_pcm, 100);
+            continue;
+        }
+        if (ret < 0) {
+            if (ret == -EPIPE) {
+                m_underruns++;
+            }
+            // 欠载 (EPIPE) 或挂起 (ESTRPIPE) 后重新 prepare，继续写入剩余数据
+            int err = snd_pcm_recover(m_pcm, static_cast<int>(ret), 1);
+            if (err < 0) {
+                LOG_ERROR(QString("Write failed: %1").arg(snd_strerror(err)));
+                return -1;
+            }
+            continue;
+        }
+        written += static_cast<int>(ret);
+    }
+    return written;
+}
+
+int AlsaPlaybackDevice::delayFrames()
+{
+    if (!m_pcm) {
+        return -1;
+    }
+    snd_pcm_sframes_t delay = 0;
+    if (snd_pcm_delay(m_pcm, &delay) < 0) {
+        return -1;
+    }
+    return delay > 0 ? static_cast<int>(delay) : 0;
+}
+
+int AlsaPlaybackDevice::rewind(int frames)
+{
+    if (!m_pcm || frames <= 0) {
+        return 0;
+    }
+    // rewindable 已扣除硬件正在读取的部分，dmix 等插件可能返回 0
+    snd_pcm_sframes_t rewindable = snd_pcm_rewindable(m_pcm);
+    if (rewindable <= 0) {
+        return 0;
+    }
+    snd_pcm_sframes_t ret = snd_pcm_rewind(m_pcm, static_cast<snd_pcm_uframes_t>(qMin<snd_pcm_sframes_t>(frames, rewindable)));
+    return ret > 0 ? static_cast<int>(ret) : 0;
+}
+
+int AlsaPlaybackDevice::drop()
+{
+    if (!m_pcm) {
+        return 0;
+    }
+    int queued = qMax(0, delayFrames());
+    snd_pcm_drop(m_pcm);
+    snd_pcm_prepare(m_pcm);
+    return queued;
+}
+
+int AlsaPlaybackDevice::start()
+{
+    if (!m_pcm || snd_pcm_state(m_pcm) != SND_PCM_STATE_PREPARED) {
+        return 0;
+    }
+    int queued = qMax(0, delayFrames());
+    if (queued == 0) {
+        // 没有数据时启动会立即欠载，等下一次写入自动启动
+        return 0;
+    }
+    // 不足一个 period 时补静音，否则设备播完排队数据后立即欠载
+    int padding = qMax(0, m_periodFrames - queued);
+    if (padding > 0 && write(m_silence.data(), padding) < 0) {
+        return 0;
+    }
+    if (snd_pcm_state(m_pcm) == SND_PCM_STATE_PREPARED) {
+        int err = snd_pcm_start(m_pcm);
+        if (err < 0) {
+            LOG_WARN(QString("Cannot start playback: %1").arg(snd_strerror(err)));
+        }
+    }
+    return padding;
+}
+
+bool AlsaPlaybackDevice::setHardwareVolume(int volume)
+{
+    if (!m_mixerElem) {
+        return false;
+    }
+    volume = qBound(0, volume, 100);
+    long value = m_volumeMin + (m_volumeMax - m_volumeMin) * volume / 100;
+    if (snd_mixer_selem_set_playback_volume_all(m_mixerElem, value) < 0) {
+        return false;
+    }
+    if (snd_mixer_selem_has_playback_switch(m_mixerElem)) {
+        snd_mixer_selem_set_playback_switch_all(m_mixerElem, volume > 0 ? 1 : 0);
+    }
+    return true;
+}
+
+bool AlsaPlaybackDevice::openMixer(const QString& device, const QString& control)
+{
+    // hw:1,0 / plughw:1,0 -> hw:1，其他设备名 (default 等) 直接使用
+    QString card = device;
+    int colon = device.indexOf(':');
+    if (colon >= 0 && (device.startsWith("hw:") || device.startsWith("plughw:"))) {
+        card = "hw:" + device.mid(colon + 1).section(',', 0, 0);
+    }
+
+    QByteArray cardName = card.toUtf8();
+    if (snd_mixer_open(&m_mixer, 0) < 0) {
+        m_mixer = nullptr;
+        return false;
+    }
+    if (snd_mixer_attach(m_mixer, cardName.constData()) < 0 ||
+        snd_mixer_selem_register(m_mixer, nullptr, nullptr) < 0 ||
+        snd_mixer_load(m_mixer) < 0) {
+        closeMixer();
+        return false;
+    }
+
+    QStringList candidates;
+    if (!control.isEmpty()) {
+        candidates << control;
+    } else {
+        candidates << "PCM" << "Speaker" << "Master" << "Headphone";
+    }
+
+    for (const QString& name : candidates) {
+        QByteArray elemName = name.toUtf8();
+        snd_mixer_selem_id_t* sid = nullptr;
+        snd_mixer_selem_id_alloca(&sid);
+        snd_mixer_selem_id_set_index(sid, 0);
+        snd_mixer_selem_id_set_name(sid, elemName.constData());
+        snd_mixer_elem_t* elem = snd_mixer_find_selem(m_mixer, sid);
+        if (elem && snd_mixer_selem_has_playback_volume(elem)) {
+            m_mixerElem = elem;
+            break;
+        }
+    }
+
+    // USB 声卡的控件名不固定，未指定时退回第一个有播放音量的控件
+    if (!m_mixerElem && control.isEmpty()) {
+        for (snd_mixer_elem_t* elem = snd_mixer_first_elem(m_mixer); elem;
+             elem = snd_mixer_elem_next(elem)) {
+            if (snd_mixer_selem_has_playback_volume(elem)) {
+                m_mixerElem = elem;
+                break;
+            }
+        }
+    }
+
+    if (!m_mixerElem) {
+        closeMixer();
+        return false;
+    }
+
+    snd_mixer_selem_get_playback_volume_range(m_mixerElem, &m_volumeMin, &m_volumeMax);
+    if (m_volumeMax <= m_volumeMin) {
+        closeMixer();
+        return false;
+    }
+
+    LOG_INFO(QString("Hardware volume: %1 '%2' [%3, %4]")
+             .arg(card, snd_mixer_selem_get_name(m_mixerElem))
+             .arg(m_volumeMin).arg(m_volumeMax));
+    return true;
+}
+
+void AlsaPlaybackDevice::closeMixer()
+{
+    m_mixerElem = nullptr;
+    if (m_mixer) {
+        snd_mixer_close(m_mixer);
+        m_mixer = nullptr;
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <cstdint>
+#include <vector>
+
+typedef struct _snd_pcm snd_pcm_t;
+typedef struct _snd_mixer snd_mixer_t;
+typedef struct _snd_mixer_elem snd_mixer_elem_t;
+
+/**
+ * ALSA 播放设备 (S16_LE 交错)
+ * 显式设置 period/buffer 大小，写入阻塞到设备有空间为止，由声卡时钟决定节拍；
+ * 声卡提供播放音量控件时通过硬件混音器调节音量
+ *
+ * 非线程安全，所有调用需在同一线程 (播放线程) 中进行
+ */
+class AlsaPlaybackDevice {
+public:
+    struct Config {
+        QString device = "hw:1,0";
+        QString mixerControl;       // 为空时依次尝试 PCM/Speaker/Master/Headphone
+        int sampleRate = 48000;
+        int channels = 2;
+        int periodMs = 10;
+        int periodCount = 4;
+    };
+
+    // 设备原生支持的格式 (S16_LE 交错)
+    struct Capabilities {
+        QList<int> sampleRates;     // 候选采样率中设备支持的部分
+        int minChannels = 0;
+        int maxChannels = 0;
+        bool supportsRate(int rate) const { return sampleRates.contains(rate); }
+    };
+
+    // 短暂打开设备查询能力，设备被占用或不存在时返回 false
+    static bool queryCapabilities(const QString& device, const QList<int>& candidateRates,
+                                  Capabilities& caps);
+
+    AlsaPlaybackDevice();
+    ~AlsaPlaybackDevice();
+
+    AlsaPlaybackDevice(const AlsaPlaybackDevice&) = delete;
+    AlsaPlaybackDevice& operator=(const AlsaPlaybackDevice&) = delete;
+
+    bool open(const Config& config);
+    void close();
+    bool isOpen() const { return m_pcm != nullptr; }
+
+    // 阻塞写入，欠载后自动恢复；返回写入的帧数，设备出错返回 -1
+    int write(const int16_t* samples, int frames);
+    // 已写入但尚未播放的帧数 (含硬件延迟)，失败返回 -1
+    int delayFrames();
+    // 撤回最近写入、尚未送到硬件的至多 frames 帧，返回实际撤回的帧数 (不支持时为 0)
+    int rewind(int frames);
+    // 立即丢弃所有待播放数据并重新 prepare，返回丢弃前排队的帧数
+    int drop();
+    // drop 后设备停在 PREPARED，要写满启动阈值 (一个 period) 才开始播放；
+    // 已有排队数据但未开始播放时补静音到启动阈值并立即启动，返回补入的静音帧数
+    int start();
+
+    // 协商后的实际参数
+    int sampleRate() const { return m_sampleRate; }
+    int periodFrames() const { return m_periodFrames; }
+    int bufferFrames() const { return m_bufferFrames; }
+    int underruns() const { return m_underruns; }
+
+    bool hasHardwareVolume() const { return m_mixerElem != nullptr; }
+    // volume: 0-100，按控件原始范围线性映射
+    bool setHardwareVolume(int volume);
+
+private:
+    bool openMixer(const QString& device, const QString& control);
+    void closeMixer();
+
+    snd_pcm_t* m_pcm = nullptr;
+    snd_mixer_t* m_mixer = nullptr;
+    snd_mixer_elem_t* m_mixerElem = nullptr;
+    long m_volumeMin = 0;
+    long m_volumeMax = 0;
+
+    int m_sampleRate = 0;
+    int m_channels = 0;
+    int m_periodFrames = 0;
+    int m_bufferFrames = 0;
+    int m_underruns = 0;
+    std::vector<int16_t> m_silence;  // 一个 period 的静音，open 时分配
+};
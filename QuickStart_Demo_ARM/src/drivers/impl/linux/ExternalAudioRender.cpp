@@ -1,10 +1,71 @@
 #include "ExternalAudioRender.h"
+#include "AecReferenceQueue.h"
+#include "AllocAudit.h"
+#include "AudioDsp.h"
+#include "AudioLevelMeter.h"
+#include "DriftEstimator.h"
+#include "FractionalResampler.h"
+#include "PlaybackMonitor.h"
+#include "TraceRecorder.h"
+#include "MetricsRegistry.h"
+#include "TurnLatencyTracker.h"
 #include <QDebug>
 #include <chrono>
 #include <cstring>
+#include <algorithm>
 #include <thread>
-#include <stdio.h>
-#include <cstdlib>
+#include <vector>
+
+static const int INTERRUPT_FADE_MS = 5;     // 打断时的淡出长度，避免爆音
+static const int HISTORY_MS = 200;          // 最近写入设备的音频，覆盖声卡缓冲，用于打断时重写淡出段
+static const int REFERENCE_QUEUE_MS = 500;  // 等待播出的回声参考，覆盖声卡缓冲
+static const int AI_AUDIO_PEAK = 64;        // 约 -54 dBFS，轮次统计中高于此峰值才算 AI 开始发声
+
+static int64_t steadyNowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 回调采样率候选 (SDK 支持且常见于声卡)，按开销从低到高
+static const int CALLBACK_RATES[] = {16000, 24000, 48000};
+
+static bool isSdkSampleRate(int rate) {
+    switch (rate) {
+    case 8000: case 11025: case 16000: case 22050:
+    case 24000: case 32000: case 44100: case 48000:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// 交错数据的声道转换: 单声道复制到各声道，立体声转单声道取平均，其余多出的声道补零
+static void convertChannels(const int16_t* in, int inChannels, int16_t* out, int outChannels, int frames) {
+    // 常见的单声道 <-> 立体声走 SIMD
+    if (inChannels == 1 && outChannels == 2) {
+        AudioDsp::monoToStereo(in, out, frames);
+        return;
+    }
+    if (inChannels == 2 && outChannels == 1) {
+        AudioDsp::stereoToMono(in, out, frames);
+        return;
+    }
+    for (int i = 0; i < frames; i++) {
+        const int16_t* src = in + i * inChannels;
+        int16_t* dst = out + i * outChannels;
+        if (outChannels == 1) {
+            int32_t sum = 0;
+            for (int c = 0; c < inChannels; c++) {
+                sum += src[c];
+            }
+            dst[0] = static_cast<int16_t>(sum / inChannels);
+            continue;
+        }
+        for (int c = 0; c < outChannels; c++) {
+            dst[c] = inChannels == 1 ? src[0] : (c < inChannels ? src[c] : 0);
+        }
+    }
+}
 
 ExternalAudioRender::ExternalAudioRender(QObject* parent)
     : QThread(parent) {
@@ -18,26 +79,155 @@ void ExternalAudioRender::setRTCEngine(bytertc::IRTCEngine* engine) {
     m_rtcEngine = engine;
 }
 
+void ExternalAudioRender::setThreadPolicy(const ThreadPolicyConfig& policy) {
+    m_threadPolicy = policy;
+}
+
+void ExternalAudioRender::setDeviceConfig(const AlsaPlaybackDevice::Config& config) {
+    m_deviceConfig = config;
+}
+
+void ExternalAudioRender::setJitterRange(int minDelayMs, int maxDelayMs) {
+    m_jitterMinMs = qMax(0, minDelayMs);
+    m_jitterMaxMs = qMax(m_jitterMinMs, maxDelayMs);
+}
+
+void ExternalAudioRender::setPreferredFormat(int sampleRate, int channels) {
+    if (sampleRate != 0 && !isSdkSampleRate(sampleRate)) {
+        qDebug() << "ExternalAudioRender: unsupported callback sample rate" << sampleRate << ", using auto";
+        sampleRate = 0;
+    }
+    m_preferredRate = sampleRate;
+    m_preferredChannels = qBound(0, channels, 2);
+}
+
+void ExternalAudioRender::setPlaybackMonitor(PlaybackMonitor* monitor) {
+    m_playbackMonitor = monitor;
+}
+
+void ExternalAudioRender::setLevelMeter(AudioLevelMeter* meter) {
+    m_levelMeter = meter;
+}
+
+void ExternalAudioRender::setTurnTracker(TurnLatencyTracker* tracker) {
+    m_turnTracker = tracker;
+}
+
+void ExternalAudioRender::setDuckLevel(int percent) {
+    m_duckLevel = qBound(0, percent, 100);
+}
+
+void ExternalAudioRender::setMixMode(MixMode mode, int maxStreams) {
+    m_mixMode = mode;
+    m_maxStreams = qBound(1, maxStreams, 16);
+}
+
+void ExternalAudioRender::setPriorityUser(const QString& userId) {
+    m_priorityUser = userId;
+}
+
+void ExternalAudioRender::setStreamGains(int priorityPercent, int otherPercent, int duckOthersPercent) {
+    m_streamMixer.setGains(priorityPercent, otherPercent, duckOthersPercent);
+}
+
+void ExternalAudioRender::setAecReferenceEnabled(bool enabled) {
+    m_aecReference = enabled;
+}
+
+void ExternalAudioRender::negotiateFormat(PcmFormat& callback, PcmFormat& device) {
+    // AI 语音本身是单声道，默认只让 SDK 输出单声道
+    callback.channels = m_preferredChannels > 0 ? m_preferredChannels : 1;
+    
+    QList<int> candidates = {16000, 24000, 32000, 44100, 48000};
+    if (m_preferredRate > 0 && !candidates.contains(m_preferredRate)) {
+        candidates << m_preferredRate;
+    }
+    AlsaPlaybackDevice::Capabilities caps;
+    if (!AlsaPlaybackDevice::queryCapabilities(m_deviceConfig.device, candidates, caps)) {
+        // 探测失败 (设备被占用等) 时沿用原来的 48kHz 立体声，由 open 报告具体错误
+        callback.sampleRate = 48000;
+        device.sampleRate = 48000;
+        device.channels = 2;
+        return;
+    }
+    
+    // 自动模式选声卡原生支持的最低候选采样率，省去 SDK 解码/重采样到 48kHz 以及播放线程的转换
+    if (m_preferredRate > 0) {
+        callback.sampleRate = m_preferredRate;
+    } else {
+        callback.sampleRate = 48000;
+        for (int rate : CALLBACK_RATES) {
+            if (caps.supportsRate(rate)) {
+                callback.sampleRate = rate;
+                break;
+            }
+        }
+    }
+    
+    // 声卡不支持回调采样率时优先 48kHz，否则取支持的最高采样率，由播放线程重采样
+    if (caps.supportsRate(callback.sampleRate)) {
+        device.sampleRate = callback.sampleRate;
+    } else if (caps.supportsRate(48000)) {
+        device.sampleRate = 48000;
+    } else {
+        device.sampleRate = *std::max_element(caps.sampleRates.begin(), caps.sampleRates.end());
+    }
+    // 只有单声道的声卡也可能要求立体声 (例如 I2S 功放)，声道数取声卡允许范围内最接近的
+    device.channels = qBound(caps.minChannels, callback.channels, caps.maxChannels);
+}
+
 void ExternalAudioRender::startRender() {
     if (m_running) {
         return;
     }
     
-    if (!m_rtcEngine) {
+    if (!m_rtcEngine && !m_localInput) {
         qDebug() << "ExternalAudioRender: RTC engine is null";
         return;
     }
     
+    PcmFormat callback;
+    PcmFormat device;
+    negotiateFormat(callback, device);
+    m_callbackFormat = callback;
+    m_deviceFormat = device;
+    qDebug() << "ExternalAudioRender: callback" << callback.sampleRate << "Hz" << callback.channels << "ch,"
+             << "device" << device.sampleRate << "Hz" << device.channels << "ch";
+    
+    // 注册观察者之前准备好抖动缓冲，回调里只做无锁写入
+    // 最大取块 20ms，覆盖漂移补偿时略多于 10ms 的输入
+    if (m_mixMode == MixPerStream) {
+        m_streamMixer.setPriorityUser(m_priorityUser.toStdString());
+        m_streamMixer.configure(callback.sampleRate, callback.channels, m_maxStreams,
+                                m_jitterMinMs, m_jitterMaxMs, callback.sampleRate / 50);
+    } else {
+        m_jitterBuffer.configure(callback.sampleRate, callback.channels, m_jitterMinMs, m_jitterMaxMs,
+                                 1000, callback.sampleRate / 50);
+    }
+    
+    if (m_localInput) {
+        qDebug() << "ExternalAudioRender: local input mode, SDK callbacks not registered";
+        m_running = true;
+        start();
+        return;
+    }
+    
     // 注册音频帧观察者
     int ret = m_rtcEngine->registerAudioFrameObserver(this);
     qDebug() << "ExternalAudioRender: registerAudioFrameObserver ret:" << ret;
     
-    // 启用 Playback 回调（远端音频）
+    // 启用 Playback 回调（远端音频）；分流模式改为按远端流回调，只订阅其中一种，避免重复播放
     bytertc::AudioFormat format;
-    format.sample_rate = bytertc::kAudioSampleRate48000;
-    format.channel = bytertc::kAudioChannelStereo;
-    ret = m_rtcEngine->enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kPlayback, format);
-    qDebug() << "ExternalAudioRender: enableAudioFrameCallback(kPlayback) ret:" << ret;
+    format.sample_rate = static_cast<bytertc::AudioSampleRate>(callback.sampleRate);
+    format.channel = callback.channels == 1 ? bytertc::kAudioChannelMono : bytertc::kAudioChannelStereo;
+    if (m_mixMode == MixPerStream) {
+        ret = m_rtcEngine->enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kRemoteUser, format);
+        qDebug() << "ExternalAudioRender: enableAudioFrameCallback(kRemoteUser) ret:" << ret
+                 << "max streams:" << m_maxStreams << "priority:" << m_priorityUser;
+    } else {
+        ret = m_rtcEngine->enableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kPlayback, format);
+        qDebug() << "ExternalAudioRender: enableAudioFrameCallback(kPlayback) ret:" << ret;
+    }
     
     m_running = true;
     start();
@@ -46,8 +236,9 @@ void ExternalAudioRender::startRender() {
 void ExternalAudioRender::stopRender() {
     m_running = false;
     
-    if (m_rtcEngine) {
+    if (m_rtcEngine && !m_localInput) {
         m_rtcEngine->disableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kPlayback);
+        m_rtcEngine->disableAudioFrameCallback(bytertc::AudioFrameCallbackMethod::kRemoteUser);
         m_rtcEngine->registerAudioFrameObserver(nullptr);
     }
     
@@ -76,106 +267,488 @@ bool ExternalAudioRender::isMuted() const {
     return m_muted;
 }
 
+void ExternalAudioRender::interrupt() {
+    // 只记录请求时间，由播放线程在下一块之前处理 (最多等一次阻塞写入)
+    int64_t expected = 0;
+    m_interruptRequestUs.compare_exchange_strong(expected, steadyNowUs());
+}
+
+int ExternalAudioRender::lastInterruptLatencyMs() const {
+    int us = m_interruptLatencyUs.load(std::memory_order_relaxed);
+    return us < 0 ? -1 : us / 1000;
+}
+
+double ExternalAudioRender::driftPpm() const {
+    return m_driftPpm.load(std::memory_order_relaxed);
+}
+
+int ExternalAudioRender::outputLatencyMs() const {
+    return m_outputLatencyUs.load(std::memory_order_relaxed) / 1000;
+}
+
+int ExternalAudioRender::aecReferenceDelayMs() const {
+    int us = m_aecReferenceDelayUs.load(std::memory_order_relaxed);
+    return us < 0 ? -1 : us / 1000;
+}
+
+JitterBuffer::Stats ExternalAudioRender::jitterStats() const {
+    return m_mixMode == MixPerStream ? m_streamMixer.stats() : m_jitterBuffer.stats();
+}
+
+int ExternalAudioRender::activeRemoteStreams() const {
+    return m_mixMode == MixPerStream ? m_streamMixer.activeStreams() : 0;
+}
+
+int ExternalAudioRender::popInput(int16_t* samples, int frames) {
+    return m_mixMode == MixPerStream ? m_streamMixer.pop(samples, frames) : m_jitterBuffer.pop(samples, frames);
+}
+
+int ExternalAudioRender::flushInput() {
+    return m_mixMode == MixPerStream ? m_streamMixer.flush() : m_jitterBuffer.flush();
+}
+
+int ExternalAudioRender::inputDepthFrames() const {
+    return m_mixMode == MixPerStream ? m_streamMixer.depthFrames() : m_jitterBuffer.depthFrames();
+}
+
+int ExternalAudioRender::inputTargetFrames() const {
+    return m_mixMode == MixPerStream ? m_streamMixer.targetFrames() : m_jitterBuffer.targetFrames();
+}
+
+bool ExternalAudioRender::isInputPlaying() const {
+    return m_mixMode == MixPerStream ? m_streamMixer.isPlaying() : m_jitterBuffer.isPlaying();
+}
+
 void ExternalAudioRender::onPlaybackAudioFrame(const bytertc::IAudioFrame& audio_frame) {
-    // 在 SDK 回调线程中接收远端音频数据
+    TRACE_SCOPE("audio.sdk.onPlaybackAudioFrame");
+    // 在 SDK 回调线程中接收远端音频数据 (协商的回调格式)，写入抖动缓冲，不加锁不分配
     uint8_t* data = audio_frame.data();
     int dataSize = audio_frame.dataSize();
     
     if (data && dataSize > 0) {
-        QMutexLocker locker(&m_mutex);
-        
-        // 防止队列过大
-        while (m_audioQueue.size() >= MAX_QUEUE_SIZE) {
-            m_audioQueue.dequeue();
+        int frames = dataSize / (2 * m_callbackFormat.channels);
+        m_jitterBuffer.push(reinterpret_cast<const int16_t*>(data), frames);
+        // 只在等待本轮第一块 AI 音频时测量，SDK 空闲时回调的是静音
+        if (m_turnTracker && m_turnTracker->isAwaitingAudio() &&
+            AudioDsp::measure(reinterpret_cast<const int16_t*>(data), frames * m_callbackFormat.channels).peak >= AI_AUDIO_PEAK) {
+            m_turnTracker->markAudioReceived(steadyNowUs());
         }
-        
-        // 复制音频数据到队列
-        QByteArray audioData(reinterpret_cast<const char*>(data), dataSize);
-        m_audioQueue.enqueue(audioData);
     }
 }
 
+void ExternalAudioRender::setLocalInput(bool enabled) {
+    m_localInput = enabled;
+}
+
+void ExternalAudioRender::pushLocalAudio(const int16_t* samples, int frames) {
+    // 与 SDK 回调相同，直接写入抖动缓冲
+    if (m_localInput && m_mixMode == MixSdk && samples && frames > 0) {
+        m_jitterBuffer.push(samples, frames);
+    }
+}
+
+void ExternalAudioRender::onRemoteUserAudioFrame(const char* stream_id, const bytertc::StreamInfo& stream_info,
+                                                 const bytertc::IAudioFrame& audio_frame) {
+    TRACE_SCOPE("audio.sdk.onRemoteUserAudioFrame");
+    // 分流模式: 按远端流写入各自的抖动缓冲，同样不加锁不分配
+    if (m_mixMode != MixPerStream) {
+        return;
+    }
+    uint8_t* data = audio_frame.data();
+    int dataSize = audio_frame.dataSize();
+    
+    if (data && dataSize > 0) {
+        int frames = dataSize / (2 * m_callbackFormat.channels);
+        m_streamMixer.push(stream_id, stream_info.user_id, reinterpret_cast<const int16_t*>(data), frames);
+        if (m_turnTracker && m_turnTracker->isAwaitingAudio() &&
+            (m_priorityUser.isEmpty() || m_priorityUser == QLatin1String(stream_info.user_id)) &&
+            AudioDsp::measure(reinterpret_cast<const int16_t*>(data), frames * m_callbackFormat.channels).peak >= AI_AUDIO_PEAK) {
+            m_turnTracker->markAudioReceived(steadyNowUs());
+        }
+    }
+}
+
+bool ExternalAudioRender::openDevice() {
+    // 进程内直接打开 ALSA，格式为协商的设备格式, 16-bit signed little-endian
+    m_device = new AlsaPlaybackDevice();
+    AlsaPlaybackDevice::Config config = m_deviceConfig;
+    config.sampleRate = m_deviceFormat.sampleRate;
+    config.channels = m_deviceFormat.channels;
+    if (!m_device->open(config)) {
+        qDebug() << "ExternalAudioRender: failed to open" << config.device;
+        delete m_device;
+        m_device = nullptr;
+        return false;
+    }
+    
+    qDebug() << "ExternalAudioRender: ALSA playback opened, buffer"
+             << m_device->bufferFrames() * 1000 / m_device->sampleRate() << "ms";
+    return true;
+}
+
+void ExternalAudioRender::writeDevice(const int16_t* samples, int frames) {
+    if (!m_device) {
+        return;
+    }
+    // 声卡缓冲满时阻塞，写入节拍即播放节拍
+    TRACE_SCOPE("audio.render.write");
+    m_device->write(samples, frames);
+}
+
+void ExternalAudioRender::closeDevice() {
+    if (m_device) {
+        m_device->close();
+        delete m_device;
+        m_device = nullptr;
+    }
+}
+
+int ExternalAudioRender::deviceDelayFrames() {
+    return m_device ? m_device->delayFrames() : -1;
+}
+
+int ExternalAudioRender::discardDeviceFrames(int keepFrames) {
+    if (!m_device) {
+        return 0;
+    }
+    int queued = m_device->delayFrames();
+    if (queued <= keepFrames) {
+        return 0;
+    }
+    int rewound = m_device->rewind(queued - keepFrames);
+    if (rewound > 0) {
+        return rewound;
+    }
+    // 不支持 rewind 的设备直接 drop，淡出段从当前播放位置重写
+    return m_device->drop();
+}
+
+int ExternalAudioRender::startDevice() {
+    return m_device ? m_device->start() : 0;
+}
+
+bool ExternalAudioRender::setDeviceVolume(int volume) {
+    return m_device && m_device->setHardwareVolume(volume);
+}
+
+bool ExternalAudioRender::isRealtime() const {
+    return true;
+}
+
+int ExternalAudioRender::pushReference(const int16_t* samples, int frames, int64_t playoutUs) {
+    if (!m_rtcEngine) {
+        return -1;
+    }
+    TRACE_SCOPE("audio.render.pushReferenceAudioPCMData");
+    bytertc::AudioFrameBuilder builder;
+    builder.sample_rate = static_cast<bytertc::AudioSampleRate>(m_deviceFormat.sampleRate);
+    builder.channel = m_callbackFormat.channels == 1 ? bytertc::kAudioChannelMono : bytertc::kAudioChannelStereo;
+    builder.timestamp_us = playoutUs;
+    builder.data = reinterpret_cast<uint8_t*>(const_cast<int16_t*>(samples));
+    builder.data_size = static_cast<int64_t>(frames) * m_callbackFormat.channels * 2;
+    builder.deep_copy = true;
+    
+    bytertc::IAudioFrame* audioFrame = bytertc::buildAudioFrame(builder);
+    if (!audioFrame) {
+        return -1;
+    }
+    int ret = m_rtcEngine->pushReferenceAudioPCMData(audioFrame);
+    audioFrame->release();
+    return ret;
+}
+
 void ExternalAudioRender::run() {
     qDebug() << "ExternalAudioRender: starting audio render thread...";
+    ThreadPolicy::applyToCurrentThread(m_threadPolicy);
 
-    // 使用 popen 直接写入 aplay
-    // 格式: 48000Hz, 立体声, 16-bit signed little-endian
-    FILE* aplayPipe = popen("aplay -D hw:1,0 -f S16_LE -r 48000 -c 2 -t raw -q 2>/dev/null", "w");
-    
-    if (!aplayPipe) {
-        qDebug() << "ExternalAudioRender: failed to start aplay";
+    if (!openDevice()) {
+        qDebug() << "ExternalAudioRender: failed to open playback device";
         return;
     }
     
-    qDebug() << "ExternalAudioRender: aplay started";
+    const bool realtime = isRealtime();
+    const int inRate = m_callbackFormat.sampleRate;
+    const int inChannels = m_callbackFormat.channels;
+    const int outRate = m_deviceFormat.sampleRate;
+    const int outChannels = m_deviceFormat.channels;
+    const int blockFrames = outRate / 100;  // 每次输出 10ms
+    // 采样率相同时比率为 1，只做漂移补偿
+    const double baseRatio = inRate / static_cast<double>(outRate);
+    const bool convertLayout = inChannels != outChannels;
+    
+    // SDK 回调节拍与声卡时钟之间的漂移补偿:
+    // 以抖动缓冲深度 (回调采样率的帧) 作为水位、抖动缓冲的目标深度作为目标，微调每块消耗的输入帧数；
+    // 突发积压由抖动缓冲的时间压缩处理
+    DriftEstimator drift(inRate, 0.01);
+    FractionalResampler resampler(inChannels);
+    resampler.setRatio(baseRatio);
+    std::vector<int16_t> inBuffer(resampler.inputFramesFor(blockFrames) * inChannels * 2);
+    std::vector<int16_t> outBuffer(blockFrames * inChannels);
+    // 声道数不同时才需要的转换缓冲
+    std::vector<int16_t> deviceBuffer(convertLayout ? blockFrames * outChannels : 0);
+    // 最近写入设备的音频 (环形)，打断时找回被撤回部分的开头做淡出
+    const int historyFrames = outRate * HISTORY_MS / 1000;
+    const int fadeFrames = outRate * INTERRUPT_FADE_MS / 1000;
+    std::vector<int16_t> history(historyFrames * outChannels);
+    std::vector<int16_t> fadeBuffer(fadeFrames * outChannels);
+    int historyPos = 0;
+    int historyCount = 0;
+    // 回声参考: 声道扩展之前的输出 (与声卡播出的内容一致)，等到播出时刻再推送给 SDK
+    const bool aecReference = m_aecReference && isSdkSampleRate(outRate);
+    if (m_aecReference && !aecReference) {
+        qDebug() << "ExternalAudioRender: device rate" << outRate << "not supported by SDK, AEC reference disabled";
+    }
+    AecReferenceQueue referenceQueue;
+    if (aecReference) {
+        referenceQueue.configure(blockFrames * inChannels, REFERENCE_QUEUE_MS / 10);
+    }
+    int referenceCount = 0;
+    int referenceErrors = 0;
+    m_aecReferenceDelayUs = -1;
+    m_interruptRequestUs = 0;
+    m_driftPpm = 0.0;
+    m_outputLatencyUs = 0;
     
     int frameCount = 0;
     int emptyCount = 0;
+    float duckGain = 1.0f;
+    float volumeGain = 1.0f;
+    int appliedVolume = -1;
+    bool hardwareVolume = false;
+    DeadlineMonitor deadline(m_threadPolicy.name.isEmpty() ? "audio-out" : m_threadPolicy.name,
+                             blockFrames * 1000000 / outRate);
+    // 指标在线程启动时登记一次，循环中只做原子累加
+    MetricCounter* blocksMetric = MetricsRegistry::instance()->counter(
+        "audio_render_blocks", "Blocks written to the playback device");
+    MetricCounter* silentBlocksMetric = MetricsRegistry::instance()->counter(
+        "audio_render_empty_blocks", "Blocks written without remote audio");
+    MetricCounter* referenceErrorsMetric = MetricsRegistry::instance()->counter(
+        "audio_reference_errors", "pushReferenceAudioPCMData failures");
 
     while (m_running) {
-        QByteArray audioData;
+        int64_t interruptUs = m_interruptRequestUs.load(std::memory_order_acquire);
+        if (interruptUs != 0) {
+            // 打断: 丢弃抖动缓冲，撤回声卡中尚未播出的部分，只保留淡出所需的几毫秒
+            int droppedFrames = flushInput();
+            int discarded = qMin(discardDeviceFrames(fadeFrames), historyCount);
+            if (discarded > 0) {
+                // 被撤回音频的开头与声卡中保留的部分相接，线性淡出后重新写入
+                int count = qMin(discarded, fadeFrames);
+                int start = (historyPos - discarded + historyFrames) % historyFrames;
+                for (int i = 0; i < count; i++) {
+                    const int16_t* src = &history[((start + i) % historyFrames) * outChannels];
+                    std::copy(src, src + outChannels, fadeBuffer.begin() + i * outChannels);
+                }
+                AudioDsp::applyGainRamp(fadeBuffer.data(), count, outChannels, 1.0f, 0.0f);
+                writeDevice(fadeBuffer.data(), count);
+            }
+            // 不支持 rewind 的设备 drop 后停在 PREPARED，淡出段要等下一块写满启动阈值才播放；
+            // 这里立即启动，延迟也要在开始播放后测量 (PREPARED 状态下的 delay 偏小)
+            int paddedFrames = startDevice();
+            historyCount = 0;
+            resampler.reset();
+            // 被撤回的音频不会播出，对应的参考信号一并丢弃
+            referenceQueue.clear();
+            // 被打断的回复已丢弃，下一轮回复不再闪避
+            if (m_playbackMonitor) {
+                m_playbackMonitor->clearDuck();
+            }
+            
+            // 打断到静音 = 请求等待时间 + 声卡中剩余 (含淡出段，不含补入的静音) 的播放时间
+            int remainingFrames = qMax(0, deviceDelayFrames() - paddedFrames);
+            int latencyUs = static_cast<int>(steadyNowUs() - interruptUs +
+                                             static_cast<int64_t>(remainingFrames) * 1000000 / outRate);
+            m_interruptLatencyUs.store(latencyUs, std::memory_order_relaxed);
+            m_interruptRequestUs.store(0, std::memory_order_release);
+            AllocAudit::ScopedAllow allow;
+            qDebug() << "ExternalAudioRender: interrupted, silence in" << latencyUs / 1000.0 << "ms"
+                     << "(dropped" << droppedFrames * 1000 / inRate << "ms buffered,"
+                     << discarded * 1000 / outRate << "ms from device)";
+        }
         
-        {
-            QMutexLocker locker(&m_mutex);
-            if (!m_audioQueue.isEmpty()) {
-                audioData = m_audioQueue.dequeue();
+        // 音量在播放线程中下发，硬件混音器只在这里访问
+        int volume = m_volume.load();
+        if (volume != appliedVolume) {
+            hardwareVolume = setDeviceVolume(volume);
+            appliedVolume = volume;
+            if (hardwareVolume) {
+                volumeGain = 1.0f;
             }
         }
         
-        if (!audioData.isEmpty()) {
-            // 检查静音状态
-            if (m_muted.load()) {
-                // 静音时跳过播放
-                frameCount++;
-                emptyCount = 0;
-                continue;
+        int inFrames = resampler.inputFramesFor(blockFrames);
+        if (!realtime && inputDepthFrames() < inFrames) {
+            // 非实时模式只写真实音频
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            continue;
+        }
+        
+        // 抖动缓冲总是返回一整块，欠载时为补偿/静音数据，声卡不会断流
+        TRACE_SCOPE("audio.render.block");
+        TRACE_COUNTER("audio.render.inputDepth", inputDepthFrames());
+        int realFrames = popInput(inBuffer.data(), inFrames);
+        
+        if (realtime && isInputPlaying()) {
+            drift.setTargetLevel(inputTargetFrames());
+            drift.update(inputDepthFrames());
+            resampler.setRatio(baseRatio * drift.ratio());
+            m_driftPpm.store(drift.driftPpm(), std::memory_order_relaxed);
+        }
+        
+        int outFrames = resampler.process(inBuffer.data(), inFrames, outBuffer.data(), blockFrames);
+        
+        // 插话闪避: 增益在一块内线性过渡到目标，避免爆音
+        float duckTarget = (m_playbackMonitor && m_playbackMonitor->isDuckRequested())
+            ? m_duckLevel.load() / 100.0f : 1.0f;
+        
+        // 播出电平 (回声估计、电平表) 与增益处理在同一次遍历中测得
+        AudioDsp::Level level;
+        bool needLevel = m_playbackMonitor || m_levelMeter || m_turnTracker;
+        bool muted = m_muted.load();
+        if (muted) {
+            // 静音时写入静音数据，声卡继续按节拍消费
+            std::fill(outBuffer.begin(), outBuffer.begin() + outFrames * inChannels, 0);
+        } else {
+            // 没有硬件音量控件时软件调节；音量和闪避合并为一段斜坡，变化在一块内线性过渡，避免咔哒声
+            // 在声道扩展之前处理，处理的采样数最少
+            float rampStart = duckGain;
+            float rampEnd = duckTarget;
+            if (!hardwareVolume) {
+                float volumeTarget = volume / 100.0f;
+                rampStart *= volumeGain;
+                rampEnd *= volumeTarget;
+                volumeGain = volumeTarget;
             }
-            
-            // 应用音量调节
-            int volume = m_volume.load();
-            if (volume != 100) {
-                int16_t* samples = reinterpret_cast<int16_t*>(audioData.data());
-                int sampleCount = audioData.size() / 2;
-                for (int i = 0; i < sampleCount; i++) {
-                    int32_t sample = samples[i] * volume / 100;
-                    // 防止溢出
-                    if (sample > 32767) sample = 32767;
-                    if (sample < -32768) sample = -32768;
-                    samples[i] = static_cast<int16_t>(sample);
+            if (rampStart != 1.0f || rampEnd != 1.0f) {
+                if (needLevel) {
+                    level = AudioDsp::applyGainRampMeasured(outBuffer.data(), outFrames, inChannels, rampStart, rampEnd);
+                } else {
+                    AudioDsp::applyGainRamp(outBuffer.data(), outFrames, inChannels, rampStart, rampEnd);
                 }
+            } else if (needLevel) {
+                level = AudioDsp::measure(outBuffer.data(), outFrames * inChannels);
             }
+        }
+        duckGain = duckTarget;
+        
+        // 发布实际播出的峰值，供采集端估计回声
+        if (m_playbackMonitor) {
+            m_playbackMonitor->publish(level.peak, realFrames > 0 && !muted);
+        }
+        if (m_levelMeter) {
+            m_levelMeter->publish(level);
+        }
+        
+        // 写入播放设备，实时模式下阻塞到声卡有空间
+        const int16_t* deviceSamples = outBuffer.data();
+        if (convertLayout) {
+            convertChannels(outBuffer.data(), inChannels, deviceBuffer.data(), outChannels, outFrames);
+            deviceSamples = deviceBuffer.data();
+        }
+        writeDevice(deviceSamples, outFrames);
+        
+        // 记入历史环 (两段拷贝)
+        int head = qMin(outFrames, historyFrames - historyPos);
+        std::copy(deviceSamples, deviceSamples + head * outChannels, history.begin() + historyPos * outChannels);
+        std::copy(deviceSamples + head * outChannels, deviceSamples + outFrames * outChannels, history.begin());
+        historyPos = (historyPos + outFrames) % historyFrames;
+        historyCount = qMin(historyFrames, historyCount + outFrames);
+        
+        // 输出延迟 = 抖动缓冲深度 + 声卡缓冲中尚未播出的部分
+        int delayFrames = deviceDelayFrames();
+        m_outputLatencyUs.store(static_cast<int>(
+            static_cast<int64_t>(inputDepthFrames()) * 1000000 / inRate +
+            static_cast<int64_t>(qMax(0, delayFrames)) * 1000000 / outRate),
+            std::memory_order_relaxed);
+        
+        // 轮次延迟统计: 本轮第一块有声的 AI 音频，按声卡中排在它之前的音频推算实际播出时刻
+        if (m_turnTracker && realFrames > 0 && !muted && level.peak >= AI_AUDIO_PEAK &&
+            m_turnTracker->isAwaitingPlayout()) {
+            int64_t aheadUs = delayFrames >= 0
+                ? static_cast<int64_t>(qMax(0, delayFrames - outFrames)) * 1000000 / outRate : 0;
+            m_turnTracker->markPlayout(steadyNowUs() + aheadUs);
+        }
+        
+        if (aecReference) {
+            // 这块音频排在声卡中其余 delayFrames - outFrames 帧之后播出 (为负表示已经开始播放)
+            int64_t nowUs = steadyNowUs();
+            int64_t aheadUs = delayFrames >= 0
+                ? static_cast<int64_t>(delayFrames - outFrames) * 1000000 / outRate : 0;
+            referenceQueue.push(outBuffer.data(), outFrames, inChannels, nowUs + aheadUs);
+            m_aecReferenceDelayUs.store(static_cast<int>(qMax<int64_t>(0, aheadUs)), std::memory_order_relaxed);
             
-            // 写入音频数据到 aplay
-            size_t written = fwrite(audioData.data(), 1, audioData.size(), aplayPipe);
-            fflush(aplayPipe);
-            
-            frameCount++;
-            emptyCount = 0;
-            
-            if (frameCount % 50 == 0) {  // 每秒打印一次 (50 * 20ms = 1s)
-                // 检查数据是否全为0
-                int16_t* samples = reinterpret_cast<int16_t*>(audioData.data());
-                int sampleCount = audioData.size() / 2;
-                int maxSample = 0;
-                for (int i = 0; i < sampleCount; i++) {
-                    int absSample = abs(samples[i]);
-                    if (absSample > maxSample) maxSample = absSample;
+            // 播放线程约 10ms 一轮，提前半块出队，到达时间误差不超过半块；时间戳仍为准确的播出时刻
+            while (referenceQueue.isDue(nowUs, 5000)) {
+                int frames = 0;
+                int64_t playoutUs = 0;
+                const int16_t* samples = referenceQueue.front(&frames, &playoutUs);
+                int ret = pushReference(samples, frames, playoutUs);
+                referenceQueue.pop();
+                referenceCount++;
+                if (ret != 0) {
+                    referenceErrorsMetric->add();
+                }
+                if (ret != 0 && referenceErrors++ % 500 == 0) {
+                    AllocAudit::ScopedAllow allow;
+                    qDebug() << "ExternalAudioRender: pushReferenceAudioPCMData ret:" << ret
+                             << "(" << referenceErrors << "errors )";
                 }
-                qDebug() << "ExternalAudioRender: played frame" << frameCount 
-                         << "size:" << audioData.size() << "maxSample:" << maxSample;
             }
-        } else {
+        }
+        
+        if (realtime) {
+            deadline.tick();
+        }
+        
+        blocksMetric->add();
+        if (realFrames == 0) {
+            silentBlocksMetric->add();
             emptyCount++;
-            if (emptyCount % 500 == 0) {  // 每10秒打印一次
-                qDebug() << "ExternalAudioRender: no audio data in queue";
+            if (emptyCount % 1000 == 0) {  // 每10秒打印一次
+                AllocAudit::ScopedAllow allow;
+                qDebug() << "ExternalAudioRender: no audio data in jitter buffer";
             }
+            continue;
         }
         
-        // 等待 20ms（回调周期是 20ms）
-        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        frameCount++;
+        emptyCount = 0;
+        // 周期性日志会分配内存，不计入稳态分配审计
+        if (frameCount % 100 == 0 && !muted) {  // 每秒打印一次 (100 * 10ms = 1s)
+            AllocAudit::ScopedAllow allow;
+            // 检查数据是否全为0
+            int maxSample = needLevel ? level.peak : AudioDsp::measure(outBuffer.data(), outFrames * inChannels).peak;
+            qDebug() << "ExternalAudioRender: played frame" << frameCount 
+                     << "maxSample:" << maxSample
+                     << "latency:" << outputLatencyMs() << "ms";
+        }
+        if (frameCount % 1000 == 0) {  // 每10秒打印一次抖动缓冲统计
+            AllocAudit::ScopedAllow allow;
+            JitterBuffer::Stats stats = jitterStats();
+            qDebug() << "ExternalAudioRender: jitter depth" << stats.depthMs << "/" << stats.targetMs
+                     << "ms, jitter" << stats.jitterMs << "ms, underruns" << stats.underruns
+                     << "concealed" << stats.concealedMs << "ms, accelerated" << stats.acceleratedMs
+                     << "ms, dropped" << stats.droppedMs << "ms";
+        }
+        if (aecReference && frameCount % 1000 == 0) {  // 每10秒打印一次回声参考状态
+            AllocAudit::ScopedAllow allow;
+            qDebug() << "ExternalAudioRender: AEC reference delay" << aecReferenceDelayMs() << "ms, pushed"
+                     << referenceCount << "errors" << referenceErrors << "dropped" << referenceQueue.dropped();
+        }
+        if (frameCount % 6000 == 0) {  // 每分钟打印一次漂移
+            AllocAudit::ScopedAllow allow;
+            qDebug() << "ExternalAudioRender: drift" << drift.driftPpm() << "ppm, depth"
+                     << drift.filteredLevel() << "/" << drift.targetLevel() << "frames";
+        }
     }
     
-    pclose(aplayPipe);
+    closeDevice();
+    m_outputLatencyUs = 0;
     
-    qDebug() << "ExternalAudioRender: render stopped, total frames:" << frameCount;
+    JitterBuffer::Stats stats = jitterStats();
+    qDebug() << "ExternalAudioRender: render stopped, total frames:" << frameCount
+             << "missed deadlines:" << deadline.missed()
+             << "drift ppm:" << drift.driftPpm()
+             << "underruns:" << stats.underruns
+             << "dropped ms:" << stats.droppedMs;
 }
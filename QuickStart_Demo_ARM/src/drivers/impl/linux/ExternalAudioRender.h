@@ -1,28 +1,95 @@
 #pragma once
 
 #include <QThread>
-#include <QMutex>
-#include <QQueue>
 #include <atomic>
 #include "bytertc_engine.h"
 #include "rtc/bytertc_audio_frame.h"
 #include "drivers/interfaces/IAudioRender.h"
+#include "ThreadPolicy.h"
+#include "AlsaPlaybackDevice.h"
+#include "JitterBuffer.h"
+#include "RemoteStreamMixer.h"
+#include <QString>
+
+class PlaybackMonitor;
+class AudioLevelMeter;
+class TurnLatencyTracker;
 
 /**
  * 外部音频渲染
  * 通过 IAudioFrameObserver 回调获取远端音频并通过 ALSA 播放
  * 解决树莓派上 SDK 无法枚举音频设备的问题
  * 
+ * SDK 回调与播放线程之间经自适应抖动缓冲交接 (无锁、预分配)，
+ * 播放线程每 10ms 取一块阻塞写入声卡，由声卡时钟决定节拍；声卡有音量控件时使用硬件音量
+ * 
+ * 回调格式按声卡能力协商: AI 语音默认取单声道、声卡原生支持的最低常用采样率，
+ * 只有声卡不支持回调格式时才做采样率转换 / 声道扩展
+ * 
+ * 分流模式下改用 onRemoteUserAudioFrame 按远端流接收，每路流独立缓冲，
+ * 由播放线程按增益混音 (智能体优先，其发声时其他参与者闪避)
+ * 
+ * 每块播出音频的峰值和 RMS 与音量/闪避处理同一次遍历测得，发布到播放监视器和电平表
+ * 
+ * 可选把写入声卡的音频作为回声消除参考推回 SDK，按实测的声卡输出延迟对齐到实际播出时刻
+ * 
+ * 设置轮次延迟统计后，每轮第一块 AI 音频在到达 (SDK 回调) 和实际播出时各打一次点
+ * 
+ * 本地输入模式 (回环测试) 下不需要引擎，也不注册 SDK 回调，音频由 pushLocalAudio 写入
+ * 
  * 实现 IAudioRender 接口
  */
 class ExternalAudioRender : public QThread, public IAudioRender, public bytertc::IAudioFrameObserver {
     Q_OBJECT
 
 public:
+    // 远端音频来源: SDK 混好的播放音频，或按远端流分别接收后自行混音
+    enum MixMode {
+        MixSdk,
+        MixPerStream
+    };
+
+    struct PcmFormat {
+        int sampleRate = 48000;
+        int channels = 2;
+    };
+
     ExternalAudioRender(QObject* parent = nullptr);
     ~ExternalAudioRender() override;
 
     void setRTCEngine(bytertc::IRTCEngine* engine);
+    // 线程调度策略，需在 startRender 之前设置
+    void setThreadPolicy(const ThreadPolicyConfig& policy);
+    // 播放设备及 period/buffer 大小，需在 startRender 之前设置
+    void setDeviceConfig(const AlsaPlaybackDevice::Config& config);
+    AlsaPlaybackDevice::Config deviceConfig() const { return m_deviceConfig; }
+    // 抖动缓冲目标深度范围，需在 startRender 之前设置
+    void setJitterRange(int minDelayMs, int maxDelayMs);
+    int jitterMinMs() const { return m_jitterMinMs; }
+    int jitterMaxMs() const { return m_jitterMaxMs; }
+    // 期望的回调格式，0 表示按声卡能力自动选择，需在 startRender 之前设置
+    void setPreferredFormat(int sampleRate, int channels);
+    // 与采集端共享的播放监视器 (输出峰值、插话闪避)，由调用方持有，需在 startRender 之前设置
+    void setPlaybackMonitor(PlaybackMonitor* monitor);
+    // 播出音频的电平表，由调用方持有，需在 startRender 之前设置
+    void setLevelMeter(AudioLevelMeter* meter);
+    // 对话轮次延迟统计 (AI 音频到达/播出打点)，由调用方持有，需在 startRender 之前设置
+    void setTurnTracker(TurnLatencyTracker* tracker);
+    // 闪避时的音量百分比，0 表示完全静音
+    void setDuckLevel(int percent);
+    // 远端混音方式及最多同时混音的流数，需在 startRender 之前设置
+    void setMixMode(MixMode mode, int maxStreams = 4);
+    MixMode mixMode() const { return m_mixMode; }
+    // 分流模式下优先的远端用户 (AI 智能体)，需在 startRender 之前设置
+    void setPriorityUser(const QString& userId);
+    // 分流模式下的增益百分比: 优先用户、其他用户、优先用户发声时其他用户闪避到的音量 (任意线程)
+    void setStreamGains(int priorityPercent, int otherPercent, int duckOthersPercent);
+    // 把播出的音频推送给 SDK 作为回声消除参考，需在 startRender 之前设置
+    void setAecReferenceEnabled(bool enabled);
+    // 本地输入模式，需在 startRender 之前设置；回调格式应通过 setPreferredFormat 指定
+    void setLocalInput(bool enabled);
+    // 本地输入: 写入一块回调格式的音频 (单一生产者线程，不加锁不分配)
+    void pushLocalAudio(const int16_t* samples, int frames);
     
     // IAudioRender 接口实现
     void startRender() override;
@@ -32,24 +99,98 @@ public:
     int getVolume() const override;
     void setMute(bool mute) override;
     bool isMuted() const override;
+    
+    // 打断当前播放 (任意线程，无锁): 丢弃抖动缓冲和声卡中尚未播出的音频，短淡出后静音
+    void interrupt();
+    // 最近一次打断从请求到声卡静音的耗时，尚未打断过时返回 -1
+    int lastInterruptLatencyMs() const;
+    
+    // SDK 回调节拍相对播放节拍的漂移估计 (ppm)
+    double driftPpm() const;
+    // 输出延迟: 抖动缓冲中待播放 + 声卡缓冲中尚未播出的音频 (ms)
+    int outputLatencyMs() const;
+    // 回声参考的对齐延迟: 写入声卡到实际播出的时间 (ms)，未启用时为 -1
+    int aecReferenceDelayMs() const;
+    // 抖动缓冲深度、欠载、丢弃等统计 (分流模式下为主导流)
+    JitterBuffer::Stats jitterStats() const;
+    // 分流模式下正在混音的远端流数
+    int activeRemoteStreams() const;
+    // 协商结果 (startRender 之后有效)
+    PcmFormat callbackFormat() const { return m_callbackFormat; }
+    PcmFormat deviceFormat() const { return m_deviceFormat; }
 
     // IAudioFrameObserver 回调
     void onRecordAudioFrameOriginal(const bytertc::IAudioFrame& audio_frame) override {}
     void onRecordAudioFrame(const bytertc::IAudioFrame& audio_frame) override {}
     void onPlaybackAudioFrame(const bytertc::IAudioFrame& audio_frame) override;
-    void onRemoteUserAudioFrame(const char* stream_id, const bytertc::StreamInfo& stream_info, const bytertc::IAudioFrame& audio_frame) override {}
+    void onRemoteUserAudioFrame(const char* stream_id, const bytertc::StreamInfo& stream_info, const bytertc::IAudioFrame& audio_frame) override;
     void onMixedAudioFrame(const bytertc::IAudioFrame& audio_frame) override {}
     void onCaptureMixedAudioFrame(const bytertc::IAudioFrame& audio_frame) override {}
 
 protected:
     void run() override;
+    
+    // 在 startRender 的调用线程中确定 SDK 回调格式和设备格式
+    virtual void negotiateFormat(PcmFormat& callback, PcmFormat& device);
+    int preferredSampleRate() const { return m_preferredRate; }
+    int preferredChannels() const { return m_preferredChannels; }
+
+    // 设备钩子，均在播放线程中调用；子类可以替换为其他输出 (例如文件)
+    // 输入为 deviceFormat() 格式的 S16_LE 交错数据
+    virtual bool openDevice();
+    // 实时模式下应阻塞到设备能接收数据为止，播放节拍由这里决定
+    virtual void writeDevice(const int16_t* samples, int frames);
+    virtual void closeDevice();
+    // 设备中尚未播放的帧数，未知时返回 -1 (不计入输出延迟)
+    virtual int deviceDelayFrames();
+    // 丢弃设备中排队的音频，只保留最早的 keepFrames 帧；返回丢弃的帧数 (从队尾算起)
+    virtual int discardDeviceFrames(int keepFrames);
+    // 丢弃后设备未在播放时立即启动 (可能补入静音)，返回补入的静音帧数
+    virtual int startDevice();
+    // 硬件音量，设备不支持时返回 false，改用软件音量
+    virtual bool setDeviceVolume(int volume);
+    // false 时只写真实音频，缓冲为空时不补静音 (离线录制、基准测试)
+    virtual bool isRealtime() const;
+    // 推送一块 (10ms) 回声参考: 设备采样率、回调声道数，playoutUs 为其首个采样的播出时刻 (steady 时钟)
+    // 在到达播出时刻时调用，默认推送给 SDK
+    virtual int pushReference(const int16_t* samples, int frames, int64_t playoutUs);
+    bool isLocalInput() const { return m_localInput; }
 
 private:
+    // 播放线程的输入，按混音方式取自抖动缓冲或分流混音
+    int popInput(int16_t* samples, int frames);
+    int flushInput();
+    int inputDepthFrames() const;
+    int inputTargetFrames() const;
+    bool isInputPlaying() const;
+
     bytertc::IRTCEngine* m_rtcEngine = nullptr;
+    AlsaPlaybackDevice* m_device = nullptr;  // 仅在播放线程中访问
+    AlsaPlaybackDevice::Config m_deviceConfig;
     std::atomic<bool> m_running{false};
     std::atomic<int> m_volume{100};  // 0-100
     std::atomic<bool> m_muted{false};
-    QMutex m_mutex;
-    QQueue<QByteArray> m_audioQueue;
-    static const int MAX_QUEUE_SIZE = 50;  // 最大缓冲 500ms
+    int m_preferredRate = 0;
+    int m_preferredChannels = 0;
+    PcmFormat m_callbackFormat;
+    PcmFormat m_deviceFormat;
+    JitterBuffer m_jitterBuffer;  // SDK 回调线程写，播放线程读，格式与回调一致
+    MixMode m_mixMode = MixSdk;
+    int m_maxStreams = 4;
+    QString m_priorityUser;
+    RemoteStreamMixer m_streamMixer;  // 分流模式下代替 m_jitterBuffer
+    int m_jitterMinMs = 40;
+    int m_jitterMaxMs = 200;
+    std::atomic<double> m_driftPpm{0.0};
+    std::atomic<int> m_outputLatencyUs{0};
+    std::atomic<int64_t> m_interruptRequestUs{0};  // 0 表示没有待处理的打断
+    std::atomic<int> m_interruptLatencyUs{-1};
+    PlaybackMonitor* m_playbackMonitor = nullptr;
+    std::atomic<int> m_duckLevel{20};
+    AudioLevelMeter* m_levelMeter = nullptr;
+    TurnLatencyTracker* m_turnTracker = nullptr;
+    bool m_aecReference = false;
+    bool m_localInput = false;
+    std::atomic<int> m_aecReferenceDelayUs{-1};
+    ThreadPolicyConfig m_threadPolicy;
 };
@@ -1,9 +1,26 @@
 #include "ExternalAudioSource.h"
+#include "AllocAudit.h"
+#include "DriftEstimator.h"
+#include "FractionalResampler.h"
+#include "AudioDsp.h"
+#include "AudioLevelMeter.h"
+#include "AudioRingBuffer.h"
+#include "KeywordSpotter.h"
+#include "PlaybackMonitor.h"
+#include "TraceRecorder.h"
+#include "MetricsRegistry.h"
+#include "ProcStats.h"
+#include "TurnLatencyTracker.h"
 #include <QDebug>
+#include <QMutexLocker>
 #include <QProcess>
 #include <chrono>
 #include <cstring>
 #include <thread>
+#include <vector>
+
+static const int ECHO_WINDOW_MS = 300;      // 播放写入声卡到麦克风拾取的最大间隔
+static const int DUCK_HOLD_MS = 400;        // 最后一帧语音之后继续闪避的时长
 
 ExternalAudioSource::ExternalAudioSource(QObject* parent)
     : QThread(parent) {
@@ -11,12 +28,19 @@ ExternalAudioSource::ExternalAudioSource(QObject* parent)
 
 ExternalAudioSource::~ExternalAudioSource() {
     stopCapture();
+    delete m_keywordSpotter;
 }
 
 void ExternalAudioSource::setRTCEngine(bytertc::IRTCEngine* engine) {
+    // 采集线程推送时持有同一把锁，返回后旧引擎不会再被访问，可以安全销毁
+    QMutexLocker locker(&m_mutex);
     m_rtcEngine = engine;
 }
 
+void ExternalAudioSource::setThreadPolicy(const ThreadPolicyConfig& policy) {
+    m_threadPolicy = policy;
+}
+
 void ExternalAudioSource::startCapture() {
     if (m_running) {
         return;
@@ -44,17 +68,69 @@ int ExternalAudioSource::getVolume() const {
     return m_volume;
 }
 
-void ExternalAudioSource::run() {
-    qDebug() << "ExternalAudioSource: starting audio capture...";
-    
-    if (!m_rtcEngine) {
-        qDebug() << "ExternalAudioSource: RTC engine is null";
+double ExternalAudioSource::driftPpm() const {
+    return m_driftPpm.load(std::memory_order_relaxed);
+}
+
+void ExternalAudioSource::setPrerollDuration(int ms) {
+    m_prerollMs = qMax(0, ms);
+}
+
+void ExternalAudioSource::setPushEnabled(bool enabled) {
+    m_pushEnabled = enabled;
+}
+
+bool ExternalAudioSource::isPushEnabled() const {
+    return m_pushEnabled;
+}
+
+void ExternalAudioSource::flushPreroll(int ms) {
+    // 由采集线程在下一帧执行，补推后打开推送
+    m_flushRequestMs = qMax(0, ms);
+}
+
+void ExternalAudioSource::setKeywordSpotter(KeywordSpotter* spotter) {
+    if (isRunning()) {
+        qDebug() << "ExternalAudioSource: keyword spotter must be set before capture starts";
+        delete spotter;
         return;
     }
+    delete m_keywordSpotter;
+    m_keywordSpotter = spotter;
+}
+
+void ExternalAudioSource::setWakeWordEnabled(bool enabled) {
+    m_wakeWordEnabled = enabled;
+}
+
+bool ExternalAudioSource::isWakeWordEnabled() const {
+    return m_wakeWordEnabled;
+}
+
+int ExternalAudioSource::pushFrame(bytertc::IRTCEngine* engine, int16_t* samples, int sampleCount,
+                                   int64_t timestampUs) {
+    TRACE_SCOPE("audio.capture.pushExternalAudioFrame");
+    bytertc::AudioFrameBuilder builder;
+    builder.sample_rate = bytertc::kAudioSampleRate16000;
+    builder.channel = bytertc::kAudioChannelMono;
+    builder.timestamp_us = timestampUs;
+    builder.data = reinterpret_cast<uint8_t*>(samples);
+    builder.data_size = sampleCount * 2;
+    builder.deep_copy = true;
+    
+    bytertc::IAudioFrame* audioFrame = bytertc::buildAudioFrame(builder);
+    if (!audioFrame) {
+        return -1;
+    }
+    int ret = engine->pushExternalAudioFrame(audioFrame);
+    audioFrame->release();
+    return ret;
+}
 
+bool ExternalAudioSource::openDevice() {
     // 使用 arecord 从 USB 麦克风采集音频
     // 格式: 16000Hz, 单声道, 16-bit signed little-endian
-    QProcess process;
+    m_process = new QProcess();
     QStringList args;
     args << "-D" << "hw:1,0"      // USB 麦克风设备 (Yundea M1066)
          << "-f" << "S16_LE"      // 16-bit signed little-endian
@@ -63,91 +139,380 @@ void ExternalAudioSource::run() {
          << "-t" << "raw"         // 原始 PCM 数据
          << "-q";                 // 静默模式
     
-    process.start("arecord", args);
+    m_process->start("arecord", args);
     
-    if (!process.waitForStarted(5000)) {
+    if (!m_process->waitForStarted(5000)) {
         qDebug() << "ExternalAudioSource: failed to start arecord";
-        return;
+        delete m_process;
+        m_process = nullptr;
+        return false;
     }
     
+    m_deviceSampleRate = 16000;
+    // arecord 是独立进程，CPU/内存不在本进程的线程统计中，登记后由 ProcStats 单独采样
+    ProcStats::registerChildProcess("arecord", m_process->processId());
     qDebug() << "ExternalAudioSource: arecord started";
+    return true;
+}
+
+bool ExternalAudioSource::readDevice(QByteArray& buffer, int timeoutMs) {
+    TRACE_SCOPE("audio.capture.read");
+    if (!m_process || m_process->state() != QProcess::Running) {
+        return false;
+    }
+    // 读入调用方预留的容量，不用 readAllStandardOutput (每次返回新分配的 QByteArray)；
+    // 超出容量的部分留在 QProcess 的缓冲中，下次再读
+    int room = buffer.capacity() - buffer.size();
+    if (room > 0 && (m_process->bytesAvailable() > 0 || m_process->waitForReadyRead(timeoutMs))) {
+        int offset = buffer.size();
+        buffer.resize(offset + room);
+        qint64 got = m_process->read(buffer.data() + offset, room);
+        buffer.resize(offset + static_cast<int>(qMax<qint64>(0, got)));
+    }
+    return true;
+}
 
+void ExternalAudioSource::closeDevice() {
+    if (m_process) {
+        ProcStats::unregisterChildProcess(m_process->processId());
+        m_process->terminate();
+        m_process->waitForFinished(1000);
+        delete m_process;
+        m_process = nullptr;
+    }
+}
+
+bool ExternalAudioSource::isRealtime() const {
+    return true;
+}
+
+void ExternalAudioSource::setPlaybackMonitor(PlaybackMonitor* monitor) {
+    m_playbackMonitor = monitor;
+}
+
+void ExternalAudioSource::setSuspended(bool suspended) {
+    m_suspended = suspended;
+}
+
+bool ExternalAudioSource::isSuspended() const {
+    return m_suspended;
+}
+
+void ExternalAudioSource::setLevelMeter(AudioLevelMeter* meter) {
+    m_levelMeter = meter;
+}
+
+void ExternalAudioSource::setLocalFrameCallback(LocalFrameCallback callback) {
+    m_localFrameCallback = std::move(callback);
+}
+
+void ExternalAudioSource::setTurnTracker(TurnLatencyTracker* tracker) {
+    m_turnTracker = tracker;
+}
+
+void ExternalAudioSource::setBargeInConfig(const BargeInDetector::Config& config) {
+    m_bargeInDetector.setConfig(config);
+}
+
+void ExternalAudioSource::setBargeInEnabled(bool enabled) {
+    m_bargeInEnabled = enabled;
+}
+
+bool ExternalAudioSource::isBargeInEnabled() const {
+    return m_bargeInEnabled;
+}
+
+void ExternalAudioSource::run() {
+    qDebug() << "ExternalAudioSource: starting audio capture...";
+    ThreadPolicy::applyToCurrentThread(m_threadPolicy);
+
+    if (!openDevice()) {
+        qDebug() << "ExternalAudioSource: failed to open capture device";
+        m_running = false;
+        return;
+    }
+    
     // 每 10ms 推送一次音频数据
     // 16000 Hz * 10ms = 160 samples
     // 160 samples * 2 bytes (16-bit) = 320 bytes
     const int sampleRate = 16000;
     const int channels = 1;
     const int samplesPerFrame = sampleRate / 100;  // 160 samples per 10ms
-    const int bytesPerFrame = samplesPerFrame * channels * 2;  // 320 bytes
     
-    QByteArray audioBuffer;
-    audioBuffer.reserve(bytesPerFrame * 4);
+    // 设备采样率与推送采样率不同时 (例如 48kHz 的 WAV 文件)，由重采样器一并转换
+    const int deviceRate = m_deviceSampleRate > 0 ? m_deviceSampleRate : sampleRate;
+    const double baseRatio = deviceRate / static_cast<double>(sampleRate);
+    const bool realtime = isRealtime();
+    
+    // 设备读出的原始字节 (可能在采样中间截断，余下的字节留到下次)
+    QByteArray readBuffer;
+    readBuffer.reserve(deviceRate * channels * 2 / 10);
+    // 待处理积压: 固定 1 秒的环形缓冲，写满时丢弃最旧的采样，地址不变，可以安全地锁定内存
+    AudioRingBuffer backlog(static_cast<size_t>(deviceRate) * channels);
+    bool backlogLocked = m_threadPolicy.lockMemory &&
+                         ThreadPolicy::lockBuffer(backlog.data(), backlog.capacity() * sizeof(int16_t));
+    // 重采样输入 (从积压中取出的连续一段)，为漂移补偿留足余量
+    std::vector<int16_t> inputBuffer(static_cast<size_t>(samplesPerFrame * baseRatio + 1) * 2 * channels);
+    bool inputLocked = m_threadPolicy.lockMemory &&
+                       ThreadPolicy::lockBuffer(inputBuffer.data(), inputBuffer.size() * sizeof(int16_t));
+    
+    // 预录环形缓冲: 未推送 (无引擎或推送关闭) 时保存最近的音频，满时丢弃最旧的帧
+    AudioRingBuffer preroll(static_cast<size_t>(m_prerollMs) * sampleRate / 1000);
+    bool prerollLocked = m_threadPolicy.lockMemory &&
+                         ThreadPolicy::lockBuffer(preroll.data(), preroll.capacity() * sizeof(int16_t));
+    
+    // 重采样输出缓冲，固定一帧大小
+    std::vector<int16_t> frameBuffer(samplesPerFrame * channels);
+    std::vector<int16_t> flushBuffer(samplesPerFrame * channels);
+    bool frameLocked = m_threadPolicy.lockMemory &&
+                       ThreadPolicy::lockBuffer(frameBuffer.data(), frameBuffer.size() * sizeof(int16_t));
+    
+    // 麦克风时钟与推送节拍 (系统时钟) 之间的漂移补偿:
+    // 以 arecord 管道积压量作为水位，微调每帧消耗的输入采样数
+    const auto framePeriod = std::chrono::microseconds(samplesPerFrame * 1000000 / sampleRate);
+    DriftEstimator drift(deviceRate, samplesPerFrame / static_cast<double>(sampleRate));
+    FractionalResampler resampler(channels);
+    resampler.setRatio(baseRatio);
+    m_driftPpm = 0.0;
+    
+    DeadlineMonitor deadline(m_threadPolicy.name.isEmpty() ? "audio-in" : m_threadPolicy.name,
+                             samplesPerFrame * 1000000 / sampleRate);
+    // 指标在线程启动时登记一次，循环中只做原子累加
+    MetricCounter* framesMetric = MetricsRegistry::instance()->counter(
+        "audio_capture_frames", "10 ms frames captured and processed");
+    MetricCounter* pushErrorsMetric = MetricsRegistry::instance()->counter(
+        "audio_push_errors", "pushExternalAudioFrame failures");
+    
+    KeywordSpotter* spotter = (m_keywordSpotter && m_keywordSpotter->isLoaded()) ? m_keywordSpotter : nullptr;
+    bool spotting = false;
+    float volumeGain = 1.0f;
+    bool suspended = false;
+    size_t suspendBacklog = 0;
     
     int frameCount = 0;
-    auto startTime = std::chrono::steady_clock::now();
-    auto lastPushTime = startTime;
+    int pushedCount = 0;
+    auto nextPushTime = std::chrono::steady_clock::now();
 
-    while (m_running && process.state() == QProcess::Running) {
+    while (m_running) {
         // 读取音频数据
-        if (process.waitForReadyRead(5)) {
-            audioBuffer.append(process.readAllStandardOutput());
+        if (!readDevice(readBuffer, 5)) {
+            qDebug() << "ExternalAudioSource: capture device ended";
+            m_running = false;
+            break;
+        }
+        int readSamples = readBuffer.size() / 2;
+        if (readSamples > 0) {
+            if (backlog.space() < static_cast<size_t>(readSamples)) {
+                backlog.discard(readSamples - backlog.space());
+            }
+            backlog.write(reinterpret_cast<const int16_t*>(readBuffer.constData()), readSamples);
+            readBuffer.remove(0, readSamples * 2);
+        }
+        
+        // 挂起: 继续读空设备，只保留挂起时的积压量，恢复后从最新的音频开始处理，
+        // 推送节拍和漂移补偿的水位都不受影响
+        if (m_suspended.load(std::memory_order_relaxed)) {
+            if (!suspended) {
+                suspended = true;
+                suspendBacklog = backlog.available();
+                preroll.discard(preroll.available());
+                AllocAudit::ScopedAllow allow;
+                qDebug() << "ExternalAudioSource: suspended";
+            }
+            if (backlog.available() > suspendBacklog) {
+                backlog.discard(backlog.available() - suspendBacklog);
+            }
+            if (!realtime) {
+                std::this_thread::sleep_for(framePeriod);
+            }
+            continue;
+        }
+        if (suspended) {
+            suspended = false;
+            spotting = false;
+            m_bargeInDetector.reset();
+            nextPushTime = std::chrono::steady_clock::now();
+            deadline.reset();
+            AllocAudit::ScopedAllow allow;
+            qDebug() << "ExternalAudioSource: resumed";
         }
         
         // 检查是否有足够的数据推送一帧
-        while (audioBuffer.size() >= bytesPerFrame && m_running) {
-            // 计算时间戳
+        int inputFrames = resampler.inputFramesFor(samplesPerFrame);
+        while (backlog.available() >= static_cast<size_t>(inputFrames * channels) && m_running) {
+            TRACE_SCOPE("audio.capture.frame");
+            // 计算时间戳: 实时模式取这一帧首个采样的采集时刻 (steady 时钟，扣除尚未处理的积压)，
+            // 与播放端推送的回声参考信号使用同一时间基准；非实时模式按帧数推算，保证回放结果可重复
             auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - startTime);
+            int64_t backlogUs = static_cast<int64_t>(backlog.available() / channels) * 1000000 / deviceRate;
+            int64_t timestampUs = realtime
+                ? std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count() - backlogUs
+                : (framePeriod * frameCount).count();
             
-            // 应用音量调节
-            int volume = m_volume.load();
-            if (volume != 100) {
-                int16_t* samples = reinterpret_cast<int16_t*>(audioBuffer.data());
-                int sampleCount = bytesPerFrame / 2;
-                for (int i = 0; i < sampleCount; i++) {
-                    int32_t sample = samples[i] * volume / 100;
-                    // 防止溢出
-                    if (sample > 32767) sample = 32767;
-                    if (sample < -32768) sample = -32768;
-                    samples[i] = static_cast<int16_t>(sample);
+            backlog.read(inputBuffer.data(), inputFrames * channels);
+            resampler.process(inputBuffer.data(), inputFrames,
+                              frameBuffer.data(), samplesPerFrame);
+            
+            if (realtime) {
+                drift.update(backlog.available() / channels);
+                resampler.setRatio(baseRatio * drift.ratio());
+                m_driftPpm.store(drift.driftPpm(), std::memory_order_relaxed);
+            }
+            
+            // 唤醒词检测使用音量调节前的信号；重新开启时清空旧的特征上下文
+            if (spotter) {
+                bool enabled = m_wakeWordEnabled.load(std::memory_order_relaxed);
+                if (enabled && !spotting) {
+                    spotter->reset();
+                }
+                spotting = enabled;
+                if (spotting && spotter->process(frameBuffer.data(), samplesPerFrame)) {
+                    // 日志和队列连接的信号都会分配内存，只在检测到时发生
+                    AllocAudit::ScopedAllow allow;
+                    qDebug() << "ExternalAudioSource: wake word detected, score" << spotter->lastScore();
+                    emit wakeWordDetected(spotter->lastScore());
+                }
+            }
+            
+            // 本帧电平只测一次: 插话检测用音量调节前的电平，音量为 1 时电平表直接复用
+            AudioDsp::Level level;
+            bool measured = false;
+            
+            // 本地插话检测，同样使用音量调节前的信号；回声时间窗覆盖声卡缓冲和声学路径
+            // 轮次延迟统计复用同一个语音检测器，只取语音结束时刻
+            bool bargeIn = m_playbackMonitor && m_bargeInEnabled.load(std::memory_order_relaxed);
+            if (bargeIn || m_turnTracker) {
+                int farPeak = m_playbackMonitor ? m_playbackMonitor->recentPeak(ECHO_WINDOW_MS) : 0;
+                level = AudioDsp::measure(frameBuffer.data(), samplesPerFrame);
+                measured = true;
+                bool onset = m_bargeInDetector.process(level, farPeak);
+                if (m_turnTracker && m_bargeInDetector.speechEnded()) {
+                    // 与消息时间戳同为 steady 时钟；非实时模式的帧时间戳是推算值，改用当前时刻
+                    int64_t frameEndUs = realtime ? timestampUs + framePeriod.count() : TurnLatencyTracker::nowUs();
+                    m_turnTracker->markSpeechEnd(frameEndUs - BargeInDetector::hangoverMs() * 1000);
+                }
+                if (bargeIn && m_bargeInDetector.inSpeech() && m_playbackMonitor->isActive(ECHO_WINDOW_MS)) {
+                    // 说话期间持续请求闪避，停止说话后保持时间结束播放端自动恢复
+                    m_playbackMonitor->requestDuck(DUCK_HOLD_MS);
+                    if (onset) {
+                        AllocAudit::ScopedAllow allow;
+                        qDebug() << "ExternalAudioSource: barge-in detected in" << m_bargeInDetector.decisionMs()
+                                 << "ms, echo coupling" << m_bargeInDetector.echoCouplingDb() << "dB";
+                        emit bargeInDetected(m_bargeInDetector.decisionMs());
+                    }
+                }
+            }
+            
+            // 应用音量调节，音量变化在一帧内线性过渡，避免咔哒声；有电平表时同一次遍历测量输出电平
+            float volumeTarget = m_volume.load() / 100.0f;
+            if (volumeTarget != 1.0f || volumeGain != 1.0f) {
+                if (m_levelMeter) {
+                    level = AudioDsp::applyGainRampMeasured(frameBuffer.data(), samplesPerFrame, channels,
+                                                            volumeGain, volumeTarget);
+                    measured = true;
+                } else {
+                    AudioDsp::applyGainRamp(frameBuffer.data(), samplesPerFrame, channels, volumeGain, volumeTarget);
                 }
+                volumeGain = volumeTarget;
+            }
+            if (m_levelMeter) {
+                if (!measured) {
+                    level = AudioDsp::measure(frameBuffer.data(), samplesPerFrame);
+                }
+                m_levelMeter->publish(level);
             }
             
-            // 构建音频帧
-            bytertc::AudioFrameBuilder builder;
-            builder.sample_rate = bytertc::kAudioSampleRate16000;
-            builder.channel = bytertc::kAudioChannelMono;
-            builder.timestamp_us = elapsed.count();
-            builder.data = reinterpret_cast<uint8_t*>(audioBuffer.data());
-            builder.data_size = bytesPerFrame;
-            builder.deep_copy = true;
+            if (m_localFrameCallback) {
+                m_localFrameCallback(frameBuffer.data(), samplesPerFrame, timestampUs);
+            }
             
-            bytertc::IAudioFrame* audioFrame = bytertc::buildAudioFrame(builder);
-            if (audioFrame) {
-                int ret = m_rtcEngine->pushExternalAudioFrame(audioFrame);
-                audioFrame->release();
+            {
+                QMutexLocker locker(&m_mutex);
+                bytertc::IRTCEngine* engine = m_rtcEngine;
+                // 没有引擎时保留补推请求，等引擎就绪后执行
+                int flushMs = engine ? m_flushRequestMs.exchange(-1) : -1;
+                if (flushMs >= 0) {
+                    m_pushEnabled = true;
+                }
                 
-                frameCount++;
-                if (frameCount % 100 == 0) {  // 每秒打印一次
-                    qDebug() << "ExternalAudioSource: pushed audio frame" << frameCount << "ret:" << ret;
+                if (engine && m_pushEnabled) {
+                    // 先补推预录中最近 flushMs 的音频，时间戳按 10ms 向前回溯
+                    if (flushMs > 0 && preroll.available() > 0) {
+                        size_t keep = static_cast<size_t>(flushMs) * sampleRate / 1000;
+                        keep -= keep % samplesPerFrame;
+                        if (preroll.available() > keep) {
+                            preroll.discard(preroll.available() - keep);
+                        }
+                        int flushFrames = static_cast<int>(preroll.available() / samplesPerFrame);
+                        for (int i = flushFrames; i > 0; i--) {
+                            preroll.read(flushBuffer.data(), samplesPerFrame);
+                            pushFrame(engine, flushBuffer.data(), samplesPerFrame,
+                                      timestampUs - static_cast<int64_t>(i) * framePeriod.count());
+                        }
+                        AllocAudit::ScopedAllow allow;
+                        qDebug() << "ExternalAudioSource: flushed" << flushFrames * 10 << "ms of pre-roll";
+                    }
+                    preroll.discard(preroll.available());
+                    
+                    int ret = pushFrame(engine, frameBuffer.data(), samplesPerFrame, timestampUs);
+                    if (ret != 0) {
+                        pushErrorsMetric->add();
+                    }
+                    pushedCount++;
+                    if (pushedCount % 100 == 0) {  // 每秒打印一次
+                        AllocAudit::ScopedAllow allow;
+                        qDebug() << "ExternalAudioSource: pushed audio frame" << pushedCount << "ret:" << ret;
+                    }
+                } else {
+                    if (preroll.space() < static_cast<size_t>(samplesPerFrame)) {
+                        preroll.discard(samplesPerFrame);
+                    }
+                    preroll.write(frameBuffer.data(), samplesPerFrame);
                 }
             }
             
-            // 移除已处理的数据
-            audioBuffer.remove(0, bytesPerFrame);
+            framesMetric->add();
+            frameCount++;
+            if (frameCount % 6000 == 0) {  // 每分钟打印一次漂移
+                AllocAudit::ScopedAllow allow;
+                qDebug() << "ExternalAudioSource: drift" << drift.driftPpm() << "ppm, backlog"
+                         << drift.filteredLevel() << "/" << drift.targetLevel() << "frames";
+            }
             
-            // 控制推送速率，每 10ms 推送一帧
-            auto targetTime = lastPushTime + std::chrono::milliseconds(10);
-            now = std::chrono::steady_clock::now();
-            if (now < targetTime) {
-                std::this_thread::sleep_until(targetTime);
+            // 按固定节拍推送，每 10ms 一帧；节拍基于绝对时间，不随处理耗时累积
+            if (realtime) {
+                nextPushTime += framePeriod;
+                now = std::chrono::steady_clock::now();
+                if (now < nextPushTime) {
+                    std::this_thread::sleep_until(nextPushTime);
+                } else if (now - nextPushTime > framePeriod * 10) {
+                    // 长时间停顿后重新对齐，不补发
+                    nextPushTime = now;
+                }
+                deadline.tick();
             }
-            lastPushTime = std::chrono::steady_clock::now();
+            
+            inputFrames = resampler.inputFramesFor(samplesPerFrame);
         }
     }
     
-    process.terminate();
-    process.waitForFinished(1000);
+    if (prerollLocked) {
+        ThreadPolicy::unlockBuffer(preroll.data(), preroll.capacity() * sizeof(int16_t));
+    }
+    if (frameLocked) {
+        ThreadPolicy::unlockBuffer(frameBuffer.data(), frameBuffer.size() * sizeof(int16_t));
+    }
+    if (backlogLocked) {
+        ThreadPolicy::unlockBuffer(backlog.data(), backlog.capacity() * sizeof(int16_t));
+    }
+    if (inputLocked) {
+        ThreadPolicy::unlockBuffer(inputBuffer.data(), inputBuffer.size() * sizeof(int16_t));
+    }
+    
+    closeDevice();
     
-    qDebug() << "ExternalAudioSource: capture stopped, total frames:" << frameCount;
+    qDebug() << "ExternalAudioSource: capture stopped, total frames:" << frameCount
+             << "pushed:" << pushedCount
+             << "missed deadlines:" << deadline.missed()
+             << "drift ppm:" << drift.driftPpm();
 }
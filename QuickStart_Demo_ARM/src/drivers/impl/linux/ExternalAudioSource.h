@@ -2,26 +2,56 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QByteArray>
 #include <atomic>
+#include <functional>
 #include "bytertc_engine.h"
 #include "rtc/bytertc_audio_frame.h"
 #include "drivers/interfaces/IAudioSource.h"
+#include "ThreadPolicy.h"
+#include "BargeInDetector.h"
+
+class QProcess;
+class KeywordSpotter;
+class PlaybackMonitor;
+class AudioLevelMeter;
+class TurnLatencyTracker;
 
 /**
  * 外部音频源
  * 使用 ALSA 直接采集音频并推送给 RTC SDK
  * 解决树莓派上 SDK 无法枚举音频设备的问题
  * 
+ * 采集可以在没有引擎时提前启动 (预热)，此时和推送关闭时一样，
+ * 音频写入预录环形缓冲；flushPreroll() 把最近一段补推给 SDK 后恢复实时推送
+ * 
+ * 设置唤醒词检测器后，可在采集线程上逐帧检测唤醒词 (待机模式)
+ * 
+ * 设置播放监视器后，AI 播放期间逐帧做回声感知的语音检测，
+ * 用户插话时立即请求播放端闪避，并发出 bargeInDetected
+ * 
+ * 设置电平表后每帧发布发送音频的峰值和 RMS (与音量调节同一次遍历)
+ * 
+ * 设置轮次延迟统计后，同一个语音检测器的语音结束时刻作为每轮 AI 响应计时的起点
+ * 
+ * 挂起 (麦克风静音) 时设备保持打开，只读空不处理，也不写入预录；恢复后下一帧即开始推送
+ * 
  * 实现 IAudioSource 接口
  */
 class ExternalAudioSource : public QThread, public IAudioSource {
     Q_OBJECT
 
 public:
+    // 本地回环: samples 为 16kHz 单声道，只在回调期间有效
+    using LocalFrameCallback = std::function<void(const int16_t* samples, int count, int64_t timestampUs)>;
+
     ExternalAudioSource(QObject* parent = nullptr);
     ~ExternalAudioSource() override;
 
+    // 线程安全，可以在采集过程中切换或置空
     void setRTCEngine(bytertc::IRTCEngine* engine);
+    // 线程调度策略，需在 startCapture 之前设置
+    void setThreadPolicy(const ThreadPolicyConfig& policy);
     
     // IAudioSource 接口实现
     void startCapture() override;
@@ -29,13 +59,84 @@ public:
     bool isCapturing() const override;
     void setVolume(int volume) override;
     int getVolume() const override;
+    
+    // 麦克风时钟相对推送节拍的漂移估计 (ppm)
+    double driftPpm() const;
+    
+    // 预录缓冲时长，需在 startCapture 之前设置
+    void setPrerollDuration(int ms);
+    // 关闭推送时只采集到预录缓冲
+    void setPushEnabled(bool enabled);
+    // 挂起/恢复处理 (线程安全)，挂起时清空预录，静音期间的音频不会被补推
+    void setSuspended(bool suspended);
+    bool isSuspended() const;
+    bool isPushEnabled() const;
+    // 补推预录中最近 ms 毫秒尚未推送的音频，然后打开推送
+    void flushPreroll(int ms);
+    
+    // 唤醒词检测器，需在 startCapture 之前设置，所有权转移给本对象
+    void setKeywordSpotter(KeywordSpotter* spotter);
+    bool hasKeywordSpotter() const { return m_keywordSpotter != nullptr; }
+    // 线程安全，仅在开启时运行检测
+    void setWakeWordEnabled(bool enabled);
+    bool isWakeWordEnabled() const;
+    
+    // 本地插话检测，需在 startCapture 之前设置；monitor 由调用方持有
+    void setPlaybackMonitor(PlaybackMonitor* monitor);
+    void setBargeInConfig(const BargeInDetector::Config& config);
+    // 线程安全
+    void setBargeInEnabled(bool enabled);
+    bool isBargeInEnabled() const;
+    
+    // 发送音频 (音量调节后) 的电平表，由调用方持有，需在 startCapture 之前设置
+    void setLevelMeter(AudioLevelMeter* meter);
+    // 每帧 (音量调节后) 在采集线程中回调，与是否推送给 SDK 无关，需在 startCapture 之前设置
+    void setLocalFrameCallback(LocalFrameCallback callback);
+    // 对话轮次延迟统计 (用户语音结束打点)，由调用方持有，需在 startCapture 之前设置
+    void setTurnTracker(TurnLatencyTracker* tracker);
+
+signals:
+    // 在采集线程中发出，连接时使用队列连接
+    void wakeWordDetected(float score);
+    // decisionMs: 从用户开口到判定插话的时长
+    void bargeInDetected(int decisionMs);
 
 protected:
     void run() override;
+    
+    // 设备钩子，均在采集线程中调用；子类可以替换为其他输入 (例如文件)
+    // 设备输出单声道 S16_LE，采样率写入 m_deviceSampleRate
+    virtual bool openDevice();
+    // 把可读数据追加到 buffer，不超过其预留容量 (capacity，实时线程中不分配内存)，最多等待 timeoutMs；
+    // 设备结束时返回 false
+    virtual bool readDevice(QByteArray& buffer, int timeoutMs);
+    virtual void closeDevice();
+    // false 时不按 10ms 节拍等待，尽快推送 (离线回放、基准测试)
+    virtual bool isRealtime() const;
+    
+    int m_deviceSampleRate = 16000;
 
 private:
+    // 调用方需持有 m_mutex
+    int pushFrame(bytertc::IRTCEngine* engine, int16_t* samples, int sampleCount, int64_t timestampUs);
+
     bytertc::IRTCEngine* m_rtcEngine = nullptr;
+    QProcess* m_process = nullptr;  // arecord，仅在采集线程中访问
     std::atomic<bool> m_running{false};
     std::atomic<int> m_volume{100};  // 0-100
-    QMutex m_mutex;
+    std::atomic<double> m_driftPpm{0.0};
+    QMutex m_mutex;  // 保护 m_rtcEngine
+    int m_prerollMs = 3000;
+    std::atomic<bool> m_pushEnabled{true};
+    std::atomic<bool> m_suspended{false};
+    std::atomic<int> m_flushRequestMs{-1};
+    KeywordSpotter* m_keywordSpotter = nullptr;  // 仅在采集线程中访问
+    std::atomic<bool> m_wakeWordEnabled{false};
+    PlaybackMonitor* m_playbackMonitor = nullptr;
+    BargeInDetector m_bargeInDetector;  // 仅在采集线程中访问
+    std::atomic<bool> m_bargeInEnabled{false};
+    AudioLevelMeter* m_levelMeter = nullptr;
+    LocalFrameCallback m_localFrameCallback;
+    TurnLatencyTracker* m_turnTracker = nullptr;
+    ThreadPolicyConfig m_threadPolicy;
 };
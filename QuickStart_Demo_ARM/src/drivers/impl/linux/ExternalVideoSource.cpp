@@ -1,9 +1,13 @@
 #include "ExternalVideoSource.h"
+#include "FrameStamp.h"
+#include "TraceRecorder.h"
+#include "MetricsRegistry.h"
 #include <QDebug>
 #include <QProcess>
 #include <QRegularExpression>
 #include <chrono>
 #include <cstring>
+#include <vector>
 
 // 静态成员初始化
 bool ExternalVideoSource::s_gstInitialized = false;
@@ -33,6 +37,34 @@ void ExternalVideoSource::setRTCEngine(bytertc::IRTCEngine* engine) {
     m_rtcEngine = engine;
 }
 
+void ExternalVideoSource::setThreadPolicy(const ThreadPolicyConfig& policy) {
+    m_threadPolicy = policy;
+}
+
+void ExternalVideoSource::setLocalFrameCallback(LocalFrameCallback callback) {
+    m_localFrameCallback = std::move(callback);
+}
+
+void ExternalVideoSource::setFrameStamping(bool enabled) {
+    m_frameStamping = enabled;
+}
+
+void ExternalVideoSource::setCaptureFormat(int width, int height, int frameRate) {
+    // I420 的色度平面按 2x2 下采样，宽高取偶数
+    m_width = qMax(2, width & ~1);
+    m_height = qMax(2, height & ~1);
+    m_frameRate = qBound(1, frameRate, 60);
+}
+
+CameraInfo ExternalVideoSource::testPatternCamera() {
+    CameraInfo pattern;
+    pattern.id = "PATTERN";
+    pattern.name = "测试图案";
+    pattern.type = "PATTERN";
+    pattern.deviceIndex = -1;
+    return pattern;
+}
+
 void ExternalVideoSource::startCapture() {
     if (m_running) {
         return;
@@ -43,6 +75,10 @@ void ExternalVideoSource::startCapture() {
 
 void ExternalVideoSource::stopCapture() {
     m_running = false;
+    {
+        QMutexLocker locker(&m_suspendMutex);
+        m_resumed.wakeAll();
+    }
     
     // 停止 GStreamer pipeline
     if (m_pipeline) {
@@ -60,6 +96,33 @@ bool ExternalVideoSource::isCapturing() const {
     return m_running;
 }
 
+void ExternalVideoSource::setSuspended(bool suspended) {
+    QMutexLocker locker(&m_suspendMutex);
+    m_suspended = suspended;
+    m_resumed.wakeAll();
+}
+
+bool ExternalVideoSource::isSuspended() const {
+    return m_suspended;
+}
+
+bool ExternalVideoSource::applySuspended(bool suspended) {
+    // 实时源在 PAUSED 下不产生数据，但摄像头和协商好的格式保持不变
+    GstStateChangeReturn ret = gst_element_set_state(m_pipeline, suspended ? GST_STATE_PAUSED : GST_STATE_PLAYING);
+    if (ret == GST_STATE_CHANGE_FAILURE) {
+        qDebug() << "ExternalVideoSource: failed to" << (suspended ? "pause" : "resume") << "pipeline";
+        return false;
+    }
+    if (suspended) {
+        // 丢弃挂起前残留的帧，恢复后第一帧是新画面
+        while (GstSample* stale = gst_app_sink_try_pull_sample(GST_APP_SINK(m_appsink), 0)) {
+            gst_sample_unref(stale);
+        }
+    }
+    qDebug() << "ExternalVideoSource:" << (suspended ? "suspended" : "resumed");
+    return true;
+}
+
 void ExternalVideoSource::setCamera(const CameraInfo& camera) {
     QMutexLocker locker(&m_mutex);
     m_currentCamera = camera;
@@ -168,30 +231,39 @@ QList<CameraInfo> ExternalVideoSource::detectCameras() {
 QString ExternalVideoSource::buildPipelineString() {
     QString pipeline;
     
-    if (m_currentCamera.type == "USB") {
+    if (m_currentCamera.type == "PATTERN") {
+        // 合成图案源，按实时节拍产生帧，采集端没有摄像头曝光和 ISP 延迟
+        pipeline = QString(
+            "videotestsrc is-live=true pattern=ball ! "
+            "video/x-raw,width=%1,height=%2,framerate=%3/1 ! "
+            "videoconvert ! "
+            "video/x-raw,format=I420 ! "
+            "appsink name=sink emit-signals=true sync=false max-buffers=2 drop=true"
+        ).arg(m_width).arg(m_height).arg(m_frameRate);
+    } else if (m_currentCamera.type == "USB") {
         // USB 摄像头使用 v4l2src
         // 不指定严格的 framerate，让 v4l2src 自动选择
         // 使用 videorate 转换到目标帧率
         pipeline = QString(
             "v4l2src device=/dev/video%1 ! "
-            "video/x-raw,width=640,height=480 ! "
-            "videorate ! video/x-raw,framerate=15/1 ! "
+            "video/x-raw,width=%2,height=%3 ! "
+            "videorate ! video/x-raw,framerate=%4/1 ! "
             "videoconvert ! "
             "video/x-raw,format=I420 ! "
             "appsink name=sink emit-signals=true sync=false max-buffers=2 drop=true"
-        ).arg(m_currentCamera.deviceIndex);
+        ).arg(m_currentCamera.deviceIndex).arg(m_width).arg(m_height).arg(m_frameRate);
     } else {
         // CSI 摄像头使用 libcamerasrc
         // libcamerasrc 默认输出较大分辨率，需要 videoscale 缩放
         pipeline = QString(
             "libcamerasrc ! "
             "videoconvert ! "
-            "videoscale ! video/x-raw,width=640,height=480 ! "
-            "videorate ! video/x-raw,framerate=15/1 ! "
+            "videoscale ! video/x-raw,width=%1,height=%2 ! "
+            "videorate ! video/x-raw,framerate=%3/1 ! "
             "videoconvert ! "
             "video/x-raw,format=I420 ! "
             "appsink name=sink emit-signals=true sync=false max-buffers=2 drop=true"
-        );
+        ).arg(m_width).arg(m_height).arg(m_frameRate);
     }
     
     return pipeline;
@@ -254,8 +326,9 @@ void ExternalVideoSource::cleanupGStreamer() {
 
 void ExternalVideoSource::run() {
     qDebug() << "ExternalVideoSource: starting GStreamer capture for" << m_currentCamera.name;
+    ThreadPolicy::applyToCurrentThread(m_threadPolicy);
     
-    if (!m_rtcEngine) {
+    if (!m_rtcEngine && !m_localFrameCallback) {
         qDebug() << "ExternalVideoSource: RTC engine is null";
         emit cameraError("RTC engine is null");
         return;
@@ -265,15 +338,56 @@ void ExternalVideoSource::run() {
         return;
     }
     
-    const int width = 640;
-    const int height = 480;
+    // 管道启动后格式固定，修改采集格式需重启采集线程
+    const int width = m_width;
+    const int height = m_height;
+    const int frameBytes = width * height * 3 / 2;
+    
+    // 延迟测量时 appsink 的缓冲不可写，复制到预分配的缓冲后再写入图案
+    std::vector<uint8_t> stampBuffer(m_frameStamping ? frameBytes : 0);
     
     int frameCount = 0;
     auto startTime = std::chrono::steady_clock::now();
+    // 帧间隔与管道中的 framerate 一致
+    DeadlineMonitor deadline(m_threadPolicy.name.isEmpty() ? "video-capture" : m_threadPolicy.name,
+                             1000000 / m_frameRate);
+    // 指标在线程启动时登记一次，循环中只做原子累加
+    MetricCounter* framesMetric = MetricsRegistry::instance()->counter(
+        "video_capture_frames", "Frames pulled from the capture pipeline");
+    MetricCounter* pushedMetric = MetricsRegistry::instance()->counter(
+        "video_push_frames", "Frames accepted by pushExternalVideoFrame");
+    MetricCounter* pushErrorsMetric = MetricsRegistry::instance()->counter(
+        "video_push_errors", "pushExternalVideoFrame failures");
+    
+    bool paused = false;
     
     while (m_running) {
+        bool suspend = m_suspended.load();
+        if (suspend != paused) {
+            if (!applySuspended(suspend)) {
+                emit cameraError(suspend ? "无法暂停摄像头" : "无法恢复摄像头");
+                break;
+            }
+            paused = suspend;
+            if (!paused) {
+                deadline.reset();
+            }
+        }
+        if (paused) {
+            // 挂起期间不占用 CPU，恢复或停止时立即唤醒
+            QMutexLocker locker(&m_suspendMutex);
+            if (m_suspended && m_running) {
+                m_resumed.wait(&m_suspendMutex);
+            }
+            continue;
+        }
+        
         // 从 appsink 拉取样本
-        GstSample* sample = gst_app_sink_try_pull_sample(GST_APP_SINK(m_appsink), 100 * GST_MSECOND);
+        GstSample* sample = nullptr;
+        {
+            TRACE_SCOPE("video.capture.pull");
+            sample = gst_app_sink_try_pull_sample(GST_APP_SINK(m_appsink), 100 * GST_MSECOND);
+        }
         
         if (!sample) {
             // 检查是否到达 EOS 或出错
@@ -284,6 +398,7 @@ void ExternalVideoSource::run() {
             continue;
         }
         
+        TRACE_SCOPE("video.capture.frame");
         GstBuffer* buffer = gst_sample_get_buffer(sample);
         if (!buffer) {
             gst_sample_unref(sample);
@@ -295,6 +410,12 @@ void ExternalVideoSource::run() {
             gst_sample_unref(sample);
             continue;
         }
+        if (map.size < static_cast<gsize>(frameBytes)) {
+            // caps 与设置的格式不符 (例如摄像头不支持该分辨率)，不把越界数据交给 SDK
+            gst_buffer_unmap(buffer, &map);
+            gst_sample_unref(sample);
+            continue;
+        }
         
         // 计算 I420 帧各平面大小
         const int ySize = width * height;
@@ -313,18 +434,45 @@ void ExternalVideoSource::run() {
         auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - startTime);
         frame.timestamp_us = elapsed.count();
         
+        // 延迟测量: 时间戳为帧从管道取出的时刻 (steady 时钟)
+        uint8_t* data = map.data;
+        if (m_frameStamping) {
+            TRACE_SCOPE("video.capture.stamp");
+            memcpy(stampBuffer.data(), map.data, frameBytes);
+            data = stampBuffer.data();
+            FrameStamp::encode(data, width, data + ySize, data + ySize + uvSize, width / 2, width, height,
+                               std::chrono::duration_cast<std::chrono::microseconds>(
+                                   now.time_since_epoch()).count());
+        }
+        
         // 设置平面数据
         frame.number_of_planes = 3;
-        frame.plane_data[0] = map.data;                    // Y
-        frame.plane_data[1] = map.data + ySize;            // U
-        frame.plane_data[2] = map.data + ySize + uvSize;   // V
+        frame.plane_data[0] = data;                    // Y
+        frame.plane_data[1] = data + ySize;            // U
+        frame.plane_data[2] = data + ySize + uvSize;   // V
         frame.plane_stride[0] = width;
         frame.plane_stride[1] = width / 2;
         frame.plane_stride[2] = width / 2;
         
-        // 推送帧到 SDK
-        int ret = m_rtcEngine->pushExternalVideoFrame(frame);
+        // 推送帧到 SDK；本地回环时交给回调
+        int ret = 0;
+        if (m_rtcEngine) {
+            TRACE_SCOPE("video.capture.pushExternalVideoFrame");
+            ret = m_rtcEngine->pushExternalVideoFrame(frame);
+        }
+        if (m_localFrameCallback) {
+            TRACE_SCOPE("video.capture.localCallback");
+            m_localFrameCallback(frame.plane_data[0], frame.plane_data[1], frame.plane_data[2], width, height,
+                                 std::chrono::duration_cast<std::chrono::microseconds>(
+                                     now.time_since_epoch()).count());
+        }
         
+        framesMetric->add();
+        if (ret != 0) {
+            pushErrorsMetric->add();
+        } else if (m_rtcEngine) {
+            pushedMetric->add();
+        }
         frameCount++;
         if (frameCount % 30 == 0) {
             qDebug() << "ExternalVideoSource: pushed frame" << frameCount 
@@ -333,8 +481,10 @@ void ExternalVideoSource::run() {
         
         gst_buffer_unmap(buffer, &map);
         gst_sample_unref(sample);
+        deadline.tick();
     }
     
     cleanupGStreamer();
-    qDebug() << "ExternalVideoSource: capture stopped, total frames:" << frameCount;
+    qDebug() << "ExternalVideoSource: capture stopped, total frames:" << frameCount
+             << "missed deadlines:" << deadline.missed();
 }
@@ -2,13 +2,16 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QWaitCondition>
 #include <QList>
 #include <QPair>
 #include <atomic>
+#include <functional>
 #include <string>
 #include "bytertc_engine.h"
 #include "rtc/bytertc_video_frame.h"
 #include "drivers/interfaces/IVideoSource.h"
+#include "ThreadPolicy.h"
 
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
@@ -18,24 +21,52 @@
  * 支持 CSI 摄像头 (libcamerasrc) 和 USB 摄像头 (v4l2src)
  * 使用 GStreamer 统一管道架构
  * 
+ * 挂起 (关闭摄像头画面) 时管道切到 PAUSED，摄像头保持打开，采集线程阻塞等待；
+ * 恢复时切回 PLAYING，不需要重新创建管道和初始化摄像头
+ * 
+ * 设置本地帧回调后可以不连接引擎 (本地回环)，采集的帧直接交给回调
+ * 
+ * 延迟测量模式下每帧写入 FrameStamp 时间戳图案 (取出管道的时刻)，可配合测试图案源 (videotestsrc) 使用
+ * 
  * 实现 IVideoSource 接口
  */
 class ExternalVideoSource : public QThread, public IVideoSource {
     Q_OBJECT
 
 public:
+    // 本地回环: I420 平面数据只在回调期间有效，timestampUs 为采集时刻 (steady 时钟)
+    using LocalFrameCallback = std::function<void(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                                                  int width, int height, int64_t timestampUs)>;
+
     ExternalVideoSource(QObject* parent = nullptr);
     ~ExternalVideoSource() override;
 
     void setRTCEngine(bytertc::IRTCEngine* engine);
+    // 线程调度策略，需在 startCapture 之前设置
+    void setThreadPolicy(const ThreadPolicyConfig& policy);
+    // 每帧在采集线程中回调 (有引擎时同时推送)，需在 startCapture 之前设置
+    void setLocalFrameCallback(LocalFrameCallback callback);
+    // 每帧写入时间戳图案 (端到端延迟测量)，需在 startCapture 之前设置
+    void setFrameStamping(bool enabled);
+    // 采集分辨率和帧率，需在 startCapture 之前设置 (采集中修改需重启采集才生效)
+    void setCaptureFormat(int width, int height, int frameRate);
+    int captureWidth() const { return m_width; }
+    int captureHeight() const { return m_height; }
+    int captureFrameRate() const { return m_frameRate; }
     
     // IVideoSource 接口实现
     void startCapture() override;
     void stopCapture() override;
     bool isCapturing() const override;
     
+    // 挂起/恢复推送 (线程安全)，在采集开始前设置时管道启动后立即挂起
+    void setSuspended(bool suspended);
+    bool isSuspended() const;
+    
     // 摄像头管理
     static QList<CameraInfo> detectCamerasStatic();
+    // 合成测试图案源 (不占用摄像头)，用于延迟测量
+    static CameraInfo testPatternCamera();
     QList<CameraInfo> detectCameras() override;
     void setCamera(const CameraInfo& camera) override;
     CameraInfo currentCamera() const override;
@@ -50,11 +81,22 @@ private:
     bool initGStreamer();
     void cleanupGStreamer();
     QString buildPipelineString();
+    // 在采集线程中切换管道状态，挂起时丢弃 appsink 中残留的旧帧
+    bool applySuspended(bool suspended);
     
     bytertc::IRTCEngine* m_rtcEngine = nullptr;
     std::atomic<bool> m_running{false};
+    std::atomic<bool> m_suspended{false};
     QMutex m_mutex;
+    QMutex m_suspendMutex;
+    QWaitCondition m_resumed;  // 挂起期间采集线程在此等待
     CameraInfo m_currentCamera;
+    ThreadPolicyConfig m_threadPolicy;
+    LocalFrameCallback m_localFrameCallback;
+    bool m_frameStamping = false;
+    int m_width = 640;
+    int m_height = 480;
+    int m_frameRate = 15;
     
     // GStreamer
     GstElement* m_pipeline = nullptr;
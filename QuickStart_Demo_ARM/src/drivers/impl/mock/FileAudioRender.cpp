@@ -0,0 +1,196 @@
+#include "FileAudioRender.h"
+#include "Logger.h"
+#include <cstdlib>
+#include <thread>
+
+#define LOG_MODULE "FileAudioRender"
+
+static const int MAX_MISMATCH_LOGS = 5;
+
+static int64_t toUs(std::chrono::steady_clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+}
+
+FileAudioRender::FileAudioRender(const QString& path, bool realtime, QObject* parent)
+    : ExternalAudioRender(parent)
+    , m_path(path)
+    , m_realtime(realtime)
+{
+}
+
+FileAudioRender::~FileAudioRender()
+{
+    // 基类析构时子类已销毁，必须在这里停止线程
+    stopRender();
+}
+
+void FileAudioRender::setSimulatedLatency(int latencyMs)
+{
+    m_latencyMs = qBound(0, latencyMs, 500);
+}
+
+void FileAudioRender::negotiateFormat(PcmFormat& callback, PcmFormat& device)
+{
+    // 没有声卡限制，文件直接保存回调格式，不做任何转换
+    callback.sampleRate = preferredSampleRate() > 0 ? preferredSampleRate() : 16000;
+    callback.channels = preferredChannels() > 0 ? preferredChannels() : 1;
+    device = callback;
+}
+
+bool FileAudioRender::openDevice()
+{
+    m_format.sampleRate = deviceFormat().sampleRate;
+    m_format.channels = deviceFormat().channels;
+
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOG_ERROR(QString("Cannot open %1: %2").arg(m_path, m_file.errorString()));
+        return false;
+    }
+
+    m_dataBytes = 0;
+    m_nextWriteTime = std::chrono::steady_clock::now();
+    m_writtenCount = 0;
+    m_referenceCursor = 0;
+    m_referenceChecked = 0;
+    m_referenceWithdrawn = 0;
+    m_referenceMismatched = 0;
+    m_referenceMaxErrorUs = 0;
+    m_wav = WavFile::isWavPath(m_path);
+    if (m_wav) {
+        WavFile::writeHeader(&m_file, m_format);
+    }
+
+    LOG_INFO(QString("Recording playback to %1 (%2 Hz, %3 ch, %4)")
+             .arg(m_path).arg(m_format.sampleRate).arg(m_format.channels)
+             .arg(m_realtime ? "realtime" : "as fast as possible"));
+    return true;
+}
+
+void FileAudioRender::writeDevice(const int16_t* samples, int frames)
+{
+    qint64 bytes = static_cast<qint64>(frames) * m_format.channels * 2;
+    qint64 written = m_file.write(reinterpret_cast<const char*>(samples), bytes);
+    if (written > 0) {
+        m_dataBytes += written;
+    }
+    
+    if (!m_realtime) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_nextWriteTime > std::chrono::milliseconds(200)) {
+        // 队列空闲后重新对齐，不补写
+        m_nextWriteTime = now;
+    }
+    
+    // 记录这块的模拟播出时刻 (模拟声卡时钟上排在已写入数据之后)
+    WrittenBlock& block = m_written[m_writtenCount % WRITTEN_HISTORY];
+    block.playoutUs = toUs(m_nextWriteTime);
+    block.hash = hashSamples(samples, frames * m_format.channels);
+    block.frames = frames;
+    m_writtenCount++;
+    
+    // 模拟声卡: 按写入的采样数推进节拍，阻塞到这段音频"播完"，有模拟缓冲时提前 latencyMs 返回
+    m_nextWriteTime += std::chrono::microseconds(static_cast<int64_t>(frames) * 1000000 / m_format.sampleRate);
+    auto wakeTime = m_nextWriteTime - std::chrono::milliseconds(m_latencyMs);
+    if (std::chrono::steady_clock::now() < wakeTime) {
+        std::this_thread::sleep_until(wakeTime);
+    }
+}
+
+int FileAudioRender::deviceDelayFrames()
+{
+    if (!m_realtime) {
+        return -1;
+    }
+    // 模拟声卡中尚未"播出"的部分
+    int64_t queuedUs = toUs(m_nextWriteTime) - toUs(std::chrono::steady_clock::now());
+    return static_cast<int>(qMax<int64_t>(0, queuedUs) * m_format.sampleRate / 1000000);
+}
+
+uint32_t FileAudioRender::hashSamples(const int16_t* samples, int count)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < count; i++) {
+        hash = (hash ^ static_cast<uint16_t>(samples[i])) * 16777619u;
+    }
+    return hash;
+}
+
+bool FileAudioRender::matchReference(const WrittenBlock& block, uint32_t hash, int frames, int64_t playoutUs,
+                                     int64_t* errorUs) const
+{
+    // 容差为半块: 对应到相邻块时误差约为一整块，不会误判为对齐
+    int64_t toleranceUs = static_cast<int64_t>(frames) * 1000000 / m_format.sampleRate / 2;
+    *errorUs = std::llabs(playoutUs - block.playoutUs);
+    return block.frames == frames && block.hash == hash && *errorUs <= toleranceUs;
+}
+
+int FileAudioRender::pushReference(const int16_t* samples, int frames, int64_t playoutUs)
+{
+    if (m_realtime && m_latencyMs > 0) {
+        // 参考块按写入顺序推送，逐块对应，不按内容查找 (静音块内容都相同)
+        uint32_t hash = hashSamples(samples, frames * m_format.channels);
+        int64_t oldest = qMax<int64_t>(0, m_writtenCount - WRITTEN_HISTORY);
+        int64_t errorUs = -1;
+        bool aligned = m_referenceCursor >= oldest && m_referenceCursor < m_writtenCount &&
+                       matchReference(m_written[m_referenceCursor % WRITTEN_HISTORY], hash, frames, playoutUs, &errorUs);
+        if (aligned) {
+            m_referenceCursor++;
+            m_referenceChecked++;
+            m_referenceMaxErrorUs = qMax(m_referenceMaxErrorUs, errorUs);
+        } else {
+            int mismatched = ++m_referenceMismatched;
+            if (mismatched <= MAX_MISMATCH_LOGS) {
+                LOG_WARN(QString("AEC reference block %1 misaligned: playout error %2 us (%3 frames, %4 blocks written)")
+                         .arg(m_referenceCursor).arg(errorUs).arg(frames).arg(m_writtenCount));
+            }
+            // 丢块等造成错位时，按播出时刻重新对齐到之后的写入块，避免后续每块都连带失败
+            for (int64_t seq = qMax(oldest, m_referenceCursor); seq < m_writtenCount; seq++) {
+                if (matchReference(m_written[seq % WRITTEN_HISTORY], hash, frames, playoutUs, &errorUs)) {
+                    m_referenceCursor = seq + 1;
+                    break;
+                }
+            }
+        }
+    }
+    // 本地回环没有 SDK，只做校验
+    return isLocalInput() ? 0 : ExternalAudioRender::pushReference(samples, frames, playoutUs);
+}
+
+int FileAudioRender::discardDeviceFrames(int keepFrames)
+{
+    // 没有可撤回的设备缓冲；打断时播放线程清空参考队列，已写入但尚未推送参考的块不会再有参考
+    m_referenceWithdrawn += m_writtenCount - m_referenceCursor;
+    m_referenceCursor = m_writtenCount;
+    return 0;
+}
+
+void FileAudioRender::closeDevice()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    if (m_wav) {
+        WavFile::finalize(&m_file, m_format, m_dataBytes);
+    }
+    m_file.close();
+    LOG_INFO(QString("Recorded %1 ms to %2")
+             .arg(m_dataBytes * 1000 / (m_format.sampleRate * m_format.channels * 2)).arg(m_path));
+    int mismatched = m_referenceMismatched.load();
+    QString summary = QString("AEC reference check: %1 blocks aligned (max error %2 us), %3 misaligned, %4 withdrawn")
+                      .arg(m_referenceChecked).arg(m_referenceMaxErrorUs).arg(mismatched).arg(m_referenceWithdrawn);
+    if (mismatched > 0) {
+        LOG_ERROR(summary);
+    } else if (m_referenceChecked > 0) {
+        LOG_INFO(summary);
+    }
+}
+
+bool FileAudioRender::isRealtime() const
+{
+    return m_realtime;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include "ExternalAudioRender.h"
+#include "WavFile.h"
+
+/**
+ * 文件音频渲染
+ * 把 SDK 播放回调的音频 (S16_LE) 写入 WAV 或裸 PCM 文件，
+ * 走与扬声器相同的队列/重采样/音量链路，用于录下 AI 的回复做离线分析
+ * 文件格式即回调格式，未指定时为 16kHz 单声道
+ *
+ * - 实时模式: 写入按文件采样率的节拍阻塞，与真实声卡一致；
+ *   可模拟声卡缓冲 (写入比播出提前 latencyMs)，并校验推送的回声参考与模拟播出时刻、内容是否一致:
+ *   第 n 个参考块必须对应第 n 个写入块 (打断时撤回的块除外)，内容相同且播出时刻误差不超过半块，
+ *   否则记为未对齐 (需 latencyMs > 0，没有模拟缓冲时参考即刻播出，无从校验)；
+ *   --latency-test 有未对齐时以非零退出码结束
+ * - 非实时模式: 队列有数据就写
+ */
+class FileAudioRender : public ExternalAudioRender {
+    Q_OBJECT
+
+public:
+    FileAudioRender(const QString& path, bool realtime = true, QObject* parent = nullptr);
+    ~FileAudioRender() override;
+
+    QString filePath() const { return m_path; }
+    // 模拟的声卡缓冲深度 (仅实时模式)，需在 startRender 之前设置
+    void setSimulatedLatency(int latencyMs);
+    // 回声参考未对齐的块数 (任意线程)
+    int referenceMismatches() const { return m_referenceMismatched.load(std::memory_order_relaxed); }
+
+protected:
+    void negotiateFormat(PcmFormat& callback, PcmFormat& device) override;
+    bool openDevice() override;
+    void writeDevice(const int16_t* samples, int frames) override;
+    void closeDevice() override;
+    bool isRealtime() const override;
+    int deviceDelayFrames() override;
+    int discardDeviceFrames(int keepFrames) override;
+    int pushReference(const int16_t* samples, int frames, int64_t playoutUs) override;
+
+private:
+    // 最近写入的块 (按写入序号存放): 模拟播出时刻与内容摘要，用于校验回声参考
+    struct WrittenBlock {
+        int64_t playoutUs = 0;
+        uint32_t hash = 0;
+        int frames = 0;
+    };
+    static const int WRITTEN_HISTORY = 64;
+    static uint32_t hashSamples(const int16_t* samples, int count);
+    bool matchReference(const WrittenBlock& block, uint32_t hash, int frames, int64_t playoutUs, int64_t* errorUs) const;
+
+    QString m_path;
+    bool m_realtime;
+    bool m_wav = false;
+    QFile m_file;
+    WavFormat m_format;
+    qint64 m_dataBytes = 0;
+    std::chrono::steady_clock::time_point m_nextWriteTime;
+    int m_latencyMs = 0;
+    WrittenBlock m_written[WRITTEN_HISTORY];
+    int64_t m_writtenCount = 0;
+    int64_t m_referenceCursor = 0;      // 下一个参考块应对应的写入序号
+    int m_referenceChecked = 0;
+    int64_t m_referenceWithdrawn = 0;   // 打断时撤回、不会有参考的写入块
+    std::atomic<int> m_referenceMismatched{0};
+    int64_t m_referenceMaxErrorUs = 0;
+};
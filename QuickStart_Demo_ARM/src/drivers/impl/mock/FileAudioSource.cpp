@@ -0,0 +1,159 @@
+#include "FileAudioSource.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+
+#define LOG_MODULE "FileAudioSource"
+
+// 采集链路推送给 SDK 的采样率
+static const int CAPTURE_RATE = 16000;
+// 抗混叠低通: 8 阶 Butterworth (4 个二阶节)，截止频率为目标奈奎斯特频率的 0.9 倍
+static const int ANTI_ALIAS_SECTIONS = 4;
+static const double ANTI_ALIAS_CUTOFF = 0.45;
+
+FileAudioSource::FileAudioSource(const QString& path, bool realtime, bool loop, QObject* parent)
+    : ExternalAudioSource(parent)
+    , m_path(path)
+    , m_realtime(realtime)
+    , m_loop(loop)
+{
+}
+
+FileAudioSource::~FileAudioSource()
+{
+    // 基类析构时子类已销毁，必须在这里停止线程
+    stopCapture();
+}
+
+bool FileAudioSource::openDevice()
+{
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        LOG_ERROR(QString("Cannot open %1: %2").arg(m_path, m_file.errorString()));
+        return false;
+    }
+
+    m_format = WavFormat();
+    qint64 dataBytes = m_file.size();
+    if (WavFile::isWavPath(m_path)) {
+        if (!WavFile::readHeader(&m_file, m_format, dataBytes)) {
+            LOG_ERROR(QString("Invalid WAV file: %1").arg(m_path));
+            m_file.close();
+            return false;
+        }
+    }
+    m_dataStart = m_file.pos();
+    m_dataEnd = qMin(m_file.size(), m_dataStart + dataBytes);
+    m_deviceSampleRate = m_format.sampleRate;
+    designAntiAlias(m_format.sampleRate, CAPTURE_RATE);
+
+    LOG_INFO(QString("Playing %1: %2 Hz, %3 ch, %4 ms, %5")
+             .arg(m_path).arg(m_format.sampleRate).arg(m_format.channels)
+             .arg((m_dataEnd - m_dataStart) * 1000 / (m_format.sampleRate * m_format.channels * 2))
+             .arg(m_realtime ? "realtime" : "as fast as possible"));
+    return true;
+}
+
+bool FileAudioSource::readDevice(QByteArray& buffer, int timeoutMs)
+{
+    Q_UNUSED(timeoutMs);
+
+    // 每次读取 10ms
+    const int frameBytes = m_format.channels * 2;
+    const int chunkBytes = (m_format.sampleRate / 100) * frameBytes;
+
+    qint64 remaining = m_dataEnd - m_file.pos();
+    if (remaining < frameBytes) {
+        if (!m_loop || !rewind()) {
+            return false;
+        }
+        remaining = m_dataEnd - m_file.pos();
+    }
+
+    m_readBuffer.resize(static_cast<int>(qMin<qint64>(chunkBytes, remaining - remaining % frameBytes)));
+    qint64 got = m_file.read(m_readBuffer.data(), m_readBuffer.size());
+    if (got <= 0) {
+        return false;
+    }
+    int frames = static_cast<int>(got / frameBytes);
+
+    int offset = buffer.size();
+    if (m_format.channels == 1) {
+        buffer.append(m_readBuffer.constData(), frames * 2);
+    } else {
+        // 多声道混为单声道
+        const int16_t* in = reinterpret_cast<const int16_t*>(m_readBuffer.constData());
+        buffer.resize(offset + frames * 2);
+        int16_t* out = reinterpret_cast<int16_t*>(buffer.data() + offset);
+        for (int i = 0; i < frames; i++) {
+            int32_t sum = 0;
+            for (int c = 0; c < m_format.channels; c++) {
+                sum += in[i * m_format.channels + c];
+            }
+            out[i] = static_cast<int16_t>(sum / m_format.channels);
+        }
+    }
+    if (!m_antiAlias.empty()) {
+        applyAntiAlias(reinterpret_cast<int16_t*>(buffer.data() + offset), frames);
+    }
+    return true;
+}
+
+void FileAudioSource::closeDevice()
+{
+    m_file.close();
+}
+
+bool FileAudioSource::isRealtime() const
+{
+    return m_realtime;
+}
+
+void FileAudioSource::designAntiAlias(int inRate, int outRate)
+{
+    m_antiAlias.clear();
+    if (inRate <= outRate) {
+        return;
+    }
+    // 双线性变换 (RBJ 低通)，各节 Q 取 Butterworth 极点角: Q_k = 1 / (2 cos((2k-1)π / 4N))
+    const double pi = 3.14159265358979323846;
+    const double w0 = 2.0 * pi * ANTI_ALIAS_CUTOFF * outRate / inRate;
+    const double cosw = std::cos(w0);
+    const double sinw = std::sin(w0);
+    const int order = ANTI_ALIAS_SECTIONS * 2;
+    for (int k = 1; k <= ANTI_ALIAS_SECTIONS; k++) {
+        double q = 1.0 / (2.0 * std::cos((2 * k - 1) * pi / (2.0 * order)));
+        double alpha = sinw / (2.0 * q);
+        double a0 = 1.0 + alpha;
+        Biquad section;
+        section.b0 = static_cast<float>((1.0 - cosw) / 2.0 / a0);
+        section.b1 = static_cast<float>((1.0 - cosw) / a0);
+        section.b2 = section.b0;
+        section.a1 = static_cast<float>(-2.0 * cosw / a0);
+        section.a2 = static_cast<float>((1.0 - alpha) / a0);
+        m_antiAlias.push_back(section);
+    }
+}
+
+void FileAudioSource::applyAntiAlias(int16_t* samples, int count)
+{
+    for (int i = 0; i < count; i++) {
+        float x = samples[i];
+        for (Biquad& s : m_antiAlias) {
+            float y = s.b0 * x + s.z1;
+            s.z1 = s.b1 * x - s.a1 * y + s.z2;
+            s.z2 = s.b2 * x - s.a2 * y;
+            x = y;
+        }
+        samples[i] = static_cast<int16_t>(std::lrint(std::min(32767.0f, std::max(-32768.0f, x))));
+    }
+}
+
+bool FileAudioSource::rewind()
+{
+    if (m_dataEnd <= m_dataStart) {
+        return false;
+    }
+    LOG_DEBUG("Looping input file");
+    return m_file.seek(m_dataStart);
+}
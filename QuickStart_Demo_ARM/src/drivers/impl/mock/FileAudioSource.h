@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QFile>
+#include <QString>
+#include <vector>
+#include "ExternalAudioSource.h"
+#include "WavFile.h"
+
+/**
+ * 文件音频源
+ * 从 WAV 或裸 PCM (16kHz 单声道 S16_LE) 文件读取音频，走与麦克风相同的推送链路
+ * 用于在没有 USB 麦克风的机器上回放录音，做可重复的延迟/CPU 测试
+ *
+ * - 实时模式: 按 10ms 节拍推送，与真实麦克风一致
+ * - 非实时模式: 尽快推送，时间戳按帧数推算
+ * 多声道 WAV 在读取时混为单声道，采样率不是 16kHz 时由采集链路重采样；
+ * 高于 16kHz 时先经过抗混叠低通 (8 阶 Butterworth)，重采样器本身只做插值
+ */
+class FileAudioSource : public ExternalAudioSource {
+    Q_OBJECT
+
+public:
+    FileAudioSource(const QString& path, bool realtime = true, bool loop = false, QObject* parent = nullptr);
+    ~FileAudioSource() override;
+
+    QString filePath() const { return m_path; }
+
+protected:
+    bool openDevice() override;
+    bool readDevice(QByteArray& buffer, int timeoutMs) override;
+    void closeDevice() override;
+    bool isRealtime() const override;
+
+private:
+    // 直接 II 型转置二阶节
+    struct Biquad {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+        float z1 = 0.0f, z2 = 0.0f;
+    };
+
+    bool rewind();
+    void designAntiAlias(int inRate, int outRate);
+    void applyAntiAlias(int16_t* samples, int count);
+
+    QString m_path;
+    bool m_realtime;
+    bool m_loop;
+    QFile m_file;
+    WavFormat m_format;
+    qint64 m_dataStart = 0;
+    qint64 m_dataEnd = 0;
+    QByteArray m_readBuffer;
+    std::vector<Biquad> m_antiAlias;  // 为空时不滤波
+};
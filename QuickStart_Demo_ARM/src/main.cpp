@@ -1,13 +1,136 @@
 ﻿#include "RoomMainWidget.h"
+#include "LoopbackWidget.h"
+#include "MediaManager.h"
+#include "FileAudioRender.h"
+#include "AudioDsp.h"
+#include "FractionalResampler.h"
+#include "AllocAudit.h"
 #include "ConfigManager.h"
 #include "Logger.h"
+#include "TraceRecorder.h"
+#include "MetricsServer.h"
+#include "ControlRegistry.h"
+#include "ControlServer.h"
+#include "SamplingProfiler.h"
 #include "StyleManager.h"
 #include <QtWidgets/QApplication>
 #include <QScreen>
 #include <QDir>
+#include <QJsonArray>
+#include <QJsonObject>
 
 #define LOG_MODULE "Main"
 
+static const int DEFAULT_LATENCY_TEST_COUNT = 20;
+
+// "--name N" 形式的可选计数参数，缺省或非法时返回 defaultValue
+static int countArgument(const QStringList& args, const QString& name, int defaultValue)
+{
+    int index = args.indexOf(name);
+    if (index < 0 || index + 1 >= args.size()) {
+        return defaultValue;
+    }
+    bool ok = false;
+    int value = args.at(index + 1).toInt(&ok);
+    return ok && value > 0 ? value : defaultValue;
+}
+
+// 进程级的控制命令 (日志级别、热路径追踪、保存配置、分配审计)；媒体和渲染命令由各自的模块注册
+static void registerControlCommands(QObject* context)
+{
+    ControlRegistry* registry = ControlRegistry::instance();
+    
+    registry->registerCommand("log.level", "Log level {level: debug|info|warning|error}", context,
+                              [](const QJsonObject& params, QString* error) {
+        if (params.contains("level")) {
+            Logger::Level level;
+            if (!Logger::levelFromString(params.value("level").toString(), &level)) {
+                *error = "\"level\" must be debug, info, warning or error";
+                return QJsonObject();
+            }
+            Logger::setLevel(level);
+        }
+        return QJsonObject{{"level", Logger::levelName(Logger::level())}};
+    });
+    
+    registry->registerCommand("trace", "Hot path tracing {enabled}; stopping exports trace-<time>.json", context,
+                              [](const QJsonObject& params, QString* error) {
+        QJsonObject result;
+        if (params.contains("enabled")) {
+            if (!params.value("enabled").isBool()) {
+                *error = "\"enabled\" must be true or false";
+                return QJsonObject();
+            }
+            bool enable = params.value("enabled").toBool();
+            bool wasEnabled = TraceRecorder::isEnabled();
+            TraceRecorder::setEnabled(enable);
+            QString dir = ConfigManager::instance()->telemetryReportPath();
+            if (wasEnabled && !enable && !dir.isEmpty()) {
+                result["file"] = TraceRecorder::exportToDir(dir);
+            }
+        }
+        result["enabled"] = TraceRecorder::isEnabled();
+        return result;
+    });
+    
+    registry->registerCommand("config", "Config file {save: true} writes runtime changes back", context,
+                              [](const QJsonObject& params, QString* error) {
+        ConfigManager* config = ConfigManager::instance();
+        if (params.value("save").toBool()) {
+            if (config->configPath().isEmpty() || !config->saveToFile(config->configPath())) {
+                *error = QString("failed to save %1").arg(config->configPath());
+                return QJsonObject();
+            }
+        }
+        return QJsonObject{{"path", config->configPath()}};
+    });
+    
+    registry->registerCommand("alloc.audit", "Heap allocations on realtime threads after warm-up (ALLOC_AUDIT builds)", context,
+                              [](const QJsonObject&, QString*) {
+        QJsonArray threads;
+        for (const AllocAudit::Snapshot& s : AllocAudit::snapshotAll()) {
+            threads.append(QJsonObject{{"thread", s.thread},
+                                       {"cycles", static_cast<double>(s.cycles)},
+                                       {"warmup", static_cast<double>(s.warmupAllocations)},
+                                       {"allowed", static_cast<double>(s.allowedAllocations)},
+                                       {"steady", static_cast<double>(s.steadyAllocations)},
+                                       {"steadyBytes", static_cast<double>(s.steadyBytes)}});
+        }
+        QJsonArray sites;
+        for (const AllocAudit::CallSite& site : AllocAudit::callSites()) {
+            sites.append(QJsonObject{{"thread", site.thread},
+                                     {"count", static_cast<double>(site.count)},
+                                     {"frames", QJsonArray::fromStringList(site.frames)}});
+        }
+        return QJsonObject{{"enabled", AllocAudit::isEnabled()},
+                           {"violations", static_cast<double>(AllocAudit::violations())},
+                           {"threads", threads},
+                           {"sites", sites}};
+    });
+}
+
+static void registerProfilerCommand(SamplingProfiler* profiler)
+{
+    ControlRegistry::instance()->registerCommand("profile", "CPU sampling profile {seconds} or {stop: true}; writes profile-<time>.folded", profiler,
+                                                 [profiler](const QJsonObject& params, QString* error) {
+        if (params.contains("seconds")) {
+            int seconds = params.value("seconds").toInt();
+            if (seconds <= 0) {
+                *error = "\"seconds\" must be a positive integer";
+                return QJsonObject();
+            }
+            if (profiler->startProfile(seconds, error).isEmpty()) {
+                return QJsonObject();
+            }
+        } else if (params.value("stop").toBool()) {
+            profiler->stopProfile();
+        }
+        return QJsonObject{{"available", profiler->isAvailable()},
+                           {"running", profiler->isRunning()},
+                           {"file", profiler->outputPath()}};
+    });
+}
+
 int main(int argc, char *argv[]) {
     qputenv("QT_AUTO_SCREEN_SCALE_FACTOR", "1");
 
@@ -19,21 +142,108 @@ int main(int argc, char *argv[]) {
     Logger::init();
     LOG_INFO("Application starting...");
     
+    // 稳态分配审计 (cmake -DALLOC_AUDIT=ON): 退出时报告实时线程热身后的堆分配，
+    // --alloc-audit-abort 在第一次违规处中止
+    if (AllocAudit::isEnabled()) {
+        AllocAudit::setAbortOnViolation(QCoreApplication::arguments().contains("--alloc-audit-abort"));
+        QObject::connect(&a, &QCoreApplication::aboutToQuit, []() { AllocAudit::report(); });
+        LOG_INFO("Allocation audit enabled for realtime threads");
+    }
+    
+    // 音频 DSP: 按 CPU 选择 SIMD 实现并自检；--dsp-bench 只运行自检和微基准后退出
+    AudioDsp::initialize();
+    if (QCoreApplication::arguments().contains("--dsp-bench")) {
+        bool resamplerOk = FractionalResampler::selfTest();
+        bool dspOk = AudioDsp::benchmark();
+        return resamplerOk && dspOk ? 0 : 1;
+    }
+    
     // 加载配置文件
     QString configPath = QDir(QCoreApplication::applicationDirPath()).filePath("../config/config.json");
     ConfigManager::instance()->loadFromFile(configPath);
     LOG_INFO(QString("Config loaded from: %1").arg(configPath));
     
+    // 热路径追踪: 配置开启时从启动开始记录，运行中 kill -USR2 <pid> 切换，停止时导出到报告目录
+    TraceRecorder::installSignalToggle(ConfigManager::instance()->telemetryReportPath());
+    if (ConfigManager::instance()->telemetryTrace()) {
+        TraceRecorder::setEnabled(true);
+    }
+    
+    // 指标导出: /metrics (OpenMetrics) 和可选的滚动快照文件，在独立线程中运行
+    ConfigManager* config = ConfigManager::instance();
+    MetricsServer::Config metricsConfig;
+    metricsConfig.bindAddress = config->metricsBindAddress();
+    metricsConfig.port = config->metricsPort();
+    metricsConfig.snapshotIntervalSec = config->metricsSnapshotIntervalSec();
+    metricsConfig.snapshotMaxKB = config->metricsSnapshotMaxKB();
+    if (config->metricsSnapshotIntervalSec() > 0 && !config->telemetryReportPath().isEmpty()) {
+        metricsConfig.snapshotPath = QDir(config->telemetryReportPath()).filePath("metrics.prom");
+    }
+    MetricsServer metricsServer;
+    metricsServer.startServer(metricsConfig);
+    
+    // 运行时控制: Unix 域套接字上的 JSON 命令 (独立线程收发，命令在主线程执行)
+    registerControlCommands(&a);
+    ControlServer controlServer;
+    controlServer.startServer(config->controlSocketPath());
+    
+    // 按需采样分析: kill -USR1 <pid> 或控制命令 profile，窗口结束后写出折叠栈
+    SamplingProfiler profiler;
+    SamplingProfiler::Config profilerConfig;
+    profilerConfig.frequencyHz = config->profilerFrequencyHz();
+    profilerConfig.maxSeconds = config->profilerMaxSeconds();
+    profilerConfig.outputDir = config->telemetryReportPath();
+    profiler.setConfig(profilerConfig);
+    profiler.installSignalTrigger();
+    registerProfilerCommand(&profiler);
+    
     // 加载样式主题
     StyleManager::instance()->loadTheme(":/QuickStart/../src/ui/styles/dark.qss");
     LOG_INFO("Theme loaded");
     
+    QStringList args = QCoreApplication::arguments();
+    QScreen *screen = QGuiApplication::primaryScreen();
+    
+    // --latency-test [N]: 无界面，本地回环测 N 次麦克风 -> 扬声器延迟，输出统计后退出
+    if (args.contains("--latency-test")) {
+        int count = countArgument(args, "--latency-test", DEFAULT_LATENCY_TEST_COUNT);
+        MediaManager mediaManager;
+        if (!mediaManager.startLoopback(false)) {
+            LOG_ERROR("Latency test: loopback failed to start");
+            return 1;
+        }
+        QObject::connect(&mediaManager, &MediaManager::latencyTestFinished, &a, [&mediaManager, &a]() {
+            LatencyStats stats = mediaManager.latencyStats();
+            LOG_INFO(QString("Latency test result: %1 ok, %2 missed, mean %3 ms, stddev %4 ms, min %5 ms, max %6 ms")
+                     .arg(stats.count).arg(stats.missed)
+                     .arg(stats.meanMs(), 0, 'f', 1).arg(stats.stddevMs(), 0, 'f', 1)
+                     .arg(stats.minMs, 0, 'f', 1).arg(stats.maxMs, 0, 'f', 1));
+            // 文件后端的回声参考未对齐也算失败 (停止后渲染对象延迟删除，此时仍有效)
+            FileAudioRender* fileRender = qobject_cast<FileAudioRender*>(mediaManager.getAudioRender());
+            mediaManager.stopLoopback();
+            int misaligned = fileRender ? fileRender->referenceMismatches() : 0;
+            // 审计构建中实时线程稳态分配也算失败
+            a.exit(stats.count > 0 && misaligned == 0 && AllocAudit::violations() == 0 ? 0 : 1);
+        });
+        mediaManager.startLatencyTest(count);
+        return a.exec();
+    }
+    
+    // --loopback: 不加入房间，本地回环页面 (摄像头直显、麦克风直通扬声器、延迟测量)
+    if (args.contains("--loopback")) {
+        MediaManager mediaManager;
+        LoopbackWidget loopback(&mediaManager, DEFAULT_LATENCY_TEST_COUNT);
+        loopback.setWindowFlags(Qt::FramelessWindowHint);
+        loopback.setGeometry(screen->geometry());
+        loopback.showFullScreen();
+        return a.exec();
+    }
+    
     RoomMainWidget w;
     // 全屏无边框，适配4.3寸横屏 (800x480)
     w.setWindowFlags(Qt::FramelessWindowHint);
     
     // 获取屏幕尺寸并全屏显示
-    QScreen *screen = QGuiApplication::primaryScreen();
     QRect screenGeometry = screen->geometry();
     w.setGeometry(screenGeometry);
     w.showFullScreen();
@@ -0,0 +1,276 @@
+#include "HudOverlay.h"
+#include <QDebug>
+#include <QFont>
+#include <QFontMetrics>
+#include <QOpenGLShaderProgram>
+#include <QPainter>
+#include <cstring>
+
+static const int HUD_FONT_PIXELS = 13;
+static const int HUD_MARGIN = 8;        // 叠加层到控件左上角
+static const int HUD_PADDING = 6;       // 背景框内边距
+static const int ATLAS_COLUMNS = 16;
+static const int FIRST_GLYPH = 32;      // 空格
+static const int GLYPH_COUNT = 95;      // 32..126
+static const int SOLID_CELL = GLYPH_COUNT;  // 图集最后一格为实心，用于背景框
+static const GLfloat BACKGROUND_ALPHA = 0.6f;
+
+static const char* hudVertexShaderSource = R"(
+    attribute vec2 aPosition;
+    attribute vec2 aTexCoord;
+    uniform vec2 uViewport;
+    varying vec2 vTexCoord;
+    void main() {
+        gl_Position = vec4(aPosition.x / uViewport.x * 2.0 - 1.0, 1.0 - aPosition.y / uViewport.y * 2.0, 0.0, 1.0);
+        vTexCoord = aTexCoord;
+    }
+)";
+
+static const char* hudFragmentShaderSource = R"(
+    varying highp vec2 vTexCoord;
+    uniform sampler2D uAtlas;
+    uniform lowp vec4 uColor;
+    void main() {
+        gl_FragColor = vec4(uColor.rgb, uColor.a * texture2D(uAtlas, vTexCoord).a);
+    }
+)";
+
+namespace {
+// 白色字形 + 透明背景，GPU 路径取 alpha 通道，CPU 路径直接叠加
+struct GlyphAtlas {
+    QImage image;       // ARGB32_Premultiplied
+    QImage alpha;       // Alpha8，上传为纹理
+    int cellWidth = 0;
+    int cellHeight = 0;
+
+    QRect cell(int index) const
+    {
+        return QRect((index % ATLAS_COLUMNS) * cellWidth, (index / ATLAS_COLUMNS) * cellHeight,
+                     cellWidth, cellHeight);
+    }
+};
+}
+
+static const GlyphAtlas& glyphAtlas()
+{
+    static GlyphAtlas atlas;
+    if (!atlas.image.isNull()) {
+        return atlas;
+    }
+    QFont font("DejaVu Sans Mono");
+    font.setStyleHint(QFont::Monospace);
+    font.setPixelSize(HUD_FONT_PIXELS);
+    QFontMetrics metrics(font);
+    atlas.cellWidth = metrics.maxWidth();
+    atlas.cellHeight = metrics.height();
+
+    int rows = (GLYPH_COUNT + 1 + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    atlas.image = QImage(ATLAS_COLUMNS * atlas.cellWidth, rows * atlas.cellHeight,
+                         QImage::Format_ARGB32_Premultiplied);
+    atlas.image.fill(Qt::transparent);
+    QPainter painter(&atlas.image);
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    for (int i = 0; i < GLYPH_COUNT; i++) {
+        painter.drawText(atlas.cell(i), Qt::AlignCenter, QString(QChar(FIRST_GLYPH + i)));
+    }
+    painter.fillRect(atlas.cell(SOLID_CELL), Qt::white);
+    painter.end();
+    atlas.alpha = atlas.image.convertToFormat(QImage::Format_Alpha8);
+    return atlas;
+}
+
+static int glyphIndex(QChar c)
+{
+    ushort code = c.unicode();
+    return code >= FIRST_GLYPH && code < FIRST_GLYPH + GLYPH_COUNT ? code - FIRST_GLYPH : '?' - FIRST_GLYPH;
+}
+
+// 两个三角形，顶点格式 x, y, s, t
+static void appendQuad(GLfloat* out, float x0, float y0, float x1, float y1,
+                       float s0, float t0, float s1, float t1)
+{
+    const GLfloat quad[6 * 4] = {
+        x0, y0, s0, t0,   x1, y0, s1, t0,   x0, y1, s0, t1,
+        x0, y1, s0, t1,   x1, y0, s1, t0,   x1, y1, s1, t1,
+    };
+    memcpy(out, quad, sizeof(quad));
+}
+
+HudOverlay::HudOverlay()
+{
+    memset(m_backgroundVertices, 0, sizeof(m_backgroundVertices));
+}
+
+HudOverlay::~HudOverlay()
+{
+    // GL 资源需在上下文有效时由 releaseGL 释放，这里只处理未释放的程序对象
+    delete m_program;
+}
+
+void HudOverlay::setText(const QStringList& lines)
+{
+    if (lines == m_lines) {
+        return;
+    }
+    m_lines = lines;
+    m_layoutDirty = true;
+    m_imageDirty = true;
+}
+
+void HudOverlay::layout()
+{
+    const GlyphAtlas& atlas = glyphAtlas();
+    const float atlasWidth = atlas.image.width();
+    const float atlasHeight = atlas.image.height();
+
+    int columns = 0;
+    int glyphs = 0;
+    for (const QString& line : m_lines) {
+        columns = qMax(columns, line.size());
+        glyphs += line.size();
+    }
+    m_boxWidth = columns * atlas.cellWidth + 2 * HUD_PADDING;
+    m_boxHeight = m_lines.size() * atlas.cellHeight + 2 * HUD_PADDING;
+
+    // 背景框采样实心格的中心，避免线性过滤时混入相邻字形
+    QRect solid = atlas.cell(SOLID_CELL);
+    float s = (solid.left() + solid.width() / 2.0f) / atlasWidth;
+    float t = (solid.top() + solid.height() / 2.0f) / atlasHeight;
+    appendQuad(m_backgroundVertices, HUD_MARGIN, HUD_MARGIN, HUD_MARGIN + m_boxWidth, HUD_MARGIN + m_boxHeight,
+               s, t, s, t);
+
+    m_textVertices.resize(glyphs * 6 * 4);
+    GLfloat* out = m_textVertices.data();
+    for (int row = 0; row < m_lines.size(); row++) {
+        const QString& line = m_lines.at(row);
+        float y = HUD_MARGIN + HUD_PADDING + row * atlas.cellHeight;
+        for (int col = 0; col < line.size(); col++) {
+            if (line.at(col) == QChar(' ')) {
+                continue;
+            }
+            QRect cell = atlas.cell(glyphIndex(line.at(col)));
+            float x = HUD_MARGIN + HUD_PADDING + col * atlas.cellWidth;
+            appendQuad(out, x, y, x + atlas.cellWidth, y + atlas.cellHeight,
+                       cell.left() / atlasWidth, cell.top() / atlasHeight,
+                       (cell.left() + cell.width()) / atlasWidth, (cell.top() + cell.height()) / atlasHeight);
+            out += 6 * 4;
+        }
+    }
+    m_textVertices.resize(out - m_textVertices.data());
+    m_layoutDirty = false;
+}
+
+bool HudOverlay::initGL(QOpenGLFunctions* gl)
+{
+    m_program = new QOpenGLShaderProgram();
+    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, hudVertexShaderSource) ||
+        !m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, hudFragmentShaderSource) ||
+        !m_program->link()) {
+        qDebug() << "HudOverlay: failed to build shader program:" << m_program->log();
+        delete m_program;
+        m_program = nullptr;
+        return false;
+    }
+
+    const GlyphAtlas& atlas = glyphAtlas();
+    gl->glGenTextures(1, &m_atlasTexture);
+    gl->glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+    // Alpha8 每行按 4 字节对齐，与 GL 默认的 UNPACK_ALIGNMENT 一致
+    gl->glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, atlas.alpha.width(), atlas.alpha.height(), 0,
+                     GL_ALPHA, GL_UNSIGNED_BYTE, atlas.alpha.constBits());
+    // 字形按 1:1 像素绘制，最近邻采样保持清晰
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    gl->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return true;
+}
+
+void HudOverlay::releaseGL(QOpenGLFunctions* gl)
+{
+    if (m_atlasTexture) {
+        gl->glDeleteTextures(1, &m_atlasTexture);
+        m_atlasTexture = 0;
+    }
+    delete m_program;
+    m_program = nullptr;
+}
+
+void HudOverlay::paintGL(QOpenGLFunctions* gl, int width, int height)
+{
+    if (m_lines.isEmpty() || m_glFailed || width <= 0 || height <= 0) {
+        return;
+    }
+    if (!m_program && !initGL(gl)) {
+        m_glFailed = true;
+        return;
+    }
+    if (m_layoutDirty) {
+        layout();
+    }
+
+    m_program->bind();
+    gl->glActiveTexture(GL_TEXTURE0);
+    gl->glBindTexture(GL_TEXTURE_2D, m_atlasTexture);
+    m_program->setUniformValue("uAtlas", 0);
+    m_program->setUniformValue("uViewport", static_cast<GLfloat>(width), static_cast<GLfloat>(height));
+
+    gl->glEnable(GL_BLEND);
+    gl->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    int posLoc = m_program->attributeLocation("aPosition");
+    int texLoc = m_program->attributeLocation("aTexCoord");
+    gl->glEnableVertexAttribArray(posLoc);
+    gl->glEnableVertexAttribArray(texLoc);
+
+    gl->glVertexAttribPointer(posLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), m_backgroundVertices);
+    gl->glVertexAttribPointer(texLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), m_backgroundVertices + 2);
+    m_program->setUniformValue("uColor", 0.0f, 0.0f, 0.0f, BACKGROUND_ALPHA);
+    gl->glDrawArrays(GL_TRIANGLES, 0, 6);
+
+    if (!m_textVertices.empty()) {
+        gl->glVertexAttribPointer(posLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), m_textVertices.data());
+        gl->glVertexAttribPointer(texLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), m_textVertices.data() + 2);
+        m_program->setUniformValue("uColor", 1.0f, 1.0f, 1.0f, 1.0f);
+        gl->glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_textVertices.size() / 4));
+    }
+
+    gl->glDisableVertexAttribArray(posLoc);
+    gl->glDisableVertexAttribArray(texLoc);
+    gl->glDisable(GL_BLEND);
+    m_program->release();
+}
+
+void HudOverlay::composeImage()
+{
+    if (m_layoutDirty) {
+        layout();
+    }
+    const GlyphAtlas& atlas = glyphAtlas();
+    m_image = QImage(m_boxWidth, m_boxHeight, QImage::Format_ARGB32_Premultiplied);
+    m_image.fill(QColor(0, 0, 0, static_cast<int>(BACKGROUND_ALPHA * 255)));
+    QPainter painter(&m_image);
+    for (int row = 0; row < m_lines.size(); row++) {
+        const QString& line = m_lines.at(row);
+        for (int col = 0; col < line.size(); col++) {
+            if (line.at(col) == QChar(' ')) {
+                continue;
+            }
+            painter.drawImage(QPoint(HUD_PADDING + col * atlas.cellWidth, HUD_PADDING + row * atlas.cellHeight),
+                              atlas.image, atlas.cell(glyphIndex(line.at(col))));
+        }
+    }
+    m_imageDirty = false;
+}
+
+void HudOverlay::paint(QPainter* painter)
+{
+    if (m_lines.isEmpty()) {
+        return;
+    }
+    if (m_imageDirty) {
+        composeImage();
+    }
+    painter->drawImage(HUD_MARGIN, HUD_MARGIN, m_image);
+}
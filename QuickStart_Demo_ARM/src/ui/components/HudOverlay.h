@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QImage>
+#include <QOpenGLFunctions>
+#include <QStringList>
+#include <vector>
+
+class QOpenGLShaderProgram;
+class QPainter;
+
+/**
+ * 性能 HUD 叠加层 (视频画面左上角的多行 ASCII 文本)
+ * 字形图集 (等宽字体的可打印 ASCII + 一个实心格) 在首次使用时绘制一次，之后只在文字变化时
+ * (PerfHud 每秒约 2 次) 重新排版，每帧的开销与文字内容无关:
+ * - GPU: 图集上传为一张 alpha 纹理，排版结果为预先生成的顶点数组，每帧两次 draw call (背景 + 文字)
+ * - CPU: 排版时用图集拼出整块叠加图像，每帧只 drawImage 一次
+ *
+ * 文本为空时不绘制；只在 GUI 线程中使用
+ */
+class HudOverlay {
+public:
+    HudOverlay();
+    ~HudOverlay();
+
+    void setText(const QStringList& lines);
+    bool isEmpty() const { return m_lines.isEmpty(); }
+
+    // 在当前 GL 上下文中叠加绘制 (paintGL 末尾调用)，尺寸为控件的逻辑像素
+    void paintGL(QOpenGLFunctions* gl, int width, int height);
+    // 释放 GL 资源，需在上下文有效时调用 (控件析构前 makeCurrent)
+    void releaseGL(QOpenGLFunctions* gl);
+
+    // CPU 渲染控件的 paintEvent 末尾调用
+    void paint(QPainter* painter);
+
+private:
+    bool initGL(QOpenGLFunctions* gl);
+    void layout();
+    void composeImage();
+
+    QStringList m_lines;
+    bool m_layoutDirty = false;
+    bool m_imageDirty = false;
+
+    // 顶点格式: x, y (像素), s, t
+    std::vector<GLfloat> m_textVertices;
+    GLfloat m_backgroundVertices[6 * 4];
+    int m_boxWidth = 0;
+    int m_boxHeight = 0;
+
+    QOpenGLShaderProgram* m_program = nullptr;
+    GLuint m_atlasTexture = 0;
+    bool m_glFailed = false;
+
+    QImage m_image;  // CPU 路径的整块叠加图像
+};
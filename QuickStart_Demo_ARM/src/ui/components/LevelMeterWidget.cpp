@@ -0,0 +1,65 @@
+#include "LevelMeterWidget.h"
+#include <QPainter>
+#include <QtMath>
+
+static const float FLOOR_DB = -60.0f;   // 显示范围下限，更低的电平不显示
+static const float WARN_DB = -12.0f;
+static const float CLIP_DB = -1.0f;
+
+static float dbToRatio(float db)
+{
+    return qBound(0.0f, (db - FLOOR_DB) / -FLOOR_DB, 1.0f);
+}
+
+LevelMeterWidget::LevelMeterWidget(QWidget* parent)
+    : QWidget(parent)
+{
+    setFixedSize(6, 24);
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+void LevelMeterWidget::setColor(const QColor& color)
+{
+    m_color = color;
+    update();
+}
+
+void LevelMeterWidget::setLevel(float rmsDbfs, float peakDbfs)
+{
+    // 按显示精度 (约 1 像素) 比较，避免静音时每次轮询都重绘
+    int oldRms = qRound(dbToRatio(m_rmsDb) * height());
+    int oldPeak = qRound(dbToRatio(m_peakDb) * height());
+    int newRms = qRound(dbToRatio(rmsDbfs) * height());
+    int newPeak = qRound(dbToRatio(peakDbfs) * height());
+    bool colorChanged = (m_peakDb >= CLIP_DB) != (peakDbfs >= CLIP_DB) ||
+                        (m_rmsDb >= WARN_DB) != (rmsDbfs >= WARN_DB);
+    m_rmsDb = rmsDbfs;
+    m_peakDb = peakDbfs;
+    if (oldRms != newRms || oldPeak != newPeak || colorChanged) {
+        update();
+    }
+}
+
+void LevelMeterWidget::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    QPainter p(this);
+    p.setPen(Qt::NoPen);
+    p.setBrush(QColor("#555"));
+    p.drawRoundedRect(rect(), 2, 2);
+
+    int h = height();
+    int rmsHeight = qRound(dbToRatio(m_rmsDb) * h);
+    if (rmsHeight > 0) {
+        QColor fill = m_peakDb >= CLIP_DB ? QColor("#F44336")
+                    : m_rmsDb >= WARN_DB ? QColor("#FFC107") : m_color;
+        p.setBrush(fill);
+        p.drawRoundedRect(QRect(0, h - rmsHeight, width(), rmsHeight), 2, 2);
+    }
+
+    int peakY = h - qRound(dbToRatio(m_peakDb) * h);
+    if (peakY < h) {
+        p.setBrush(m_peakDb >= CLIP_DB ? QColor("#F44336") : QColor("#EEE"));
+        p.drawRect(QRect(0, qMax(0, peakY - 1), width(), 2));
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QWidget>
+#include <QColor>
+
+/**
+ * 音频电平条 (VU 表)
+ * 竖直细条: 填充高度为 RMS，细线标出峰值；按 dBFS 着色 (绿 / 黄 / 红)
+ * 只在电平变化时重绘，由调用方定时调用 setLevel
+ */
+class LevelMeterWidget : public QWidget {
+    Q_OBJECT
+
+public:
+    LevelMeterWidget(QWidget* parent = nullptr);
+
+    // 颜色为正常电平时的填充色
+    void setColor(const QColor& color);
+    // rmsDbfs / peakDbfs: -96 (静音) - 0 (满幅)
+    void setLevel(float rmsDbfs, float peakDbfs);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    float m_rmsDb = -96.0f;
+    float m_peakDb = -96.0f;
+    QColor m_color = QColor("#4CAF50");
+};
@@ -1,10 +1,24 @@
 #include "VideoRenderWidget.h"
 #include "CustomVideoSink.h"
+#include "VideoLatencyMonitor.h"
+#include "TraceRecorder.h"
+#include "MetricsRegistry.h"
 #include <QPainter>
+#include <chrono>
+
+static int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 VideoRenderWidget::VideoRenderWidget(QWidget* parent)
     : QWidget(parent) {
     setAttribute(Qt::WA_OpaquePaintEvent);
+    m_renderFramesMetric = MetricsRegistry::instance()->counter(
+        "video_render_frames", "Video frames drawn by the local renderer");
+    m_frameAgeMetric = MetricsRegistry::instance()->gauge(
+        "video_render_frame_age_ms", "Time from sink delivery to draw of the latest frame");
 }
 
 VideoRenderWidget::~VideoRenderWidget() {
@@ -25,14 +39,24 @@ void VideoRenderWidget::clearFrame() {
     update();
 }
 
+void VideoRenderWidget::setHudText(const QStringList& lines) {
+    if (lines.isEmpty() && m_hud.isEmpty()) {
+        return;
+    }
+    m_hud.setText(lines);
+    update();
+}
+
 void VideoRenderWidget::paintEvent(QPaintEvent* event) {
     Q_UNUSED(event);
+    TRACE_SCOPE("video.render.paint");
     
     QPainter painter(this);
     painter.setRenderHint(QPainter::SmoothPixmapTransform);
     
     if (m_videoSink) {
-        QImage frame = m_videoSink->getCurrentFrame();
+        int64_t arrivalUs = 0;
+        QImage frame = m_videoSink->getCurrentFrame(&arrivalUs);
         if (!frame.isNull()) {
             // 使用 KeepAspectRatioByExpanding 填充整个 widget，可能会裁剪
             QImage scaled = frame.scaled(size(), Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
@@ -44,10 +68,27 @@ void VideoRenderWidget::paintEvent(QPaintEvent* event) {
             painter.setClipRect(rect());
             painter.fillRect(rect(), Qt::black);
             painter.drawImage(x, y, scaled);
+            
+            // 延迟测量: 从 RGB888 的 G 通道解码，记录采集到绘制完成的耗时
+            if (frame.format() == QImage::Format_RGB888) {
+                VideoLatencyMonitor::instance()->recordFrame(VideoLatencyMonitor::Display, frame.constBits() + 1,
+                                                             frame.bytesPerLine(), 3, frame.width(), frame.height(),
+                                                             &m_lastStampUs);
+            }
+            
+            if (frame.cacheKey() != m_lastFrameKey) {
+                m_lastFrameKey = frame.cacheKey();
+                m_renderFramesMetric->add();
+                if (arrivalUs > 0) {
+                    m_frameAgeMetric->set((steadyNowUs() - arrivalUs) / 1000.0);
+                }
+            }
+            m_hud.paint(&painter);
             return;
         }
     }
     
     // 没有视频帧时显示黑色背景
     painter.fillRect(rect(), Qt::black);
+    m_hud.paint(&painter);
 }
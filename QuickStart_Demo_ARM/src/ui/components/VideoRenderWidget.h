@@ -3,8 +3,11 @@
 #include <QWidget>
 #include <QImage>
 #include <QMutex>
+#include "HudOverlay.h"
 
 class CustomVideoSink;
+class MetricCounter;
+class MetricGauge;
 
 /**
  * 视频渲染 Widget
@@ -22,10 +25,20 @@ public:
     
     // 清除画面（显示黑屏）
     void clearFrame();
+    
+    // 性能 HUD 文本，空列表时隐藏
+    void setHudText(const QStringList& lines);
 
 protected:
     void paintEvent(QPaintEvent* event) override;
 
 private:
     CustomVideoSink* m_videoSink = nullptr;
+    int64_t m_lastStampUs = 0;  // 延迟测量: 最近一次记录的帧，重复绘制同一帧时不再记录
+    
+    // 性能 HUD
+    HudOverlay m_hud;
+    qint64 m_lastFrameKey = 0;  // 帧计数只统计新帧 (QImage::cacheKey)
+    MetricCounter* m_renderFramesMetric = nullptr;
+    MetricGauge* m_frameAgeMetric = nullptr;
 };
@@ -1,6 +1,10 @@
 #include "VideoRenderWidgetGL.h"
 #include "CustomVideoSink.h"
+#include "VideoLatencyMonitor.h"
+#include "TraceRecorder.h"
+#include "MetricsRegistry.h"
 #include <QDebug>
+#include <chrono>
 
 // I420 到 RGB 的 shader - 在 GPU 上进行颜色空间转换
 static const char* vertexShaderSource = R"(
@@ -32,20 +36,41 @@ static const char* fragmentShaderSource = R"(
     }
 )";
 
+static int64_t steadyNowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 VideoRenderWidgetGL::VideoRenderWidgetGL(QWidget* parent)
     : QOpenGLWidget(parent) {
     setAttribute(Qt::WA_OpaquePaintEvent);
+    m_renderFramesMetric = MetricsRegistry::instance()->counter(
+        "video_render_frames", "Video frames drawn by the local renderer");
+    m_frameAgeMetric = MetricsRegistry::instance()->gauge(
+        "video_render_frame_age_ms", "Time from sink delivery to draw of the latest frame");
 }
 
 VideoRenderWidgetGL::~VideoRenderWidgetGL() {
     makeCurrent();
     deleteTextures();
+    m_hud.releaseGL(this);
     delete m_program;
     doneCurrent();
 }
 
+void VideoRenderWidgetGL::setHudText(const QStringList& lines) {
+    if (lines.isEmpty() && m_hud.isEmpty()) {
+        return;
+    }
+    m_hud.setText(lines);
+    update();
+}
+
 void VideoRenderWidgetGL::updateI420Frame(const uint8_t* yData, const uint8_t* uData, const uint8_t* vData,
-                                          int width, int height, int yStride, int uStride, int vStride) {
+                                          int width, int height, int yStride, int uStride, int vStride,
+                                          int64_t arrivalUs) {
+    TRACE_SCOPE("video.gl.copyFrame");
     QMutexLocker locker(&m_mutex);
     
     // 复制数据
@@ -67,6 +92,8 @@ void VideoRenderWidgetGL::updateI420Frame(const uint8_t* yData, const uint8_t* u
     m_uStride = uStride;
     m_vStride = vStride;
     m_frameReady = true;
+    m_newFrame = true;
+    m_frameArrivalUs = arrivalUs;
     
     // 触发重绘
     update();
@@ -87,10 +114,19 @@ void VideoRenderWidgetGL::resizeGL(int w, int h) {
 }
 
 void VideoRenderWidgetGL::paintGL() {
+    TRACE_SCOPE("video.gl.paint");
     glClear(GL_COLOR_BUFFER_BIT);
     
-    QMutexLocker locker(&m_mutex);
+    {
+        QMutexLocker locker(&m_mutex);
+        paintFrame();
+    }
     
+    // HUD 叠加在视频之上 (无帧时也显示)
+    m_hud.paintGL(this, width(), height());
+}
+
+void VideoRenderWidgetGL::paintFrame() {
     if (!m_frameReady || m_frameWidth == 0 || m_frameHeight == 0) {
         return;
     }
@@ -178,6 +214,19 @@ void VideoRenderWidgetGL::paintGL() {
     glDisableVertexAttribArray(texLoc);
     
     m_program->release();
+    
+    // 延迟测量: 绘制命令提交后记录采集到显示的耗时 (不含合成器和扫描输出)
+    VideoLatencyMonitor::instance()->recordFrame(VideoLatencyMonitor::Display,
+                                                 reinterpret_cast<const uint8_t*>(m_yData.constData()),
+                                                 m_yStride, 1, m_frameWidth, m_frameHeight, &m_lastStampUs);
+    
+    if (m_newFrame) {
+        m_newFrame = false;
+        m_renderFramesMetric->add();
+        if (m_frameArrivalUs > 0) {
+            m_frameAgeMetric->set((steadyNowUs() - m_frameArrivalUs) / 1000.0);
+        }
+    }
 }
 
 void VideoRenderWidgetGL::initShaders() {
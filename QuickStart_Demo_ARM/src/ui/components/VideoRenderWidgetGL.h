@@ -4,8 +4,11 @@
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
 #include <QMutex>
+#include "HudOverlay.h"
 
 class CustomVideoSink;
+class MetricCounter;
+class MetricGauge;
 
 /**
  * OpenGL 视频渲染 Widget
@@ -22,12 +25,16 @@ public:
     void setVideoSink(CustomVideoSink* sink) { m_videoSink = sink; }
     CustomVideoSink* getVideoSink() const { return m_videoSink; }
     
-    // 直接更新 I420 数据（避免 CPU 转换）
+    // 直接更新 I420 数据（避免 CPU 转换）；arrivalUs 为帧到达 sink 的时刻 (steady 时钟)，用于性能 HUD
     void updateI420Frame(const uint8_t* yData, const uint8_t* uData, const uint8_t* vData,
-                         int width, int height, int yStride, int uStride, int vStride);
+                         int width, int height, int yStride, int uStride, int vStride,
+                         int64_t arrivalUs = 0);
     
     // 清除画面（显示黑屏）
     void clearFrame();
+    
+    // 性能 HUD 文本，空列表时隐藏
+    void setHudText(const QStringList& lines);
 
 protected:
     void initializeGL() override;
@@ -36,6 +43,7 @@ protected:
 
 private:
     void initShaders();
+    void paintFrame();
     void createTextures(int width, int height);
     void deleteTextures();
 
@@ -60,6 +68,14 @@ private:
     int m_vStride = 0;
     bool m_frameReady = false;
     bool m_texturesCreated = false;
+    int64_t m_lastStampUs = 0;  // 延迟测量: 最近一次记录的帧，重复绘制同一帧时不再记录
     int m_textureWidth = 0;
     int m_textureHeight = 0;
+    
+    // 性能 HUD
+    HudOverlay m_hud;
+    int64_t m_frameArrivalUs = 0;
+    bool m_newFrame = false;  // 帧计数只统计新帧，重复绘制同一帧不计
+    MetricCounter* m_renderFramesMetric = nullptr;
+    MetricGauge* m_frameAgeMetric = nullptr;
 };
@@ -1,4 +1,5 @@
 ﻿#include "OperateWidget.h"
+#include "LevelMeterWidget.h"
 #include <QMouseEvent>
 #include <QPainter>
 #include <QHBoxLayout>
@@ -50,18 +51,28 @@ void OperateWidget::setupVolumeControls() {
         "QSlider::sub-page:horizontal { background: #2196F3; border-radius: 2px; }"
     );
     
+    // 电平表 (滑块右侧的细条，颜色与滑块一致)
+    m_micLevel = new LevelMeterWidget(this);
+    m_micLevel->setColor(QColor("#4CAF50"));
+    m_micLevel->setToolTip("麦克风电平");
+    m_speakerLevel = new LevelMeterWidget(this);
+    m_speakerLevel->setColor(QColor("#2196F3"));
+    m_speakerLevel->setToolTip("喇叭电平");
+    
     // 将滑块插入到现有布局中
     QHBoxLayout* mainLayout = qobject_cast<QHBoxLayout*>(ui.muteAudioBtn->parentWidget()->layout());
     if (mainLayout) {
-        // 在音频按钮后面插入麦克风音量
+        // 在音频按钮后面插入麦克风音量和电平
         int audioIndex = mainLayout->indexOf(ui.muteAudioBtn);
         if (audioIndex >= 0) {
             mainLayout->insertWidget(audioIndex + 1, m_micVolumeSlider);
+            mainLayout->insertWidget(audioIndex + 2, m_micLevel);
         }
-        // 在喇叭按钮后面插入喇叭音量
+        // 在喇叭按钮后面插入喇叭音量和电平
         int speakerIndex = mainLayout->indexOf(ui.muteSpeakerBtn);
         if (speakerIndex >= 0) {
             mainLayout->insertWidget(speakerIndex + 1, m_speakerVolumeSlider);
+            mainLayout->insertWidget(speakerIndex + 2, m_speakerLevel);
         }
     }
     
@@ -78,6 +89,15 @@ void OperateWidget::onSpeakerVolumeChanged(int value) {
     emit sigSpeakerVolumeChanged(value);
 }
 
+void OperateWidget::setAudioLevels(const AudioLevelMeter::Reading& mic, const AudioLevelMeter::Reading& speaker) {
+    if (m_micLevel) {
+        m_micLevel->setLevel(mic.rmsDbfs, mic.peakDbfs);
+    }
+    if (m_speakerLevel) {
+        m_speakerLevel->setLevel(speaker.rmsDbfs, speaker.peakDbfs);
+    }
+}
+
 bool OperateWidget::eventFilter(QObject *watched, QEvent *event) {
     if (watched == parent()) {
         auto parentWindow = dynamic_cast<QWidget *>(parent());
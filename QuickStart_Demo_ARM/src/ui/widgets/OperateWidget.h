@@ -7,6 +7,9 @@
 #include <QComboBox>
 #include "ui_OperateWidget.h"
 #include "ExternalVideoSource.h"
+#include "AudioLevelMeter.h"
+
+class LevelMeterWidget;
 
 class OperateWidget : public QWidget {
     Q_OBJECT
@@ -45,6 +48,9 @@ public:
     void refreshCameras();
     void setCurrentCamera(const CameraInfo& camera);
     
+    // 麦克风 / 喇叭电平表，由房间页定时刷新
+    void setAudioLevels(const AudioLevelMeter::Reading& mic, const AudioLevelMeter::Reading& speaker);
+    
 private:
     void setupVolumeControls();
     void setupCameraSelector();
@@ -56,6 +62,8 @@ private:
     QSlider* m_speakerVolumeSlider = nullptr;
     QLabel* m_micLabel = nullptr;
     QLabel* m_speakerLabel = nullptr;
+    LevelMeterWidget* m_micLevel = nullptr;
+    LevelMeterWidget* m_speakerLevel = nullptr;
     
     // 摄像头选择
     QComboBox* m_cameraCombo = nullptr;
@@ -1,14 +1,15 @@
 #!/bin/bash
 
-# 资源监控脚本 - 监控 AIGC Demo 相关进程的资源使用情况
-# 使用原地更新，不滚动屏幕
-# CPU% 使用与任务管理器一致的计算方式（相对于总 CPU）
+# 资源监控脚本 - 显示 QuickStart 各线程的 CPU、运行队列等待、缺页和进程内存
+# 数据来自程序内部采样 (/proc/self/task/*/stat、schedstat、smaps_rollup)，通过指标接口读取，
+# 需要配置 telemetry.metrics.port (默认 9464)；麦克风采集的 arecord 子进程由程序登记后一并采样
+# AIGC 服务端 (node) 是独立进程，仍从 /proc 读取；另外显示网络流量和 GPU 内存 (树莓派)
+# 用法: ./monitor-resources.sh [间隔秒数] [主机:端口]
+# 使用原地更新，不滚动屏幕；CPU% 以 100 表示占满一个核
 
 # 监控间隔（秒）
 INTERVAL=${1:-2}
-
-# 获取 CPU 核心数
-CPU_CORES=$(nproc)
+ENDPOINT=${2:-127.0.0.1:9464}
 
 # 隐藏光标
 tput civis
@@ -19,74 +20,99 @@ trap 'tput cnorm; echo ""; exit 0' INT TERM
 # 清屏一次
 clear
 
-# 固定行数
-LINES=20
+CLK_TCK=$(getconf CLK_TCK)
+LAST_NODE_PID=""
+LAST_NODE_TICKS=""
 
 while true; do
     # 移动光标到开头
     tput cup 0 0
-    
-    # 获取数据
+
     TIME_NOW=$(date '+%H:%M:%S')
-    CPU_USAGE=$(top -bn1 | grep "Cpu(s)" | awk '{printf "%.1f", $2}')
-    MEM_INFO=$(free -m | awk '/^Mem:/{printf "%d/%dMB (%.0f%%)", $3, $2, $3/$2*100}')
-    
-    # CPU 温度
-    TEMP_C="N/A"
-    if [ -f /sys/class/thermal/thermal_zone0/temp ]; then
-        TEMP=$(cat /sys/class/thermal/thermal_zone0/temp)
-        TEMP_C=$(echo "scale=1; $TEMP/1000" | bc)"°C"
+    printf "\033[1;32m%-64s\033[0m\n" "═══ AIGC Demo 资源监控 [$TIME_NOW] ═══"
+
+    METRICS=$(curl -s --max-time 1 "http://$ENDPOINT/metrics")
+    if [ -z "$METRICS" ]; then
+        printf "%-64s\n" "无法读取 http://$ENDPOINT/metrics (程序未运行或未开启 telemetry.metrics.port)"
+    else
+        echo "$METRICS" | awk '
+            function labelValue(line, key,    pattern, start) {
+                pattern = key "=\""
+                start = index(line, pattern)
+                if (start == 0) return ""
+                line = substr(line, start + length(pattern))
+                return substr(line, 1, index(line, "\"") - 1)
+            }
+            /^process_cpu_percent /        { processCpu = $2 }
+            /^process_threads /            { threads = $2 }
+            /^soc_temperature_celsius /    { temperature = $2 }
+            /^process_memory_kb\{/         { memory[labelValue($0, "type")] = $2 }
+            /^process_page_faults_total\{/ { faults[labelValue($0, "type")] = $2 }
+            /^thread_cpu_percent\{/        { name = labelValue($0, "thread"); cpu[name] = $2 }
+            /^thread_runqueue_wait_percent\{/ { wait[labelValue($0, "thread")] = $2 }
+            /^thread_count\{/              { count[labelValue($0, "thread")] = $2 }
+            /^child_process_cpu_percent\{/ { childCpu[labelValue($0, "process")] = $2 }
+            /^child_process_memory_kb\{/   { childMem[labelValue($0, "process")] = $2 }
+            /^thread_page_faults\{/ {
+                if (labelValue($0, "type") == "major") majflt[labelValue($0, "thread")] = $2
+            }
+            END {
+                printf "\033[1;34mCPU:\033[0m %6.1f%%  \033[1;34mRSS:\033[0m %6.1fMB  \033[1;34mPSS:\033[0m %6.1fMB  \033[1;34m温度:\033[0m %s  \033[1;34m线程:\033[0m %d\n",
+                       processCpu, memory["rss"] / 1024, memory["pss"] / 1024,
+                       temperature == "" ? "N/A" : sprintf("%.1f°C", temperature), threads
+                printf "缺页: minor %d  major %d\n", faults["minor"], faults["major"]
+                print "────────────────────────────────────────────────────────────────"
+                printf "%-20s %7s %7s %6s %8s\n", "线程", "CPU%", "等待%", "数量", "majflt"
+                print "────────────────────────────────────────────────────────────────"
+                # 按 CPU 从高到低
+                n = 0
+                for (name in cpu) names[++n] = name
+                for (i = 1; i <= n; i++)
+                    for (j = i + 1; j <= n; j++)
+                        if (cpu[names[j]] + 0 > cpu[names[i]] + 0) { t = names[i]; names[i] = names[j]; names[j] = t }
+                for (i = 1; i <= n && i <= 16; i++) {
+                    name = names[i]
+                    if (count[name] + 0 == 0) continue
+                    printf "%-20s %7.1f %7.1f %6d %8d\n", name, cpu[name], wait[name], count[name], majflt[name]
+                }
+                # 子进程 (arecord)
+                for (name in childCpu) {
+                    printf "%-20s %7.1f %7s %6s %8s  %.1fMB\n", "[" name "]", childCpu[name], "-", "-", "-",
+                           childMem[name] / 1024
+                }
+            }'
     fi
-    
-    # 打印标题
-    printf "\033[1;32m%-60s\033[0m\n" "═══ AIGC Demo 资源监控 [$TIME_NOW] ═══"
-    printf "\033[1;34mCPU:\033[0m %-8s \033[1;34m内存:\033[0m %-20s \033[1;34m温度:\033[0m %-8s \033[1;34m核心:\033[0m %d\n" "${CPU_USAGE}%" "$MEM_INFO" "$TEMP_C" "$CPU_CORES"
-    echo "────────────────────────────────────────────────────────────"
-    printf "%-16s %7s %7s %9s %8s\n" "进程" "CPU%" "内存%" "内存MB" "PID"
-    echo "────────────────────────────────────────────────────────────"
-    
-    # 进程信息 - 固定5行
-    # CPU% 除以核心数，与任务管理器一致
-    PROC_COUNT=0
-    ps aux --sort=-%cpu | grep -E "(QuickStart|node.*app|arecord|aplay)" | grep -v grep | head -5 | while read line; do
-        PID=$(echo $line | awk '{print $2}')
-        CPU_RAW=$(echo $line | awk '{print $3}')
-        # 除以核心数得到相对于总 CPU 的百分比
-        CPU=$(echo "scale=1; $CPU_RAW / $CPU_CORES" | bc)
-        MEM=$(echo $line | awk '{print $4}')
-        MEM_MB=$(echo $line | awk '{printf "%.1f", $6/1024}')
-        
-        if echo "$line" | grep -q "QuickStart"; then
-            PNAME="QuickStart"
-        elif echo "$line" | grep -q "node"; then
-            PNAME="AIGC Server"
-        elif echo "$line" | grep -q "arecord"; then
-            PNAME="音频采集(arecord)"
-        elif echo "$line" | grep -q "aplay"; then
-            PNAME="音频播放(aplay)"
+
+    # AIGC 服务端 (node)，按两次采样之间的 utime+stime 计算
+    NODE_PID=$(pgrep -f "node.*app" | head -1)
+    if [ -n "$NODE_PID" ] && [ -r "/proc/$NODE_PID/stat" ]; then
+        NODE_TICKS=$(sed 's/.*) //' "/proc/$NODE_PID/stat" | awk '{print $12 + $13}')
+        NODE_RSS=$(awk '/^VmRSS:/{printf "%.1f", $2 / 1024}' "/proc/$NODE_PID/status")
+        if [ "$NODE_PID" = "$LAST_NODE_PID" ]; then
+            NODE_CPU=$(awk -v d=$((NODE_TICKS - LAST_NODE_TICKS)) -v hz="$CLK_TCK" -v t="$INTERVAL" \
+                'BEGIN { printf "%.1f", d / hz / t * 100 }')
         else
-            PNAME="其他"
+            NODE_CPU="-"
         fi
-        
-        printf "%-16s %7s %7s %9s %8s\n" "$PNAME" "$CPU" "$MEM" "$MEM_MB" "$PID"
-    done
-    
-    # 填充空行保持格式
-    for i in $(seq $(ps aux | grep -E "(QuickStart|node.*app|arecord|aplay)" | grep -v grep | wc -l) 4); do
-        printf "%-16s %7s %7s %9s %8s\n" "-" "-" "-" "-" "-"
-    done
-    
-    echo "────────────────────────────────────────────────────────────"
-    
+        printf "%-20s %7s %7s %6s %8s  %sMB (pid %s)\n" "[AIGC Server]" "$NODE_CPU" "-" "-" "-" "$NODE_RSS" "$NODE_PID"
+        LAST_NODE_PID=$NODE_PID
+        LAST_NODE_TICKS=$NODE_TICKS
+    else
+        printf "%-64s\n" "[AIGC Server] 未运行"
+        LAST_NODE_PID=""
+    fi
+
+    echo "────────────────────────────────────────────────────────────────"
+
     # 网络流量
     IFACE=$(ip route | grep default | awk '{print $5}' | head -1)
     if [ -n "$IFACE" ] && [ -f "/sys/class/net/$IFACE/statistics/rx_bytes" ]; then
-        RX=$(cat /sys/class/net/$IFACE/statistics/rx_bytes)
-        TX=$(cat /sys/class/net/$IFACE/statistics/tx_bytes)
-        
+        RX=$(cat "/sys/class/net/$IFACE/statistics/rx_bytes")
+        TX=$(cat "/sys/class/net/$IFACE/statistics/tx_bytes")
+
         if [ -n "$LAST_RX" ]; then
-            RX_RATE=$(echo "scale=1; ($RX-$LAST_RX)/$INTERVAL/1024" | bc)
-            TX_RATE=$(echo "scale=1; ($TX-$LAST_TX)/$INTERVAL/1024" | bc)
+            RX_RATE=$(awk -v d=$((RX - LAST_RX)) -v t="$INTERVAL" 'BEGIN { printf "%.1f", d / t / 1024 }')
+            TX_RATE=$(awk -v d=$((TX - LAST_TX)) -v t="$INTERVAL" 'BEGIN { printf "%.1f", d / t / 1024 }')
             printf "\033[1;34m网络(%s):\033[0m 下载 %6s KB/s | 上传 %6s KB/s\n" "$IFACE" "$RX_RATE" "$TX_RATE"
         else
             printf "\033[1;34m网络(%s):\033[0m 计算中...\n" "$IFACE"
@@ -94,18 +120,18 @@ while true; do
         LAST_RX=$RX
         LAST_TX=$TX
     fi
-    
+
     # GPU 信息
     if command -v vcgencmd &> /dev/null; then
         GPU_MEM=$(vcgencmd get_mem gpu 2>/dev/null | cut -d'=' -f2)
         printf "\033[1;34mGPU内存:\033[0m %-10s\n" "$GPU_MEM"
     fi
-    
-    echo "────────────────────────────────────────────────────────────"
+
+    echo "────────────────────────────────────────────────────────────────"
     printf "\033[1;33m刷新: %d秒 | Ctrl+C 退出\033[0m\n" "$INTERVAL"
-    
+
     # 清除剩余行
-    tput el
-    
-    sleep $INTERVAL
+    tput ed
+
+    sleep "$INTERVAL"
 done